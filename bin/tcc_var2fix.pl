@@ -0,0 +1 @@
+/root/repo/tcc/tcc_var2fix.pl
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/tcc/ext/echoh.h
\ No newline at end of file
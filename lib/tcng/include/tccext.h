@@ -0,0 +1 @@
+/root/repo/tcc/ext/tccext.h
\ No newline at end of file
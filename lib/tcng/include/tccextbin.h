@@ -0,0 +1 @@
+/root/repo/tcc/ext/tccextbin.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/tcc/tccmeta.h
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/tcc/tcm_bench.c
\ No newline at end of file
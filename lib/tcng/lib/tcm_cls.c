@@ -0,0 +1 @@
+/root/repo/tcc/tcm_cls.c
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/tcc/tcm_f.c
\ No newline at end of file
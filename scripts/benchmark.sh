@@ -0,0 +1,201 @@
+#!/bin/sh
+#
+# benchmark.sh - Measure compile time, memory use, and output size of tcc
+#
+# Distributed under the GPL.
+#
+
+#
+# For each size, scripts/rulegen.pl generates a configuration with that many
+# filter elements, which is then compiled for each target. The results go to
+# standard output, one line per size and target:
+#
+# <size> <target> <status> <wall> <cpu> <maxrss> <bytes>
+#
+# <status> is "ok", "timeout", "error", or "skipped" if the target already
+# timed out with a smaller size. <wall> and <cpu> are in seconds,
+# and <maxrss> is in kilobytes, as reported by tcc -s. <bytes> is the size of
+# everything tcc generated: tc commands, the input of the external program, or
+# the C code of the module. The "c" target uses a tcc-module that does not
+# build the module, so only tcc itself is measured.
+#
+# With -c, the results are compared with those of an earlier run, and the
+# script fails if any value grew by more than the threshold, or if a run that
+# used to succeed no longer does. Time and memory differences that are too
+# small to be meaningful are ignored.
+#
+# Run this script from the top-level directory.
+#
+
+TARGETS="tc c ext bit"
+SIZES="10 100 1000 10000 100000"
+LIMIT=600
+THRESHOLD=25
+MIN_SECONDS=0.1
+MIN_KB=1024
+
+
+usage()
+{
+    echo "usage: $0 [-c baseline] [-l seconds] [-t percent] [-T targets]" 1>&2
+    echo "                      [size ...]" 1>&2
+    echo "  -c baseline  compare with results of an earlier run" 1>&2
+    echo "  -l seconds   abandon compilations that take longer (default:" \
+      "$LIMIT)" 1>&2
+    echo "  -t percent   maximum acceptable increase (default: $THRESHOLD)" 1>&2
+    echo "  -T targets   targets to use (default: \"$TARGETS\")" 1>&2
+    echo "  size         number of filter elements (default: \"$SIZES\")" 1>&2
+    exit 1
+}
+
+
+baseline=
+while [ ! -z "$1" ]; do
+    case "$1" in
+	-c)	[ -z "$2" ] && usage
+		baseline=$2
+		shift 2;;
+	-l)	[ -z "$2" ] && usage
+		LIMIT=$2
+		shift 2;;
+	-t)	[ -z "$2" ] && usage
+		THRESHOLD=$2
+		shift 2;;
+	-T)	[ -z "$2" ] && usage
+		TARGETS=$2
+		shift 2;;
+	-*)	usage;;
+	*)	break;;
+    esac
+done
+[ -z "$1" ] || SIZES="$*"
+
+top=`pwd`
+[ -z "$TCC" ] && TCC=$top/tcc/tcc
+[ -z "$TCNG_TOPDIR" ] && TCNG_TOPDIR=$top/lib/tcng
+if [ ! -x "$TCC" -o ! -d "$TCNG_TOPDIR/include" ]; then
+    echo "$0: run this script from the top-level directory" 1>&2
+    exit 1
+fi
+if [ ! -z "$baseline" -a ! -r "$baseline" ]; then
+    echo "$0: cannot read $baseline" 1>&2
+    exit 1
+fi
+
+timeout=
+type timeout >/dev/null 2>&1 && timeout="timeout $LIMIT"
+
+dir=${TMPDIR:-/tmp}/tcng-bench-$$
+trap "rm -rf $dir" 0 1 2 15
+mkdir $dir || exit 1
+
+#
+# Shadow TCNG_TOPDIR, with a tcc-module that just leaves the MDI file behind
+#
+
+mkdir $dir/topdir $dir/topdir/bin $dir/work || exit 1
+ln -s $TCNG_TOPDIR/include $dir/topdir/include || exit 1
+for n in $TCNG_TOPDIR/bin/*; do
+    ln -s $n $dir/topdir/bin/ || exit 1
+done
+rm -f $dir/topdir/bin/tcc-module
+cat <<EOF >$dir/topdir/bin/tcc-module
+#!/bin/sh
+exit 0
+EOF
+chmod +x $dir/topdir/bin/tcc-module
+TCNG_TOPDIR=$dir/topdir
+export TCNG_TOPDIR
+
+
+#
+# total <name> <file> - extract a total from the output of tcc -s
+#
+
+total()
+{
+    sed '/^  "'$1'": \([0-9.]*\),*$/s//\1/p;d' <$2
+}
+
+
+run()
+{
+    case "$2" in
+	tc)	args=;;
+	c)	args="-tnotc -tc";;
+	ext)	args="-xif:file -Xx,file=$dir/work/ext";;
+	bit)	args="-xif:file -Xx,file=$dir/work/ext -B";;
+	*)	echo "$0: unknown target \"$2\"" 1>&2
+		exit 1;;
+    esac
+    if echo " $slow " | grep " $2 " >/dev/null; then
+	echo "$1 $2 skipped - - - -"
+	return
+    fi
+    rm -f $dir/work/*
+    ( cd $dir/work && $timeout $TCC -q -s $dir/stats $args $dir/in.tc \
+      >$dir/work/out 2>$dir/err )
+    case $? in
+	0)	status=ok;;
+	124)	status=timeout
+		slow="$slow $2";;
+	*)	status=error
+		sed 's/^/# /' <$dir/err;;
+    esac
+    if [ $status = ok ]; then
+	echo "$1 $2 $status `total wall $dir/stats` `total cpu $dir/stats`" \
+	  "`total maxrss $dir/stats` `cat $dir/work/* | wc -c`"
+    else
+	echo "$1 $2 $status - - - -"
+    fi
+}
+
+
+slow=
+echo "# size target status wall cpu maxrss bytes"
+for size in $SIZES; do
+    perl $top/scripts/rulegen.pl $size >$dir/in.tc || exit 1
+    for target in $TARGETS; do
+	run $size $target
+    done
+done | tee $dir/results
+
+[ -z "$baseline" ] && exit 0
+
+#
+# Compare with baseline
+#
+
+awk '
+    NR == FNR {
+	if ($1 ~ /^#/) next;
+	status[$1 " " $2] = $3;
+	for (i = 4; i <= 7; i++)
+	    value[$1 " " $2 " " i] = $i;
+	next;
+    }
+    function check(key,name,i,min,	old,new)
+    {
+	old = value[key " " i];
+	new = $i;
+	if (new <= old*(1+'$THRESHOLD'/100) || new-old < min) return;
+	print "REGRESSION: " key " " name " " old " -> " new;
+	bad = 1;
+    }
+    {
+	if ($1 ~ /^#/) next;
+	key = $1 " " $2;
+	if (!(key in status) || status[key] != "ok") next;
+	if ($3 != "ok") {
+	    print "REGRESSION: " key " " $3;
+	    bad = 1;
+	    next;
+	}
+	check(key,"wall",4,'$MIN_SECONDS');
+	check(key,"cpu",5,'$MIN_SECONDS');
+	check(key,"maxrss",6,'$MIN_KB');
+	check(key,"bytes",7,0);
+    }
+    END {
+	exit bad;
+    }' $baseline - <$dir/results
@@ -0,0 +1,109 @@
+#!/usr/bin/perl
+#
+# rulegen.pl - Generate synthetic tcng configurations of a given size
+#
+# Distributed under the GPL.
+#
+
+#
+# The configuration consists of an HTB qdisc on eth0 with "elements" filter
+# elements, which select leaf classes and cycle through the following kinds of
+# selectors:
+#
+# - destination address prefix
+# - source address prefix and TCP destination port
+# - UDP destination port
+# - destination address prefix and a policer (if there are any policers),
+#   dropping what exceeds the rate
+#
+# Policers are used in turn, HTB classes at random.
+#
+# Addresses, prefix lengths, and ports come from a simple linear congruential
+# generator, so the output only depends on the arguments, not on the Perl
+# version.
+#
+
+sub usage
+{
+    print STDERR "usage: $0 [-c classes] [-p policers] [-s seed] elements\n";
+    print STDERR "  -c classes   number of HTB leaf classes (default: ".
+      "elements/10, 1 to 1000)\n";
+    print STDERR "  -p policers  number of policers (default: elements/100)\n";
+    print STDERR "  -s seed      seed of the number generator (default: 1)\n";
+    exit(1);
+}
+
+
+sub rnd
+{
+    local ($n) = @_;
+
+    $seed = ($seed*1103515245+12345) % 2147483648;
+    return int(($seed >> 8)*$n/8388608);
+}
+
+
+sub prefix
+{
+    local ($min) = @_;
+    local ($len, $addr);
+
+    $len = $min+&rnd(33-$min);
+    $addr = 0x0a000000+&rnd(0x1000000);
+    $addr &= ~((1 << (32-$len))-1) & 0xffffffff if $len < 32;
+    return sprintf(":%d == %d.%d.%d.%d",$len,$addr >> 24,
+      ($addr >> 16) & 255,($addr >> 8) & 255,$addr & 255);
+}
+
+
+$seed = 1;
+while ($ARGV[0] =~ /^-/) {
+    $opt = shift;
+    &usage unless defined $ARGV[0];
+    if ($opt eq "-c") { $classes = shift; }
+    elsif ($opt eq "-p") { $policers = shift; }
+    elsif ($opt eq "-s") { $seed = shift; }
+    else { &usage; }
+}
+&usage unless $#ARGV == 0 && $ARGV[0] =~ /^\d+$/;
+$elements = $ARGV[0];
+if (!defined $classes) {
+    $classes = int($elements/10);
+    $classes = 1 if $classes < 1;
+    $classes = 1000 if $classes > 1000;
+}
+$policers = int($elements/100) unless defined $policers;
+&usage if $classes < 1;
+
+print "/* $elements elements, $classes classes, $policers policers */\n\n";
+print "dev eth0 {\n    egress {\n";
+for ($i = 0; $i < $policers; $i++) {
+    printf("\t\$p%d = SLB(cir %dkbps, cbs %dkB);\n",$i,64+&rnd(1000),
+      2+&rnd(30));
+}
+print "\n" if $policers;
+for ($i = 0; $i < $elements; $i++) {
+    $kind = $i % 4;
+    $kind = 0 if $kind == 3 && !$policers;
+    printf("\tclass (<\$c%d>) if ",&rnd($classes));
+    if ($kind == 0) {
+	print "ip_dst".&prefix(8);
+    }
+    elsif ($kind == 1) {
+	printf("ip_src%s && tcp_dport == %d",&prefix(16),1+&rnd(65535));
+    }
+    elsif ($kind == 2) {
+	printf("udp_dport == %d",1+&rnd(65535));
+    }
+    else {
+	printf("ip_dst%s && SLB_else_drop(\$p%d)",&prefix(16),
+	  $policed++ % $policers);
+    }
+    print ";\n";
+}
+print "\n\thtb {\n\t    class (rate 100Mbps, ceil 100Mbps) {\n";
+for ($i = 0; $i < $classes; $i++) {
+    printf("\t\t\$c%d = class (rate %dkbps, ceil 100Mbps);\n",$i,
+      int(100000/$classes));
+}
+print "\t    }\n\t}\n    }\n}\n";
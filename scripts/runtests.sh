@@ -29,8 +29,8 @@
 #
 # The only comments allowed are the test titles, but <input> may contain lines
 # beginning with a hash sign (#). runtests.sh defines the commands tcc, tcsim,
-# trinity, and tcsim_filter, so that no path names have to be specified to
-# access them.
+# trinity, tcsim_filter, and tcc_bpf_run, so that no path names have to be
+# specified to access them.
 #
 # runtests.sh executes each command with standard input from the <input>
 # section. Normally, the command is expected to return with exit status zero
@@ -102,6 +102,7 @@ TCSIM_CMD="`find_in_path tcsim $TOPDIR/bin:$PATH`"
 TRINITY="`find_in_path trinity.sh $TOPDIR/scripts:$PATH`"
 TCSIM_FILTER="`find_in_path tcsim_filter $TOPDIR/bin:$PATH`"
 TCSIM_PLOT="`find_in_path tcsim_plot $TOPDIR/bin:$PATH`"
+TCC_BPF_RUN="`find_in_path tcc-bpf-run $TOPDIR/bin:$PATH`"
 VALGRIND=
 
 set -a
@@ -235,6 +236,12 @@ tcsim_plot()
 }
 
 
+tcc_bpf_run()
+{
+    $TCC_BPF_RUN "$@"
+}
+
+
 runtests()
 {
     sed 's/^|//' | scripts/runtests.sh
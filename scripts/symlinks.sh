@@ -57,7 +57,7 @@ fi
 # bin
 #
 link $2/bin \
-  tcc/tcc tcc/tcc_var2fix.pl \
+  tcc/tcc tcc/tcc_var2fix.pl tcc/tcc-bpf-run \
   tcsim/tcsim tcsim/tcsim_filter tcsim/tcsim_plot tcsim/tcsim_pretty
 
 #
@@ -74,7 +74,7 @@ link $2/lib/tcng/bin \
 link $2/lib/tcng/include \
   tcc/default.tc tcc/meta.tc tcc/fields.tc tcc/fields4.tc tcc/fields6.tc \
   tcc/values.tc tcc/meters.tc tcc/ports.tc tcc/idiomatic.tc \
-  tcc/ext/tccext.h tcc/ext/echoh.h \
+  tcc/ext/tccext.h tcc/ext/tccextbin.h tcc/ext/echoh.h \
   tcc/tccmeta.h \
   tcsim/default.tcsim \
   tcsim/ip.def tcsim/packet.def tcsim/packet4.def tcsim/packet6.def \
@@ -85,7 +85,7 @@ link $2/lib/tcng/include \
 # lib/tcng/lib
 #
 link $2/lib/tcng/lib \
-  tcc/tcm_cls.c tcc/tcm_f.c \
+  tcc/tcm_cls.c tcc/tcm_f.c tcc/tcm_bench.c \
   tcc/ext/libtccext.a
 
 #
@@ -8,6 +8,7 @@
 
 
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <ctype.h>
@@ -21,10 +22,16 @@
 /* ----- Malloc wrappers --------------------------------------------------- */
 
 
+unsigned long alloc_count = 0;
+unsigned long alloc_bytes = 0;
+
+
 void *alloc(size_t size)
 {
     void *new;
 
+    alloc_count++;
+    alloc_bytes += size;
     new = malloc(size);
     if (new) return new;
     perror("malloc");
@@ -36,6 +43,8 @@ char *stralloc(const char *s)
 {
     char *new;
 
+    alloc_count++;
+    alloc_bytes += strlen(s)+1;
     new = strdup(s);
     if (new) return new;
     perror("strdup");
@@ -43,6 +52,73 @@ char *stralloc(const char *s)
 }
 
 
+/* ----- Regions ----------------------------------------------------------- */
+
+
+#define REGION_CHUNK	65536	/* default chunk size, in bytes */
+
+union region_align {
+    long l;
+    double d;
+    void *p;
+};
+
+#define REGION_ROUND(n) \
+  (((n)+sizeof(union region_align)-1) & ~(sizeof(union region_align)-1))
+
+struct _region_chunk {
+    struct _region_chunk *next;
+    union region_align data[1];
+};
+
+
+void *region_alloc(REGION *region,size_t size)
+{
+    struct _region_chunk *chunk;
+    void *p;
+
+    size = REGION_ROUND(size ? size : 1);
+    if (size <= region->left) {
+	p = region->next;
+	region->next += size;
+	region->left -= size;
+	return p;
+    }
+    if (size > REGION_CHUNK/4) {
+	/* large objects get a chunk of their own */
+	chunk = alloc(offsetof(struct _region_chunk,data)+size);
+	if (region->chunks) {
+	    chunk->next = region->chunks->next;
+	    region->chunks->next = chunk;
+	}
+	else {
+	    chunk->next = NULL;
+	    region->chunks = chunk;
+	}
+	return chunk->data;
+    }
+    chunk = alloc(offsetof(struct _region_chunk,data)+REGION_CHUNK);
+    chunk->next = region->chunks;
+    region->chunks = chunk;
+    region->next = (char *) chunk->data+size;
+    region->left = REGION_CHUNK-size;
+    return chunk->data;
+}
+
+
+void region_free(REGION *region)
+{
+    while (region->chunks) {
+	struct _region_chunk *next = region->chunks->next;
+
+	free(region->chunks);
+	region->chunks = next;
+    }
+    region->next = NULL;
+    region->left = 0;
+}
+
+
 /* ----- "Safe" sprintf ---------------------------------------------------- */
 
 
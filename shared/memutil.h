@@ -18,10 +18,34 @@
 
 #define alloc_t(T) ((T *) alloc(sizeof(T)))
 
+extern unsigned long alloc_count;	/* calls to alloc and stralloc */
+extern unsigned long alloc_bytes;	/* bytes requested from them */
+
 void *alloc(size_t size);
 char *stralloc(const char *s);
 
 
+/* ----- Regions ----------------------------------------------------------- */
+
+/*
+ * A region hands out memory from large chunks, and releases all of it at once.
+ * Objects allocated from a region must not be freed individually.
+ */
+
+typedef struct {
+    struct _region_chunk *chunks;
+    char *next;			/* next free byte in the current chunk */
+    size_t left;		/* bytes left in the current chunk */
+} REGION;
+
+#define REGION_INIT { NULL, NULL, 0 }
+
+#define region_alloc_t(r,T) ((T *) region_alloc(r,sizeof(T)))
+
+void *region_alloc(REGION *region,size_t size);
+void region_free(REGION *region);
+
+
 /* ----- "Safe" sprintf ---------------------------------------------------- */
 
 
@@ -0,0 +1,179 @@
+/*
+ * bpf.h - eBPF definitions shared by the "bpf" target and tcc-bpf-run
+ *
+ * We don't include <linux/bpf.h>, so that tcc still builds on systems whose
+ * kernel headers predate eBPF.
+ */
+
+
+#ifndef EBPF_H
+#define EBPF_H
+
+#include <stdint.h>
+
+
+/*
+ * Instruction format
+ */
+
+struct bpf_insn {
+    uint8_t code;
+    uint8_t dst_reg:4;
+    uint8_t src_reg:4;
+    int16_t off;
+    int32_t imm;
+};
+
+/* instruction classes */
+#define BPF_LD		0x00
+#define BPF_LDX		0x01
+#define BPF_ST		0x02
+#define BPF_STX		0x03
+#define BPF_ALU		0x04
+#define BPF_JMP		0x05
+#define BPF_ALU64	0x07
+#define BPF_CLASS(code)	((code) & 0x07)
+
+/* load and store sizes */
+#define BPF_W		0x00
+#define BPF_H		0x08
+#define BPF_B		0x10
+#define BPF_DW		0x18
+#define BPF_SIZE(code)	((code) & 0x18)
+
+/* load and store modes */
+#define BPF_IMM		0x00
+#define BPF_ABS		0x20
+#define BPF_IND		0x40
+#define BPF_MEM		0x60
+#define BPF_MODE(code)	((code) & 0xe0)
+
+/* ALU operations */
+#define BPF_ADD		0x00
+#define BPF_SUB		0x10
+#define BPF_MUL		0x20
+#define BPF_DIV		0x30
+#define BPF_OR		0x40
+#define BPF_AND		0x50
+#define BPF_LSH		0x60
+#define BPF_RSH		0x70
+#define BPF_NEG		0x80
+#define BPF_MOD		0x90
+#define BPF_XOR		0xa0
+#define BPF_MOV		0xb0
+#define BPF_END		0xd0
+#define BPF_OP(code)	((code) & 0xf0)
+
+/* jumps */
+#define BPF_JA		0x00
+#define BPF_JEQ		0x10
+#define BPF_JGT		0x20
+#define BPF_JGE		0x30
+#define BPF_JSET	0x40
+#define BPF_JNE		0x50
+#define BPF_CALL	0x80
+#define BPF_EXIT	0x90
+#define BPF_JLT		0xa0
+#define BPF_JLE		0xb0
+
+/* operand source */
+#define BPF_K		0x00
+#define BPF_X		0x08
+#define BPF_SRC(code)	((code) & 0x08)
+
+#define BPF_TO_BE	0x08	/* for BPF_END */
+
+#define BPF_PSEUDO_MAP_FD 1	/* src_reg of BPF_LD | BPF_IMM | BPF_DW */
+
+/* registers */
+#define BPF_REG_0	0	/* return value, result of BPF_ABS/BPF_IND */
+#define BPF_REG_1	1	/* first argument, context at entry */
+#define BPF_REG_2	2
+#define BPF_REG_3	3
+#define BPF_REG_4	4
+#define BPF_REG_5	5
+#define BPF_REG_6	6	/* callee-saved */
+#define BPF_REG_7	7
+#define BPF_REG_8	8
+#define BPF_REG_9	9
+#define BPF_REG_10	10	/* read-only frame pointer */
+#define BPF_REGS	11
+
+#define BPF_STACK_SIZE	512
+
+/* helper functions */
+#define BPF_FUNC_map_lookup_elem 1
+#define BPF_FUNC_ktime_get_ns	5
+#define BPF_FUNC_skb_load_bytes_relative 68
+
+/* start_header of bpf_skb_load_bytes_relative */
+#define BPF_HDR_START_NET 1
+
+
+/*
+ * Fields of struct __sk_buff we use
+ */
+
+#define SKB_LEN		0
+#define SKB_MARK	8
+#define SKB_PROTOCOL	16
+#define SKB_TC_INDEX	44
+#define SKB_TC_CLASSID	72
+#define SKB_SIZE	84	/* up to and including data_end */
+
+
+/*
+ * Return values in direct-action mode
+ */
+
+#define TC_ACT_UNSPEC	-1
+#define TC_ACT_OK	0
+#define TC_ACT_RECLASSIFY 1
+#define TC_ACT_SHOT	2
+
+
+/*
+ * Object file, as understood by tc. Maps are described by struct bpf_elf_map
+ * in the section BPF_MAPS_SEC, with one global symbol per map. Instructions
+ * referring to a map are loaded with BPF_LD | BPF_IMM | BPF_DW, and have a
+ * relocation against that symbol.
+ */
+
+#define BPF_PROG_SEC	"classifier"
+#define BPF_MAPS_SEC	"maps"
+#define BPF_LICENSE_SEC	"license"
+#define BPF_LICENSE	"GPL"
+
+#ifndef EM_BPF
+#define EM_BPF		247
+#endif
+#define R_BPF_64_64	1
+
+#define BPF_MAP_TYPE_ARRAY 2
+
+struct bpf_elf_map {
+    uint32_t type;
+    uint32_t size_key;
+    uint32_t size_value;
+    uint32_t max_elem;
+    uint32_t flags;
+    uint32_t id;
+    uint32_t pinning;
+    uint32_t inner_id;
+    uint32_t inner_idx;
+};
+
+
+/*
+ * Policers keep their state in an array map, indexed by bucket number. Since
+ * the kernel initializes arrays with zeroes, we store how many tokens are
+ * missing in the bucket, not how many it contains. That way, all buckets
+ * start out full.
+ */
+
+#define BPF_BUCKET_MAP	"tcng_buckets"
+#define BPF_BUCKET_DEFICIT 0	/* u64, depth minus tokens */
+#define BPF_BUCKET_LAST	8	/* u64, time of last refill, in ns */
+#define BPF_BUCKET_SIZE	16
+
+#endif /* EBPF_H */
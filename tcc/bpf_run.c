@@ -0,0 +1,656 @@
+/*
+ * bpf_run.c - Run a classifier generated by the "bpf" target in user space
+ *
+ * tcsim can't run cls_bpf, so this is how we check what the "bpf" target
+ * generates: tcc-bpf-run loads the object file like tc would, and interprets
+ * the program for each packet enqueued in the output of tcsim -v. The time of
+ * the enqueue event is what bpf_ktime_get_ns() returns, so policers behave
+ * like they would on a real system that receives the same packets.
+ *
+ * The interpreter only implements what the "bpf" target uses, but it checks
+ * all memory accesses, so that a bad program is reported instead of just
+ * crashing tcc-bpf-run.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <endian.h>
+#include <elf.h>
+
+#include "bpf.h"
+
+
+#define MAX_LINE	65536	/* maximum line length in tcsim output */
+#define MAX_STEPS	1000000	/* give up if a program runs that long */
+
+#define TC_H_MAJ(h)	((h) & 0xffff0000)
+#define TC_H_MIN(h)	((h) & 0xffff)
+
+
+struct map {
+    struct bpf_elf_map dsc;
+    uint8_t *values;
+};
+
+
+static const char *object;	/* name of the object file */
+static struct bpf_insn *insns;
+static int n_insns;
+static struct map *maps;
+static int n_maps;
+
+static uint8_t ctx[SKB_SIZE];
+static uint8_t stack[BPF_STACK_SIZE];
+static const uint8_t *pkt;	/* packet, starting at the network header */
+static uint32_t pkt_len;
+static uint64_t now;		/* time of the current packet, in ns */
+
+
+static void fatal(const char *msg,int pc)
+{
+    if (pc < 0) fprintf(stderr,"%s: %s\n",object,msg);
+    else fprintf(stderr,"%s: instruction %d: %s\n",object,pc,msg);
+    exit(1);
+}
+
+
+/* ------------------------------ Object file ------------------------------ */
+
+
+static uint8_t *read_file(const char *name,size_t *size)
+{
+    FILE *file;
+    uint8_t *buf = NULL;
+    size_t got = 0,n;
+
+    file = fopen(name,"r");
+    if (!file) {
+	perror(name);
+	exit(1);
+    }
+    do {
+	buf = realloc(buf,got+65536);
+	if (!buf) {
+	    perror("realloc");
+	    exit(1);
+	}
+	n = fread(buf+got,1,65536,file);
+	got += n;
+    }
+    while (n);
+    if (ferror(file)) {
+	perror(name);
+	exit(1);
+    }
+    (void) fclose(file);
+    *size = got;
+    return buf;
+}
+
+
+static const Elf64_Shdr *section(const uint8_t *elf,size_t size,int n)
+{
+    const Elf64_Ehdr *eh = (const Elf64_Ehdr *) elf;
+    const Elf64_Shdr *sh;
+
+    if (n <= 0 || n >= eh->e_shnum) fatal("bad section index",-1);
+    sh = (const Elf64_Shdr *) (elf+eh->e_shoff)+n;
+    if (sh->sh_type != SHT_NOBITS &&
+      (sh->sh_offset > size || sh->sh_size > size-sh->sh_offset))
+	fatal("section extends beyond end of file",-1);
+    return sh;
+}
+
+
+static void load_object(void)
+{
+    const Elf64_Ehdr *eh;
+    const Elf64_Shdr *names,*prog = NULL,*map_sec = NULL,*rel = NULL;
+    const char *strtab;
+    uint8_t *elf;
+    size_t size;
+    int prog_idx = 0,map_idx = 0;
+    int i;
+
+    elf = read_file(object,&size);
+    eh = (const Elf64_Ehdr *) elf;
+    if (size < sizeof(Elf64_Ehdr) || memcmp(eh->e_ident,ELFMAG,SELFMAG) ||
+      eh->e_ident[EI_CLASS] != ELFCLASS64)
+	fatal("not a 64 bit ELF file",-1);
+    if (eh->e_machine != EM_BPF) fatal("not an eBPF object",-1);
+    if (eh->e_shoff > size ||
+      eh->e_shnum*sizeof(Elf64_Shdr) > size-eh->e_shoff)
+	fatal("bad section header table",-1);
+    names = section(elf,size,eh->e_shstrndx);
+    strtab = (const char *) elf+names->sh_offset;
+    for (i = 1; i < eh->e_shnum; i++) {
+	const Elf64_Shdr *sh = section(elf,size,i);
+	const char *name = strtab+sh->sh_name;
+
+	if (sh->sh_name >= names->sh_size) fatal("bad section name",-1);
+	if (!strcmp(name,BPF_PROG_SEC)) {
+	    prog = sh;
+	    prog_idx = i;
+	}
+	else if (!strcmp(name,BPF_MAPS_SEC)) {
+	    map_sec = sh;
+	    map_idx = i;
+	}
+	else if (sh->sh_type == SHT_REL && !strncmp(name,".rel",4) &&
+	  !strcmp(name+4,BPF_PROG_SEC))
+	    rel = sh;
+    }
+    if (!prog) fatal("no section \"" BPF_PROG_SEC "\"",-1);
+    insns = (struct bpf_insn *) (elf+prog->sh_offset);
+    n_insns = prog->sh_size/sizeof(struct bpf_insn);
+    if (map_sec) {
+	n_maps = map_sec->sh_size/sizeof(struct bpf_elf_map);
+	maps = calloc(n_maps,sizeof(struct map));
+	if (!maps) {
+	    perror("calloc");
+	    exit(1);
+	}
+	for (i = 0; i < n_maps; i++) {
+	    struct map *m = maps+i;
+
+	    memcpy(&m->dsc,elf+map_sec->sh_offset+i*sizeof(struct bpf_elf_map),
+	      sizeof(struct bpf_elf_map));
+	    if (m->dsc.type != BPF_MAP_TYPE_ARRAY || m->dsc.size_key != 4)
+		fatal("unsupported map type",-1);
+	    m->values = calloc(m->dsc.max_elem,m->dsc.size_value);
+	    if (!m->values) {
+		perror("calloc");
+		exit(1);
+	    }
+	}
+    }
+    if (rel) {
+	const Elf64_Shdr *symtab = section(elf,size,rel->sh_link);
+	const Elf64_Rel *r = (const Elf64_Rel *) (elf+rel->sh_offset);
+	int n = rel->sh_size/sizeof(Elf64_Rel);
+
+	if (rel->sh_info != prog_idx) fatal("relocations for wrong section",-1);
+	for (i = 0; i < n; i++) {
+	    const Elf64_Sym *sym;
+	    int pc = r[i].r_offset/sizeof(struct bpf_insn);
+
+	    if (ELF64_R_SYM(r[i].r_info) >= symtab->sh_size/sizeof(Elf64_Sym))
+		fatal("bad symbol in relocation",-1);
+	    sym = (const Elf64_Sym *) (elf+symtab->sh_offset)+
+	      ELF64_R_SYM(r[i].r_info);
+	    if (pc >= n_insns-1 ||
+	      insns[pc].code != (BPF_LD | BPF_IMM | BPF_DW))
+		fatal("relocation doesn't point to a 64 bit load",pc);
+	    if (sym->st_shndx != map_idx ||
+	      sym->st_value/sizeof(struct bpf_elf_map) >= n_maps)
+		fatal("relocation doesn't refer to a map",pc);
+	    insns[pc].src_reg = BPF_PSEUDO_MAP_FD;
+	    insns[pc].imm = sym->st_value/sizeof(struct bpf_elf_map);
+	}
+    }
+}
+
+
+/* ------------------------------ Interpreter ------------------------------ */
+
+
+/*
+ * Returns a pointer to "size" bytes at "addr", if all of them are in the
+ * context, on the stack, or in a map value.
+ */
+
+static uint8_t *access_mem(uint64_t addr,int size,int write,int pc)
+{
+    uint8_t *p = (uint8_t *) (uintptr_t) addr;
+    int i;
+
+    if (p >= ctx && p+size <= ctx+SKB_SIZE) {
+	if (write && p != ctx+SKB_TC_CLASSID)
+	    fatal("write to read-only context field",pc);
+	return p;
+    }
+    if (p >= stack && p+size <= stack+BPF_STACK_SIZE) return p;
+    for (i = 0; i < n_maps; i++) {
+	const struct map *m = maps+i;
+
+	if (p >= m->values &&
+	  p+size <= m->values+(size_t) m->dsc.max_elem*m->dsc.size_value)
+	    return p;
+    }
+    fatal("invalid memory access",pc);
+    return NULL; /* not reached */
+}
+
+
+static uint64_t load_mem(const uint8_t *p,int size)
+{
+    uint8_t v8;
+    uint16_t v16;
+    uint32_t v32;
+    uint64_t v64;
+
+    switch (size) {
+	case 1:
+	    memcpy(&v8,p,1);
+	    return v8;
+	case 2:
+	    memcpy(&v16,p,2);
+	    return v16;
+	case 4:
+	    memcpy(&v32,p,4);
+	    return v32;
+	default:
+	    memcpy(&v64,p,8);
+	    return v64;
+    }
+}
+
+
+static void store_mem(uint8_t *p,int size,uint64_t value)
+{
+    uint8_t v8 = value;
+    uint16_t v16 = value;
+    uint32_t v32 = value;
+
+    switch (size) {
+	case 1:
+	    memcpy(p,&v8,1);
+	    break;
+	case 2:
+	    memcpy(p,&v16,2);
+	    break;
+	case 4:
+	    memcpy(p,&v32,4);
+	    break;
+	default:
+	    memcpy(p,&value,8);
+    }
+}
+
+
+static int mem_size(uint8_t code)
+{
+    switch (BPF_SIZE(code)) {
+	case BPF_B:
+	    return 1;
+	case BPF_H:
+	    return 2;
+	case BPF_W:
+	    return 4;
+	default:
+	    return 8;
+    }
+}
+
+
+/*
+ * bpf_skb_load_bytes_relative. Returns -EFAULT if the packet is too short.
+ */
+
+static uint64_t load_bytes(const uint64_t *reg,int pc)
+{
+    uint64_t off = reg[BPF_REG_2],len = reg[BPF_REG_4];
+    uint8_t *to;
+
+    if ((const uint8_t *) (uintptr_t) reg[BPF_REG_1] != ctx)
+	fatal("skb_load_bytes_relative: not the context",pc);
+    if (reg[BPF_REG_5] != BPF_HDR_START_NET)
+	fatal("only offsets relative to the network header are supported",pc);
+    if (!len || len > BPF_STACK_SIZE)
+	fatal("skb_load_bytes_relative: bad length",pc);
+    to = access_mem(reg[BPF_REG_3],len,1,pc);
+    if (off > pkt_len || len > pkt_len-off) {
+	memset(to,0,len);
+	return (uint64_t) -EFAULT;
+    }
+    memcpy(to,pkt+off,len);
+    return 0;
+}
+
+
+static uint64_t alu(uint8_t op,uint64_t a,uint64_t b,int bits,int pc)
+{
+    switch (op) {
+	case BPF_ADD:
+	    return a+b;
+	case BPF_SUB:
+	    return a-b;
+	case BPF_MUL:
+	    return a*b;
+	case BPF_DIV:
+	    return b ? a/b : 0;
+	case BPF_MOD:
+	    return b ? a % b : a;
+	case BPF_OR:
+	    return a | b;
+	case BPF_AND:
+	    return a & b;
+	case BPF_XOR:
+	    return a ^ b;
+	case BPF_LSH:
+	    return a << (b & (bits-1));
+	case BPF_RSH:
+	    return a >> (b & (bits-1));
+	case BPF_NEG:
+	    return -a;
+	case BPF_MOV:
+	    return b;
+	default:
+	    fatal("unsupported ALU operation",pc);
+	    return 0; /* not reached */
+    }
+}
+
+
+static uint64_t byte_swap(uint64_t v,int bits,int pc)
+{
+    switch (bits) {
+	case 16:
+	    return htobe16(v);
+	case 32:
+	    return htobe32(v);
+	case 64:
+	    return htobe64(v);
+	default:
+	    fatal("bad byte swap width",pc);
+	    return 0; /* not reached */
+    }
+}
+
+
+static int jump(uint8_t op,uint64_t a,uint64_t b,int pc)
+{
+    switch (op) {
+	case BPF_JEQ:
+	    return a == b;
+	case BPF_JNE:
+	    return a != b;
+	case BPF_JGT:
+	    return a > b;
+	case BPF_JGE:
+	    return a >= b;
+	case BPF_JLT:
+	    return a < b;
+	case BPF_JLE:
+	    return a <= b;
+	case BPF_JSET:
+	    return !!(a & b);
+	default:
+	    fatal("unsupported jump",pc);
+	    return 0; /* not reached */
+    }
+}
+
+
+static uint64_t call(int32_t func,uint64_t *reg,int pc)
+{
+    const struct map *m;
+    uint32_t key;
+
+    switch (func) {
+	case BPF_FUNC_map_lookup_elem:
+	    m = (const struct map *) (uintptr_t) reg[BPF_REG_1];
+	    if (m < maps || m >= maps+n_maps)
+		fatal("map_lookup_elem: not a map",pc);
+	    key = load_mem(access_mem(reg[BPF_REG_2],4,0,pc),4);
+	    if (key >= m->dsc.max_elem) return 0;
+	    return (uintptr_t) (m->values+(size_t) key*m->dsc.size_value);
+	case BPF_FUNC_ktime_get_ns:
+	    return now;
+	case BPF_FUNC_skb_load_bytes_relative:
+	    return load_bytes(reg,pc);
+	default:
+	    fatal("unsupported helper function",pc);
+	    return 0; /* not reached */
+    }
+}
+
+
+static int run(void)
+{
+    uint64_t reg[BPF_REGS];
+    int pc = 0,steps = 0;
+
+    memset(reg,0,sizeof(reg));
+    memset(stack,0,sizeof(stack));
+    reg[BPF_REG_1] = (uintptr_t) ctx;
+    reg[BPF_REG_10] = (uintptr_t) (stack+BPF_STACK_SIZE);
+    while (1) {
+	const struct bpf_insn *insn;
+	uint64_t src;
+	int bits;
+
+	if (pc < 0 || pc >= n_insns) fatal("jump out of program",pc);
+	if (++steps > MAX_STEPS) fatal("program doesn't terminate",pc);
+	insn = insns+pc;
+	if (insn->dst_reg >= BPF_REGS || insn->src_reg >= BPF_REGS)
+	    fatal("bad register",pc);
+	src = BPF_SRC(insn->code) == BPF_X ? reg[insn->src_reg] :
+	  (uint64_t) (int64_t) insn->imm;
+	switch (BPF_CLASS(insn->code)) {
+	    case BPF_ALU:
+	    case BPF_ALU64:
+		if (insn->dst_reg == BPF_REG_10)
+		    fatal("write to frame pointer",pc);
+		bits = BPF_CLASS(insn->code) == BPF_ALU ? 32 : 64;
+		if (BPF_OP(insn->code) == BPF_END) {
+		    reg[insn->dst_reg] =
+		      BPF_SRC(insn->code) == BPF_TO_BE ?
+		      byte_swap(reg[insn->dst_reg],insn->imm,pc) :
+		      reg[insn->dst_reg];
+		    if (insn->imm < 64)
+			reg[insn->dst_reg] &= (1ULL << insn->imm)-1;
+		    break;
+		}
+		if (bits == 32) {
+		    reg[insn->dst_reg] = (uint32_t) alu(BPF_OP(insn->code),
+		      (uint32_t) reg[insn->dst_reg],(uint32_t) src,32,pc);
+		}
+		else {
+		    reg[insn->dst_reg] = alu(BPF_OP(insn->code),
+		      reg[insn->dst_reg],src,64,pc);
+		}
+		break;
+	    case BPF_JMP:
+		switch (BPF_OP(insn->code)) {
+		    case BPF_EXIT:
+			return (int32_t) reg[BPF_REG_0];
+		    case BPF_CALL:
+			reg[BPF_REG_0] = call(insn->imm,reg,pc);
+			break;
+		    case BPF_JA:
+			pc += insn->off;
+			break;
+		    default:
+			if (jump(BPF_OP(insn->code),reg[insn->dst_reg],src,pc))
+			    pc += insn->off;
+		}
+		break;
+	    case BPF_LDX:
+		if (BPF_MODE(insn->code) != BPF_MEM) fatal("bad load mode",pc);
+		reg[insn->dst_reg] = load_mem(access_mem(reg[insn->src_reg]+
+		  insn->off,mem_size(insn->code),0,pc),mem_size(insn->code));
+		break;
+	    case BPF_STX:
+	    case BPF_ST:
+		if (BPF_MODE(insn->code) != BPF_MEM) fatal("bad store mode",pc);
+		store_mem(access_mem(reg[insn->dst_reg]+insn->off,
+		  mem_size(insn->code),1,pc),mem_size(insn->code),
+		  BPF_CLASS(insn->code) == BPF_STX ? reg[insn->src_reg] :
+		  (uint64_t) (int64_t) insn->imm);
+		break;
+	    case BPF_LD:
+		switch (BPF_MODE(insn->code)) {
+		    case BPF_IMM:
+			if (BPF_SIZE(insn->code) != BPF_DW || pc == n_insns-1)
+			    fatal("bad immediate load",pc);
+			if (insn->src_reg == BPF_PSEUDO_MAP_FD) {
+			    if (insn->imm < 0 || insn->imm >= n_maps)
+				fatal("bad map reference",pc);
+			    reg[insn->dst_reg] = (uintptr_t) (maps+insn->imm);
+			}
+			else {
+			    reg[insn->dst_reg] = (uint32_t) insn->imm |
+			      (uint64_t) insn[1].imm << 32;
+			}
+			pc++;
+			break;
+		    default:
+			fatal("bad load mode",pc);
+		}
+		break;
+	    default:
+		fatal("unsupported instruction class",pc);
+	}
+	pc++;
+    }
+}
+
+
+/* --------------------------------- Packets ------------------------------- */
+
+
+static const char *action(int ret)
+{
+    static char buf[20];
+
+    switch (ret) {
+	case TC_ACT_UNSPEC:
+	    return "UNSPEC (-1)";
+	case TC_ACT_OK:
+	    return "OK (0)";
+	case TC_ACT_RECLASSIFY:
+	    return "RECLASSIFY (1)";
+	case TC_ACT_SHOT:
+	    return "SHOT (2)";
+	default:
+	    sprintf(buf,"%d",ret);
+	    return buf;
+    }
+}
+
+
+/*
+ * cls_bpf in direct-action mode combines the major number of the filter's
+ * classid with the tc_classid the program sets.
+ */
+
+static void classify(const char *time,uint32_t classid)
+{
+    uint16_t protocol;
+    uint32_t v;
+    int ret;
+
+    memset(ctx,0,sizeof(ctx));
+    v = pkt_len;
+    memcpy(ctx+SKB_LEN,&v,4);
+    protocol = htobe16(pkt_len && (*pkt >> 4) == 6 ? 0x86dd : 0x0800);
+    v = protocol;
+    memcpy(ctx+SKB_PROTOCOL,&v,4);
+    ret = run();
+    printf("%s %u : returns %s",time,(unsigned) pkt_len,action(ret));
+    if (ret == TC_ACT_OK || ret == TC_ACT_RECLASSIFY) {
+	memcpy(&v,ctx+SKB_TC_CLASSID,4);
+	v = TC_H_MAJ(classid) | TC_H_MIN(v);
+	printf(" (%x:%x)",(unsigned) (v >> 16),(unsigned) TC_H_MIN(v));
+    }
+    putchar('\n');
+}
+
+
+/*
+ * Enqueue lines look like this:
+ * 0.000000 E : 0x00000000 28 : eth0: 4500001c 00000000 ...
+ * Packets that were truncated by tcsim -s are skipped.
+ */
+
+static void read_tcsim(FILE *file,uint32_t classid)
+{
+    static char line[MAX_LINE];
+    uint8_t *buf;
+
+    buf = malloc(MAX_LINE/2);
+    if (!buf) {
+	perror("malloc");
+	exit(1);
+    }
+    pkt = buf;
+    while (fgets(line,MAX_LINE,file)) {
+	char time[32];
+	const char *p;
+	int pos = 0;
+
+	(void) sscanf(line,"%31s E : %*s %*d : %*[^:]:%n",time,&pos);
+	if (!pos) continue;
+	if (strstr(line+pos,"...")) continue;
+	pkt_len = 0;
+	for (p = line+pos; *p; p++) {
+	    unsigned byte;
+
+	    if (*p == ' ' || *p == '\n') continue;
+	    if (sscanf(p,"%2x",&byte) != 1) break;
+	    buf[pkt_len++] = byte;
+	    p++;
+	}
+	now = strtod(time,NULL)*1e9+0.5;
+	classify(time,classid);
+    }
+    free(buf);
+}
+
+
+/* ---------------------------------- Main --------------------------------- */
+
+
+static void usage(const char *name)
+{
+    fprintf(stderr,"usage: %s [-c classid] object_file [tcsim_output ...]\n",
+      name);
+    fprintf(stderr,"  -c classid  classid of the filter (default: 1:0)\n");
+    exit(1);
+}
+
+
+int main(int argc,char **argv)
+{
+    uint32_t classid = 0x10000;
+    unsigned long major,minor;
+    char *tmp;
+    int c;
+
+    while ((c = getopt(argc,argv,"c:")) != EOF)
+	switch (c) {
+	    case 'c':
+		major = strtoul(optarg,&tmp,16);
+		if (*tmp != ':' || major > 0xffff) usage(*argv);
+		minor = strtoul(tmp+1,&tmp,16);
+		if (*tmp || minor > 0xffff) usage(*argv);
+		classid = major << 16 | minor;
+		break;
+	    default:
+		usage(*argv);
+	}
+    if (optind == argc) usage(*argv);
+    object = argv[optind++];
+    load_object();
+    if (optind == argc) read_tcsim(stdin,classid);
+    else
+	while (optind < argc) {
+	    FILE *file;
+
+	    file = fopen(argv[optind],"r");
+	    if (!file) {
+		perror(argv[optind]);
+		exit(1);
+	    }
+	    read_tcsim(file,classid);
+	    (void) fclose(file);
+	    optind++;
+	}
+    return 0;
+}
@@ -23,10 +23,22 @@
 #define MAX_DEBUG_DEPTH	100	/* stack depth for debugf; okay to guess */
 #define MAX_PARAM_DEPTH	100	/* parameter stack depth */
 #define MAX_MODULE_ARGS	1024	/* maximum length of tcc-module arguments */
-#define MAX_C_BUCKETS	1024	/* buckets used in if_c */
-#define MAX_C_RESULTS	4096	/* exit points in if_c expression */
 #define MAX_U32_KEYS	1024	/* number of u32 keys per match */
+#define U32_HASH_MIN	8	/* minimum number of rules in u32 hash table */
+#define U32_HASH_BYTES	64	/* bytes considered for u32 hash key */
+#define U32_HASH_SPREAD	4	/* copy u32 rule to at most 2^n buckets */
+#define MAX_U32_TABLES	0x7ff	/* highest u32 hash table ID we allocate */
 #define MAX_EXT_LINE	10000	/* maximum line length at ext. interface */
+#define MAX_PROFILE_LINE 1024	/* maximum line length in profile */
+#define TC_CMD_USEC	5000	/* estimated time to run tc once */
+#define TC_BATCH_CMD_USEC 100	/* estimated time per command in tc -batch */
+#define TC_DIFF_HASH	4099	/* hash buckets for tcc -p elements */
+#define IF_C_HASH	4099	/* hash buckets for if_c buckets and results */
+#define IF_BPF_HASH	4099	/* hash buckets for if_bpf results */
+#define IFLIB_DAG_HASH	65521	/* hash buckets for interned expressions */
+#define BDD_CACHE	65536	/* computed table entries in iflib_newbit */
+#define BDD_GC_NODES	100000	/* iflib_newbit nodes before first GC */
+#define BDD_MAX_NODES	2000000	/* maximum live nodes in iflib_newbit */
 #define RESERVED_OFFSET_GROUPS 10
 				/* reserved for internal/future use */
 #define AUTO_OFFSET_GROUP_BASE 100 /* auto-assign offset groups from here */
@@ -34,7 +46,11 @@
 extern const char *default_device;
 extern const char *location_file; /* write location map to this file */
 extern const char *var_use_file; /* write variable use info to this file */
+extern const char *profile_file; /* read class hit counts from this file */
+extern const char *stats_file; /* write per-phase statistics to this file */
+extern const char *previous_file; /* only output changes to this config */
 extern int remove_qdiscs; /* issue tc commands to remove old qdiscs */
+extern int tc_batch; /* produce output for tc -batch */
 extern int quiet; /* produce terse output */
 extern int debug; /* debugging message and sanity check level (0 = none) */
 extern int generate_default_class; /* if_ext generates default classes */
@@ -42,6 +58,7 @@ extern int use_bit_tree; /* use experimental bit tree algorithm */
 extern int alg_mode; /* algorithm mode: 0 = default; > 0 = experimental */
 extern int dump_all; /* dump all qdiscs and filters (experimental) */
 extern int add_fifos; /* add FIFOs default qdisc is used */
+extern int max_jobs; /* dump up to this many devices in parallel */
 extern int no_combine; /* don't combine ifs into single expression */
 extern int no_warn; /* suppress all warnings */
 extern int no_struct_separator; /* join struct entries without . */
@@ -56,6 +73,7 @@ extern int warn_exp_error; /* turn above warnings intro hard errors */
 extern int warn_redefine; /* warn when re-defining variables */
 extern int warn_explicit; /* warn if shared class is explictly defined */
 extern int warn_const_pfx; /* warn if taking prefix of constant IP address */
+extern int warn_shadow; /* warn about rules that can never match */
 
 extern REGISTRY optimization_switches;
 
@@ -21,6 +21,7 @@
 #include "field.h"
 #include "error.h"
 #include "data.h"
+#include "stats.h"
 
 
 /* ----- Type-specific creator functions ----------------------------------- */
@@ -372,7 +373,9 @@ DATA data_clone(DATA d)
 	if (d.type == dt_assoc) return data_clone_assoc(d);
 	return d;
     }
+    if (d.op->node) return d; /* interned nodes are shared */
     new_op = alloc_t(OP);
+    IR_NODE_NEW();
     *new_op = *d.op;
     new_op->a = data_clone(d.op->a);
     new_op->b = data_clone(d.op->b);
@@ -446,13 +449,19 @@ static void data_destroy_assoc(DATA d)
 
 void data_destroy_1(DATA d)
 {
-    if (d.op) free(d.op);
+    if (d.op) {
+	if (!d.op->node) {
+	    free(d.op);
+	    IR_NODES_FREED(1);
+	}
+    }
     else if (d.type == dt_assoc) data_destroy_assoc(d);
 }
 
 
 void data_destroy(DATA d)
 {
+    if (d.op && d.op->node) return;
     if (d.op) {
 	data_destroy(d.op->a);
 	data_destroy(d.op->b);
@@ -7,17 +7,26 @@
  */
 
 
+#include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 #include "config.h"
+#include "util.h"
 #include "error.h"
+#include "police.h"
 #include "tc.h"
+#include "ext.h"
 #include "tree.h"
 #include "qdisc.h"
 #include "device.h"
 
 
 int add_fifos = 0; /* add FIFOs default qdisc is used */
+int max_jobs = 1; /* dump up to this many devices in parallel */
 
 DEVICE *devices = NULL;
 
@@ -69,20 +78,214 @@ void check_devices(void)
 }
 
 
-void dump_devices(void)
+static void dump_device(const DEVICE *device)
 {
-    DEVICE *device;
+    if (remove_qdiscs) {
+	tc_begin();
+	tc_more("qdisc del dev %s root",device->name);
+	tc_nl();
+	tc_begin();
+	tc_more("qdisc del dev %s ingress",device->name);
+	tc_nl();
+    }
+    if (!device->egress && !device->ingress) return;
+    tc_comment('=',"Device %s",device->name);
+    if (device->ingress) dump_qdisc(device->ingress);
+    if (device->egress) dump_qdisc(device->egress);
+}
 
-    for (device = devices; device; device = device->next) {
-	if (remove_qdiscs) {
-	    tc_more("tc qdisc del dev %s root",device->name);
-	    tc_nl();
-	    tc_more("tc qdisc del dev %s ingress",device->name);
-	    tc_nl();
+
+/* ----- Parallel dumping -------------------------------------------------- */
+
+/*
+ * With -j, each device is dumped by a child process, which writes its standard
+ * output and standard error to temporary files. The parent copies them to its
+ * own in the order of the devices, so the result is the same as when dumping
+ * sequentially, except that the messages of a device follow all of its output.
+ *
+ * Devices are almost independent. The exception are policers, which are
+ * numbered globally, may be added while dumping (e.g., the drop policer), and
+ * are only fully described the first time they are used. A child therefore
+ * reports whether it changed any policer. If it did, its output and that of
+ * all the devices after it are discarded, and the parent dumps these devices
+ * itself.
+ *
+ * Each device counts the build runs of external programs from zero, so their
+ * unique names also contain the position of the device.
+ */
+
+
+struct job {
+    const DEVICE *device;
+    pid_t pid;			/* 0 if finished */
+    int status;
+    FILE *out,*err,*info;
+};
+
+
+static FILE *job_file(void)
+{
+    FILE *file;
+
+    file = tmpfile();
+    if (file) return file;
+    perror("tmpfile");
+    exit(1);
+}
+
+
+static void start_job(struct job *jobs,struct job *job)
+{
+    unsigned long changes = police_changes;
+
+    job->out = job_file();
+    job->err = job_file();
+    job->info = job_file();
+    fflush(stdout);
+    fflush(stderr);
+    job->pid = fork();
+    if (job->pid < 0) {
+	perror("fork");
+	exit(1);
+    }
+    if (job->pid) return;
+    ext_unique_device(job-jobs);
+    if (dup2(fileno(job->out),1) < 0 || dup2(fileno(job->err),2) < 0) {
+	perror("dup2");
+	exit(1);
+    }
+    tc_reset_count();
+    dump_device(job->device);
+    fprintf(job->info,"%d %lu\n",tc_count(),police_changes-changes);
+    exit(0);
+}
+
+
+static void wait_job(struct job *jobs,int n)
+{
+    pid_t pid;
+    int status,i;
+
+    pid = wait(&status);
+    if (pid < 0) {
+	perror("wait");
+	exit(1);
+    }
+    for (i = 0; i < n; i++)
+	if (jobs[i].pid == pid) {
+	    jobs[i].pid = 0;
+	    jobs[i].status = status;
+	}
+}
+
+
+static void copy_file(FILE *from,FILE *to)
+{
+    char buf[4096];
+    size_t got;
+
+    rewind(from);
+    while ((got = fread(buf,1,sizeof(buf),from)))
+	if (fwrite(buf,1,got,to) != got) {
+	    perror("fwrite");
+	    exit(1);
 	}
-	if (!device->egress && !device->ingress) continue;
-	tc_comment('=',"Device %s",device->name);
-	if (device->ingress) dump_qdisc(device->ingress);
-	if (device->egress) dump_qdisc(device->egress);
+    if (ferror(from)) {
+	perror("fread");
+	exit(1);
+    }
+    fflush(to);
+}
+
+
+static void close_job(struct job *job)
+{
+    fclose(job->out);
+    fclose(job->err);
+    fclose(job->info);
+}
+
+
+/*
+ * Returns 1 if the job's output was used, 0 if the parent has to dump this
+ * device (and all that follow) itself. Exits if the child failed.
+ */
+
+static int finish_job(struct job *job)
+{
+    unsigned long changes;
+    int commands;
+
+    rewind(job->info);
+    if (fscanf(job->info,"%d %lu",&commands,&changes) != 2) {
+	/* the child exited with an error, after printing what it had to say */
+	copy_file(job->out,stdout);
+	copy_file(job->err,stderr);
+	while (wait(NULL) > 0);
+	if (WIFEXITED(job->status) && WEXITSTATUS(job->status))
+	    exit(WEXITSTATUS(job->status));
+	exit(1);
     }
+    if (changes) return 0;
+    copy_file(job->out,stdout);
+    copy_file(job->err,stderr);
+    tc_add_count(commands);
+    close_job(job);
+    return 1;
+}
+
+
+static void dump_devices_parallel(int n)
+{
+    const DEVICE *device;
+    struct job *jobs;
+    int started = 0,running = 0,done = 0;
+    int i;
+
+    jobs = alloc(sizeof(struct job)*n);
+    for (device = devices; device; device = device->next)
+	jobs[started++].device = device;
+    started = 0;
+    while (done < n) {
+	/*
+	 * Don't get too far ahead of the output, so that we don't collect
+	 * temporary files for all devices while one is slow.
+	 */
+	while (running < max_jobs && started < n && started < done+2*max_jobs) {
+	    start_job(jobs,jobs+started);
+	    started++;
+	    running++;
+	}
+	wait_job(jobs,started);
+	running--;
+	while (done < started && !jobs[done].pid) {
+	    if (!finish_job(jobs+done)) break;
+	    done++;
+	}
+	if (done < started && !jobs[done].pid) break;
+    }
+    if (done < n) {
+	while (wait(NULL) > 0);
+	for (i = done; i < started; i++) close_job(jobs+i);
+	for (i = done; i < n; i++) {
+	    ext_unique_device(i);
+	    dump_device(jobs[i].device);
+	}
+    }
+    free(jobs);
+}
+
+
+void dump_devices(void)
+{
+    const DEVICE *device;
+    int n = 0;
+
+    for (device = devices; device; device = device->next) n++;
+    if (max_jobs > 1 && !stats_file && n > 1)
+	dump_devices_parallel(n);
+    else
+	for (device = devices; device; device = device->next)
+	    dump_device(device);
+    tc_summary();
 }
@@ -95,6 +95,7 @@ int warn_exp_error = 0;
 int warn_redefine = 0;
 int warn_explicit = 1;
 int warn_const_pfx = 0;
+int warn_shadow = 1;
 
 
 int set_warn_switch(const char *arg,int lock)
@@ -110,6 +111,7 @@ int set_warn_switch(const char *arg,int lock)
 	"redefine",
 	"explicit",
 	"constpfx",
+	"shadow",
 	NULL
     };
     static int *warn_switch_flags[] = {
@@ -121,6 +123,7 @@ int set_warn_switch(const char *arg,int lock)
 	&warn_redefine,
 	&warn_explicit,
 	&warn_const_pfx,
+	&warn_shadow,
 	NULL
     };
 
@@ -19,10 +19,13 @@
 #include "error.h"
 #include "tree.h"
 #include "tc.h"
+#include "target.h"
 #include "ext.h"
 
 
 static int debug_target = 0;
+static int unique_device = -1; /* -1 if not dumping devices in parallel */
+static int unique_count = 0;
 
 
 static void make_argv0(char **argv,const char *name)
@@ -33,18 +36,28 @@ static void make_argv0(char **argv,const char *name)
 
 static void make_unique(char **argv)
 {
-    static char unique[5];
-    static int count = 0;
-
-    if (count == 0x100) error("too many calls to external interface");
-    sprintf(unique,"%02x%02x",getpid() & 0xff,count & 0xff);
-    count++;
+    static char unique[13];
+
+    if (unique_count == 0x100) error("too many calls to external interface");
+    if (unique_device < 0)
+	sprintf(unique,"%02x%02x",getpid() & 0xff,unique_count);
+    else sprintf(unique,"%02x%x%02x",getpid() & 0xff,unique_device,
+	  unique_count);
+    unique_count++;
     argv[2] = unique;
 }
 
 
-void ext_config(const char *name)
+void ext_unique_device(int device)
+{
+    unique_device = device;
+    unique_count = 0;
+}
+
+
+void ext_config(struct ext_target *target)
 {
+    const char *name = target->name;
     char *argv[] = { NULL, "config", NULL };
     FILE *file;
     char line[MAX_EXT_LINE+2];
@@ -52,7 +65,7 @@ void ext_config(const char *name)
     make_argv0(argv,name);
     file = ext_open(argv,name);
     free(argv[0]);
-    ext_read(name,"on configuration query");
+    file = ext_read(name,"on configuration query");
     while (fgets(line,MAX_EXT_LINE+2,file)) {
 	char *nl;
 
@@ -65,6 +78,7 @@ void ext_config(const char *name)
 	else if (!strcmp(line,"nocontinue")); /* ignore */
 	else if (!strcmp(line,"debug_target")) debug_target = 1;
 	else if (!strcmp(line,"nocombine")) no_combine = 1;
+	else if (!strcmp(line,"binary")) target->binary = 1;
 	else errorf("unrecognized configuration item \"%s\"",line);
     }
     ext_close();
@@ -74,6 +88,7 @@ void ext_config(const char *name)
 void ext_build(const char *name,const QDISC *qdisc,const FILTER *filter,
   void (*dump_config)(FILE *file,void *user),void *user)
 {
+    const struct ext_target *target = ext_target_find(name);
     char *argv[] = { NULL, "build", NULL, NULL };
     FILE *file;
     int got_element;
@@ -83,8 +98,11 @@ void ext_build(const char *name,const QDISC *qdisc,const FILTER *filter,
     make_unique(argv);
     file = ext_open(argv,name);
     free(argv[0]);
+    ext_binary = target && target->binary;
+    if (ext_binary) ext_bin_header(file);
     dump_config(file,user);
-    ext_read(name,"when building");
+    ext_binary = 0;
+    file = ext_read(name,"when building");
     got_element = 0;
     while (fgets(line,MAX_EXT_LINE+2,file)) {
 	char *nl,*element;
@@ -97,7 +115,7 @@ void ext_build(const char *name,const QDISC *qdisc,const FILTER *filter,
 	    if (!qdisc) errorf("did not expect a qdisc from \"%s\"",name);
 	    if (got_element)
 		errorf("already got an element from \"%s\"",name);
-	    printf("insmod sch_%s.o\n",element);
+	    tc_insmod("sch",element);
 	    __tc_qdisc_add(qdisc,element);
 	    tc_more("%s\n",line+pos);
 	    free(element);
@@ -107,7 +125,7 @@ void ext_build(const char *name,const QDISC *qdisc,const FILTER *filter,
 	    if (!filter) errorf("did not expect a filter from \"%s\"",name);
 	    if (got_element)
 		errorf("already got an element from \"%s\"",name);
-	    printf("insmod cls_%s.o\n",element);
+	    tc_insmod("cls",element);
 	    __tc_filter_add(filter,ETH_P_ALL);
 	    tc_more(" %s%s\n",element,line+pos);
 	    free(element);
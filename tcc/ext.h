@@ -9,6 +9,7 @@
 #ifndef EXT_H
 #define EXT_H
 
+#include <stdint.h>
 #include <stdio.h>
 
 #include "tree.h"
@@ -21,23 +22,67 @@
  * the program.
  *
  * Once all data is sent, ext_read closes the stream, waits for the process
- * to terminate, opens the stream for reading the output generated by the
- * external program, and returns the exit status. (Or -1 if the process did
- * not exit normally.)
+ * to terminate, and returns a stream for reading the output generated by the
+ * external program. If the program failed, ext_read prints an error message
+ * and exits.
+ *
+ * If the environment variable TCNG_EXT_SERVER is set, requests are instead
+ * sent to a program server (see tccext_serve) listening on the UNIX socket
+ * named by the variable, and no temporary files are used.
  *
  * ext_close can be called before or after ext_read to close the stream.
  */
 
 FILE *ext_open(char **argv,const char *name);
-void ext_read(const char *name,const char *action);
+FILE *ext_read(const char *name,const char *action);
 void ext_close(void);
 
 void add_tcc_external_arg(const char *name,const char *arg);
 
-void ext_config(const char *name);
+/*
+ * Unique names for build runs begin with the process ID. Parallel dumping
+ * adds the index of the device set with ext_unique_device, since each device
+ * counts its build runs from zero.
+ */
+
+void ext_unique_device(int device);
+
+struct ext_target;
+
+void ext_config(struct ext_target *target);
 void ext_build(const char *name,const QDISC *qdisc,const FILTER *filter,
   void (*dump_config)(FILE *file,void *user),void *user);
 
+/*
+ * Binary encoding (ext/tccextbin.h). ext_build sets ext_binary while it sends
+ * the configuration to an external target that announced "binary". A record
+ * is built with ext_bin_begin, then ext_bin_u32, etc., and is written by
+ * ext_bin_end. ext_bin_mark reserves a word that can later be set with
+ * ext_bin_patch. ext_bin_value reserves space for the value of a field, and
+ * ext_bin_value_bit sets one of its bits, counting from the most significant
+ * one.
+ *
+ * Output of functions that only know the text format is written to the
+ * stream returned by ext_bin_text_begin. ext_bin_text_end then sends it as a
+ * text record. Without ext_binary, both are no-ops.
+ */
+
+extern int ext_binary;
+
+void ext_bin_header(FILE *file);
+void ext_bin_begin(FILE *file,int type);
+void ext_bin_u32(uint32_t value);
+int ext_bin_mark(void);
+void ext_bin_patch(int mark,uint32_t value);
+void ext_bin_string(const char *s);
+void ext_bin_field(int offset_group,int offset,int length);
+int ext_bin_value(int length);
+void ext_bin_value_bit(int value,int length,int bit);
+void ext_bin_end(void);
+
+FILE *ext_bin_text_begin(FILE *file);
+void ext_bin_text_end(FILE *file,FILE *text);
+
 void ext_dump_class(FILE *file,const CLASS *class,const PARAM_DSC **special,
   void (*fn)(FILE *file,const PARAM_DSC *param,const CLASS *class));
 void do_ext_dump_qdisc(FILE *file,const QDISC *qdisc,const QDISC_DSC *dsc,
@@ -0,0 +1,502 @@
+/*
+ * bench.c - Compare and time the classifiers of match.c
+ *
+ * Distributed under the LGPL.
+ */
+
+/*
+ * tcc-ext-bench reads what tcc sends to an external program (e.g. the output
+ * of "tcc -xif:err"), and classifies random packets with it. Most packets are
+ * made to match a randomly chosen rule, so that all rules are exercised.
+ *
+ * match.c is linked twice: as "bench", which uses the bit tree if tcc provided
+ * one (-B -N) and there are no barriers, and as "bench_rules" (bench_rules.c),
+ * which only uses the rules. If there is no policing, the results are also
+ * checked against a simple matcher that tests one bit at a time.
+ *
+ * Packets are 2048 bytes, of which only the first 64 are random. Offset fields
+ * must therefore not move accesses beyond the end of the packet.
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <linux/if_ether.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include <tccmeta.h>
+
+#include "tccext.h"
+
+
+#define PACKET_SIZE	2048
+#define RANDOM_SIZE	64	/* random bytes at the beginning of a packet */
+#define BATCH		64	/* packets per call of match_batch */
+#define RUNS		5	/* timing runs; the fastest is reported */
+#define MAX_DIFFS	5	/* differences to print */
+#define TICK		0.0001	/* simulated time between packets, in seconds */
+
+
+double get_time(void); /* used by match.c */
+void match_batch(uint8_t *const *raw,const int *len,const uint16_t *protocol,
+  uint32_t *class,int *res,int n);
+void rules_match_batch(uint8_t *const *raw,const int *len,
+  const uint16_t *protocol,uint32_t *class,int *res,int n);
+
+
+enum { by_rules,by_fsm,by_reference,classifiers };
+
+static const char *classifier_name[] = { "rules","bit tree","reference" };
+
+static int n_packets = 10000;
+static uint8_t **raw;
+static int *len;
+static uint16_t *protocol;	/* network byte order */
+static int *res[classifiers];
+static uint32_t *class[classifiers];
+static double now;
+static long ticks;
+
+
+double get_time(void)
+{
+    return now;
+}
+
+
+static void *alloc(size_t size)
+{
+    void *p;
+
+    p = malloc(size ? size : 1);
+    if (!p) {
+	perror("malloc");
+	exit(1);
+    }
+    return p;
+}
+
+
+/* ----- Bit access -------------------------------------------------------- */
+
+
+static int get_bit(const uint8_t *data,int pos)
+{
+    return (data[pos >> 3] >> (7-(pos & 7))) & 1;
+}
+
+
+static void set_bit(uint8_t *data,int pos,int value)
+{
+    if (value) data[pos >> 3] |= 0x80 >> (pos & 7);
+    else data[pos >> 3] &= ~(0x80 >> (pos & 7));
+}
+
+
+static uint32_t get_bits(const uint8_t *data,int pos,int bits)
+{
+    uint32_t res = 0;
+
+    while (bits--) res = (res << 1) | get_bit(data,pos++);
+    return res;
+}
+
+
+static int group_offset(const TCCEXT_OFFSET *group,const uint8_t *raw)
+{
+    if (!group) return 0;
+    return group_offset(group->base,raw)+(get_bits(raw,
+      group_offset(group->field.offset_group,raw)+group->field.offset,
+      group->field.length) << group->shift_left);
+}
+
+
+/*
+ * Returns the data the field is in, and sets *pos to the bit position of the
+ * field, or returns NULL if the field is outside the packet.
+ */
+
+static uint8_t *field_data(const TCCEXT_FIELD *field,uint8_t *raw,
+  uint8_t *meta,int *pos)
+{
+    if (field->offset_group == &tccext_meta_field_group) {
+	*pos = field->offset;
+	return meta;
+    }
+    *pos = group_offset(field->offset_group,raw)+field->offset;
+    return *pos+field->length > PACKET_SIZE*8 ? NULL : raw;
+}
+
+
+/* ----- Reference matcher ------------------------------------------------- */
+
+
+static int match_bits(const TCCEXT_MATCH *m,uint8_t *raw,uint8_t *meta)
+{
+    const uint8_t *data;
+    int pos,skip,i;
+
+    data = field_data(&m->field,raw,meta,&pos);
+    if (!data) return 0;
+    skip = (-m->field.length) & 7;
+    for (i = 0; i != m->field.length; i++)
+	if (get_bit(data,pos+i) != get_bit(m->data,skip+i)) return 0;
+    return 1;
+}
+
+
+static int reference(const TCCEXT_BLOCK *block,uint8_t *raw,uint16_t protocol,
+  uint32_t *class)
+{
+    uint8_t meta[META_PROTOCOL_OFFSET+META_PROTOCOL_SIZE];
+    const TCCEXT_RULE *rule;
+    const TCCEXT_MATCH *m;
+    const TCCEXT_CLASS *c;
+
+    memcpy(meta+META_PROTOCOL_OFFSET,&protocol,META_PROTOCOL_SIZE);
+    for (rule = block ? block->rules : NULL; rule; rule = rule->next) {
+	if (!rule->actions) continue;
+	for (m = rule->matches; m; m = m->next)
+	    if (!match_bits(m,raw,meta)) break;
+	if (m) continue;
+	switch (rule->actions->type) {
+	    case tat_class:
+		c = rule->actions->u.class_list->class;
+		*class = (c->parent_qdisc->index << 16) | c->index;
+		return 0;
+	    case tat_drop:
+		return 2;
+	    default:
+		/* unspec: continue after the next barrier */
+		while (rule->next && rule->next->actions) rule = rule->next;
+		break;
+	}
+    }
+    return -1;
+}
+
+
+static int policing(const TCCEXT_BLOCK *block)
+{
+    const TCCEXT_ACTION *a;
+
+    if (!block) return 0;
+    for (a = block->actions; a; a = a->next)
+	if (a->type == tat_conform || a->type == tat_count) return 1;
+    return 0;
+}
+
+
+static int barrier(const TCCEXT_BLOCK *block)
+{
+    const TCCEXT_RULE *rule;
+
+    if (!block) return 0;
+    for (rule = block->rules; rule; rule = rule->next)
+	if (!rule->actions) return 1;
+    return 0;
+}
+
+
+/* ----- Packet generation ------------------------------------------------- */
+
+
+static void plant(const TCCEXT_RULE *rule,uint8_t *raw,uint16_t *protocol)
+{
+    uint8_t meta[META_PROTOCOL_OFFSET+META_PROTOCOL_SIZE];
+    const TCCEXT_MATCH *m;
+    uint8_t *data;
+    int pos,skip,i;
+
+    memcpy(meta+META_PROTOCOL_OFFSET,protocol,META_PROTOCOL_SIZE);
+    for (m = rule->matches; m; m = m->next) {
+	data = field_data(&m->field,raw,meta,&pos);
+	if (!data) continue;
+	skip = (-m->field.length) & 7;
+	for (i = 0; i != m->field.length; i++)
+	    set_bit(data,pos+i,get_bit(m->data,skip+i));
+    }
+    memcpy(protocol,meta+META_PROTOCOL_OFFSET,META_PROTOCOL_SIZE);
+}
+
+
+static void generate(const TCCEXT_BLOCK *block)
+{
+    const TCCEXT_RULE *rule;
+    int n_rules = 0;
+    int i,j;
+
+    for (rule = block ? block->rules : NULL; rule; rule = rule->next)
+	if (rule->actions) n_rules++;
+    raw = alloc(sizeof(uint8_t *)*n_packets);
+    len = alloc(sizeof(int)*n_packets);
+    protocol = alloc(sizeof(uint16_t)*n_packets);
+    for (i = 0; i != classifiers; i++) {
+	res[i] = alloc(sizeof(int)*n_packets);
+	class[i] = alloc(sizeof(uint32_t)*n_packets);
+    }
+    for (i = 0; i != n_packets; i++) {
+	uint8_t *p;
+
+	p = raw[i] = alloc(PACKET_SIZE);
+	memset(p,0,PACKET_SIZE);
+	/* small values are more likely to be what the rules look for */
+	for (j = 0; j != RANDOM_SIZE; j++)
+	    p[j] = random() % 4 ? random() & 3 : random();
+	p[0] = random() % 4 ? 0x45 : 0x40 | (5+random() % 11);
+	p[9] = random() % 3 ? random() & 1 ? IPPROTO_TCP : IPPROTO_UDP :
+	  random();
+	protocol[i] = htons(random() % 8 ? ETH_P_IP :
+	  random() & 1 ? ETH_P_IPV6 : random());
+	len[i] = 20+random() % 1480;
+	if (!n_rules || !(random() % 4)) continue;
+	j = random() % n_rules;
+	for (rule = block->rules; !rule->actions || j--; rule = rule->next);
+	/* planting can change offsets, so do it twice */
+	plant(rule,p,protocol+i);
+	plant(rule,p,protocol+i);
+	/* make some packets fail just one match */
+	if (!(random() % 8)) p[random() % RANDOM_SIZE] ^= 1 << (random() % 8);
+    }
+}
+
+
+/* ----- Classification ---------------------------------------------------- */
+
+
+static void classify(int by,const TCCEXT_BLOCK *block)
+{
+    int i,n;
+
+    if (by == by_reference) {
+	for (i = 0; i != n_packets; i++)
+	    res[by][i] = reference(block,raw[i],protocol[i],class[by]+i);
+	return;
+    }
+    for (i = 0; i < n_packets; i += BATCH) {
+	n = n_packets-i < BATCH ? n_packets-i : BATCH;
+	now = ticks*TICK;
+	ticks += n;
+	(by == by_rules ? rules_match_batch : match_batch)(raw+i,len+i,
+	  protocol+i,class[by]+i,res[by]+i,n);
+    }
+}
+
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec+ts.tv_nsec/1e9;
+}
+
+
+static void timing(int by,const TCCEXT_BLOCK *block)
+{
+    double best = 0;
+#if defined(__i386__) || defined(__x86_64__)
+    uint64_t best_cycles = 0;
+#endif
+    int i;
+
+    for (i = 0; i != RUNS; i++) {
+	double t;
+#if defined(__i386__) || defined(__x86_64__)
+	uint64_t cycles;
+
+	cycles = __rdtsc();
+#endif
+	t = seconds();
+	classify(by,block);
+	t = seconds()-t;
+#if defined(__i386__) || defined(__x86_64__)
+	cycles = __rdtsc()-cycles;
+	if (!i || cycles < best_cycles) best_cycles = cycles;
+#endif
+	if (!i || t < best) best = t;
+    }
+    printf("%s: %.1f ns/packet",classifier_name[by],best*1e9/n_packets);
+#if defined(__i386__) || defined(__x86_64__)
+    printf(", %.1f cycles/packet",(double) best_cycles/n_packets);
+#endif
+    putchar('\n');
+}
+
+
+static void print_result(int res,uint32_t class)
+{
+    switch (res) {
+	case 0:
+	    printf("OK (%x:%x)",(unsigned) class >> 16,
+	      (unsigned) class & 0xffff);
+	    break;
+	case 2:
+	    printf("SHOT");
+	    break;
+	case -1:
+	    printf("UNSPEC");
+	    break;
+	default:
+	    printf("%d",res);
+    }
+}
+
+
+static int compare(const int *use)
+{
+    int diffs = 0;
+    int i,by;
+
+    for (i = 0; i != n_packets; i++)
+	for (by = by_fsm; by != classifiers; by++) {
+	    if (!use[by]) continue;
+	    if (res[by][i] == res[by_rules][i] &&
+	      (res[by][i] || class[by][i] == class[by_rules][i])) continue;
+	    if (diffs++ >= MAX_DIFFS) continue;
+	    printf("packet %d: %s ",i,classifier_name[by_rules]);
+	    print_result(res[by_rules][i],class[by_rules][i]);
+	    printf(", %s ",classifier_name[by]);
+	    print_result(res[by][i],class[by][i]);
+	    putchar('\n');
+	}
+    return diffs;
+}
+
+
+/* ----- Configuration ----------------------------------------------------- */
+
+
+static char *read_all(FILE *file,size_t *size)
+{
+    char *buf = NULL;
+    size_t got;
+
+    *size = 0;
+    do {
+	buf = realloc(buf,*size+BUFSIZ);
+	if (!buf) {
+	    perror("realloc");
+	    exit(1);
+	}
+	got = fread(buf+*size,1,BUFSIZ,file);
+	*size += got;
+    }
+    while (got);
+    if (ferror(file)) {
+	perror("read");
+	exit(1);
+    }
+    return buf;
+}
+
+
+static void write_file(const char *name,const char *buf,size_t size)
+{
+    FILE *file;
+
+    file = fopen(name,"w");
+    if (!file) {
+	perror(name);
+	exit(1);
+    }
+    if (fwrite(buf,1,size,file) != size || fclose(file) == EOF) {
+	perror(name);
+	exit(1);
+    }
+}
+
+
+static void usage(const char *name)
+{
+    fprintf(stderr,"usage: %s [-n packets] [-s seed] [-t] [file]\n",name);
+    exit(1);
+}
+
+
+int main(int argc,char **argv)
+{
+    const TCCEXT_CONTEXT *context;
+    const TCCEXT_BLOCK *block;
+    FILE *file = stdin;
+    char *buf,*end;
+    size_t size;
+    int use[classifiers];
+    int timed = 0;
+    int c,by,diffs;
+
+    srandom(1);
+    while ((c = getopt(argc,argv,"n:s:t")) != EOF)
+	switch (c) {
+	    case 'n':
+		n_packets = strtol(optarg,&end,0);
+		if (*end || n_packets <= 0) usage(*argv);
+		break;
+	    case 's':
+		srandom(strtoul(optarg,&end,0));
+		if (*end) usage(*argv);
+		break;
+	    case 't':
+		timed = 1;
+		break;
+	    default:
+		usage(*argv);
+	}
+    switch (argc-optind) {
+	case 0:
+	    break;
+	case 1:
+	    file = fopen(argv[optind],"r");
+	    if (!file) {
+		perror(argv[optind]);
+		exit(1);
+	    }
+	    break;
+	default:
+	    usage(*argv);
+    }
+    buf = read_all(file,&size);
+    file = fmemopen(buf,size,"r");
+    if (!file) {
+	perror("fmemopen");
+	exit(1);
+    }
+    context = tccext_parse(file,NULL);
+    if (!context) exit(1);
+    write_file("__bench.out",buf,size);
+    write_file("__bench_rules.out",buf,size);
+    block = context->blocks;
+    use[by_rules] = 1;
+    use[by_fsm] = block && block->fsm && !barrier(block);
+    use[by_reference] = !policing(block);
+    printf("classifiers:");
+    for (by = 0; by != classifiers; by++)
+	if (use[by]) printf("%s %s",by ? "," : "",classifier_name[by]);
+    putchar('\n');
+    generate(block);
+    /*
+     * Let both instances of match.c read their configuration before we start
+     * (and the first packet is as good as any other for this).
+     */
+    rules_match_batch(raw,len,protocol,class[by_rules],res[by_rules],1);
+    match_batch(raw,len,protocol,class[by_fsm],res[by_fsm],1);
+    /* both instances must see the same time, or policing could differ */
+    for (by = 0; by != classifiers; by++)
+	if (use[by]) {
+	    ticks = 1;
+	    classify(by,block);
+	}
+    diffs = compare(use);
+    printf("%d packets, %d differences\n",n_packets,diffs);
+    if (timed)
+	for (by = 0; by != by_reference; by++)
+	    if (use[by]) timing(by,block);
+    return !!diffs;
+}
@@ -0,0 +1,14 @@
+/*
+ * bench_rules.c - Instance of match.c that only uses the rules
+ *
+ * Distributed under the LGPL.
+ */
+
+
+#undef NAME
+#define NAME bench_rules
+
+#define MATCH_NO_FSM
+#define MATCH(name) rules_##name
+
+#include "match.c"
@@ -171,6 +171,18 @@ static void print_rules(FILE *file,const TCCEXT_RULE *rules)
 }
 
 
+static void print_bits(FILE *file,const TCCEXT_BIT *bit)
+{
+    if (!bit) return;
+    print_bits(file,bit->next); /* list is in reverse order */
+    fprintf(file,"bit %d = ",bit->index);
+    if (bit->action) fprintf(file,"action %d",bit->action->index);
+    else print_field(file,bit->field);
+    fprintf(file," %d %d\n",bit->edge[1] ? bit->edge[1]->index : 0,
+      bit->edge[0] ? bit->edge[0]->index : 0);
+}
+
+
 static void print_parameters(FILE *file,const TCCEXT_PARAMETER *parameters)
 {
     const TCCEXT_PARAMETER *prm;
@@ -229,6 +241,7 @@ static void print_blocks(FILE *file,const TCCEXT_BLOCK *blocks)
 	fputc('\n',file);
 	print_qdiscs(file,block->qdiscs);
 	print_actions(stderr,block->actions);
+	print_bits(stderr,block->bits);
 	print_rules(stderr,block->rules);
     }
 }
@@ -254,6 +267,10 @@ int main(int argc,const char **argv)
 	return 0;
     }
     if (!strcmp(argv[1],"check")) return 0;
+    if (!strcmp(argv[1],"serve")) {
+	if (argc != 3) usage(*argv);
+	return tccext_serve(argv[2],main);
+    }
     if (strcmp(argv[1],"build")) {
 	fprintf(stderr,"%s: unrecognized mode %s",*argv,argv[1]);
 	return 1;
@@ -0,0 +1,320 @@
+/*
+ * fsm.c - Execute the bit tree of a block
+ *
+ * Distributed under the LGPL.
+ */
+
+/*
+ * The bit tree is flattened into an array of nodes in breadth-first order,
+ * so that the nodes near the root, which are visited by every packet, share
+ * few cache lines. All tests of bits in the same byte that follow each other
+ * are collapsed into a single node, which extracts these bits at once and
+ * looks up the next node in a table. Nodes are twelve bytes.
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tccext.h"
+
+
+#define FSM_ACTION	0xffff	/* "group" of action nodes */
+
+
+struct fsm_node {
+    uint16_t group;	/* offset group index, or FSM_ACTION */
+    uint8_t width;	/* number of bits extracted (1-8) */
+    uint8_t mask;	/* (1 << width)-1 */
+    int32_t offset;	/* bit offset of the first bit within the group */
+    uint32_t next;	/* first entry in "edges" for the value of the bits, or
+			   index in "actions" */
+};
+
+struct fsm_group {
+    int base;		/* index of base group (0 for raw) */
+    int field_group;	/* index of group of the increment field */
+    int field_offset;	/* bit offset of the increment field */
+    int length;		/* length of the increment field */
+    int shift_left;	/* increment scaling */
+};
+
+struct _tccext_fsm {
+    struct fsm_node *nodes;	/* nodes[0] is the root */
+    uint32_t *edges;		/* indices of next nodes */
+    const TCCEXT_ACTION **actions;
+    struct fsm_group *groups;	/* groups[0] is the packet start, the meta
+				   fields are the last group */
+    int n_groups;
+    int *offsets;		/* offsets of groups for the current packet */
+};
+
+
+static void *alloc(size_t size)
+{
+    void *p;
+
+    p = malloc(size ? size : 1);
+    if (!p) {
+	perror("malloc");
+	exit(1);
+    }
+    return p;
+}
+
+
+/* ----- Offset groups ----------------------------------------------------- */
+
+
+static int group_index(const TCCEXT_FSM *fsm,const TCCEXT_CONTEXT *ctx,
+  const TCCEXT_OFFSET *group)
+{
+    const TCCEXT_OFFSET *walk;
+    int i;
+
+    if (!group) return 0;
+    if (group == &tccext_meta_field_group) return fsm->n_groups-1;
+    i = fsm->n_groups-1;
+    for (walk = ctx->offset_groups; walk != group; walk = walk->next) i--;
+    return i-1;
+}
+
+
+static void compile_groups(TCCEXT_FSM *fsm,const TCCEXT_CONTEXT *ctx)
+{
+    const TCCEXT_OFFSET *walk;
+    int i;
+
+    /*
+     * The list has the last group first, and groups can only be based on
+     * groups defined before them.
+     */
+    fsm->n_groups = 2;
+    for (walk = ctx->offset_groups; walk; walk = walk->next) fsm->n_groups++;
+    fsm->groups = alloc(sizeof(struct fsm_group)*fsm->n_groups);
+    fsm->offsets = alloc(sizeof(int)*fsm->n_groups);
+    fsm->offsets[0] = fsm->offsets[fsm->n_groups-1] = 0;
+    i = fsm->n_groups-1;
+    for (walk = ctx->offset_groups; walk; walk = walk->next) {
+	struct fsm_group *g = fsm->groups+(--i);
+
+	if (walk->field.length > 25) {
+	    fprintf(stderr,"offset field of more than 25 bits\n");
+	    exit(1);
+	}
+	if (walk->base == &tccext_meta_field_group ||
+	  walk->field.offset_group == &tccext_meta_field_group) {
+	    fprintf(stderr,"can't use meta fields in offset\n");
+	    exit(1);
+	}
+	g->base = group_index(fsm,ctx,walk->base);
+	g->field_group = group_index(fsm,ctx,walk->field.offset_group);
+	g->field_offset = walk->field.offset;
+	g->length = walk->field.length;
+	g->shift_left = walk->shift_left;
+    }
+}
+
+
+/* ----- Flattening -------------------------------------------------------- */
+
+
+struct flat {
+    const TCCEXT_BIT **bits;	/* all bits, sorted by address */
+    int *node;			/* node of each bit; -1 if none */
+    int n_bits;
+    const TCCEXT_BIT **queue;	/* bits of nodes, in node order */
+    int n_nodes;
+    int n_edges,edges_size;
+    int n_actions;
+};
+
+
+static int comp_bits(const void *a,const void *b)
+{
+    const TCCEXT_BIT *bit_a = *(const TCCEXT_BIT **) a;
+    const TCCEXT_BIT *bit_b = *(const TCCEXT_BIT **) b;
+
+    return bit_a < bit_b ? -1 : bit_a > bit_b;
+}
+
+
+static uint32_t node_of(struct flat *flat,const TCCEXT_BIT *bit)
+{
+    const TCCEXT_BIT **found;
+    int *node;
+
+    if (!bit) {
+	fprintf(stderr,"bit tree has no next bit for a test\n");
+	exit(1);
+    }
+    found = bsearch(&bit,flat->bits,flat->n_bits,sizeof(TCCEXT_BIT *),
+      comp_bits);
+    node = flat->node+(found-flat->bits);
+    if (*node == -1) {
+	*node = flat->n_nodes;
+	flat->queue[flat->n_nodes++] = bit;
+    }
+    return *node;
+}
+
+
+static int same_byte(const TCCEXT_BIT *a,const TCCEXT_BIT *b)
+{
+    return b && !b->action &&
+      a->field.offset_group == b->field.offset_group &&
+      a->field.offset >> 3 == b->field.offset >> 3;
+}
+
+
+static void bit_range(const TCCEXT_BIT *first,const TCCEXT_BIT *bit,int *lo,
+  int *hi)
+{
+    int n = bit->field.offset & 7;
+
+    if (n < *lo) *lo = n;
+    if (n > *hi) *hi = n;
+    if (same_byte(first,bit->edge[0])) bit_range(first,bit->edge[0],lo,hi);
+    if (same_byte(first,bit->edge[1])) bit_range(first,bit->edge[1],lo,hi);
+}
+
+
+static void add_node(TCCEXT_FSM *fsm,const TCCEXT_CONTEXT *ctx,
+  struct flat *flat,int n)
+{
+    const TCCEXT_BIT *bit = flat->queue[n];
+    struct fsm_node *node = fsm->nodes+n;
+    int lo,hi,v;
+
+    if (bit->action) {
+	node->group = FSM_ACTION;
+	node->next = flat->n_actions;
+	fsm->actions[flat->n_actions++] = bit->action;
+	return;
+    }
+    if (bit->field.length != 1) {
+	fprintf(stderr,"bit tree tests a field of %d bits\n",
+	  bit->field.length);
+	exit(1);
+    }
+    lo = hi = bit->field.offset & 7;
+    bit_range(bit,bit,&lo,&hi);
+    node->group = group_index(fsm,ctx,bit->field.offset_group);
+    node->width = hi-lo+1;
+    node->mask = (1 << node->width)-1;
+    node->offset = (bit->field.offset & ~7)+lo;
+    node->next = flat->n_edges;
+    if (flat->n_edges+(1 << node->width) > flat->edges_size) {
+	while (flat->n_edges+(1 << node->width) > flat->edges_size)
+	    flat->edges_size *= 2;
+	fsm->edges = realloc(fsm->edges,sizeof(uint32_t)*flat->edges_size);
+	if (!fsm->edges) {
+	    perror("realloc");
+	    exit(1);
+	}
+    }
+    for (v = 0; v != 1 << node->width; v++) {
+	const TCCEXT_BIT *walk = bit;
+
+	do walk = walk->edge[(v >> (hi-(walk->field.offset & 7))) & 1];
+	while (same_byte(bit,walk));
+	fsm->edges[flat->n_edges++] = node_of(flat,walk);
+    }
+}
+
+
+TCCEXT_FSM *tccext_fsm_compile(const TCCEXT_CONTEXT *ctx,
+  const TCCEXT_BLOCK *block)
+{
+    TCCEXT_FSM *fsm;
+    struct flat flat;
+    const TCCEXT_BIT *bit;
+    int i;
+
+    if (!block->fsm) return NULL;
+    fsm = alloc(sizeof(TCCEXT_FSM));
+    compile_groups(fsm,ctx);
+    flat.n_bits = 0;
+    for (bit = block->bits; bit; bit = bit->next) flat.n_bits++;
+    flat.bits = alloc(sizeof(TCCEXT_BIT *)*flat.n_bits);
+    flat.node = alloc(sizeof(int)*flat.n_bits);
+    flat.queue = alloc(sizeof(TCCEXT_BIT *)*flat.n_bits);
+    for (bit = block->bits, i = 0; bit; bit = bit->next, i++) {
+	flat.bits[i] = bit;
+	flat.node[i] = -1;
+    }
+    qsort(flat.bits,flat.n_bits,sizeof(TCCEXT_BIT *),comp_bits);
+    fsm->nodes = alloc(sizeof(struct fsm_node)*flat.n_bits);
+    fsm->actions = alloc(sizeof(TCCEXT_ACTION *)*flat.n_bits);
+    flat.edges_size = 256;
+    fsm->edges = alloc(sizeof(uint32_t)*flat.edges_size);
+    flat.n_nodes = flat.n_edges = flat.n_actions = 0;
+    node_of(&flat,block->fsm);
+    for (i = 0; i != flat.n_nodes; i++) add_node(fsm,ctx,&flat,i);
+    free(flat.bits);
+    free(flat.node);
+    free(flat.queue);
+    return fsm;
+}
+
+
+void tccext_fsm_destroy(TCCEXT_FSM *fsm)
+{
+    free(fsm->nodes);
+    free(fsm->edges);
+    free(fsm->actions);
+    free(fsm->groups);
+    free(fsm->offsets);
+    free(fsm);
+}
+
+
+/* ----- Execution --------------------------------------------------------- */
+
+
+static inline uint32_t get_bits(const uint8_t *data,int start,int bits)
+{
+    uint32_t res = 0;
+    int end = (start & 7)+bits;
+
+    data += start >> 3;
+    while (end > 0) {
+	res = (res << 8) | *data++;
+	end -= 8;
+    }
+    return (res >> -end) & ((1 << bits)-1);
+}
+
+
+const TCCEXT_ACTION *tccext_fsm_run(const TCCEXT_FSM *fsm,const uint8_t *raw,
+  const uint8_t *meta)
+{
+    const struct fsm_node *node = fsm->nodes;
+    int meta_group = fsm->n_groups-1;
+    int i;
+
+    for (i = 1; i != meta_group; i++) {
+	const struct fsm_group *g = fsm->groups+i;
+
+	fsm->offsets[i] = fsm->offsets[g->base]+(get_bits(raw,
+	  fsm->offsets[g->field_group]+g->field_offset,g->length) <<
+	  g->shift_left);
+    }
+    while (node->group != FSM_ACTION) {
+	const uint8_t *p;
+	int pos,end;
+	uint32_t word;
+
+	pos = fsm->offsets[node->group]+node->offset;
+	p = (node->group == meta_group ? meta : raw)+(pos >> 3);
+	end = (pos & 7)+node->width;
+	word = *p;
+	if (end > 8) word = (word << 8) | p[1];
+	else end += 8;
+	node = fsm->nodes+fsm->edges[node->next+
+	  ((word >> (16-end)) & node->mask)];
+    }
+    return fsm->actions[node->next];
+}
@@ -11,6 +11,17 @@
  * to use it only with broad safety margins.
  */
 
+/*
+ * The rules are compiled into arrays when the first packet is classified:
+ * the offsets of all groups are calculated once per packet, in an order in
+ * which each group follows the groups it depends on, and each match compares
+ * at most 32 bits at a precomputed position with a precomputed value. Longer
+ * fields are split into several matches.
+ *
+ * If tcc also provides a bit tree (-B -N) and there are no barriers, packets
+ * are classified with the bit tree instead of the rules.
+ */
+
 
 #include <inttypes.h>
 #include <stdlib.h>
@@ -25,43 +36,150 @@
 #define _S(x) #x
 #define S(x) _S(x)
 
+#define META_GROUP	-1	/* "group" of matches on meta_protocol */
+
+/*
+ * bench_rules.c includes this file with MATCH_NO_FSM, and renames the entry
+ * points with MATCH, so that tcc-ext-bench can compare the rules with the bit
+ * tree.
+ */
+
+#ifndef MATCH
+#define MATCH(name) name
+#endif
+
 
 extern double get_time(void); /* from cls_ext_test.c */
 
 
-static uint32_t extract_bits(uint8_t *data,int start,int bits)
+/* ----- Compiled rules ---------------------------------------------------- */
+
+
+struct my_offset {
+    TCCEXT_OFFSET o;	/* tccext's offset group data */
+    int index;		/* index in "groups" */
+};
+
+struct group {
+    int base;		/* index of base group (0 for raw) */
+    int field_group;	/* index of group of the increment field */
+    int field_offset;	/* bit offset of the increment field */
+    int length;		/* length of the increment field */
+    uint32_t mask;	/* (1 << length)-1 */
+    int shift_left;	/* increment scaling */
+};
+
+struct match {
+    int group;		/* index of offset group, or META_GROUP */
+    int offset;		/* bit offset within the group */
+    int length;		/* 1 to 32 bits */
+    uint32_t mask;	/* (1 << length)-1 */
+    uint32_t value;	/* value to compare with */
+};
+
+struct rule {
+    int matches;	/* index of first match */
+    int end;		/* index after the last match */
+    const TCCEXT_ACTION *action;
+    int next_section;	/* index of the first rule after the next barrier,
+			   or n_rules if there is none */
+};
+
+
+static struct group *groups;	/* groups[0] is the packet start */
+static int n_groups;
+static struct match *matches;
+static int n_matches;
+static struct rule *rules;
+static int n_rules;
+static int *offsets;		/* offsets of groups, in bits */
+static TCCEXT_FSM *fsm;		/* compiled bit tree; NULL if not used */
+
+
+static void *alloc(size_t size)
+{
+    void *p;
+
+    p = malloc(size ? size : 1);
+    if (!p) {
+	perror("malloc");
+	exit(1);
+    }
+    return p;
+}
+
+
+static inline uint32_t mask(int length)
+{
+    return length == 32 ? 0xffffffff : (1U << length)-1;
+}
+
+
+static inline uint32_t get_bits(const uint8_t *data,int start,int bits,
+  uint32_t mask)
 {
-    uint32_t res = 0;
+    uint64_t res = 0;
+    int end = (start & 7)+bits;
 
-    if ((bits+(start & 7)) > 32) abort();
     data += start >> 3;
-    start &= 7;
-    res = *data++ & ((1 << (8-start))-1);
-    bits -= 8-start;
-    while (bits > 0) {
+    while (end > 0) {
 	res = (res << 8) | *data++;
-	bits -= 8;
+	end -= 8;
     }
-    if (bits) res >>= -bits;
-    return res;
+    return (res >> -end) & mask;
 }
 
 
-static int offset(const TCCEXT_OFFSET *group,uint8_t *raw)
+static int group_index(const TCCEXT_OFFSET *group)
 {
     if (!group) return 0;
     if (group == &tccext_meta_field_group) {
 	fprintf(stderr,"\"match\" can't handle meta fields in offset\n");
 	exit(1);
     }
-    return offset(group->base,raw)+
-      (extract_bits(raw,offset(group->field.offset_group,raw)+
-      group->field.offset,group->field.length) << group->shift_left);
+    return ((const struct my_offset *) group)->index;
+}
+
+
+static void compile_groups(const TCCEXT_CONTEXT *context)
+{
+    const TCCEXT_OFFSET *walk;
+    int i;
+
+    n_groups = 1;
+    for (walk = context->offset_groups; walk; walk = walk->next) n_groups++;
+    groups = alloc(sizeof(struct group)*n_groups);
+    offsets = alloc(sizeof(int)*n_groups);
+    offsets[0] = 0;
+    /*
+     * The list has the last group first, and groups can only be based on
+     * groups defined before them.
+     */
+    i = n_groups;
+    for (walk = context->offset_groups; walk; walk = walk->next)
+	((struct my_offset *) walk)->index = --i;
+    for (walk = context->offset_groups; walk; walk = walk->next) {
+	struct group *g = groups+((struct my_offset *) walk)->index;
+
+	if (walk->field.length > 32) {
+	    fprintf(stderr,"\"match\" can't handle offset fields of more "
+	      "than 32 bits\n");
+	    exit(1);
+	}
+	g->base = group_index(walk->base);
+	g->field_group = group_index(walk->field.offset_group);
+	g->field_offset = walk->field.offset;
+	g->length = walk->field.length;
+	g->mask = mask(g->length);
+	g->shift_left = walk->shift_left;
+    }
 }
 
 
-static int match_1(const TCCEXT_MATCH *m,uint8_t *raw,uint16_t protocol)
+static void add_match(const TCCEXT_MATCH *m)
 {
+    int i;
+
     if (m->field.offset_group == &tccext_meta_field_group) {
 	if (m->field.offset != META_PROTOCOL_OFFSET*8) {
 	    fprintf(stderr,"invalid offset for meta_protocol\n");
@@ -71,15 +189,78 @@ static int match_1(const TCCEXT_MATCH *m,uint8_t *raw,uint16_t protocol)
 	    fprintf(stderr,"invalid size for meta_protocol access");
 	    exit(1);
 	}
-	return ntohs(protocol) ==
-	  extract_bits(m->data,(-m->field.length) & 7,m->field.length);
     }
-    return extract_bits(raw,offset(m->field.offset_group,raw)+m->field.offset,
-      m->field.length) == extract_bits(m->data,(-m->field.length) & 7,
-      m->field.length);
+    for (i = 0; i < m->field.length; i += 32) {
+	struct match *c = matches+n_matches++;
+
+	c->group = m->field.offset_group == &tccext_meta_field_group ?
+	  META_GROUP : group_index(m->field.offset_group);
+	c->offset = m->field.offset+i;
+	c->length = m->field.length-i > 32 ? 32 : m->field.length-i;
+	c->mask = mask(c->length);
+	c->value = get_bits(m->data,((-m->field.length) & 7)+i,c->length,
+	  c->mask);
+    }
+}
+
+
+static void compile(const TCCEXT_CONTEXT *context)
+{
+    const TCCEXT_RULE *r;
+    const TCCEXT_MATCH *m;
+    int section,barrier;
+
+    compile_groups(context);
+    if (context->blocks && context->blocks->next) {
+	fprintf(stderr,"match.c cannot handle multiple blocks\n");
+	exit(1);
+    }
+    n_rules = n_matches = 0;
+    for (r = context->blocks ? context->blocks->rules : NULL; r; r = r->next) {
+	if (r->actions) n_rules++;
+	for (m = r->matches; m; m = m->next)
+	    n_matches += (m->field.length+31) >> 5;
+    }
+    rules = alloc(sizeof(struct rule)*n_rules);
+    matches = alloc(sizeof(struct match)*n_matches);
+    n_rules = n_matches = section = barrier = 0;
+    for (r = context->blocks ? context->blocks->rules : NULL; r; r = r->next) {
+	struct rule *rule = rules+n_rules;
+
+	if (!r->actions) {
+	    while (section != n_rules) rules[section++].next_section = n_rules;
+	    barrier = 1;
+	    continue;
+	}
+	rule->matches = n_matches;
+	for (m = r->matches; m; m = m->next) add_match(m);
+	rule->end = n_matches;
+	rule->action = r->actions;
+	n_rules++;
+    }
+    while (section != n_rules) rules[section++].next_section = n_rules;
+    /* the bit tree can't express barriers */
+#ifndef MATCH_NO_FSM
+    if (context->blocks && !barrier) {
+	const TCCEXT_BIT *bit;
+
+	for (bit = context->blocks->bits; bit; bit = bit->next)
+	    if (!bit->action &&
+	      bit->field.offset_group == &tccext_meta_field_group &&
+	      (bit->field.offset < META_PROTOCOL_OFFSET*8 ||
+	      bit->field.offset >= (META_PROTOCOL_OFFSET+META_PROTOCOL_SIZE)*8)) {
+		fprintf(stderr,"invalid offset for meta_protocol\n");
+		exit(1);
+	    }
+	fsm = tccext_fsm_compile(context,context->blocks);
+    }
+#endif
 }
 
 
+/* ----- Policing ---------------------------------------------------------- */
+
+
 struct my_bucket {
     TCCEXT_BUCKET b;	/* tccext's bucket data */
     int tokens;		/* current number of tokens in bucket */
@@ -166,44 +347,90 @@ static int action(const TCCEXT_ACTION *a,int len,uint32_t *class)
 }
 
 
-int match(uint8_t *raw,int len,uint16_t protocol,uint32_t *class);
-  /* extern in cls_ext_test.c */
+/* ----- Classification ---------------------------------------------------- */
 
-int match(uint8_t *raw,int len,uint16_t protocol,uint32_t *class)
-{
-    static TCCEXT_CONTEXT *context;
-    TCCEXT_RULE *r;
 
-    if (!context) {
-	static TCCEXT_SIZES sizes = { .bucket = sizeof(struct my_bucket) };
-	FILE *file;
-
-	file = fopen("__" S(NAME) ".out","r");
-	if (!file) {
-	    perror("_" S(NAME) ".out");
-	    exit(1);
-	}
-	context = tccext_parse(file,&sizes);
-	if (remove("__" S(NAME) ".out")) perror("remove __" S(NAME) ".out");
-    }
-    if (context->blocks->next) {
-	fprintf(stderr,"match.c cannot handle multiple blocks\n");
+static void setup(void)
+{
+    static TCCEXT_SIZES sizes = {
+	.offset = sizeof(struct my_offset),
+	.bucket = sizeof(struct my_bucket)
+    };
+    TCCEXT_CONTEXT *context;
+    FILE *file;
+
+    file = fopen("__" S(NAME) ".out","r");
+    if (!file) {
+	perror("_" S(NAME) ".out");
 	exit(1);
     }
-    for (r = context->blocks->rules; r; r = r->next) {
-	TCCEXT_MATCH *m;
+    context = tccext_parse(file,&sizes);
+    if (remove("__" S(NAME) ".out")) perror("remove __" S(NAME) ".out");
+    compile(context);
+}
 
-	if (!r->actions) continue;
-	for (m = r->matches; m; m = m->next)
-	    if (!match_1(m,raw,protocol)) break;
-	if (!m) {
-	    int act;
-
-	    act = action(r->actions,len,class);
-	    if (act != -1) return act;
-	    while (r && r->actions) r = r->next;
-	    if (!r) break;
+
+static int classify(const uint8_t *raw,int len,uint16_t protocol,
+  uint32_t *class)
+{
+    const struct rule *r;
+    int i;
+
+    if (fsm)
+	return action(tccext_fsm_run(fsm,raw,
+	  (const uint8_t *) &protocol-META_PROTOCOL_OFFSET),len,class);
+    for (i = 1; i != n_groups; i++) {
+	const struct group *g = groups+i;
+
+	offsets[i] = offsets[g->base]+(get_bits(raw,
+	  offsets[g->field_group]+g->field_offset,g->length,g->mask) <<
+	  g->shift_left);
+    }
+    r = rules;
+    while (r != rules+n_rules) {
+	const struct match *m;
+	int act;
+
+	for (m = matches+r->matches; m != matches+r->end; m++)
+	    if (m->group == META_GROUP) {
+		if (ntohs(protocol) != m->value) break;
+	    }
+	    else {
+		if (get_bits(raw,offsets[m->group]+m->offset,m->length,
+		  m->mask) != m->value) break;
+	    }
+	if (m != matches+r->end) {
+	    r++;
+	    continue;
 	}
+	act = action(r->action,len,class);
+	if (act != -1) return act;
+	r = rules+r->next_section;
     }
     return -1; /* TC_POLICE_UNSPEC */
 }
+
+
+int MATCH(match)(uint8_t *raw,int len,uint16_t protocol,uint32_t *class);
+  /* extern in cls_ext_test.c */
+void MATCH(match_batch)(uint8_t *const *raw,const int *len,
+  const uint16_t *protocol,uint32_t *class,int *res,int n);
+  /* classifies n packets, and stores the result of each in res (used by
+     tcc-ext-bench) */
+
+int MATCH(match)(uint8_t *raw,int len,uint16_t protocol,uint32_t *class)
+{
+    if (!rules) setup();
+    return classify(raw,len,protocol,class);
+}
+
+
+void MATCH(match_batch)(uint8_t *const *raw,const int *len,
+  const uint16_t *protocol,uint32_t *class,int *res,int n)
+{
+    int i;
+
+    if (!rules) setup();
+    for (i = 0; i != n; i++)
+	res[i] = classify(raw[i],len[i],protocol[i],class+i);
+}
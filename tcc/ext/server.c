@@ -0,0 +1,319 @@
+/*
+ * server.c - Serve requests of tcc's external interface over a UNIX socket
+ *
+ * Distributed under the LGPL.
+ */
+
+/*
+ * Each request runs the program's main function in a child process, so
+ * functions that exit on errors (e.g. tccext_parse) only end the request,
+ * and no state is left over from one request to the next. The server
+ * itself is never exec'ed again.
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "tccext.h"
+
+
+/* ----- Framing ----------------------------------------------------------- */
+
+
+static int read_all(int fd,void *buf,size_t len)
+{
+    while (len) {
+	ssize_t got;
+
+	got = read(fd,buf,len);
+	if (got < 0 && errno == EINTR) continue;
+	if (got <= 0) return -1;
+	buf = (char *) buf+got;
+	len -= got;
+    }
+    return 0;
+}
+
+
+static void write_all(int fd,const void *buf,size_t len)
+{
+    while (len) {
+	ssize_t wrote;
+
+	wrote = write(fd,buf,len);
+	if (wrote < 0 && errno == EINTR) continue;
+	if (wrote < 0) {
+	    perror("write");
+	    exit(1);
+	}
+	buf = (const char *) buf+wrote;
+	len -= wrote;
+    }
+}
+
+
+static int get_u32(int fd,uint32_t *value)
+{
+    uint8_t buf[4];
+
+    if (read_all(fd,buf,4) < 0) return -1;
+    *value = (uint32_t) buf[0] << 24 | buf[1] << 16 | buf[2] << 8 | buf[3];
+    return 0;
+}
+
+
+static char *get_block(int fd,uint32_t *len)
+{
+    char *buf;
+
+    if (get_u32(fd,len) < 0) return NULL;
+    buf = malloc(*len+1);
+    if (!buf) {
+	perror("malloc");
+	exit(1);
+    }
+    if (read_all(fd,buf,*len) < 0) {
+	free(buf);
+	return NULL;
+    }
+    buf[*len] = 0;
+    return buf;
+}
+
+
+static void put_u32(int fd,uint32_t value)
+{
+    uint8_t buf[4];
+
+    buf[0] = value >> 24;
+    buf[1] = value >> 16;
+    buf[2] = value >> 8;
+    buf[3] = value;
+    write_all(fd,buf,4);
+}
+
+
+static void put_block(int fd,const char *buf,uint32_t len)
+{
+    put_u32(fd,len);
+    write_all(fd,buf,len);
+}
+
+
+/* ----- Running a request ------------------------------------------------- */
+
+
+struct output {
+    int fd;
+    char *buf;
+    size_t len,size;
+};
+
+
+static void collect(struct output *out)
+{
+    ssize_t got;
+
+    if (out->len == out->size) {
+	out->size = out->size ? out->size*2 : 4096;
+	out->buf = realloc(out->buf,out->size);
+	if (!out->buf) {
+	    perror("realloc");
+	    exit(1);
+	}
+    }
+    got = read(out->fd,out->buf+out->len,out->size-out->len);
+    if (got < 0) {
+	if (errno == EINTR) return;
+	perror("read");
+	exit(1);
+    }
+    if (got) out->len += got;
+    else {
+	(void) close(out->fd);
+	out->fd = -1;
+    }
+}
+
+
+static void run(int (*fn)(int argc,const char **argv),int argc,
+  const char **argv,char *input,uint32_t in_len,int *status,
+  struct output out[2])
+{
+    int fds[2][2];
+    pid_t pid;
+    int i;
+
+    for (i = 0; i != 2; i++)
+	if (pipe(fds[i]) < 0) {
+	    perror("pipe");
+	    exit(1);
+	}
+    fflush(stdout);
+    fflush(stderr);
+    pid = fork();
+    if (pid < 0) {
+	perror("fork");
+	exit(1);
+    }
+    if (!pid) {
+	for (i = 0; i != 2; i++) {
+	    (void) close(fds[i][0]);
+	    if (dup2(fds[i][1],i+1) < 0) {
+		perror("dup2");
+		exit(1);
+	    }
+	    (void) close(fds[i][1]);
+	}
+	fclose(stdin);
+	stdin = in_len ? fmemopen(input,in_len,"r") : fopen("/dev/null","r");
+	if (!stdin) {
+	    perror("fmemopen");
+	    exit(1);
+	}
+	exit(fn(argc,argv));
+    }
+    for (i = 0; i != 2; i++) {
+	(void) close(fds[i][1]);
+	out[i].fd = fds[i][0];
+	out[i].buf = NULL;
+	out[i].len = out[i].size = 0;
+    }
+    while (out[0].fd != -1 || out[1].fd != -1) {
+	struct pollfd pfd[2];
+
+	for (i = 0; i != 2; i++) {
+	    pfd[i].fd = out[i].fd;
+	    pfd[i].events = POLLIN;
+	}
+	if (poll(pfd,2,-1) < 0) {
+	    if (errno == EINTR) continue;
+	    perror("poll");
+	    exit(1);
+	}
+	for (i = 0; i != 2; i++)
+	    if (pfd[i].revents) collect(out+i);
+    }
+    while (waitpid(pid,status,0) < 0)
+	if (errno != EINTR) {
+	    perror("waitpid");
+	    exit(1);
+	}
+}
+
+
+static void serve_connection(int fd,int (*fn)(int argc,const char **argv))
+{
+    while (1) {
+	struct output out[2];
+	char **argv,*input;
+	uint32_t argc,len,i;
+	int status;
+
+	if (get_u32(fd,&argc) < 0) return;
+	argv = malloc(sizeof(char *)*(argc+1));
+	if (!argv) {
+	    perror("malloc");
+	    exit(1);
+	}
+	for (i = 0; i != argc; i++)
+	    if (!(argv[i] = get_block(fd,&len))) return;
+	argv[argc] = NULL;
+	input = get_block(fd,&len);
+	if (!input) return;
+	run(fn,argc,(const char **) argv,input,len,&status,out);
+	put_u32(fd,status);
+	for (i = 0; i != 2; i++) {
+	    put_block(fd,out[i].buf,out[i].len);
+	    free(out[i].buf);
+	}
+	for (i = 0; i != argc; i++) free(argv[i]);
+	free(argv);
+	free(input);
+    }
+}
+
+
+/* ----- Server ------------------------------------------------------------ */
+
+
+int tccext_serve(const char *path,int (*fn)(int argc,const char **argv))
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    int s;
+
+    /*
+     * The socket is bound to a temporary name and only renamed once we're
+     * listening, so that clients can wait for it to appear.
+     */
+    if (strlen(path)+4 >= sizeof(addr.sun_path)) {
+	fprintf(stderr,"%s: socket path is too long\n",path);
+	return 1;
+    }
+    s = socket(PF_UNIX,SOCK_STREAM,0);
+    if (s < 0) {
+	perror("socket");
+	return 1;
+    }
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    sprintf(addr.sun_path,"%s.new",path);
+    /* remove a socket left behind by an earlier server, but nothing else */
+    if (!lstat(addr.sun_path,&st) && S_ISSOCK(st.st_mode))
+	(void) unlink(addr.sun_path);
+    if (bind(s,(struct sockaddr *) &addr,sizeof(addr)) < 0) {
+	perror(addr.sun_path);
+	return 1;
+    }
+    if (listen(s,SOMAXCONN) < 0) {
+	perror("listen");
+	return 1;
+    }
+    if (!lstat(path,&st) && !S_ISSOCK(st.st_mode)) {
+	fprintf(stderr,"%s: exists and is not a socket\n",path);
+	(void) unlink(addr.sun_path);
+	return 1;
+    }
+    if (rename(addr.sun_path,path) < 0) {
+	perror(path);
+	(void) unlink(addr.sun_path);
+	return 1;
+    }
+    signal(SIGCHLD,SIG_IGN); /* no zombies from connections */
+    while (1) {
+	pid_t pid;
+	int fd;
+
+	fd = accept(s,NULL,NULL);
+	if (fd < 0) {
+	    if (errno == EINTR) continue;
+	    perror("accept");
+	    return 1;
+	}
+	pid = fork();
+	if (pid < 0) {
+	    perror("fork");
+	    return 1;
+	}
+	if (!pid) {
+	    (void) close(s);
+	    signal(SIGCHLD,SIG_DFL);
+	    serve_connection(fd,fn);
+	    exit(0);
+	}
+	(void) close(fd);
+    }
+}
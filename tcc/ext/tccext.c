@@ -14,10 +14,13 @@
 #include <ctype.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include "../tccmeta.h"
 
 #include "tccext.h"
+#include "tccextbin.h"
 
 
 #define MAX_LINE	65536	/* maximum input line */
@@ -120,6 +123,128 @@ static char *make_location(const char *fmt,...)
 }
 
 
+/* ----- Index ------------------------------------------------------------- */
+
+
+/*
+ * While parsing, all references by number are resolved through a hash table,
+ * so that the time to parse the input grows linearly with its size. Numbers
+ * that are only unique within a block or a qdisc are qualified by the
+ * respective object ("scope"). The table also remembers the last element of
+ * lists that grow at their end (ik_last, with the list anchor as scope).
+ * Removed entries keep their place in the table, so that searches continue
+ * past them.
+ */
+
+enum index_kind {
+    ik_group,		/* offset group; no scope */
+    ik_bucket,		/* bucket; no scope */
+    ik_qdisc,		/* qdisc; scope is the block */
+    ik_class,		/* class; scope is the qdisc */
+    ik_action,		/* action; scope is the block */
+    ik_bit,		/* bit; scope is the block */
+    ik_last,		/* last list element; scope is the anchor */
+};
+
+struct index_entry {
+    enum index_kind kind;
+    const void *scope;
+    int number;
+    void *value;	/* NULL if the entry is unused */
+};
+
+struct _tccext_index {
+    struct index_entry *entries;
+    unsigned size;	/* number of entries; a power of two */
+    unsigned used;
+};
+
+static char removed; /* value of removed entries */
+
+
+static struct index_entry *index_entry(const struct _tccext_index *index,
+  enum index_kind kind,const void *scope,int number)
+{
+    struct index_entry *entry;
+    unsigned h;
+
+    h = ((unsigned) number*0x9e3779b1u) ^ ((uintptr_t) scope >> 4) ^
+      (unsigned) kind << 24;
+    h ^= h >> 15;
+    for (entry = index->entries+(h & (index->size-1)); entry->value;
+      entry = entry == index->entries+index->size-1 ? index->entries : entry+1)
+	if (entry->kind == kind && entry->scope == scope &&
+	  entry->number == number) break;
+    return entry;
+}
+
+
+static void *index_find(const TCCEXT_CONTEXT *ctx,enum index_kind kind,
+  const void *scope,int number)
+{
+    void *value;
+
+    value = index_entry(ctx->index,kind,scope,number)->value;
+    return value == &removed ? NULL : value;
+}
+
+
+static void index_set(TCCEXT_CONTEXT *ctx,enum index_kind kind,
+  const void *scope,int number,void *value)
+{
+    struct _tccext_index *index = ctx->index;
+    struct index_entry *entry;
+
+    entry = index_entry(index,kind,scope,number);
+    if (!entry->value) {
+	if (2*++index->used > index->size) {
+	    struct index_entry *old = index->entries;
+	    unsigned i;
+
+	    index->entries = alloc_zero(2*index->size*sizeof(*old));
+	    index->size *= 2;
+	    for (i = 0; i != index->size/2; i++)
+		if (old[i].value)
+		    *index_entry(index,old[i].kind,old[i].scope,
+		      old[i].number) = old[i];
+	    free(old);
+	    entry = index_entry(index,kind,scope,number);
+	}
+	entry->kind = kind;
+	entry->scope = scope;
+	entry->number = number;
+    }
+    entry->value = value;
+}
+
+
+static void index_remove(TCCEXT_CONTEXT *ctx,enum index_kind kind,
+  const void *scope,int number)
+{
+    struct index_entry *entry;
+
+    entry = index_entry(ctx->index,kind,scope,number);
+    if (entry->value) entry->value = &removed;
+}
+
+
+static void index_create(TCCEXT_CONTEXT *ctx)
+{
+    ctx->index = alloc_zero(sizeof(struct _tccext_index));
+    ctx->index->size = 256;
+    ctx->index->entries =
+      alloc_zero(ctx->index->size*sizeof(struct index_entry));
+}
+
+
+static void index_destroy(TCCEXT_CONTEXT *ctx)
+{
+    free(ctx->index->entries);
+    free(ctx->index);
+    ctx->index = NULL;
+}
+
+
 /* ----- The offset group -------------------------------------------------- */
 
 
@@ -142,8 +267,8 @@ static TCCEXT_OFFSET *find_group(TCCEXT_CONTEXT *ctx,int number)
 
     if (!number) return NULL;
     if (number == META_FIELD_ROOT) return &tccext_meta_field_group;
-    for (group = ctx->offset_groups; group; group = group->next)
-	if (group->group_number == number) return group;
+    group = index_find(ctx,ik_group,NULL,number);
+    if (group) return group;
     fprintf(stderr,"offset group %d not found\n",number);
     exit(1);
 }
@@ -164,10 +289,26 @@ static TCCEXT_FIELD parse_field(TCCEXT_CONTEXT *ctx,const char *line,int *len)
 }
 
 
+static void check_offset(TCCEXT_CONTEXT *ctx,int number)
+{
+    if (index_find(ctx,ik_group,NULL,number)) {
+	fprintf(stderr,"duplicate offset group %d\n",number);
+	exit(1);
+    }
+}
+
+
+static void add_offset(TCCEXT_CONTEXT *ctx,TCCEXT_OFFSET *offset)
+{
+    offset->next = ctx->offset_groups;
+    ctx->offset_groups = offset;
+    index_set(ctx,ik_group,NULL,offset->group_number,offset);
+}
+
+
 static void parse_offset(TCCEXT_CONTEXT *ctx,const char *line)
 {
     TCCEXT_OFFSET *offset;
-    const TCCEXT_OFFSET *scan;
     int base,pos,pos2;
 
     offset = alloc_zero(TE_SIZEOF(ctx,offset,TCCEXT_OFFSET));
@@ -175,18 +316,11 @@ static void parse_offset(TCCEXT_CONTEXT *ctx,const char *line)
 	fprintf(stderr,"invalid offset expression \"%s\"\n",line);
 	exit(1);
     }
-    for (scan = ctx->offset_groups; scan; scan = scan->next)
-	if (scan->group_number == offset->group_number) {
-	    fprintf(stderr,"duplicate offset group %d\n",offset->group_number);
-	    exit(1);
-	}
+    check_offset(ctx,offset->group_number);
     offset->base = find_group(ctx,base);
     offset->field = parse_field(ctx,line+pos,&pos2);
-    if (sscanf(line+pos+pos2+1,"<< %i)",&offset->shift_left) == 1) {
-	offset->next = ctx->offset_groups;
-	ctx->offset_groups = offset;
-	return;
-    }
+    if (sscanf(line+pos+pos2+1,"<< %i)",&offset->shift_left) == 1)
+	add_offset(ctx,offset);
 }
 
 
@@ -195,11 +329,7 @@ static void parse_offset(TCCEXT_CONTEXT *ctx,const char *line)
 
 static TCCEXT_BIT *lookup_bit(TCCEXT_CONTEXT *ctx,int index)
 {
-    TCCEXT_BIT *bit;
-
-    for (bit = ctx->blocks->bits; bit; bit = bit->next)
-	if (bit->index == index) break;
-    return bit;
+    return index_find(ctx,ik_bit,ctx->blocks,index);
 }
 
 
@@ -215,42 +345,63 @@ static TCCEXT_BIT *find_bit(TCCEXT_CONTEXT *ctx,int index)
 }
 
 
+static void check_bit(TCCEXT_CONTEXT *ctx,int index)
+{
+    if (lookup_bit(ctx,index)) {
+	fprintf(stderr,"duplicate bit index %d\n",index);
+	exit(1);
+    }
+}
+
+
+static TCCEXT_ACTION *bit_action(TCCEXT_CONTEXT *ctx,int index)
+{
+    TCCEXT_ACTION *action;
+
+    action = find_action(ctx,index);
+    if (action) return action;
+    fprintf(stderr,"no action %d\n",index);
+    exit(1);
+}
+
+
+static void add_bit(TCCEXT_CONTEXT *ctx,TCCEXT_BIT *bit,int true,int false)
+{
+    bit->edge[0] = find_bit(ctx,false);
+    bit->edge[1] = find_bit(ctx,true);
+    bit->next = ctx->blocks->bits;
+    ctx->blocks->bits = bit;
+    ctx->blocks->fsm = bit; /* the last bit is the root */
+    index_set(ctx,ik_bit,ctx->blocks,bit->index,bit);
+}
+
+
 static void parse_bit(TCCEXT_CONTEXT *ctx,const char *line)
 {
     TCCEXT_BIT *bit;
-    int index,action,false,true;
+    int action,false,true;
     int pos = 0;
 
     bit = alloc_zero(TE_SIZEOF(ctx,bit,TCCEXT_BIT));
-    if (sscanf(line," %i = %n",&bit->index,&pos) < 2) {
-	fprintf(stderr,"invalid index %d\n",index);
+    if (sscanf(line," %i = %n",&bit->index,&pos) < 1 || !pos) {
+	fprintf(stderr,"invalid bit \"%s\"\n",line);
 	exit(1);
     }
     line += pos;
-    if (lookup_bit(ctx,bit->index)) {
-	fprintf(stderr,"duplicate bit index %d\n",bit->index);
-	exit(1);
-    }
-    if (sscanf(line," action %i",&action) != 1) {
-	bit->action = find_action(ctx,action);
-	if (!bit->action) {
-	    fprintf(stderr,"no action %d\n",index);
-	    exit(1);
-	}
+    check_bit(ctx,bit->index);
+    if (sscanf(line,"action %i%n",&action,&pos) >= 1) {
+	bit->action = bit_action(ctx,action);
 	memset(&bit->field,0,sizeof(bit->field)); /* play it safe */
     }
     else {
 	bit->action = NULL;
 	bit->field = parse_field(ctx,line,&pos);
     }
-    if (sscanf(line," %i %i",&true,&false) != 2) {
-	fprintf(stderr,"invalid next bit pointers\"%s\"\n",line);
+    if (sscanf(line+pos," %i %i",&true,&false) != 2) {
+	fprintf(stderr,"invalid next bit pointers \"%s\"\n",line);
 	exit(1);
     }
-    bit->edge[0] = find_bit(ctx,false);
-    bit->edge[1] = find_bit(ctx,true);
-    bit->next = ctx->blocks->bits;
-    ctx->blocks->bits = bit;
+    add_bit(ctx,bit,true,false);
 }
 
 
@@ -301,19 +452,48 @@ static TCCEXT_MATCH *parse_match(TCCEXT_CONTEXT *ctx,const char *line,int *len)
 }
 
 
-static void parse_rule(TCCEXT_CONTEXT *ctx,const char *line)
+static void check_rule(TCCEXT_CONTEXT *ctx)
 {
-    TCCEXT_RULE *rule,**walk;
-    TCCEXT_MATCH **next;
-    int actions,pos;
-
     if (!ctx->blocks) {
 	fprintf(stderr,"can't handle rule without block\n");
 	exit(1);
     }
+}
+
+
+static TCCEXT_ACTION *rule_action(TCCEXT_CONTEXT *ctx,int index)
+{
+    TCCEXT_ACTION *action;
+
+    action = find_action(ctx,index);
+    if (action) return action;
+    fprintf(stderr,"no actions %d\n",index);
+    exit(1);
+}
+
+
+static void add_rule(TCCEXT_CONTEXT *ctx,TCCEXT_MATCH *matches,
+  TCCEXT_ACTION *actions)
+{
+    TCCEXT_RULE *rule,*last;
+
     rule = alloc_zero(TE_SIZEOF(ctx,rule,TCCEXT_RULE));
-    rule->matches = NULL;
-    next = &rule->matches;
+    rule->matches = matches;
+    rule->actions = actions;
+    rule->next = NULL;
+    last = index_find(ctx,ik_last,&ctx->blocks->rules,0);
+    if (last) last->next = rule;
+    else ctx->blocks->rules = rule;
+    index_set(ctx,ik_last,&ctx->blocks->rules,0,rule);
+}
+
+
+static void parse_rule(TCCEXT_CONTEXT *ctx,const char *line)
+{
+    TCCEXT_MATCH *matches = NULL,**next = &matches;
+    int actions,pos;
+
+    check_rule(ctx);
     while (*line && isdigit(*line)) {
 	*next = parse_match(ctx,line,&pos);
 	next = &(*next)->next;
@@ -323,14 +503,7 @@ static void parse_rule(TCCEXT_CONTEXT *ctx,const char *line)
 	fprintf(stderr,"invalid action \"%s\"\n",line);
 	exit(1);
     }
-    rule->actions = find_action(ctx,actions);
-    if (!rule->actions) {
-	fprintf(stderr,"no actions %d\n",actions);
-	exit(1);
-    }
-    rule->next = NULL;
-    for (walk = &ctx->blocks->rules; *walk; walk = &(*walk)->next);
-    *walk = rule;
+    add_rule(ctx,matches,rule_action(ctx,actions));
 }
 
 
@@ -339,18 +512,8 @@ static void parse_rule(TCCEXT_CONTEXT *ctx,const char *line)
 
 static void parse_barrier(TCCEXT_CONTEXT *ctx,const char *line)
 {
-    TCCEXT_RULE *rule,**walk;
-
-    if (!ctx->blocks) {
-	fprintf(stderr,"can't handle rule without block\n");
-	exit(1);
-    }
-    rule = alloc_zero(TE_SIZEOF(ctx,rule,TCCEXT_RULE));
-    rule->matches = NULL;
-    rule->actions = NULL;
-    rule->next = NULL;
-    for (walk = &ctx->blocks->rules; *walk; walk = &(*walk)->next);
-    *walk = rule;
+    check_rule(ctx);
+    add_rule(ctx,NULL,NULL);
 }
 
 
@@ -412,25 +575,24 @@ static TCCEXT_PARAMETER *parse_parameters(TCCEXT_CONTEXT *ctx,const char **line)
 
 static TCCEXT_QDISC *fudge_qdisc(TCCEXT_CONTEXT *ctx,int index)
 {
-    TCCEXT_QDISC **anchor;
+    TCCEXT_QDISC **anchor,*walk;
 
     anchor = &ctx->blocks->qdiscs;
+    for (walk = *anchor; walk; walk = walk->next)
+	index_remove(ctx,ik_qdisc,ctx->blocks,walk->index);
     *anchor = alloc_zero(TE_SIZEOF(ctx,qdisc,TCCEXT_QDISC));
     (*anchor)->type = NULL;
     (*anchor)->index = index;
     (*anchor)->classes = NULL;
     (*anchor)->location = stralloc(ctx->blocks->location);
+    index_set(ctx,ik_qdisc,ctx->blocks,index,*anchor);
     return *anchor;
 }
 
 
 static TCCEXT_QDISC *find_qdisc(TCCEXT_CONTEXT *ctx,int index)
 {
-    TCCEXT_QDISC *qdisc;
-
-     for (qdisc = ctx->blocks->qdiscs; qdisc; qdisc = qdisc->next)
-	if (qdisc->index == index) return qdisc;
-    return NULL;
+    return index_find(ctx,ik_qdisc,ctx->blocks,index);
 }
 
 
@@ -457,6 +619,7 @@ static void parse_qdisc(TCCEXT_CONTEXT *ctx,const char *line)
       make_location("qdisc %s:%d",ctx->blocks->name,qdisc->index);
     qdisc->next = ctx->blocks->qdiscs;
     ctx->blocks->qdiscs = qdisc;
+    index_set(ctx,ik_qdisc,ctx->blocks,qdisc->index,qdisc);
 }
 
 
@@ -482,18 +645,24 @@ static int extract(TCCEXT_PARAMETER **params,const char *name)
 }
 
 
-static TCCEXT_CLASS *find_class(TCCEXT_CLASS *classes,int index)
+static TCCEXT_CLASS *find_class(TCCEXT_CONTEXT *ctx,const TCCEXT_QDISC *qdisc,
+  int index)
 {
-    TCCEXT_CLASS *class;
+    return index_find(ctx,ik_class,qdisc,index);
+}
 
-    for (class = classes; class; class = class->next) {
-	TCCEXT_CLASS *found;
 
-	if (class->index == index) return class;
-	found = find_class(class->classes,index);
-	if (found) return found;
-    }
-    return NULL;
+static void add_class(TCCEXT_CONTEXT *ctx,TCCEXT_CLASS **anchor,
+  TCCEXT_CLASS *class)
+{
+    TCCEXT_CLASS *last;
+
+    class->next = NULL;
+    last = index_find(ctx,ik_last,anchor,0);
+    if (last) last->next = class;
+    else *anchor = class;
+    index_set(ctx,ik_last,anchor,0,class);
+    index_set(ctx,ik_class,class->parent_qdisc,class->index,class);
 }
 
 
@@ -504,7 +673,7 @@ static TCCEXT_CLASS *find_qdisc_class(TCCEXT_CONTEXT *ctx,int qdisc_index,
 
     qdisc = find_qdisc(ctx,qdisc_index);
     if (!qdisc) return NULL;
-    return find_class(qdisc->classes,class_index);
+    return find_class(ctx,qdisc,class_index);
 }
 
 
@@ -512,16 +681,16 @@ static TCCEXT_CLASS *fudge_class(TCCEXT_CONTEXT *ctx,int qdisc_index,
   int class_index)
 {
     TCCEXT_QDISC *qdisc;
-    TCCEXT_CLASS **anchor;
+    TCCEXT_CLASS *class;
 
     qdisc = find_qdisc(ctx,qdisc_index);
     if (!qdisc) qdisc = fudge_qdisc(ctx,qdisc_index);
-    for (anchor = &qdisc->classes; *anchor; anchor = &(*anchor)->next);
-    *anchor = alloc_zero(TE_SIZEOF(ctx,class,TCCEXT_CLASS));
-    (*anchor)->parent_qdisc = qdisc;
-    (*anchor)->index = class_index;
-    (*anchor)->location = stralloc(qdisc->location);
-    return *anchor;
+    class = alloc_zero(TE_SIZEOF(ctx,class,TCCEXT_CLASS));
+    class->parent_qdisc = qdisc;
+    class->index = class_index;
+    class->location = stralloc(qdisc->location);
+    add_class(ctx,&qdisc->classes,class);
+    return class;
 }
 
 
@@ -548,7 +717,7 @@ static void parse_class(TCCEXT_CONTEXT *ctx,const char *line)
 	    exit(1);
 	}
     }
-    if (find_class(class->parent_qdisc->classes,class->index)) {
+    if (find_class(ctx,class->parent_qdisc,class->index)) {
 	fprintf(stderr,"duplicate class %d on qdisc %d\n",class->index,
 	  class->parent_qdisc->index);
 	exit(1);
@@ -562,26 +731,42 @@ static void parse_class(TCCEXT_CONTEXT *ctx,const char *line)
     else {
 	TCCEXT_CLASS *parent_class;
 
-	parent_class = find_class(class->parent_qdisc->classes,parent);
+	parent_class = find_class(ctx,class->parent_qdisc,parent);
 	if (!parent_class) {
 	    fprintf(stderr,"parent class %d not found\n",(int) parent);
 	    exit(1);
 	}
 	anchor = &parent_class->classes;
     }
-    class->next = NULL;
-    while (*anchor) anchor = &(*anchor)->next;
-    *anchor = class;
+    add_class(ctx,anchor,class);
 }
 
 
 /* ----- The block group --------------------------------------------------- */
 
 
+static void add_block(TCCEXT_CONTEXT *ctx,TCCEXT_BLOCK *block)
+{
+    const TCCEXT_BLOCK *scan;
+
+    for (scan = ctx->blocks; scan; scan = scan->next)
+	if (!strcmp(block->name,scan->name) && block->role == scan->role) {
+	    fprintf(stderr,"duplicate block \"%s\" %sgress\n",block->name,
+	      block->role == tbr_ingress ? "in" : "e");
+	    exit(1);
+	}
+    block->qdiscs = NULL;
+    block->rules = NULL;
+    block->actions = NULL;
+    block->location = make_location("device %s",block->name);
+    block->next = ctx->blocks;
+    ctx->blocks = block;
+}
+
+
 static void parse_block(TCCEXT_CONTEXT *ctx,const char *line)
 {
     TCCEXT_BLOCK *block;
-    const TCCEXT_BLOCK *scan;
     char role[11];
     int pos;
 
@@ -596,19 +781,8 @@ static void parse_block(TCCEXT_CONTEXT *ctx,const char *line)
 	fprintf(stderr,"unrecognized role \"%s\"\n",role);
 	exit(1);
     }
-    for (scan = ctx->blocks; scan; scan = scan->next)
-	if (!strcmp(block->name,scan->name) && block->role == scan->role) {
-	    fprintf(stderr,"duplicate block \"%s\" %sgress\n",block->name,
-	      block->role == tbr_ingress ? "in" : "e");
-	    exit(1);
-	}
-    block->qdiscs = NULL;
-    block->rules = NULL;
-    block->actions = NULL;
     block->pragmas = parse_pragmas(ctx,line+pos);
-    block->location = make_location("device %s",block->name);
-    block->next = ctx->blocks;
-    ctx->blocks = block;
+    add_block(ctx,block);
 }
 
 
@@ -619,17 +793,31 @@ static TCCEXT_BUCKET *find_bucket(TCCEXT_CONTEXT *ctx,int index)
 {
     TCCEXT_BUCKET *bucket;
 
-    for (bucket = ctx->buckets; bucket; bucket = bucket->next)
-	if (bucket->index == index) return bucket;
+    bucket = index_find(ctx,ik_bucket,NULL,index);
+    if (bucket) return bucket;
     fprintf(stderr,"no bucket %d\n",index);
     exit(1);
 }
 
 
+static void add_bucket(TCCEXT_CONTEXT *ctx,TCCEXT_BUCKET *bucket,
+  int overflow)
+{
+    if (index_find(ctx,ik_bucket,NULL,bucket->index)) {
+	fprintf(stderr,"duplicate bucket index %d\n",bucket->index);
+	exit(1);
+    }
+    bucket->overflow = overflow ? find_bucket(ctx,overflow) : NULL;
+    bucket->location = make_location("police %d",bucket->index);
+    bucket->next = ctx->buckets;
+    ctx->buckets = bucket;
+    index_set(ctx,ik_bucket,NULL,bucket->index,bucket);
+}
+
+
 static void parse_bucket(TCCEXT_CONTEXT *ctx,const char *line)
 {
     TCCEXT_BUCKET *bucket;
-    const TCCEXT_BUCKET *scan;
     unsigned long rate,depth,initial;
     int overflow,pos;
 
@@ -640,19 +828,11 @@ static void parse_bucket(TCCEXT_CONTEXT *ctx,const char *line)
 	fprintf(stderr,"unrecognized bucket \"%s\"\n",line);
 	exit(1);
     }
-    for (scan = ctx->buckets; scan; scan = scan->next)
-	if (scan->index== bucket->index) {
-	    fprintf(stderr,"duplicate bucket index %d\n",bucket->index);
-	    exit(1);
-	}
     bucket->rate = rate;
     bucket->depth = depth;
     bucket->initial_tokens = initial;
-    bucket->overflow = overflow ? find_bucket(ctx,overflow) : NULL;
     bucket->pragmas = parse_pragmas(ctx,line+pos);
-    bucket->location = make_location("police %d",bucket->index);
-    bucket->next = ctx->buckets;
-    ctx->buckets = bucket;
+    add_bucket(ctx,bucket,overflow);
 }
 
 
@@ -661,11 +841,20 @@ static void parse_bucket(TCCEXT_CONTEXT *ctx,const char *line)
 
 static TCCEXT_ACTION *find_action(TCCEXT_CONTEXT *ctx,int index)
 {
-    TCCEXT_ACTION *action;
+    return index_find(ctx,ik_action,ctx->blocks,index);
+}
 
-    for (action = ctx->blocks->actions; action; action = action->next)
-	if (action->index == index) break;
-    return action;
+
+static TCCEXT_CLASS_LIST *class_list_entry(TCCEXT_CONTEXT *ctx,int qdisc,
+  int class)
+{
+    TCCEXT_CLASS_LIST *entry;
+
+    entry = alloc_zero(TE_SIZEOF(ctx,class_list,TCCEXT_CLASS_LIST));
+    entry->class = find_qdisc_class(ctx,qdisc,class);
+    if (!entry->class) entry->class = fudge_class(ctx,qdisc,class);
+    entry->next = NULL;
+    return entry;
 }
 
 
@@ -682,10 +871,7 @@ static TCCEXT_CLASS_LIST *parse_class_list(TCCEXT_CONTEXT *ctx,
 	    fprintf(stderr,"not a class \"%s\"\n",*line);
 	    exit(1);
 	}
-	*next = alloc_zero(TE_SIZEOF(ctx,class_list,TCCEXT_CLASS_LIST));
-	(*next)->class = find_qdisc_class(ctx,qdisc,class);
-	if (!(*next)->class) (*next)->class = fudge_class(ctx,qdisc,class);
-	(*next)->next = NULL;
+	*next = class_list_entry(ctx,qdisc,class);
 	next = &(*next)->next;
 	*line += pos;
     }
@@ -741,10 +927,30 @@ static TCCEXT_ACTION *parse_action(TCCEXT_CONTEXT *ctx,const char **line)
 }
 
 
+static void check_action(TCCEXT_CONTEXT *ctx,int index)
+{
+    if (!ctx->blocks) {
+	fprintf(stderr,"can't handle action without block\n");
+	exit(1);
+    }
+    if (find_action(ctx,index)) {
+	fprintf(stderr,"duplicate action index %d\n",index);
+	exit(1);
+    }
+}
+
+
+static void add_action(TCCEXT_CONTEXT *ctx,TCCEXT_ACTION *action,int index)
+{
+    action->index = index;
+    action->next = ctx->blocks->actions;
+    ctx->blocks->actions = action;
+    index_set(ctx,ik_action,ctx->blocks,index,action);
+}
+
+
 static void parse_actions(TCCEXT_CONTEXT *ctx,const char *line)
 {
-    TCCEXT_ACTION *action;
-    const TCCEXT_ACTION *scan;
     int index,pos;
 
     if (!ctx->blocks) {
@@ -755,16 +961,448 @@ static void parse_actions(TCCEXT_CONTEXT *ctx,const char *line)
 	fprintf(stderr,"unrecognized action definition \"%s\"\n",line);
 	exit(1);
     }
-    for (scan = ctx->blocks->actions; scan; scan = scan->next)
-	if (scan->index == index) {
-	    fprintf(stderr,"duplicate action index %d\n",index);
+    check_action(ctx,index);
+    line += pos+1;
+    add_action(ctx,parse_action(ctx,&line),index);
+}
+
+
+/* ----- Text lines -------------------------------------------------------- */
+
+
+static void parse_line(TCCEXT_CONTEXT *ctx,char *line)
+{
+    char buf[MAX_BUF];
+    char *here;
+    int pos;
+
+    here = strchr(line,'\n');
+    if (here) *here = 0;
+    here = strchr(line,'#');
+    if (here) *here = 0;
+    if (!*line) return;
+    if (!sscanf(line,"%" S(MAX_BUF) "s%n",buf,&pos)) {
+	fprintf(stderr,"unrecognized line \"%s\"\n",line);
+	exit(1);
+    }
+    if (!strcmp(buf,"pragma")) parse_pragma(ctx,line+pos+1);
+    else if (!strcmp(buf,"block")) parse_block(ctx,line+pos+1);
+    else if (!strcmp(buf,"qdisc")) parse_qdisc(ctx,line+pos+1);
+    else if (!strcmp(buf,"class")) parse_class(ctx,line+pos+1);
+    else if (!strcmp(buf,"offset")) parse_offset(ctx,line+pos+1);
+    else if (!strcmp(buf,"bucket")) parse_bucket(ctx,line+pos+1);
+    else if (!strcmp(buf,"action")) parse_actions(ctx,line+pos+1);
+    else if (!strcmp(buf,"bit")) parse_bit(ctx,line+pos+1);
+    else if (!strcmp(buf,"match")) parse_rule(ctx,line+pos+1);
+    else if (!strcmp(buf,"barrier")) parse_barrier(ctx,line+pos+1);
+    else {
+	fprintf(stderr,"unrecognized line \"%s\"\n",line);
+	exit(1);
+    }
+}
+
+
+/*
+ * The line parsers may look one character beyond the end of the line, so
+ * each line is copied into a buffer just like fgets would return it.
+ */
+
+static void parse_text(TCCEXT_CONTEXT *ctx,const char *text,const char *end)
+{
+    const char *next;
+    char line[MAX_LINE];
+
+    for (; text != end; text = next) {
+	next = memchr(text,'\n',end-text);
+	next = next ? next+1 : end;
+	if (next-text >= MAX_LINE) {
+	    fprintf(stderr,"line too long\n");
 	    exit(1);
 	}
-    line += pos+1;
-    action = parse_action(ctx,&line);
-    action->index = index;
-    action->next = ctx->blocks->actions;
-    ctx->blocks->actions = action;
+	memcpy(line,text,next-text);
+	line[next-text] = 0;
+	parse_line(ctx,line);
+    }
+}
+
+
+/* ----- Binary encoding --------------------------------------------------- */
+
+
+/*
+ * The encoding is described in tccextbin.h. Records are decoded in place.
+ */
+
+
+struct record {
+    const uint8_t *pos;			/* next word */
+    const uint8_t *end;			/* end of payload */
+};
+
+
+static uint32_t get_u32(struct record *r)
+{
+    const uint8_t *p = r->pos;
+
+    if (r->end-p < 4) {
+	fprintf(stderr,"truncated record\n");
+	exit(1);
+    }
+    r->pos += 4;
+    return (uint32_t) p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+
+static const uint8_t *get_bytes(struct record *r,uint32_t len)
+{
+    const uint8_t *p = r->pos;
+
+    if ((uint32_t) (r->end-p) < len) {
+	fprintf(stderr,"truncated record\n");
+	exit(1);
+    }
+    r->pos += (len+3) & ~3;
+    if (r->pos > r->end) r->pos = r->end;
+    return p;
+}
+
+
+static char *get_string(struct record *r)
+{
+    const uint8_t *p;
+    uint32_t len;
+    char *s;
+
+    len = get_u32(r);
+    p = get_bytes(r,len);
+    s = malloc(len+1);
+    if (!s) {
+	perror("malloc");
+	exit(1);
+    }
+    memcpy(s,p,len);
+    s[len] = 0;
+    return s;
+}
+
+
+static TCCEXT_PRAGMA *get_pragmas(const TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    TCCEXT_PRAGMA *pragmas,**last;
+
+    last = &pragmas;
+    while (r->pos != r->end) {
+	*last = alloc_zero(TE_SIZEOF(ctx,pragma,TCCEXT_PRAGMA));
+	(*last)->pragma = get_string(r);
+	last = &(*last)->next;
+    }
+    *last = NULL;
+    return pragmas;
+}
+
+
+static TCCEXT_FIELD get_field(TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    TCCEXT_FIELD field;
+
+    field.offset_group = find_group(ctx,get_u32(r));
+    field.offset = get_u32(r);
+    field.length = get_u32(r);
+    return field;
+}
+
+
+static void bin_text(TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    const char *text;
+    uint32_t len;
+
+    len = get_u32(r);
+    text = (const char *) get_bytes(r,len);
+    parse_text(ctx,text,text+len);
+}
+
+
+static void bin_block(TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    TCCEXT_BLOCK *block;
+
+    block = alloc_zero(TE_SIZEOF(ctx,block,TCCEXT_BLOCK));
+    switch (get_u32(r)) {
+	case TCCEXT_BIN_INGRESS:
+	    block->role = tbr_ingress;
+	    break;
+	case TCCEXT_BIN_EGRESS:
+	    block->role = tbr_egress;
+	    break;
+	default:
+	    fprintf(stderr,"unrecognized role\n");
+	    exit(1);
+    }
+    block->name = get_string(r);
+    block->pragmas = get_pragmas(ctx,r);
+    add_block(ctx,block);
+}
+
+
+static void bin_offset(TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    TCCEXT_OFFSET *offset;
+
+    offset = alloc_zero(TE_SIZEOF(ctx,offset,TCCEXT_OFFSET));
+    offset->group_number = get_u32(r);
+    check_offset(ctx,offset->group_number);
+    offset->base = find_group(ctx,get_u32(r));
+    offset->field = get_field(ctx,r);
+    offset->shift_left = get_u32(r);
+    add_offset(ctx,offset);
+}
+
+
+static void bin_bucket(TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    TCCEXT_BUCKET *bucket;
+    int overflow;
+
+    bucket = alloc_zero(TE_SIZEOF(ctx,bucket,TCCEXT_BUCKET));
+    bucket->index = get_u32(r);
+    bucket->rate = get_u32(r);
+    bucket->mpu = get_u32(r);
+    bucket->depth = get_u32(r);
+    bucket->initial_tokens = get_u32(r);
+    overflow = get_u32(r);
+    bucket->pragmas = get_pragmas(ctx,r);
+    add_bucket(ctx,bucket,overflow);
+}
+
+
+static TCCEXT_ACTION *get_action(TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    TCCEXT_ACTION *action;
+    TCCEXT_CLASS_LIST **next;
+    uint32_t type,n;
+
+    type = get_u32(r);
+    if (type == tea_action) return find_action(ctx,get_u32(r));
+    action = alloc_zero(TE_SIZEOF(ctx,action,TCCEXT_ACTION));
+    switch (type) {
+	case tea_conform:
+	    action->type = tat_conform;
+	    action->u.conform.bucket = find_bucket(ctx,get_u32(r));
+	    action->u.conform.yes_action = get_action(ctx,r);
+	    action->u.conform.no_action = get_action(ctx,r);
+	    break;
+	case tea_count:
+	    action->type = tat_count;
+	    action->u.count.bucket = find_bucket(ctx,get_u32(r));
+	    action->u.count.action = get_action(ctx,r);
+	    break;
+	case tea_class:
+	    action->type = tat_class;
+	    next = &action->u.class_list;
+	    for (n = get_u32(r); n; n--) {
+		int qdisc;
+
+		qdisc = get_u32(r);
+		*next = class_list_entry(ctx,qdisc,get_u32(r));
+		next = &(*next)->next;
+	    }
+	    break;
+	case tea_drop:
+	    action->type = tat_drop;
+	    break;
+	case tea_unspec:
+	    action->type = tat_unspec;
+	    break;
+	default:
+	    fprintf(stderr,"unrecognized action type %lu\n",
+	      (unsigned long) type);
+	    exit(1);
+    }
+    return action;
+}
+
+
+static void bin_action(TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    int index;
+
+    index = get_u32(r);
+    check_action(ctx,index);
+    add_action(ctx,get_action(ctx,r),index);
+}
+
+
+static void bin_match(TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    TCCEXT_MATCH *matches = NULL,**next = &matches;
+    TCCEXT_ACTION *action;
+
+    check_rule(ctx);
+    action = rule_action(ctx,get_u32(r));
+    while (r->pos != r->end) {
+	TCCEXT_MATCH *match;
+	int bytes;
+
+	match = alloc_zero(TE_SIZEOF(ctx,match,TCCEXT_MATCH));
+	match->field = get_field(ctx,r);
+	bytes = (match->field.length+7) >> 3;
+	match->data = alloc_zero((bytes+sizeof(int)-1) & ~(sizeof(int)-1));
+	memcpy(match->data,get_bytes(r,bytes),bytes);
+	match->next = NULL;
+	match->context = ctx;
+	*next = match;
+	next = &match->next;
+    }
+    add_rule(ctx,matches,action);
+}
+
+
+static void bin_bit(TCCEXT_CONTEXT *ctx,struct record *r)
+{
+    TCCEXT_BIT *bit;
+    uint32_t action;
+    int true;
+
+    check_rule(ctx);
+    bit = alloc_zero(TE_SIZEOF(ctx,bit,TCCEXT_BIT));
+    bit->index = get_u32(r);
+    check_bit(ctx,bit->index);
+    action = get_u32(r);
+    bit->action =
+      action == TCCEXT_BIN_NO_ACTION ? NULL : bit_action(ctx,action);
+    bit->field = get_field(ctx,r);
+    true = get_u32(r);
+    add_bit(ctx,bit,true,get_u32(r));
+}
+
+
+static void parse_binary(TCCEXT_CONTEXT *ctx,const uint8_t *data,
+  const uint8_t *end)
+{
+    struct record r;
+
+    if (end-data < 8 || memcmp(data,TCCEXT_BIN_MAGIC,4)) {
+	fprintf(stderr,"unrecognized input format\n");
+	exit(1);
+    }
+    r.pos = data+4;
+    r.end = data+8;
+    if (get_u32(&r) != TCCEXT_BIN_VERSION) {
+	fprintf(stderr,"unsupported binary format version\n");
+	exit(1);
+    }
+    data += 8;
+    while (data != end) {
+	uint32_t type,len;
+
+	r.pos = data;
+	r.end = end-data < 8 ? end : data+8;
+	type = get_u32(&r);
+	len = get_u32(&r);
+	if ((uint32_t) (end-r.pos) < len) {
+	    fprintf(stderr,"truncated record\n");
+	    exit(1);
+	}
+	r.end = r.pos+len;
+	data = r.end;
+	switch (type) {
+	    case teb_text:
+		bin_text(ctx,&r);
+		break;
+	    case teb_pragma:
+		ctx->pragmas = get_pragmas(ctx,&r);
+		break;
+	    case teb_block:
+		bin_block(ctx,&r);
+		break;
+	    case teb_offset:
+		bin_offset(ctx,&r);
+		break;
+	    case teb_bucket:
+		bin_bucket(ctx,&r);
+		break;
+	    case teb_action:
+		bin_action(ctx,&r);
+		break;
+	    case teb_match:
+		bin_match(ctx,&r);
+		break;
+	    case teb_barrier:
+		check_rule(ctx);
+		add_rule(ctx,NULL,NULL);
+		break;
+	    case teb_bit:
+		bin_bit(ctx,&r);
+		break;
+	    default:
+		break;
+	}
+    }
+}
+
+
+/* ----- Input ------------------------------------------------------------- */
+
+
+/*
+ * The input is parsed in memory. Regular files are mapped, everything else
+ * (pipes, memory streams, etc.) is read into a buffer.
+ */
+
+struct input {
+    const char *data;
+    size_t len;
+    void *map;		/* mapping to remove; NULL if "data" was allocated */
+    size_t map_len;
+};
+
+
+static void map_input(FILE *file,struct input *in)
+{
+    struct stat st;
+    long pos;
+    int fd;
+
+    fd = fileno(file);
+    pos = ftell(file);
+    if (fd >= 0 && pos >= 0 && !fstat(fd,&st) && S_ISREG(st.st_mode) &&
+      st.st_size > pos) {
+	in->map = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+	if (in->map != MAP_FAILED) {
+	    in->map_len = st.st_size;
+	    in->data = (const char *) in->map+pos;
+	    in->len = st.st_size-pos;
+	    (void) fseek(file,0,SEEK_END);
+	    return;
+	}
+    }
+    in->map = NULL;
+    in->len = 0;
+    in->map_len = 65536;
+    in->data = alloc_zero(in->map_len);
+    while (1) {
+	size_t got;
+
+	got = fread((char *) in->data+in->len,1,in->map_len-in->len,file);
+	if (!got) break;
+	in->len += got;
+	if (in->len == in->map_len) {
+	    in->map_len *= 2;
+	    in->data = realloc((char *) in->data,in->map_len);
+	    if (!in->data) {
+		perror("realloc");
+		exit(1);
+	    }
+	}
+    }
+}
+
+
+static void unmap_input(struct input *in)
+{
+    if (in->map) (void) munmap(in->map,in->map_len);
+    else free((char *) in->data);
 }
 
 
@@ -774,7 +1412,7 @@ static void parse_actions(TCCEXT_CONTEXT *ctx,const char *line)
 TCCEXT_CONTEXT *tccext_parse(FILE *file,TCCEXT_SIZES *sizes)
 {
     TCCEXT_CONTEXT *ctx;
-    char line[MAX_LINE];
+    struct input in;
     
     ctx = alloc_zero(__TE_SIZEOF(sizes ? sizes->context : 0,
       sizeof(TCCEXT_CONTEXT)));
@@ -782,35 +1420,14 @@ TCCEXT_CONTEXT *tccext_parse(FILE *file,TCCEXT_SIZES *sizes)
     ctx->blocks = NULL;
     if (sizes) ctx->sizes = *sizes;
     else memset(&ctx->sizes,0,sizeof(TCCEXT_SIZES));
-    while (fgets(line,sizeof(line),file)) {
-	char buf[MAX_BUF];
-	char *here;
-	int pos;
-
-	here = strchr(line,'\n');
-	if (here) *here = 0;
-	here = strchr(line,'#');
-	if (here) *here = 0;
-	if (!*line) continue;
-	if (!sscanf(line,"%" S(MAX_BUF) "s%n",buf,&pos)) {
-	    fprintf(stderr,"unrecognized line \"%s\"\n",line);
-	    exit(1);
-	}
-	if (!strcmp(buf,"pragma")) parse_pragma(ctx,line+pos+1);
-	else if (!strcmp(buf,"block")) parse_block(ctx,line+pos+1);
-	else if (!strcmp(buf,"qdisc")) parse_qdisc(ctx,line+pos+1);
-	else if (!strcmp(buf,"class")) parse_class(ctx,line+pos+1);
-	else if (!strcmp(buf,"offset")) parse_offset(ctx,line+pos+1);
-	else if (!strcmp(buf,"bucket")) parse_bucket(ctx,line+pos+1);
-	else if (!strcmp(buf,"action")) parse_actions(ctx,line+pos+1);
-	else if (!strcmp(buf,"bit")) parse_bit(ctx,line+pos+1);
-	else if (!strcmp(buf,"match")) parse_rule(ctx,line+pos+1);
-	else if (!strcmp(buf,"barrier")) parse_barrier(ctx,line+pos+1);
-	else {
-	    fprintf(stderr,"unrecognized line \"%s\"\n",line);
-	    exit(1);
-	}
-    }
+    map_input(file,&in);
+    index_create(ctx);
+    if (in.len && !*in.data)
+	parse_binary(ctx,(const uint8_t *) in.data,
+	  (const uint8_t *) in.data+in.len);
+    else parse_text(ctx,in.data,in.data+in.len);
+    index_destroy(ctx);
+    unmap_input(&in);
     return ctx;
 }
 
@@ -936,12 +1553,11 @@ void tccext_destroy(TCCEXT_CONTEXT *ctx)
 	    ctx->blocks->rules = next_rule;
 	}
 	while (ctx->blocks->bits) {
-	    TCCEXT_BIT *next_bit = ctx->blocks->bits;
+	    TCCEXT_BIT *next_bit = ctx->blocks->bits->next;
 
 	    free(ctx->blocks->bits);
 	    ctx->blocks->bits = next_bit;
 	}
-	/* destroy_fsm here @@@ */
 	destroy_pragmas(ctx->blocks->pragmas);
 	free((char *) ctx->blocks->name);
 	free((char *) ctx->blocks->location);
@@ -126,6 +126,13 @@ typedef struct _tccext_bit {
     struct _tccext_bit *next;		/* next bit (private) */
 } TCCEXT_BIT;
 
+/*
+ * tccext_fsm_compile flattens the bit tree of a block into a form that can be
+ * executed quickly by tccext_fsm_run.
+ */
+
+typedef struct _tccext_fsm TCCEXT_FSM;
+
 
 /* ----- Rule-based classification ----------------------------------------- */
 
@@ -212,7 +219,7 @@ typedef struct _tccext_block {
     struct _tccext_block *next;		/* next block; NULL if last */
 } TCCEXT_BLOCK;
 
-/* Note: only one of "rules" and "fsm" may be non-NULL ! */
+/* Note: if "fsm" is non-NULL, "rules" classifies packets the same way. */
 
 
 /* ----- Context ----------------------------------------------------------- */
@@ -241,6 +248,8 @@ typedef struct _tccext_context {
     TCCEXT_OFFSET *offset_groups;	/* offset groups (semi-private) */
     TCCEXT_BLOCK *blocks;		/* list of blocks; NULL if none */
     TCCEXT_SIZES sizes;
+    struct _tccext_index *index;	/* lookup table used while parsing;
+					   PRIVATE */
 } TCCEXT_CONTEXT;
 
 
@@ -254,4 +263,23 @@ void tccext_destroy(TCCEXT_CONTEXT *ctx);
     /* Delete structure returned by tccext_parse. tccext_destroy does not
        de-allocate memory objects attached to user fields ! */
 
+TCCEXT_FSM *tccext_fsm_compile(const TCCEXT_CONTEXT *ctx,
+  const TCCEXT_BLOCK *block);
+    /* Flatten the bit tree of "block". Returns NULL if "block" has no bit
+       tree. */
+
+const TCCEXT_ACTION *tccext_fsm_run(const TCCEXT_FSM *fsm,const uint8_t *raw,
+  const uint8_t *meta);
+    /* Return the action the bit tree selects for the packet at "raw". "meta"
+       points to the meta fields, at the offsets defined in tccmeta.h. Not
+       reentrant. */
+
+void tccext_fsm_destroy(TCCEXT_FSM *fsm);
+    /* Delete structure returned by tccext_fsm_compile. */
+
+int tccext_serve(const char *path,int (*fn)(int argc,const char **argv));
+    /* Accept requests from tcc on the UNIX socket "path" and run fn as the
+       main function of the external program for each of them, in a child
+       process. Only returns on errors. */
+
 #endif
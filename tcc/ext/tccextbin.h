@@ -0,0 +1,84 @@
+/*
+ * tccextbin.h - Binary encoding of tcc's external interface
+ *
+ * Distributed under the LGPL.
+ */
+
+/*
+ * The binary encoding is used instead of the text format if the external
+ * program returns "binary" in the configuration query. It starts with an
+ * eight byte header (TCCEXT_BIN_MAGIC, then the version as a 32 bit word),
+ * followed by records. Each record begins with its type and the length of
+ * its payload in bytes, each as a 32 bit word. The length is always a
+ * multiple of four, so records and all words in them are aligned to four
+ * bytes. All words are in network byte order.
+ *
+ * Strings are encoded as their length, followed by the characters (without
+ * terminating NUL), padded with zero bytes to a multiple of four. Fields are
+ * encoded as offset group, offset, and length. If a field carries a value
+ * (in a match), the value follows as (length+7)/8 bytes, right-aligned and
+ * padded like a string.
+ *
+ * Payloads:
+ *
+ * teb_text	string with one or more complete lines of the text format
+ * teb_pragma	strings (until the end of the record)
+ * teb_block	role (TCCEXT_BIN_INGRESS or TCCEXT_BIN_EGRESS), name, pragma
+ *		strings
+ * teb_offset	group number, base group, field, shift
+ * teb_bucket	index, rate, mpu, depth, initial tokens, overflow bucket
+ *		(0 if none), pragma strings
+ * teb_action	index, action item
+ * teb_match	action index, fields with values
+ * teb_barrier	(empty)
+ * teb_bit	index, action index (or TCCEXT_BIN_NO_ACTION), field, number
+ *		of the next bit if the field is one, next bit if zero
+ *
+ * An action item is one of:
+ *
+ * tea_action	index of an action defined earlier
+ * tea_conform	bucket, item if conforming, item if not conforming
+ * tea_count	bucket, item
+ * tea_class	number of classes, then qdisc and class number of each
+ * tea_drop	(nothing)
+ * tea_unspec	(nothing)
+ *
+ * Records appear in the same order as the corresponding lines in the text
+ * format. Records of unknown type are skipped.
+ */
+
+
+#ifndef TCCEXTBIN_H
+#define TCCEXTBIN_H
+
+#define TCCEXT_BIN_MAGIC	"\0tcx"	/* four bytes; the text format never
+					   begins with a NUL */
+#define TCCEXT_BIN_VERSION	1
+
+#define TCCEXT_BIN_NO_ACTION	0xffffffff
+
+#define TCCEXT_BIN_INGRESS	0
+#define TCCEXT_BIN_EGRESS	1
+
+enum {
+    teb_text = 1,
+    teb_pragma,
+    teb_block,
+    teb_offset,
+    teb_bucket,
+    teb_action,
+    teb_match,
+    teb_barrier,
+    teb_bit,
+};
+
+enum {
+    tea_action = 1,
+    tea_conform,
+    tea_count,
+    tea_class,
+    tea_drop,
+    tea_unspec,
+};
+
+#endif /* TCCEXTBIN_H */
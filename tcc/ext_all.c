@@ -36,6 +36,8 @@
 #include "iflib.h"
 #include "ext.h"
 #include "ext_all.h"
+#include "ext/tccextbin.h"
+#include "stats.h"
 
 
 int dump_all; /* dump all qdiscs and filters (experimental) */
@@ -44,9 +46,18 @@ int dump_all; /* dump all qdiscs and filters (experimental) */
 /* -------------------- skb->tc_index to class mapping --------------------- */
 
 
+static int bin_classes; /* number of classes in the binary class list */
+
+
 static void print_class_n(FILE *file,const QDISC *qdisc,uint16_t class,
   int *first)
 {
+    if (ext_binary) {
+	ext_bin_u32(qdisc->number);
+	ext_bin_u32(class);
+	bin_classes++;
+	return;
+    }
     fprintf(file,"%c%u:%u",*first ? ' ' : ',',(unsigned) qdisc->number,
       (unsigned) class);
     *first = 0;
@@ -196,10 +207,17 @@ int dump_all_decision(FILE *file,QDISC *root,uint16_t class)
     for (c = root->classes; c; c = c->next)
 	if (c->qdisc) {
 	    int one = 1;
-
-	    fprintf(file," class");
+	    int mark = 0;
+
+	    if (!ext_binary) fprintf(file," class");
+	    else {
+		ext_bin_u32(tea_class);
+		mark = ext_bin_mark();
+		bin_classes = 0;
+	    }
 	    print_class_n(file,root,class,&one);
 	    find_path(file,c->qdisc,class,0);
+	    if (ext_binary) ext_bin_patch(mark,bin_classes);
 	    return 1;
 	}
     return 0;
@@ -239,15 +257,23 @@ static void dump_this_qdisc(FILE *file,QDISC *qdisc)
 static void prepare_block(QDISC *root)
 {
     if (!root->filters) return;
+    stats_begin("backend",root);
     dump_if_ext_prepare(root->filters);
+    stats_end();
 }
 
 
 static void generate_block(FILE *file,QDISC *root)
 {
+    FILE *text;
+
+    stats_begin("backend",root);
     dump_block(file,root);
-    dump_this_qdisc(file,root);
+    text = ext_bin_text_begin(file);
+    dump_this_qdisc(text,root);
+    ext_bin_text_end(file,text);
     if (root->filters) dump_if_ext_local(root->filters,file);
+    stats_end();
 }
 
 
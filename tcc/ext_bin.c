@@ -0,0 +1,186 @@
+/*
+ * ext_bin.c - Binary encoding of the configuration data for the external
+ *	       interface
+ */
+
+/*
+ * The encoding is described in ext/tccextbin.h. Records are assembled in a
+ * buffer, so that their length can be written before the payload, and are
+ * then written in one piece.
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "util.h"
+#include "ext.h"
+#include "ext/tccextbin.h"
+
+
+int ext_binary = 0; /* current external target reads the binary encoding */
+
+
+static FILE *bin_file = NULL;	/* NULL if no record is being assembled */
+static uint8_t *buf = NULL;
+static int buf_len,buf_size = 0;
+
+
+static void need(int bytes)
+{
+    if (buf_len+bytes <= buf_size) return;
+    while (buf_len+bytes > buf_size) buf_size = buf_size ? buf_size*2 : 1024;
+    buf = realloc(buf,buf_size);
+    if (!buf) {
+	perror("realloc");
+	exit(1);
+    }
+}
+
+
+static void put_u32(uint8_t *p,uint32_t value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+
+void ext_bin_header(FILE *file)
+{
+    uint8_t header[8];
+
+    memcpy(header,TCCEXT_BIN_MAGIC,4);
+    put_u32(header+4,TCCEXT_BIN_VERSION);
+    fwrite(header,1,sizeof(header),file);
+}
+
+
+void ext_bin_begin(FILE *file,int type)
+{
+    assert(!bin_file);
+    bin_file = file;
+    buf_len = 0;
+    ext_bin_u32(type);
+    ext_bin_u32(0); /* payload length, set by ext_bin_end */
+}
+
+
+void ext_bin_u32(uint32_t value)
+{
+    need(4);
+    put_u32(buf+buf_len,value);
+    buf_len += 4;
+}
+
+
+int ext_bin_mark(void)
+{
+    ext_bin_u32(0);
+    return buf_len-4;
+}
+
+
+void ext_bin_patch(int mark,uint32_t value)
+{
+    put_u32(buf+mark,value);
+}
+
+
+static int reserve(int bytes)
+{
+    int pos = buf_len;
+    int padded = (bytes+3) & ~3;
+
+    need(padded);
+    memset(buf+buf_len,0,padded);
+    buf_len += padded;
+    return pos;
+}
+
+
+void ext_bin_string(const char *s)
+{
+    int len = strlen(s);
+    int pos;
+
+    ext_bin_u32(len);
+    pos = reserve(len);
+    memcpy(buf+pos,s,len);
+}
+
+
+void ext_bin_field(int offset_group,int offset,int length)
+{
+    ext_bin_u32(offset_group);
+    ext_bin_u32(offset);
+    ext_bin_u32(length);
+}
+
+
+int ext_bin_value(int length)
+{
+    return reserve((length+7) >> 3);
+}
+
+
+void ext_bin_value_bit(int value,int length,int bit)
+{
+    int pos = (-length & 7)+bit;
+
+    buf[value+(pos >> 3)] |= 0x80 >> (pos & 7);
+}
+
+
+void ext_bin_end(void)
+{
+    assert(bin_file);
+    put_u32(buf+4,buf_len-8);
+    fwrite(buf,1,buf_len,bin_file);
+    bin_file = NULL;
+}
+
+
+/* ----- Text records ------------------------------------------------------ */
+
+
+static char *text_buf;
+static size_t text_size;
+
+
+FILE *ext_bin_text_begin(FILE *file)
+{
+    FILE *text;
+
+    if (!ext_binary) return file;
+    text = open_memstream(&text_buf,&text_size);
+    if (!text) {
+	perror("open_memstream");
+	exit(1);
+    }
+    return text;
+}
+
+
+void ext_bin_text_end(FILE *file,FILE *text)
+{
+    if (!ext_binary) return;
+    if (fclose(text) == EOF) {
+	perror("fclose");
+	exit(1);
+    }
+    if (text_size) {
+	int pos;
+
+	ext_bin_begin(file,teb_text);
+	ext_bin_u32(text_size);
+	pos = reserve(text_size);
+	memcpy(buf+pos,text_buf,text_size);
+	ext_bin_end();
+    }
+    free(text_buf);
+}
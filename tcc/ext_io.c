@@ -13,9 +13,13 @@
 #include <string.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <errno.h>
+#include <stdint.h>
 #include <assert.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 
 #include "config.h"
@@ -30,6 +34,16 @@ static pid_t pid = 0;		/* 0 if there is no process */
 static char *in_path,*out_path;
 static int no_exit_handler = 1; /* set to 1 in child process */
 
+/*
+ * If TCNG_EXT_SERVER is set, we send our requests to the server listening on
+ * that UNIX socket instead of running the external program, and keep all the
+ * data in memory.
+ */
+
+static const char *server;	/* NULL if running the external program */
+static char *in_buf,*out_buf;
+static size_t in_size;
+
 
 /* ----- Argument handling ------------------------------------------------- */
 
@@ -187,6 +201,130 @@ static void child(char **argv,int err_fds[2])
 }
 
 
+/* ----- Server ------------------------------------------------------------ */
+
+
+/*
+ * A request consists of the number of arguments, the arguments, and the
+ * data for standard input. The response consists of the wait status of the
+ * program, and the data it wrote to standard output and standard error.
+ * Numbers are 32 bit words in network byte order. Strings and data are
+ * preceded by their length.
+ */
+
+
+static void send_all(int fd,const void *buf,size_t len)
+{
+    while (len) {
+	ssize_t wrote;
+
+	wrote = write(fd,buf,len);
+	if (wrote < 0) {
+	    if (errno == EINTR) continue;
+	    perror(server);
+	    exit(1);
+	}
+	buf = (const char *) buf+wrote;
+	len -= wrote;
+    }
+}
+
+
+static void recv_all(int fd,void *buf,size_t len)
+{
+    while (len) {
+	ssize_t got;
+
+	got = read(fd,buf,len);
+	if (got < 0) {
+	    if (errno == EINTR) continue;
+	    perror(server);
+	    exit(1);
+	}
+	if (!got) errorf("external program server \"%s\" closed the connection",
+	  server);
+	buf = (char *) buf+got;
+	len -= got;
+    }
+}
+
+
+static void send_u32(int fd,uint32_t value)
+{
+    uint8_t buf[4];
+
+    buf[0] = value >> 24;
+    buf[1] = value >> 16;
+    buf[2] = value >> 8;
+    buf[3] = value;
+    send_all(fd,buf,4);
+}
+
+
+static uint32_t recv_u32(int fd)
+{
+    uint8_t buf[4];
+
+    recv_all(fd,buf,4);
+    return (uint32_t) buf[0] << 24 | buf[1] << 16 | buf[2] << 8 | buf[3];
+}
+
+
+static void send_block(int fd,const char *buf,size_t len)
+{
+    send_u32(fd,len);
+    send_all(fd,buf,len);
+}
+
+
+static char *recv_block(int fd,size_t *len)
+{
+    char *buf;
+
+    *len = recv_u32(fd);
+    buf = alloc(*len+1);
+    recv_all(fd,buf,*len);
+    return buf;
+}
+
+
+static FILE *open_buffer(char *buf,size_t len)
+{
+    FILE *file;
+
+    /* fmemopen may refuse empty buffers */
+    file = len ? fmemopen(buf,len,"r") : fopen(DEV_NULL,"r");
+    if (!file) {
+	perror("fmemopen");
+	exit(1);
+    }
+    return file;
+}
+
+
+static int server_connect(void)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(server) >= sizeof(addr.sun_path))
+	errorf("external program server path \"%s\" is too long",server);
+    fd = socket(PF_UNIX,SOCK_STREAM,0);
+    if (fd < 0) {
+	perror("socket");
+	exit(1);
+    }
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path,server);
+    if (connect(fd,(struct sockaddr *) &addr,sizeof(addr)) < 0) {
+	perror(server);
+	exit(1);
+    }
+    return fd;
+}
+
+
 /* ----- Cleanup ----------------------------------------------------------- */
 
 
@@ -205,6 +343,13 @@ static void do_ext_close(int from_signal)
 	}
 	stream = NULL;
     }
+    if (server) {
+	if (!from_signal) {
+	    free_argv();
+	    free(out_buf);
+	}
+	return;
+    }
     if (unlink(in_path) < 0) {
 	perror(in_path);
 	_exit(1);
@@ -243,12 +388,24 @@ static void interrupted(int sig)
 FILE *ext_open(char **argv,const char *name)
 {
     assert(!stream);
-    in_path = alloc_sprintf("__ext_%d.in",getpid());
-    out_path = alloc_sprintf("__ext_%d.out",getpid());
-    stream = fopen(in_path,"w");
-    if (!stream) {
-	perror(in_path);
-	exit(1);
+    server = getenv("TCNG_EXT_SERVER");
+    if (server && !*server) server = NULL;
+    if (server) {
+	out_buf = NULL;
+	stream = open_memstream(&in_buf,&in_size);
+	if (!stream) {
+	    perror("open_memstream");
+	    exit(1);
+	}
+    }
+    else {
+	in_path = alloc_sprintf("__ext_%d.in",getpid());
+	out_path = alloc_sprintf("__ext_%d.out",getpid());
+	stream = fopen(in_path,"w");
+	if (!stream) {
+	    perror(in_path);
+	    exit(1);
+	}
     }
     if (no_exit_handler) {
 	no_exit_handler = 0;
@@ -260,13 +417,27 @@ FILE *ext_open(char **argv,const char *name)
 }
 
 
-void ext_read(const char *name,const char *action)
+static void check_status(const char *name,const char *action,int status)
+{
+    if (WIFEXITED(status)) {
+	if (!WEXITSTATUS(status)) return;
+	errorf("external program \"%s\" exited with status %d %s",name,
+	  WEXITSTATUS(status),action);
+    }
+    if (WIFSIGNALED(status))
+	errorf("external program \"%s\" received signal %d %s",name,
+	  WTERMSIG(status),action);
+    errorf("external program \"%s\" returned unrecognized status %d %s",name,
+      status,action);
+}
+
+
+static void run_read(const char *name,const char *action)
 {
     FILE *err_file;
     int err_fds[2];
     int status;
 
-    assert(stream);
     (void) fflush(stream);
     if (ferror(stream)) error("error writing to sub-process");
     if (!freopen(DEV_NULL,"r",stream)) { /* close old stream */
@@ -303,16 +474,52 @@ void ext_read(const char *name,const char *action)
 	perror(out_path);
 	exit(1);
     }
-    if (WIFEXITED(status)) {
-	if (!WEXITSTATUS(status)) return;
-	errorf("external program \"%s\" exited with status %d %s",name,
-	  WEXITSTATUS(status),action);
+    check_status(name,action,status);
+}
+
+
+static void serve_read(const char *name,const char *action)
+{
+    FILE *err_file;
+    char *err_buf;
+    size_t len;
+    int fd,argc,status;
+
+    if (fclose(stream) == EOF) error("error writing to sub-process");
+    stream = NULL; /* until we have the response */
+    fd = server_connect();
+    for (argc = 0; my_argv[argc]; argc++);
+    send_u32(fd,argc);
+    for (argc = 0; my_argv[argc]; argc++)
+	send_block(fd,my_argv[argc],strlen(my_argv[argc]));
+    send_block(fd,in_buf,in_size);
+    free(in_buf);
+    status = recv_u32(fd);
+    out_buf = recv_block(fd,&len);
+    stream = open_buffer(out_buf,len);
+    err_buf = recv_block(fd,&len);
+    if (close(fd) < 0) {
+	perror("close");
+	exit(1);
     }
-    if (WIFSIGNALED(status))
-	errorf("external program \"%s\" received signal %d %s",name,
-	  WTERMSIG(status),action);
-    errorf("external program \"%s\" returned unrecognized status %d %s",name,
-      status,action);
+    fflush(stdout);
+    err_file = open_buffer(err_buf,len);
+    expand_errors(err_file);
+    if (fclose(err_file) == EOF) {
+	perror("fclose");
+	exit(1);
+    }
+    free(err_buf);
+    check_status(name,action,status);
+}
+
+
+FILE *ext_read(const char *name,const char *action)
+{
+    assert(stream);
+    if (server) serve_read(name,action);
+    else run_read(name,action);
+    return stream;
 }
 
 
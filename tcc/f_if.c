@@ -19,6 +19,7 @@
 #include "target.h"
 #include "filter_common.h"
 #include "filter.h"
+#include "stats.h"
 
 
 /* ------------------------------- Checking -------------------------------- */
@@ -50,15 +51,20 @@ static void if_dump_tc(FILTER *filter)
     struct ext_target *target;
 
     if (qdisc->if_expr.type != dt_none) return;
+    stats_begin("backend",qdisc);
     for (target = ext_targets; target; target = target->next)
 	if (have_target("if",target->name)) {
 	    dump_if_ext(filter,target->name);
+	    stats_end();
 	    return;
 	}
     qdisc->if_expr = iflib_combine(qdisc);
     if (have_target("if","c")) dump_if_c(filter);
+    else if (have_target("if","bpf")) dump_if_bpf(filter);
     else if (have_target("if","tc")) dump_if_u32(filter);
     else error("no targets available for \"if\"");
+    expr_release();
+    stats_end();
 }
 
 
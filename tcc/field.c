@@ -16,6 +16,7 @@
 #include "data.h"
 #include "op.h"
 #include "field.h"
+#include "stats.h"
 
 
 static FIELD_ROOT *field_roots = NULL;
@@ -296,10 +297,12 @@ static void reduce_access(DATA *d)
 
 DATA field_expand(DATA d)
 {
+    stats_begin("field_expand",NULL);
     do_field_expand(&d);
     debug_expr("BEFORE bubble_precond",d);
     bubble_precond(&d,&d,1);
     reduce_access(&d);
+    stats_end();
     return d;
 }
 
@@ -18,6 +18,7 @@ void reset_offsets(void);
 
 void dump_if_u32(const FILTER *filter);
 void dump_if_c(const FILTER *filter);
+void dump_if_bpf(const FILTER *filter);
 
 /* ext_if material  @@@ move all this elsewhere */
 
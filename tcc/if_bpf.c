@@ -0,0 +1,1161 @@
+/*
+ * if_bpf.c - Processing of the "if" command, generating an eBPF program
+ */
+
+/*
+ * The program is meant for cls_bpf in direct-action mode: it stores the minor
+ * number of the selected class in skb->tc_classid, and returns one of the
+ * TC_ACT_* codes. cls_bpf takes the major number from the filter's classid,
+ * so all classes must belong to the qdisc the filter is attached to.
+ *
+ * Like -Octree in the "c" target, we simplify the expression with iflib and
+ * then translate && and || into jumps. All jumps go forward, so we know
+ * whether an instruction can be reached when we emit it, and simply drop it
+ * if it can't. (The verifier rejects unreachable instructions.)
+ *
+ * Packet data is read with bpf_skb_load_bytes_relative, so offsets are from
+ * the network header, like in the other targets. If a packet is too short for
+ * an access, the program returns TC_ACT_UNSPEC, so the packet continues with
+ * the next filter, like in the other targets. (BPF_ABS and BPF_IND would end
+ * the program with 0 instead, i.e. class <major>:0, which HTB treats as its
+ * direct queue.)
+ *
+ * Policers keep their state in an array map (see bpf.h). Buckets are refilled
+ * from bpf_ktime_get_ns(), with the same overflow semantics as in the "c"
+ * target. Updates are not atomic, which is fine under the qdisc lock, but
+ * may lose tokens if several CPUs run the classifier at the same time.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <endian.h>
+#include <elf.h>
+#include <linux/if_ether.h>
+
+#include "config.h"
+#include "util.h"
+#include "error.h"
+#include "data.h"
+#include "op.h"
+#include "field.h"
+#include "tree.h"
+#include "param.h"
+#include "tc.h"
+#include "iflib.h"
+#include "if.h"
+#include "bpf.h"
+
+#include "tccmeta.h"
+
+
+#define NS_PER_SEC	1000000000
+#define SPILL_BASE	24	/* r10-8 holds the map key, r10-16 packet data */
+#define LOAD_SLOT	-16
+#define MAX_SPILL	((BPF_STACK_SIZE-SPILL_BASE)/8)
+
+
+static const FILTER *filter;	/* filter we're translating */
+
+static struct bpf_insn *insns = NULL;
+static int *jump_label = NULL;	/* target label of jumps, -1 if none */
+static int n_insns = 0;
+static int *map_refs = NULL;	/* instructions loading the bucket map */
+static int n_map_refs = 0;
+static int reachable;
+static int spill_depth;
+
+
+static void *grow(void *array,int n,size_t size)
+{
+    if (n & (n-1)) return array; /* only grow at powers of two */
+    array = realloc(array,(n ? 2*n : 1)*size);
+    if (!array) {
+	perror("realloc");
+	exit(1);
+    }
+    return array;
+}
+
+
+/* ------------------------------ Instructions ----------------------------- */
+
+
+static void emit_jump(uint8_t code,int dst,int src,int32_t imm,int label);
+
+
+static void emit(uint8_t code,int dst,int src,int16_t off,int32_t imm)
+{
+    struct bpf_insn *insn;
+
+    if (!reachable) return;
+    insns = grow(insns,n_insns,sizeof(struct bpf_insn));
+    jump_label = grow(jump_label,n_insns,sizeof(int));
+    insn = insns+n_insns;
+    insn->code = code;
+    insn->dst_reg = dst;
+    insn->src_reg = src;
+    insn->off = off;
+    insn->imm = imm;
+    jump_label[n_insns++] = -1;
+    if (code == (BPF_JMP | BPF_EXIT) || code == (BPF_JMP | BPF_JA))
+	reachable = 0;
+}
+
+
+static void emit_imm64(int dst,uint64_t value)
+{
+    emit(BPF_LD | BPF_DW | BPF_IMM,dst,0,0,(uint32_t) value);
+    emit(0,0,0,0,value >> 32);
+}
+
+
+static void emit_map(int dst)
+{
+    if (!reachable) return;
+    map_refs = grow(map_refs,n_map_refs,sizeof(int));
+    map_refs[n_map_refs++] = n_insns;
+    emit_imm64(dst,0);
+}
+
+
+/*
+ * Immediate operands are sign-extended to 64 bits, so we can only use them
+ * for 32 bit values if the most significant bit is zero.
+ */
+
+static void emit_alu64_imm(uint8_t op,int dst,uint64_t value,int tmp)
+{
+    if (value <= 0x7fffffff) emit(BPF_ALU64 | op | BPF_K,dst,0,0,value);
+    else {
+	emit_imm64(tmp,value);
+	emit(BPF_ALU64 | op | BPF_X,dst,tmp,0,0);
+    }
+}
+
+
+static void emit_jump_imm(uint8_t op,int dst,uint64_t value,int tmp,
+  int label)
+{
+    if (value <= 0x7fffffff) emit_jump(BPF_JMP | op | BPF_K,dst,0,value,label);
+    else {
+	emit_imm64(tmp,value);
+	emit_jump(BPF_JMP | op | BPF_X,dst,tmp,0,label);
+    }
+}
+
+
+/* -------------------------------- Labels --------------------------------- */
+
+
+static int labels = 0;
+static int *label_pos = NULL;	/* instruction, -1 if not yet placed */
+static int *label_refs = NULL;	/* number of jumps to each label */
+static int last_label_pos;	/* position of the last label we placed */
+
+
+static int new_label(void)
+{
+    label_pos = grow(label_pos,labels,sizeof(int));
+    label_refs = grow(label_refs,labels,sizeof(int));
+    label_pos[labels] = -1;
+    label_refs[labels] = 0;
+    return labels++;
+}
+
+
+static void emit_jump(uint8_t code,int dst,int src,int32_t imm,int label)
+{
+    if (!reachable) return;
+    emit(code,dst,src,0,imm);
+    jump_label[n_insns-1] = label;
+    label_refs[label]++;
+}
+
+
+static void emit_goto(int label)
+{
+    emit_jump(BPF_JMP | BPF_JA,0,0,0,label);
+}
+
+
+static int invert_jump(uint8_t code)
+{
+    switch (BPF_OP(code)) {
+	case BPF_JEQ:
+	    return BPF_JNE;
+	case BPF_JNE:
+	    return BPF_JEQ;
+	case BPF_JGT:
+	    return BPF_JLE;
+	case BPF_JLE:
+	    return BPF_JGT;
+	case BPF_JGE:
+	    return BPF_JLT;
+	case BPF_JLT:
+	    return BPF_JGE;
+	default:
+	    return -1;
+    }
+}
+
+
+/*
+ * A jump to the next instruction is removed when we place its label. Labels
+ * already placed at the jump then point to the label's instruction, which is
+ * what they should do anyway.
+ *
+ * A conditional jump to the next instruction but one, followed by a jump
+ * elsewhere, becomes the inverse conditional jump, unless the second jump is
+ * the target of a label.
+ */
+
+static void place_label(int label)
+{
+    while (n_insns && jump_label[n_insns-1] == label &&
+      insns[n_insns-1].code == (BPF_JMP | BPF_JA)) {
+	n_insns--;
+	label_refs[label]--;
+	reachable = 1;
+    }
+    if (n_insns > 1 && last_label_pos != n_insns-1 &&
+      insns[n_insns-1].code == (BPF_JMP | BPF_JA) &&
+      jump_label[n_insns-2] == label &&
+      invert_jump(insns[n_insns-2].code) != -1) {
+	struct bpf_insn *insn = insns+n_insns-2;
+
+	insn->code = BPF_JMP | invert_jump(insn->code) | BPF_SRC(insn->code);
+	jump_label[n_insns-2] = jump_label[n_insns-1];
+	n_insns--;
+	label_refs[label]--;
+	reachable = 1;
+    }
+    label_pos[label] = last_label_pos = n_insns;
+    if (label_refs[label]) reachable = 1;
+}
+
+
+static void resolve_jumps(void)
+{
+    int i;
+
+    for (i = 0; i < n_insns; i++) {
+	int off;
+
+	if (jump_label[i] == -1) continue;
+	off = label_pos[jump_label[i]]-i-1;
+	if (off > 0x7fff)
+	    error("\"bpf\" target: program too large for 16 bit jumps");
+	insns[i].off = off;
+    }
+}
+
+
+/* -------------------------------- Results -------------------------------- */
+
+
+/*
+ * Each distinct result is emitted only once, at the end of the program, and
+ * the decisions jump there.
+ */
+
+struct bpf_result {
+    DECISION_RESULT result;
+    uint32_t minor;
+    int label;
+    struct bpf_result *next;	/* in order of creation */
+    struct bpf_result *hash_next;
+};
+
+static struct bpf_result *results = NULL,**last_result = &results;
+static struct bpf_result *result_hash[IF_BPF_HASH];
+
+
+static int find_result(DECISION_RESULT result,uint32_t minor)
+{
+    struct bpf_result *r;
+    unsigned h;
+
+    h = (minor*4+result) % IF_BPF_HASH;
+    for (r = result_hash[h]; r; r = r->hash_next)
+	if (r->result == result && r->minor == minor) return r->label;
+    r = alloc_t(struct bpf_result);
+    r->result = result;
+    r->minor = minor;
+    r->label = new_label();
+    r->next = NULL;
+    r->hash_next = result_hash[h];
+    result_hash[h] = r;
+    *last_result = r;
+    last_result = &r->next;
+    return r->label;
+}
+
+
+static int result_label(DATA d)
+{
+    uint32_t minor = 0;
+
+    switch (d.u.decision.result) {
+	case dr_class:
+	case dr_reclassify:
+	    if (d.u.decision.class->parent.qdisc != filter->parent.qdisc)
+		error("\"bpf\" target only supports classes of the qdisc the "
+		  "filter belongs to");
+	    minor = d.u.decision.class->number;
+	    break;
+	case dr_drop:
+	case dr_continue:
+	    break;
+	default:
+	    dump_failed(d,"unsupported decision");
+    }
+    return find_result(d.u.decision.result,minor);
+}
+
+
+static void emit_result(DECISION_RESULT result,uint32_t minor)
+{
+    switch (result) {
+	case dr_class:
+	case dr_reclassify:
+	    emit(BPF_ALU | BPF_MOV | BPF_K,BPF_REG_1,0,0,minor);
+	    emit(BPF_STX | BPF_W | BPF_MEM,BPF_REG_6,BPF_REG_1,SKB_TC_CLASSID,
+	      0);
+	    emit(BPF_ALU64 | BPF_MOV | BPF_K,BPF_REG_0,0,0,
+	      result == dr_class ? TC_ACT_OK : TC_ACT_RECLASSIFY);
+	    break;
+	case dr_drop:
+	    emit(BPF_ALU64 | BPF_MOV | BPF_K,BPF_REG_0,0,0,TC_ACT_SHOT);
+	    break;
+	default:
+	    emit(BPF_ALU64 | BPF_MOV | BPF_K,BPF_REG_0,0,0,TC_ACT_UNSPEC);
+	    break;
+    }
+    emit(BPF_JMP | BPF_EXIT,0,0,0,0);
+}
+
+
+static void dump_results(void)
+{
+    while (results) {
+	struct bpf_result *next = results->next;
+
+	place_label(results->label);
+	emit_result(results->result,results->minor);
+	free(results);
+	results = next;
+    }
+    last_result = &results;
+    memset(result_hash,0,sizeof(result_hash));
+}
+
+
+/* -------------------------------- Buckets -------------------------------- */
+
+
+struct bpf_bucket {
+    uint32_t rate;		/* bytes per second */
+    uint32_t depth;
+    uint32_t mpu;
+    uint64_t max_ns;		/* time until bucket and overflow are full */
+    int overflow;		/* index of overflow bucket, -1 if none */
+};
+
+static struct bpf_bucket *buckets = NULL;
+static int n_buckets = 0;
+static int *bucket_index = NULL;	/* by policer number, -1 if unused */
+static int bucket_numbers = 0;
+
+
+static int lookup_bucket(const POLICE *p)
+{
+    if (p->number >= bucket_numbers || bucket_index[p->number] == -1)
+	abort();
+    return bucket_index[p->number];
+}
+
+
+static uint32_t depth_sum(const POLICE *p)
+{
+    const POLICE *overflow = NULL;
+
+    if (!p) return 0;
+    if (prm_present(p->params,&prm_overflow))
+	overflow = prm_data(p->params,&prm_overflow).u.police;
+    return prm_data(p->params,&prm_burst).u.fnum+depth_sum(overflow);
+}
+
+
+static void add_bucket(const POLICE *p)
+{
+    struct bpf_bucket *b;
+    int overflow = -1;
+    int i;
+
+    if (p->number < bucket_numbers && bucket_index[p->number] != -1) return;
+    if (prm_present(p->params,&prm_overflow)) {
+	const POLICE *next = prm_data(p->params,&prm_overflow).u.police;
+
+	add_bucket(next);
+	overflow = lookup_bucket(next);
+    }
+    param_get(p->params,p->location);
+    if (!prm_rate.present && prm_peakrate.present)
+        error("if_bpf only supports single-rate token bucket policer");
+    if (!prm_rate.v) lerror(p->location,"\"bpf\" target needs a rate");
+    if (p->number >= bucket_numbers) {
+	bucket_index = realloc(bucket_index,(p->number+1)*sizeof(int));
+	if (!bucket_index) {
+	    perror("realloc");
+	    exit(1);
+	}
+	for (i = bucket_numbers; i <= p->number; i++) bucket_index[i] = -1;
+	bucket_numbers = p->number+1;
+    }
+    buckets = grow(buckets,n_buckets,sizeof(struct bpf_bucket));
+    b = buckets+n_buckets;
+    b->rate = prm_rate.v;
+    b->depth = prm_burst.v;
+    b->mpu = prm_mpu.present ? prm_mpu.v : 0;
+    b->max_ns = depth_sum(p)*(double) NS_PER_SEC/prm_rate.v;
+    b->overflow = overflow;
+    bucket_index[p->number] = n_buckets++;
+}
+
+
+static void collect_buckets(DATA d)
+{
+    if (!d.op && (d.type == dt_police || d.type == dt_bucket)) {
+	add_bucket(d.u.police);
+	return;
+    }
+    if (d.op) {
+	collect_buckets(d.op->a);
+	collect_buckets(d.op->b);
+	collect_buckets(d.op->c);
+    }
+}
+
+
+/*
+ * Leaves a pointer to the bucket in "dst", or jumps to "on_null".
+ */
+
+static void emit_lookup(int bucket,int dst,int on_null)
+{
+    emit_map(BPF_REG_1);
+    emit(BPF_ALU | BPF_MOV | BPF_K,BPF_REG_0,0,0,bucket);
+    emit(BPF_STX | BPF_W | BPF_MEM,BPF_REG_10,BPF_REG_0,-4,0);
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_2,BPF_REG_10,0,0);
+    emit(BPF_ALU64 | BPF_ADD | BPF_K,BPF_REG_2,0,0,-4);
+    emit(BPF_JMP | BPF_CALL,0,0,0,BPF_FUNC_map_lookup_elem);
+    emit_jump(BPF_JMP | BPF_JEQ | BPF_K,BPF_REG_0,0,0,on_null);
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,dst,BPF_REG_0,0,0);
+}
+
+
+/*
+ * Refills the bucket and leaves a pointer to it in r9. The time that was too
+ * short to yield a whole token is carried over to the next refill.
+ */
+
+static void emit_refill(int bucket,int on_null)
+{
+    const struct bpf_bucket *b = buckets+bucket;
+    int capped = new_label();
+    int done = new_label();
+    int i;
+
+    emit(BPF_JMP | BPF_CALL,0,0,0,BPF_FUNC_ktime_get_ns);
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_8,BPF_REG_0,0,0);
+    emit_lookup(bucket,BPF_REG_9,on_null);
+
+    /* r7 = min(now-last,max_ns)*rate */
+    emit(BPF_LDX | BPF_DW | BPF_MEM,BPF_REG_1,BPF_REG_9,BPF_BUCKET_LAST,0);
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_7,BPF_REG_8,0,0);
+    emit(BPF_ALU64 | BPF_SUB | BPF_X,BPF_REG_7,BPF_REG_1,0,0);
+    emit_imm64(BPF_REG_1,b->max_ns);
+    emit_jump(BPF_JMP | BPF_JGE | BPF_X,BPF_REG_1,BPF_REG_7,0,capped);
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_7,BPF_REG_1,0,0);
+    place_label(capped);
+    emit_alu64_imm(BPF_MUL,BPF_REG_7,b->rate,BPF_REG_1);
+
+    /* r1 = tokens, last = now-remainder/rate */
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_1,BPF_REG_7,0,0);
+    emit(BPF_ALU64 | BPF_DIV | BPF_K,BPF_REG_1,0,0,NS_PER_SEC);
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_2,BPF_REG_1,0,0);
+    emit(BPF_ALU64 | BPF_MUL | BPF_K,BPF_REG_2,0,0,NS_PER_SEC);
+    emit(BPF_ALU64 | BPF_SUB | BPF_X,BPF_REG_7,BPF_REG_2,0,0);
+    emit_alu64_imm(BPF_DIV,BPF_REG_7,b->rate,BPF_REG_2);
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_2,BPF_REG_8,0,0);
+    emit(BPF_ALU64 | BPF_SUB | BPF_X,BPF_REG_2,BPF_REG_7,0,0);
+    emit(BPF_STX | BPF_DW | BPF_MEM,BPF_REG_9,BPF_REG_2,BPF_BUCKET_LAST,0);
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_7,BPF_REG_1,0,0);
+
+    /* fill bucket, then overflow buckets */
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_8,BPF_REG_9,0,0);
+    for (i = bucket; i != -1; i = buckets[i].overflow) {
+	int next = new_label();
+
+	if (i != bucket) emit_lookup(i,BPF_REG_8,done);
+	emit(BPF_LDX | BPF_DW | BPF_MEM,BPF_REG_1,BPF_REG_8,
+	  BPF_BUCKET_DEFICIT,0);
+	emit_jump(BPF_JMP | BPF_JGT | BPF_X,BPF_REG_7,BPF_REG_1,0,next);
+	emit(BPF_ALU64 | BPF_SUB | BPF_X,BPF_REG_1,BPF_REG_7,0,0);
+	emit(BPF_STX | BPF_DW | BPF_MEM,BPF_REG_8,BPF_REG_1,
+	  BPF_BUCKET_DEFICIT,0);
+	emit_goto(done);
+	place_label(next);
+	emit(BPF_ALU64 | BPF_SUB | BPF_X,BPF_REG_7,BPF_REG_1,0,0);
+	emit(BPF_ALU64 | BPF_MOV | BPF_K,BPF_REG_1,0,0,0);
+	emit(BPF_STX | BPF_DW | BPF_MEM,BPF_REG_8,BPF_REG_1,
+	  BPF_BUCKET_DEFICIT,0);
+    }
+    place_label(done);
+}
+
+
+/*
+ * Leaves the deficit the bucket would have after accepting this packet in r2.
+ */
+
+static void emit_policed_len(int bucket)
+{
+    const struct bpf_bucket *b = buckets+bucket;
+
+    emit(BPF_LDX | BPF_W | BPF_MEM,BPF_REG_1,BPF_REG_6,SKB_LEN,0);
+    if (b->mpu) {
+	int big = new_label();
+
+	emit_jump_imm(BPF_JGE,BPF_REG_1,b->mpu,BPF_REG_2,big);
+	emit(BPF_ALU | BPF_MOV | BPF_K,BPF_REG_1,0,0,b->mpu);
+	place_label(big);
+    }
+    emit(BPF_LDX | BPF_DW | BPF_MEM,BPF_REG_2,BPF_REG_9,BPF_BUCKET_DEFICIT,0);
+    emit(BPF_ALU64 | BPF_ADD | BPF_X,BPF_REG_2,BPF_REG_1,0,0);
+}
+
+
+static void emit_conform(int bucket,int on_true,int on_false)
+{
+    emit_refill(bucket,on_false);
+    emit_policed_len(bucket);
+    emit_jump_imm(BPF_JGT,BPF_REG_2,buckets[bucket].depth,BPF_REG_3,
+      on_false);
+    emit_goto(on_true);
+}
+
+
+static void emit_count(int bucket,int on_true)
+{
+    int empty = new_label();
+
+    emit_refill(bucket,on_true);
+    emit_policed_len(bucket);
+    emit_jump_imm(BPF_JGT,BPF_REG_2,buckets[bucket].depth,BPF_REG_3,empty);
+    emit(BPF_STX | BPF_DW | BPF_MEM,BPF_REG_9,BPF_REG_2,BPF_BUCKET_DEFICIT,0);
+    emit_goto(on_true);
+    place_label(empty);
+    emit_imm64(BPF_REG_2,buckets[bucket].depth);
+    emit(BPF_STX | BPF_DW | BPF_MEM,BPF_REG_9,BPF_REG_2,BPF_BUCKET_DEFICIT,0);
+    emit_goto(on_true);
+}
+
+
+/* ------------------------------ Expressions ------------------------------ */
+
+
+static void dump_cond(DATA d,int on_true,int on_false);
+
+
+static int is_const(DATA d)
+{
+    return !d.op && (d.type == dt_unum || d.type == dt_ipv4);
+}
+
+
+static void dump_value(DATA d);
+
+
+static void dump_meta(DATA d)
+{
+    uint32_t offset,size;
+
+    if (d.op->b.op || d.op->b.type != dt_unum ||
+      d.op->c.op || d.op->c.type != dt_unum)
+	dump_failed(d,"invalid meta field access");
+    offset = d.op->b.u.unum;
+    size = d.op->c.u.unum;
+    if (offset == META_PROTOCOL_OFFSET && size == META_PROTOCOL_SIZE*8) {
+	emit(BPF_LDX | BPF_W | BPF_MEM,BPF_REG_0,BPF_REG_6,SKB_PROTOCOL,0);
+	emit(BPF_ALU | BPF_END | BPF_TO_BE,BPF_REG_0,0,0,16);
+	return;
+    }
+    if (offset == META_NFMARK_OFFSET && size == META_NFMARK_SIZE*8) {
+	emit(BPF_LDX | BPF_W | BPF_MEM,BPF_REG_0,BPF_REG_6,SKB_MARK,0);
+	return;
+    }
+    if (offset == META_TC_INDEX_OFFSET && size == META_TC_INDEX_SIZE*8) {
+	emit(BPF_LDX | BPF_W | BPF_MEM,BPF_REG_0,BPF_REG_6,SKB_TC_INDEX,0);
+	return;
+    }
+    error("\"bpf\" target: unsupported meta field");
+}
+
+
+/*
+ * Loads "size" bits at "offset" plus "extra" from the network header into r0,
+ * or returns TC_ACT_UNSPEC if the packet is too short.
+ */
+
+static void dump_load(DATA offset,uint32_t extra,int size)
+{
+    uint8_t code;
+
+    switch (size) {
+	case 8:
+	    code = BPF_B;
+	    break;
+	case 16:
+	    code = BPF_H;
+	    break;
+	case 32:
+	    code = BPF_W;
+	    break;
+	default:
+	    errorf("\"bpf\" target does not support %d bit access",size);
+	    return;
+    }
+    if (is_const(offset))
+	emit_alu64_imm(BPF_MOV,BPF_REG_2,offset.u.unum+extra,BPF_REG_2);
+    else {
+	dump_value(offset);
+	emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_2,BPF_REG_0,0,0);
+	if (extra) emit(BPF_ALU64 | BPF_ADD | BPF_K,BPF_REG_2,0,0,extra);
+    }
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_1,BPF_REG_6,0,0);
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_3,BPF_REG_10,0,0);
+    emit(BPF_ALU64 | BPF_ADD | BPF_K,BPF_REG_3,0,0,LOAD_SLOT);
+    emit(BPF_ALU64 | BPF_MOV | BPF_K,BPF_REG_4,0,0,size/8);
+    emit(BPF_ALU64 | BPF_MOV | BPF_K,BPF_REG_5,0,0,BPF_HDR_START_NET);
+    emit(BPF_JMP | BPF_CALL,0,0,0,BPF_FUNC_skb_load_bytes_relative);
+    emit_jump(BPF_JMP | BPF_JNE | BPF_K,BPF_REG_0,0,0,
+      find_result(dr_continue,0));
+    emit(BPF_LDX | code | BPF_MEM,BPF_REG_0,BPF_REG_10,LOAD_SLOT,0);
+    if (size > 8) emit(BPF_ALU | BPF_END | BPF_TO_BE,BPF_REG_0,0,0,size);
+}
+
+
+static void dump_access(DATA d)
+{
+    if (d.op->a.op || d.op->a.type != dt_field_root)
+	dump_failed(d,"invalid access base");
+    if (d.op->a.u.field_root->offset_group) {
+	if (d.op->a.u.field_root->offset_group != META_FIELD_ROOT)
+	    errorf("\"bpf\" only supports field roots 0 and %d",
+	      META_FIELD_ROOT);
+	dump_meta(d);
+	return;
+    }
+    if (d.op->c.op || d.op->c.type != dt_unum)
+	dump_failed(d,"invalid access size");
+    dump_load(d.op->b,0,d.op->c.u.unum);
+}
+
+
+/*
+ * Returns non-zero if "d" is a packet access whose result isn't changed by
+ * "& mask", i.e., the mask covers all the bits that were loaded.
+ */
+
+static int mask_redundant(DATA d,uint32_t mask)
+{
+    uint32_t size;
+
+    if (mask == 0xffffffff) return 1;
+    if (!d.op || d.op->dsc != &op_access || d.op->a.op ||
+      d.op->a.type != dt_field_root || d.op->a.u.field_root->offset_group ||
+      d.op->c.op)
+	return 0;
+    size = d.op->c.u.unum;
+    return size < 32 && (mask & ((1 << size)-1)) == (1 << size)-1;
+}
+
+
+/*
+ * Binary operations with a variable right-hand side save it on the stack
+ * while computing the left-hand side, which may call helpers, and thus clobber
+ * r1 to r5.
+ */
+
+static void dump_binary(uint8_t op,DATA d)
+{
+    DATA a = d.op->a,b = d.op->b;
+    int16_t slot;
+
+    if (is_const(a) && !is_const(b) && (op == BPF_ADD || op == BPF_MUL ||
+      op == BPF_AND || op == BPF_OR || op == BPF_XOR)) {
+	a = b;
+	b = d.op->a;
+    }
+    if (is_const(b)) {
+	if ((op == BPF_DIV || op == BPF_MOD) && !b.u.unum)
+	    error("division by zero");
+	if ((op == BPF_LSH || op == BPF_RSH) && b.u.unum > 31)
+	    error("\"bpf\" target: shift by more than 31 bits");
+	dump_value(a);
+	if (op != BPF_AND || !mask_redundant(a,b.u.unum))
+	    emit(BPF_ALU | op | BPF_K,BPF_REG_0,0,0,b.u.unum);
+	return;
+    }
+    if (spill_depth == MAX_SPILL)
+	error("\"bpf\" target: expression too complex");
+    slot = -SPILL_BASE-8*spill_depth;
+    dump_value(b);
+    emit(BPF_STX | BPF_DW | BPF_MEM,BPF_REG_10,BPF_REG_0,slot,0);
+    spill_depth++;
+    dump_value(a);
+    spill_depth--;
+    emit(BPF_LDX | BPF_DW | BPF_MEM,BPF_REG_1,BPF_REG_10,slot,0);
+    emit(BPF_ALU | op | BPF_X,BPF_REG_0,BPF_REG_1,0,0);
+}
+
+
+static void dump_bool(DATA d)
+{
+    int on_true = new_label();
+    int on_false = new_label();
+    int done = new_label();
+
+    dump_cond(d,on_true,on_false);
+    place_label(on_true);
+    emit(BPF_ALU | BPF_MOV | BPF_K,BPF_REG_0,0,0,1);
+    emit_goto(done);
+    place_label(on_false);
+    emit(BPF_ALU | BPF_MOV | BPF_K,BPF_REG_0,0,0,0);
+    place_label(done);
+}
+
+
+static void dump_value(DATA d)
+{
+    const OP_DSC *dsc;
+
+    if (!d.op) {
+	if (is_const(d)) {
+	    emit(BPF_ALU | BPF_MOV | BPF_K,BPF_REG_0,0,0,d.u.unum);
+	    return;
+	}
+	if (d.type == dt_decision) {
+	    emit_goto(result_label(d));
+	    return;
+	}
+	dump_failed(d,"bad type");
+    }
+    dsc = d.op->dsc;
+    if (dsc == &op_access) dump_access(d);
+    else if (dsc == &op_plus) dump_binary(BPF_ADD,d);
+    else if (dsc == &op_minus) dump_binary(BPF_SUB,d);
+    else if (dsc == &op_mult) dump_binary(BPF_MUL,d);
+    else if (dsc == &op_div) dump_binary(BPF_DIV,d);
+    else if (dsc == &op_mod) dump_binary(BPF_MOD,d);
+    else if (dsc == &op_and) dump_binary(BPF_AND,d);
+    else if (dsc == &op_or) dump_binary(BPF_OR,d);
+    else if (dsc == &op_xor) dump_binary(BPF_XOR,d);
+    else if (dsc == &op_shift_left) dump_binary(BPF_LSH,d);
+    else if (dsc == &op_shift_right) dump_binary(BPF_RSH,d);
+    else if (dsc == &op_not) {
+	dump_value(d.op->a);
+	emit(BPF_ALU | BPF_XOR | BPF_K,BPF_REG_0,0,0,-1);
+    }
+    else if (dsc == &op_unary_minus) {
+	dump_value(d.op->a);
+	emit(BPF_ALU | BPF_NEG,BPF_REG_0,0,0,0);
+    }
+    else if (dsc == &op_eq || dsc == &op_ne || dsc == &op_gt ||
+      dsc == &op_ge || dsc == &op_lt || dsc == &op_le ||
+      dsc == &op_logical_not || dsc == &op_logical_and ||
+      dsc == &op_logical_or || dsc == &op_conform || dsc == &op_count)
+	dump_bool(d);
+    else dump_failed(d,"bad operator");
+}
+
+
+/*
+ * IPv6 addresses are compared one 32 bit word at a time. Words that are
+ * completely masked out are skipped.
+ */
+
+static void dump_eq128(DATA d,int on_true,int on_false)
+{
+    DATA a = d.op->a,b = d.op->b;
+    U128 mask = u128_not(u128_from_32(0)),value;
+    int equal,differ;
+    int i;
+
+    if (!a.op) {
+	a = b;
+	b = d.op->a;
+    }
+    if (b.op) dump_failed(d,"128 bit comparison needs a constant");
+    value = data_convert(b,dt_ipv6).u.u128;
+    if (a.op && a.op->dsc == &op_and) {
+	if (a.op->b.op) dump_failed(d,"must be \"& constant\"");
+	mask = data_convert(a.op->b,dt_ipv6).u.u128;
+	a = a.op->a;
+    }
+    if (!a.op || a.op->dsc != &op_access || a.op->c.u.unum != 128)
+	dump_failed(d,"128 bit access expected");
+    if (a.op->a.op || a.op->a.type != dt_field_root ||
+      a.op->a.u.field_root->offset_group)
+	error("\"bpf\" only supports 128 bit access at field root 0");
+    equal = d.op->dsc == &op_eq ? on_true : on_false;
+    differ = d.op->dsc == &op_eq ? on_false : on_true;
+    for (i = 0; i < 4; i++)
+	if (value.v[3-i] & ~mask.v[3-i]) {
+	    emit_goto(differ);
+	    return;
+	}
+    for (i = 0; i < 4; i++) {
+	if (!mask.v[3-i]) continue;
+	dump_load(a.op->b,4*i,32);
+	if (mask.v[3-i] != 0xffffffff)
+	    emit(BPF_ALU | BPF_AND | BPF_K,BPF_REG_0,0,0,mask.v[3-i]);
+	emit_jump_imm(BPF_JNE,BPF_REG_0,value.v[3-i],BPF_REG_1,differ);
+    }
+    emit_goto(equal);
+}
+
+
+static void dump_compare(DATA d,int on_true,int on_false)
+{
+    const OP_DSC *dsc = d.op->dsc;
+    DATA a = d.op->a,b = d.op->b;
+    uint8_t op;
+
+    if (is_const(a) && !is_const(b)) {
+	a = b;
+	b = d.op->a;
+	if (dsc == &op_gt) dsc = &op_lt;
+	else if (dsc == &op_ge) dsc = &op_le;
+	else if (dsc == &op_lt) dsc = &op_gt;
+	else if (dsc == &op_le) dsc = &op_ge;
+    }
+    if (dsc == &op_eq) op = BPF_JEQ;
+    else if (dsc == &op_ne) op = BPF_JNE;
+    else if (dsc == &op_gt) op = BPF_JGT;
+    else if (dsc == &op_ge) op = BPF_JGE;
+    else if (dsc == &op_lt) op = BPF_JLT;
+    else op = BPF_JLE;
+    if (is_const(b)) {
+	dump_value(a);
+	emit_jump_imm(op,BPF_REG_0,b.u.unum,BPF_REG_1,on_true);
+    }
+    else {
+	int16_t slot;
+
+	if (spill_depth == MAX_SPILL)
+	    error("\"bpf\" target: expression too complex");
+	slot = -SPILL_BASE-8*spill_depth;
+	dump_value(b);
+	emit(BPF_STX | BPF_DW | BPF_MEM,BPF_REG_10,BPF_REG_0,slot,0);
+	spill_depth++;
+	dump_value(a);
+	spill_depth--;
+	emit(BPF_LDX | BPF_DW | BPF_MEM,BPF_REG_1,BPF_REG_10,slot,0);
+	emit_jump(BPF_JMP | op | BPF_X,BPF_REG_0,BPF_REG_1,0,on_true);
+    }
+    emit_goto(on_false);
+}
+
+
+static void dump_cond(DATA d,int on_true,int on_false)
+{
+    const OP_DSC *dsc;
+
+    if (!d.op) {
+	if (d.type == dt_decision) emit_goto(result_label(d));
+	else if (is_const(d)) emit_goto(d.u.unum ? on_true : on_false);
+	else dump_failed(d,"bad type");
+	return;
+    }
+    dsc = d.op->dsc;
+    /*
+     * A decision is just a jump, so we can jump there directly.
+     */
+    if (dsc == &op_logical_or) {
+	int next;
+
+	if (!d.op->b.op && d.op->b.type == dt_decision) {
+	    dump_cond(d.op->a,on_true,result_label(d.op->b));
+	    return;
+	}
+	next = new_label();
+	dump_cond(d.op->a,on_true,next);
+	place_label(next);
+	dump_cond(d.op->b,on_true,on_false);
+	return;
+    }
+    if (dsc == &op_logical_and) {
+	int next;
+
+	if (!d.op->b.op && d.op->b.type == dt_decision) {
+	    dump_cond(d.op->a,result_label(d.op->b),on_false);
+	    return;
+	}
+	next = new_label();
+	dump_cond(d.op->a,next,on_false);
+	place_label(next);
+	dump_cond(d.op->b,on_true,on_false);
+	return;
+    }
+    if (dsc == &op_logical_not) {
+	dump_cond(d.op->a,on_false,on_true);
+	return;
+    }
+    if ((dsc == &op_eq || dsc == &op_ne) &&
+      (d.op->a.type == dt_ipv6 || d.op->b.type == dt_ipv6)) {
+	dump_eq128(d,on_true,on_false);
+	return;
+    }
+    if (dsc == &op_eq || dsc == &op_ne || dsc == &op_gt || dsc == &op_ge ||
+      dsc == &op_lt || dsc == &op_le) {
+	dump_compare(d,on_true,on_false);
+	return;
+    }
+    if (dsc == &op_conform) {
+	emit_conform(lookup_bucket(d.op->a.u.police),on_true,on_false);
+	return;
+    }
+    if (dsc == &op_count) {
+	emit_count(lookup_bucket(d.op->a.u.police),on_true);
+	return;
+    }
+    dump_value(d);
+    emit_jump(BPF_JMP | BPF_JNE | BPF_K,BPF_REG_0,0,0,on_true);
+    emit_goto(on_false);
+}
+
+
+static void dump_program(DATA d)
+{
+    int done;
+
+    reachable = 1;
+    spill_depth = 0;
+    last_label_pos = -1;
+    emit(BPF_ALU64 | BPF_MOV | BPF_X,BPF_REG_6,BPF_REG_1,0,0);
+    done = new_label();
+    dump_cond(d,done,done);
+    place_label(done);
+    emit_result(dr_continue,0);
+    dump_results();
+    resolve_jumps();
+}
+
+
+/* ------------------------------ Object file ------------------------------ */
+
+
+/*
+ * The "maps" section and the relocations are only present if we have buckets.
+ * The program gets a function symbol, which libbpf-based loaders look for.
+ */
+
+struct section {
+    const char *name;
+    uint32_t type;
+    uint64_t flags;
+    const void *data;
+    size_t size;
+    size_t entsize;
+    int link;
+    int info;
+};
+
+static struct section sections[8];
+static int n_sections;
+
+
+static int add_section(const char *name,uint32_t type,uint64_t flags,
+  const void *data,size_t size,size_t entsize)
+{
+    struct section *sec = sections+n_sections;
+
+    sec->name = name;
+    sec->type = type;
+    sec->flags = flags;
+    sec->data = data;
+    sec->size = size;
+    sec->entsize = entsize;
+    sec->link = sec->info = 0;
+    return n_sections++;
+}
+
+
+static void pad(FILE *file)
+{
+    while (ftell(file) & 7) fputc(0,file);
+}
+
+
+static void write_object(FILE *file)
+{
+    static const char strtab[] = "\0" BPF_BUCKET_MAP "\0tcng_classify";
+    Elf64_Ehdr ehdr;
+    Elf64_Shdr shdr[8];
+    Elf64_Sym sym[3];
+    Elf64_Rel *rel;
+    struct bpf_elf_map map;
+    char shstrtab[128];
+    int prog,maps = 0,rel_sec = 0,symtab,strtab_sec,shstrtab_sec;
+    int syms = 1,map_sym = 0,shstrtab_len = 1;
+    int i;
+
+    memset(&map,0,sizeof(map));
+    memset(sym,0,sizeof(sym));
+    n_sections = 0;
+    (void) add_section(NULL,SHT_NULL,0,NULL,0,0);
+    prog = add_section(BPF_PROG_SEC,SHT_PROGBITS,SHF_ALLOC | SHF_EXECINSTR,
+      insns,n_insns*sizeof(struct bpf_insn),0);
+    if (n_buckets) {
+	map.type = BPF_MAP_TYPE_ARRAY;
+	map.size_key = sizeof(uint32_t);
+	map.size_value = BPF_BUCKET_SIZE;
+	map.max_elem = n_buckets;
+	maps = add_section(BPF_MAPS_SEC,SHT_PROGBITS,SHF_ALLOC | SHF_WRITE,
+	  &map,sizeof(map),0);
+	map_sym = syms++;
+	sym[map_sym].st_name = 1;
+	sym[map_sym].st_info = ELF64_ST_INFO(STB_GLOBAL,STT_OBJECT);
+	sym[map_sym].st_shndx = maps;
+	sym[map_sym].st_size = sizeof(map);
+    }
+    sym[syms].st_name = sizeof(BPF_BUCKET_MAP)+1;
+    sym[syms].st_info = ELF64_ST_INFO(STB_GLOBAL,STT_FUNC);
+    sym[syms].st_shndx = prog;
+    sym[syms].st_size = n_insns*sizeof(struct bpf_insn);
+    syms++;
+    (void) add_section(BPF_LICENSE_SEC,SHT_PROGBITS,SHF_ALLOC | SHF_WRITE,
+      BPF_LICENSE,sizeof(BPF_LICENSE),0);
+    rel = alloc(sizeof(Elf64_Rel)*(n_map_refs+1));
+    if (n_map_refs) {
+	for (i = 0; i < n_map_refs; i++) {
+	    rel[i].r_offset = map_refs[i]*sizeof(struct bpf_insn);
+	    rel[i].r_info = ELF64_R_INFO(map_sym,R_BPF_64_64);
+	}
+	rel_sec = add_section(".rel" BPF_PROG_SEC,SHT_REL,0,rel,
+	  n_map_refs*sizeof(Elf64_Rel),sizeof(Elf64_Rel));
+	sections[rel_sec].info = prog;
+    }
+    symtab = add_section(".symtab",SHT_SYMTAB,0,sym,syms*sizeof(Elf64_Sym),
+      sizeof(Elf64_Sym));
+    sections[symtab].info = 1; /* first global symbol */
+    strtab_sec = add_section(".strtab",SHT_STRTAB,0,strtab,sizeof(strtab),0);
+    sections[symtab].link = strtab_sec;
+    if (rel_sec) sections[rel_sec].link = symtab;
+    shstrtab_sec = add_section(".shstrtab",SHT_STRTAB,0,shstrtab,0,0);
+
+    memset(shdr,0,sizeof(shdr));
+    shstrtab[0] = 0;
+    for (i = 1; i < n_sections; i++) {
+	shdr[i].sh_name = shstrtab_len;
+	strcpy(shstrtab+shstrtab_len,sections[i].name);
+	shstrtab_len += strlen(sections[i].name)+1;
+    }
+    sections[shstrtab_sec].size = shstrtab_len;
+
+    memset(&ehdr,0,sizeof(ehdr));
+    fwrite(&ehdr,1,sizeof(ehdr),file); /* placeholder */
+    for (i = 1; i < n_sections; i++) {
+	pad(file);
+	shdr[i].sh_type = sections[i].type;
+	shdr[i].sh_flags = sections[i].flags;
+	shdr[i].sh_offset = ftell(file);
+	shdr[i].sh_size = sections[i].size;
+	shdr[i].sh_link = sections[i].link;
+	shdr[i].sh_info = sections[i].info;
+	shdr[i].sh_addralign = sections[i].type == SHT_STRTAB ? 1 : 8;
+	shdr[i].sh_entsize = sections[i].entsize;
+	fwrite(sections[i].data,1,sections[i].size,file);
+    }
+    free(rel);
+    pad(file);
+
+    memcpy(ehdr.e_ident,ELFMAG,SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+#else
+    ehdr.e_ident[EI_DATA] = ELFDATA2MSB;
+#endif
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_type = ET_REL;
+    ehdr.e_machine = EM_BPF;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_shoff = ftell(file);
+    ehdr.e_ehsize = sizeof(ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = n_sections;
+    ehdr.e_shstrndx = shstrtab_sec;
+    fwrite(shdr,sizeof(Elf64_Shdr),n_sections,file);
+    rewind(file);
+    fwrite(&ehdr,1,sizeof(ehdr),file);
+}
+
+
+/* ------------------------------------------------------------------------- */
+
+
+static void reset(void)
+{
+    free(insns);
+    free(jump_label);
+    free(map_refs);
+    free(label_pos);
+    free(label_refs);
+    free(buckets);
+    free(bucket_index);
+    insns = NULL;
+    jump_label = map_refs = label_pos = label_refs = bucket_index = NULL;
+    buckets = NULL;
+    n_insns = n_map_refs = labels = n_buckets = bucket_numbers = 0;
+}
+
+
+void dump_if_bpf(const FILTER *_filter)
+{
+    DATA d = _filter->parent.qdisc->if_expr;
+    char *file_name;
+    FILE *file;
+
+    filter = _filter;
+    if (prm_present(filter->params,&prm_pragma))
+	lwarn(filter->location,"\"pragma\" on \"if\" ignored by \"bpf\" target");
+    reset();
+    iflib_arith(&d);
+    iflib_reduce(&d);
+    iflib_normalize(&d);
+    collect_buckets(d);
+    dump_program(d);
+    file_name = alloc_sprintf("_b%s_%02x%02x.o",filter->parent.device->name,
+      (int) (filter->parent.qdisc->number & 0xff),
+      (int) (filter->number & 0xff));
+    file = fopen(file_name,"w");
+    if (!file) {
+	perror(file_name);
+	exit(1);
+    }
+    write_object(file);
+    if (ferror(file)) errorf("error writing to %s",file_name);
+    if (fclose(file) == EOF) {
+	perror(file_name);
+	exit(1);
+    }
+    __tc_filter_add(filter,ETH_P_ALL);
+    tc_more(" bpf object-file %s section " BPF_PROG_SEC " classid %x:0 "
+      "direct-action\n",file_name,(int) filter->parent.qdisc->number);
+    free(file_name);
+}
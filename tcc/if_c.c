@@ -11,6 +11,10 @@
  * file. It's up to the C compiler to figure out what to do. Since optimizing
  * arithmetic expressions is about the oldest issue in compiler design, most
  * compilers are really good at this.
+ *
+ * However, GCC can't re-arrange tests around our policing side-effects, so
+ * with -Octree, we simplify the expression with iflib and then generate a
+ * decision tree made of switch statements and jumps ourselves.
  */
 
 
@@ -37,10 +41,105 @@
 #include "tccmeta.h"
 
 
+/*
+ * Buckets, results, and token tables are looked up in hash tables, so that
+ * configurations with many thousands of policers or classes don't make us
+ * slow down quadratically.
+ */
+
+struct c_entry {
+    uint32_t key[3];
+    int index;
+    struct c_entry *next;	/* next entry in hash chain */
+};
+
+struct t2b_table {
+    uint32_t rate;
+    uint32_t total_depth;
+    int scale;
+};
+
+static struct c_entry *bucket_hash[IF_C_HASH];
+static struct c_entry *result_hash[IF_C_HASH];
+static struct c_entry *t2b_hash[IF_C_HASH];
+
 static int results = 0;
 static int buckets = 0;
-static uint32_t bucket[MAX_C_BUCKETS];
-static unsigned long class[MAX_C_RESULTS];
+static int t2b_tables = 0;
+static unsigned long *class = NULL;	/* class ID of each result */
+static struct t2b_table *t2b = NULL;
+
+
+static void *grow(void *array,int n,size_t size)
+{
+    if (n & (n-1)) return array; /* only grow at powers of two */
+    array = realloc(array,(n ? 2*n : 1)*size);
+    if (!array) {
+	perror("realloc");
+	exit(1);
+    }
+    return array;
+}
+
+
+static unsigned hash_key(uint32_t a,uint32_t b,uint32_t c)
+{
+    return ((a*31+b)*31+c) % IF_C_HASH;
+}
+
+
+static int find_entry(struct c_entry **hash,uint32_t a,uint32_t b,uint32_t c)
+{
+    const struct c_entry *e;
+
+    for (e = hash[hash_key(a,b,c)]; e; e = e->next)
+	if (e->key[0] == a && e->key[1] == b && e->key[2] == c)
+	    return e->index;
+    return -1;
+}
+
+
+static void add_entry(struct c_entry **hash,uint32_t a,uint32_t b,uint32_t c,
+  int index)
+{
+    struct c_entry *e;
+    unsigned h = hash_key(a,b,c);
+
+    e = alloc_t(struct c_entry);
+    e->key[0] = a;
+    e->key[1] = b;
+    e->key[2] = c;
+    e->index = index;
+    e->next = hash[h];
+    hash[h] = e;
+}
+
+
+static void reset_hash(struct c_entry **hash)
+{
+    int i;
+
+    for (i = 0; i < IF_C_HASH; i++)
+	while (hash[i]) {
+	    struct c_entry *next = hash[i]->next;
+
+	    free(hash[i]);
+	    hash[i] = next;
+	}
+}
+
+
+static void reset_tables(void)
+{
+    reset_hash(bucket_hash);
+    reset_hash(result_hash);
+    reset_hash(t2b_hash);
+    free(class);
+    free(t2b);
+    class = NULL;
+    t2b = NULL;
+    results = buckets = t2b_tables = 0;
+}
 
 
 /* ------------------------ Dump bucket definitions ------------------------ */
@@ -50,9 +149,9 @@ static int __lookup_bucket(uint32_t number)
 {
     int n;
 
-    for (n = 0; n < buckets; n++)
-	if (bucket[n] == number) return n;
-    abort();
+    n = find_entry(bucket_hash,number,0,0);
+    if (n == -1) abort();
+    return n;
 }
 
 
@@ -74,21 +173,44 @@ static uint32_t depth_sum(const POLICE *p)
 }
 
 
+/*
+ * The time to tokens translation only depends on the rate, the scale, and the
+ * total depth, so buckets with the same parameters share the same table.
+ */
+
+static int lookup_t2b(uint32_t rate,uint32_t total_depth,int scale)
+{
+    int n;
+
+    n = find_entry(t2b_hash,rate,total_depth,scale);
+    if (n != -1) return n;
+    t2b = grow(t2b,t2b_tables,sizeof(struct t2b_table));
+    t2b[t2b_tables].rate = rate;
+    t2b[t2b_tables].total_depth = total_depth;
+    t2b[t2b_tables].scale = scale;
+    add_entry(t2b_hash,rate,total_depth,scale,t2b_tables);
+    return t2b_tables++;
+}
+
+
 static void add_bucket(FILE *file,const POLICE *p)
 {
     int overflow = -1;
     uint32_t total_depth,max_time;
     int scale;
 
+    if (find_entry(bucket_hash,p->number,0,0) != -1) return;
     param_get(p->params,p->location);
+    if (prm_present(p->params,&prm_overflow)) {
+	const POLICE *next = prm_data(p->params,&prm_overflow).u.police;
+
+	add_bucket(file,next);
+	overflow = __lookup_bucket(next->number);
+	param_get(p->params,p->location);
+    }
     if (!prm_rate.present && prm_peakrate.present)
         error("if_c only supports single-rate token bucket policer");
-    if (buckets >= MAX_C_BUCKETS)
-	errorf("too many buckets in if_c (max %d)",MAX_C_BUCKETS);
-    bucket[buckets++] = p->number;
-    if (prm_present(p->params,&prm_overflow))
-	overflow = __lookup_bucket(prm_data(p->params,
-	  &prm_overflow).u.police->number);
+    add_entry(bucket_hash,p->number,0,0,buckets++);
     total_depth = depth_sum(p);
     max_time = total_depth/(double) prm_rate.v*1000000.0;
     if (debug)
@@ -96,22 +218,17 @@ static void add_bucket(FILE *file,const POLICE *p)
 	  (unsigned long) prm_burst.v,(unsigned long) total_depth,
 	  (unsigned long) max_time);
     for (scale = 0; (max_time >> scale) > 255; scale++);
-    fprintf(file,"  INIT_BUCKET(%lu,%lu,%lu,%lu,%d,%lu,%lu,%d), \\\n",
-      (unsigned long) prm_rate.v,
+    fprintf(file,"  INIT_BUCKET(%lu,%lu,%lu,%d,%lu,%d,%d), \\\n",
       prm_mpu.present ? (unsigned long) prm_mpu.v : 0,
       (unsigned long) prm_burst.v,(unsigned long) prm_burst.v,overflow,
-      (unsigned long) max_time,(unsigned long) total_depth,scale);
+      (unsigned long) max_time,
+      lookup_t2b(prm_rate.v,total_depth,scale),scale);
 }
 
 
 static void collect_buckets(FILE *file,DATA d)
 {
     if (!d.op && (d.type == dt_police || d.type == dt_bucket)) { /* @@@ */
-	const POLICE *p = d.u.police;
-
-	param_get(p->params,p->location);
-	if (prm_present(p->params,&prm_overflow))
-	    add_bucket(file,prm_data(p->params,&prm_overflow).u.police);
 	add_bucket(file,d.u.police);
 	return;
     }
@@ -126,8 +243,15 @@ static void collect_buckets(FILE *file,DATA d)
 
 static void dump_buckets(FILE *file,DATA d)
 {
+    int i;
+
     fprintf(file,"#define BUCKETS \\\n");
     collect_buckets(file,d);
+    fprintf(file,"\n#define T2B_TABLES \\\n");
+    for (i = 0; i < t2b_tables; i++)
+	fprintf(file,"  INIT_T2B(%lu,%d,%lu), \\\n",
+	  (unsigned long) t2b[i].rate,t2b[i].scale,
+	  (unsigned long) t2b[i].total_depth);
     fprintf(file,"\n");
 }
 
@@ -135,6 +259,45 @@ static void dump_buckets(FILE *file,DATA d)
 /* --------------------------- Dump C expression --------------------------- */
 
 
+/*
+ * All decisions selecting the same class share the same result.
+ */
+
+static int lookup_result(const CLASS *c)
+{
+    unsigned long classid = (c->parent.qdisc->number << 16) | c->number;
+    int n;
+
+    n = find_entry(result_hash,classid,0,0);
+    if (n != -1) return n;
+    class = grow(class,results,sizeof(unsigned long));
+    class[results] = classid;
+    add_entry(result_hash,classid,0,0,results);
+    return results++;
+}
+
+
+static void dump_c_result(FILE *file,DATA d)
+{
+    switch (d.u.decision.result) {
+	case dr_class:
+	case dr_reclassify:
+	    fprintf(file,"RESULT(%s,%d)",
+	      d.u.decision.result == dr_class ? "TC_POLICE_OK" :
+	      "TC_POLICE_RECLASSIFY",lookup_result(d.u.decision.class));
+	    break;
+	case dr_drop:
+	    fprintf(file,"RESULT(TC_POLICE_SHOT,0)");
+	    break;
+	case dr_continue:
+	    fprintf(file,"RESULT(TC_POLICE_UNSPEC,0)");
+	    break;
+	default:
+	    dump_failed(d,"unsupported decision");
+    }
+}
+
+
 static void dump_c_data(FILE *file,DATA d)
 {
     switch (d.type) {
@@ -143,28 +306,9 @@ static void dump_c_data(FILE *file,DATA d)
 	    fprintf(file,"0x%lx",(unsigned long) d.u.unum);
 	    break;
 	case dt_decision:
-	    switch (d.u.decision.result) {
-		case dr_class:
-		case dr_reclassify:
-    		    if (results >= MAX_C_RESULTS)
-			errorf("too many results in if_c (max %d)",
-			  MAX_C_RESULTS);
-		    class[results] = (d.u.decision.class->parent.qdisc->number
-		       << 16) | d.u.decision.class->number;
-		    fprintf(file,"({ RESULT(%s,%d); 0; })",
-		      d.u.decision.result == dr_class ? "TC_POLICE_OK" :
-		      "TC_POLICE_RECLASSIFY",results);
-		    results++;
-		    break;
-		case dr_drop:
-		    fprintf(file,"({ RESULT(TC_POLICE_SHOT,0); 0; })");
-		    break;
-		case dr_continue:
-		    fprintf(file,"({ RESULT(TC_POLICE_UNSPEC,0); 0; })");
-		    break;
-		default:
-		    dump_failed(d,"unsupported decision");
-	    }
+	    fprintf(file,"({ ");
+	    dump_c_result(file,d);
+	    fprintf(file,"; 0; })");
 	    break;
 	default:
 	    dump_failed(d,"bad type");
@@ -175,34 +319,129 @@ static void dump_c_data(FILE *file,DATA d)
 static void dump_c_expr(FILE *file,DATA d);
 
 
+static int is_logical(const OP *op)
+{
+    return op->dsc == &op_logical_not || op->dsc == &op_logical_or ||
+      op->dsc == &op_logical_and;
+}
+
+
+/*
+ * Conditions the generated code branches on are marked with BRANCH, so that
+ * the benchmark can count them. Constants, results, and "count" don't
+ * branch.
+ */
+
+static void dump_c_cond(FILE *file,DATA d)
+{
+    if (!d.op || is_logical(d.op) || d.op->dsc == &op_count) {
+	dump_c_expr(file,d);
+	return;
+    }
+    fprintf(file,"BRANCH(");
+    dump_c_expr(file,d);
+    fputc(')',file);
+}
+
+
 static void dump_math_op(FILE *file,const OP *op)
 {
+    void (*dump)(FILE *file,DATA d) =
+      is_logical(op) ? dump_c_cond : dump_c_expr;
+
     if (op->b.type == dt_none) {
 	fprintf(file," %s",op->dsc->name);
-	dump_c_expr(file,op->a);
+	dump(file,op->a);
     }
     else {
 	fputc('(',file);
-	dump_c_expr(file,op->a);
+	dump(file,op->a);
 	fprintf(file," %s ",op->dsc->name);
-	dump_c_expr(file,op->b);
+	dump(file,op->b);
 	fputc(')',file);
 	
     }
 }
 
 
+/*
+ * There are no 128 bit integers in C, so we compare IPv6 addresses in two 64
+ * bit halves. A half that is completely masked out is omitted, and a half
+ * that isn't masked at all doesn't need an "&".
+ */
+
+static void dump_c_half(FILE *file,DATA offset,int half,uint32_t mask_hi,
+  uint32_t mask_lo,uint32_t value_hi,uint32_t value_lo)
+{
+    if ((value_hi & ~mask_hi) || (value_lo & ~mask_lo)) {
+	fprintf(file,"0");
+	return;
+    }
+    if (mask_hi == 0xffffffff && mask_lo == 0xffffffff)
+	fprintf(file,"(ACCESS64(");
+    else fprintf(file,"((ACCESS64(");
+    dump_c_expr(file,offset);
+    if (half) fprintf(file," + 8");
+    if (mask_hi == 0xffffffff && mask_lo == 0xffffffff) fprintf(file,")");
+    else fprintf(file,") & 0x%08lx%08lxULL)",(unsigned long) mask_hi,
+	  (unsigned long) mask_lo);
+    fprintf(file," == 0x%08lx%08lxULL)",(unsigned long) value_hi,
+      (unsigned long) value_lo);
+}
+
+
+static void dump_c_eq128(FILE *file,DATA d)
+{
+    DATA a = d.op->a,b = d.op->b;
+    U128 mask = u128_not(u128_from_32(0)),value;
+    int half,first = 1;
+
+    if (!a.op) {
+	a = b;
+	b = d.op->a;
+    }
+    if (b.op) dump_failed(d,"128 bit comparison needs a constant");
+    value = data_convert(b,dt_ipv6).u.u128;
+    if (a.op && a.op->dsc == &op_and) {
+	if (a.op->b.op) dump_failed(d,"must be \"& constant\"");
+	mask = data_convert(a.op->b,dt_ipv6).u.u128;
+	a = a.op->a;
+    }
+    if (!a.op || a.op->dsc != &op_access || a.op->c.u.unum != 128)
+	dump_failed(d,"128 bit access expected");
+    if (a.op->a.op || a.op->a.type != dt_field_root ||
+      a.op->a.u.field_root->offset_group)
+	error("\"c\" only supports 128 bit access at field root 0");
+    fprintf(file,d.op->dsc == &op_eq ? "(" : "!(");
+    for (half = 0; half < 2; half++) {
+	uint32_t mask_hi = mask.v[3-2*half],mask_lo = mask.v[2-2*half];
+
+	if (!mask_hi && !mask_lo &&
+	  !value.v[3-2*half] && !value.v[2-2*half])
+	    continue;
+	if (!first) fprintf(file," && ");
+	first = 0;
+	dump_c_half(file,a.op->b,half,mask_hi,mask_lo,value.v[3-2*half],
+	  value.v[2-2*half]);
+    }
+    fprintf(file,first ? "1)" : ")");
+}
+
+
 static void dump_c_op(FILE *file,DATA d)
 {
+    if ((d.op->dsc == &op_eq || d.op->dsc == &op_ne) &&
+      (d.op->a.type == dt_ipv6 || d.op->b.type == dt_ipv6)) {
+	dump_c_eq128(file,d);
+	return;
+    }
     if (d.op->dsc == &op_plus || d.op->dsc == &op_minus || 
       d.op->dsc == &op_mult || d.op->dsc == &op_div || d.op->dsc == &op_mod ||
       d.op->dsc == &op_not || d.op->dsc == &op_and || d.op->dsc == &op_or ||
       d.op->dsc == &op_xor || d.op->dsc == &op_shift_left ||
       d.op->dsc == &op_shift_right || d.op->dsc == &op_eq ||
       d.op->dsc == &op_ne || d.op->dsc == &op_gt || d.op->dsc == &op_le ||
-      d.op->dsc == &op_ge || d.op->dsc == &op_lt ||
-      d.op->dsc == &op_logical_not || d.op->dsc == &op_logical_or ||
-      d.op->dsc == &op_logical_and) {
+      d.op->dsc == &op_ge || d.op->dsc == &op_lt || is_logical(d.op)) {
 	dump_math_op(file,d.op);
 	return;
     }
@@ -247,6 +486,326 @@ static void dump_c_expr(FILE *file,DATA d)
 }
 
 
+/* -------------------------- Dump decision tree --------------------------- */
+
+
+/*
+ * With -Octree, the expression is turned into a sequence of statements, with
+ * && and || expressed as jumps. Consecutive alternatives comparing the same
+ * field with constants become a switch statement. This way, the field is
+ * loaded only once, and GCC can use a jump table for dense sets of values.
+ *
+ * All jumps go forward, so we already know whether a label is used when we
+ * reach it.
+ */
+
+
+static int labels = 0;
+static int *label_refs = NULL;	/* number of jumps to each label */
+static int pending_goto;	/* jump not yet written, -1 if none */
+static int indent;
+
+
+static void begin_line(FILE *file);
+
+
+static void flush_goto(FILE *file)
+{
+    int label = pending_goto;
+
+    if (label == -1) return;
+    pending_goto = -1;
+    begin_line(file);
+    fprintf(file,"goto L%d; \\\n",label);
+}
+
+
+static void begin_line(FILE *file)
+{
+    flush_goto(file);
+    fprintf(file,"%*s",indent*2,"");
+}
+
+
+static int new_label(void)
+{
+    if (!(labels & 63)) {
+	label_refs = realloc(label_refs,(labels+64)*sizeof(int));
+	if (!label_refs) {
+	    perror("realloc");
+	    exit(1);
+	}
+    }
+    label_refs[labels] = 0;
+    return labels++;
+}
+
+
+static void tree_goto(FILE *file,int label)
+{
+    flush_goto(file);
+    label_refs[label]++;
+    pending_goto = label;
+}
+
+
+static void tree_label(FILE *file,int label)
+{
+    if (pending_goto == label) {
+	label_refs[label]--;
+	pending_goto = -1;
+    }
+    if (!label_refs[label]) return;
+    begin_line(file);
+    fprintf(file,"L%d: ; \\\n",label);
+}
+
+
+static void dump_tree(FILE *file,DATA d,int on_true,int on_false);
+
+
+static void dump_tree_leaf(FILE *file,DATA d,int on_true,int on_false)
+{
+    if (!d.op && d.type == dt_decision) {
+	begin_line(file);
+	dump_c_result(file,d);
+	fprintf(file,"; \\\n");
+	return;
+    }
+    if (!d.op && d.type == dt_unum) {
+	tree_goto(file,d.u.unum ? on_true : on_false);
+	return;
+    }
+    if (d.op && d.op->dsc == &op_count) {
+	begin_line(file);
+	fprintf(file,"police_count(skb,%d); \\\n",lookup_bucket(d.op->a));
+	tree_goto(file,on_true);
+	return;
+    }
+    begin_line(file);
+    fprintf(file,"if (!BRANCH(");
+    dump_c_expr(file,d);
+    fprintf(file,")) goto L%d; \\\n",on_false);
+    label_refs[on_false]++;
+    tree_goto(file,on_true);
+}
+
+
+/*
+ * Returns non-zero if "alt" has the form  field == value  or
+ * field == value && rest
+ */
+
+static int switch_test(DATA alt,DATA *field,uint32_t *value,DATA *rest)
+{
+    DATA eq = alt,a,b;
+
+    *rest = data_unum(1);
+    if (eq.op && eq.op->dsc == &op_logical_and) {
+	*rest = eq.op->b;
+	eq = eq.op->a;
+    }
+    if (!eq.op || eq.op->dsc != &op_eq) return 0;
+    a = eq.op->a;
+    b = eq.op->b;
+    if (!a.op) {
+	a = b;
+	b = eq.op->a;
+    }
+    if (!a.op || b.op || (b.type != dt_unum && b.type != dt_ipv4)) return 0;
+    if (side_effect(a)) return 0;
+    *field = a;
+    *value = b.u.unum;
+    return 1;
+}
+
+
+struct switch_case {
+    uint32_t value;
+    int index;			/* position in the list of alternatives */
+    DATA rest;
+};
+
+
+static int comp_case(const void *_a,const void *_b)
+{
+    const struct switch_case *a = _a;
+    const struct switch_case *b = _b;
+
+    if (a->value != b->value) return a->value < b->value ? -1 : 1;
+    return a->index-b->index;
+}
+
+
+static int count_alts(DATA d)
+{
+    if (!d.op || d.op->dsc != &op_logical_or) return 1;
+    return count_alts(d.op->a)+count_alts(d.op->b);
+}
+
+
+static DATA *collect_alts(DATA d,DATA *alts)
+{
+    if (!d.op || d.op->dsc != &op_logical_or) {
+	*alts = d;
+	return alts+1;
+    }
+    return collect_alts(d.op->b,collect_alts(d.op->a,alts));
+}
+
+
+static void dump_alts(FILE *file,const DATA *alts,int n,int on_true,
+  int on_false);
+
+
+/*
+ * Alternatives testing the same value continue with the remaining tests of
+ * each of them, in their original order. Common tests in these remaining
+ * tests thus end up in a nested switch, or in a single "if".
+ */
+
+static void dump_case(FILE *file,const struct switch_case *cases,int n,
+  int on_true,int on_false)
+{
+    DATA *alts,*end;
+    int i,size = 0;
+
+    for (i = 0; i < n; i++)
+	size += count_alts(cases[i].rest);
+    alts = end = alloc(sizeof(DATA)*size);
+    for (i = 0; i < n; i++)
+	end = collect_alts(cases[i].rest,end);
+    dump_alts(file,alts,size,on_true,on_false);
+    free(alts);
+}
+
+
+static void dump_switch(FILE *file,const DATA *alts,int n,int on_true,
+  int on_false)
+{
+    struct switch_case *cases;
+    DATA field;
+    int i,j;
+
+    cases = alloc(sizeof(struct switch_case)*n);
+    for (i = 0; i < n; i++) {
+	(void) switch_test(alts[i],&field,&cases[i].value,&cases[i].rest);
+	cases[i].index = i;
+    }
+    qsort(cases,n,sizeof(struct switch_case),comp_case);
+    if (cases[0].value == cases[n-1].value) {
+	begin_line(file);
+	fprintf(file,"if (BRANCH(");
+	dump_c_expr(file,field);
+	fprintf(file," != 0x%lx)) goto L%d; \\\n",
+	  (unsigned long) cases[0].value,on_false);
+	label_refs[on_false]++;
+	dump_case(file,cases,n,on_true,on_false);
+	free(cases);
+	return;
+    }
+    begin_line(file);
+    fprintf(file,"switch (BRANCH(");
+    dump_c_expr(file,field);
+    fprintf(file,")) { \\\n");
+    for (i = 0; i < n; i = j) {
+	for (j = i+1; j < n && cases[j].value == cases[i].value; j++);
+	begin_line(file);
+	fprintf(file,"case 0x%lx: \\\n",(unsigned long) cases[i].value);
+	indent++;
+	dump_case(file,cases+i,j-i,on_true,on_false);
+	flush_goto(file);
+	indent--;
+    }
+    begin_line(file);
+    fprintf(file,"default: \\\n");
+    indent++;
+    tree_goto(file,on_false);
+    flush_goto(file);
+    indent--;
+    begin_line(file);
+    fprintf(file,"} \\\n");
+    free(cases);
+}
+
+
+static void dump_alts(FILE *file,const DATA *alts,int n,int on_true,
+  int on_false)
+{
+    int i,j;
+
+    for (i = 0; i < n; i = j) {
+	DATA field,other,rest;
+	uint32_t value;
+	int next;
+
+	if (!alts[i].op && alts[i].type == dt_unum && alts[i].u.unum) {
+	    tree_goto(file,on_true);
+	    return;
+	}
+	j = i+1;
+	if (switch_test(alts[i],&field,&value,&rest))
+	    while (j < n && switch_test(alts[j],&other,&value,&rest) &&
+	      expr_equal(field,other))
+		j++;
+	next = j == n ? on_false : new_label();
+	if (j-i < 2) dump_tree(file,alts[i],on_true,next);
+	else dump_switch(file,alts+i,j-i,on_true,next);
+	if (j != n) tree_label(file,next);
+    }
+}
+
+
+static void dump_tree_or(FILE *file,DATA d,int on_true,int on_false)
+{
+    DATA *alts;
+    int n;
+
+    n = count_alts(d);
+    alts = alloc(sizeof(DATA)*n);
+    (void) collect_alts(d,alts);
+    dump_alts(file,alts,n,on_true,on_false);
+    free(alts);
+}
+
+
+static void dump_tree(FILE *file,DATA d,int on_true,int on_false)
+{
+    if (d.op && d.op->dsc == &op_logical_or) {
+	dump_tree_or(file,d,on_true,on_false);
+	return;
+    }
+    if (d.op && d.op->dsc == &op_logical_and) {
+	int next = new_label();
+
+	dump_tree(file,d.op->a,next,on_false);
+	tree_label(file,next);
+	dump_tree(file,d.op->b,on_true,on_false);
+	return;
+    }
+    if (d.op && d.op->dsc == &op_logical_not) {
+	dump_tree(file,d.op->a,on_false,on_true);
+	return;
+    }
+    dump_tree_leaf(file,d,on_true,on_false);
+}
+
+
+static void dump_decision_tree(FILE *file,DATA d)
+{
+    int done;
+
+    labels = 0;
+    pending_goto = -1;
+    indent = 1;
+    fprintf(file,"#define DECISION_TREE \\\n");
+    done = new_label();
+    dump_tree(file,d,done,done);
+    tree_label(file,done);
+    fprintf(file,"\n");
+}
+
+
 /* ------------------------------------------------------------------------- */
 
 
@@ -277,6 +836,7 @@ void dump_if_c(const FILTER *filter)
 
     if (prm_present(filter->params,&prm_pragma))
 	lwarn(filter->location,"\"pragma\" on \"if\" ignored by \"C\" target");
+    reset_tables();
     name = alloc_sprintf("_c%02x%02x%01x%01x",
       (int) (filter->parent.qdisc->number & 0xff),
       (int) (filter->number & 0xff),(int) (getpid() & 0xf),
@@ -288,10 +848,24 @@ void dump_if_c(const FILTER *filter)
 	exit(1);
     }
     fprintf(file,"#define NAME %s\n\n",name);
-    dump_buckets(file,d);
-    fprintf(file,"#define EXPRESSION \\\n");
-    dump_c_expr(file,d);
-    fprintf(file,"\n\n#define ELEMENTS %d\n#define ELEMENT(f) \\\n",results);
+    if (registry_probe(&optimization_switches,"ctree")) {
+	/*
+	 * No iflib_actions: we keep policing where it is, and let the tree
+	 * follow the original order of side-effects.
+	 */
+	iflib_arith(&d);
+	iflib_reduce(&d);
+	iflib_normalize(&d);
+	dump_buckets(file,d);
+	dump_decision_tree(file,d);
+    }
+    else {
+	dump_buckets(file,d);
+	fprintf(file,"#define EXPRESSION \\\n");
+	dump_c_expr(file,d);
+	fprintf(file,"\n");
+    }
+    fprintf(file,"\n#define ELEMENTS %d\n#define ELEMENT(f) \\\n",results);
     for (i = 0; i < results; i++)
 	fprintf(file,"  f(%d,0x%lx)%s\n",i,class[i],
 	  i == results-1 ? "" : " \\");
@@ -306,7 +880,7 @@ void dump_if_c(const FILTER *filter)
     fflush(stdout);
     fflush(stderr);
     if (system(cmd)) errorf("system(%s) failed",cmd);
-    printf("insmod cls_%s.o\n",name);
+    tc_insmod("cls",name);
     __tc_filter_add(filter,ETH_P_ALL);
     tc_more(" %s\n",name);
     free(name);
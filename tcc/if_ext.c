@@ -38,6 +38,7 @@
 #include "iflib.h"
 #include "if.h"
 #include "ext.h"
+#include "ext/tccextbin.h"
 
 
 int generate_default_class; /* if_ext generates default classes */
@@ -217,9 +218,17 @@ static void dump_offsets(FILE *file)
     struct offset_group *group;
 
     for (group = offset_groups; group; group = group->next)
-	fprintf(file,"offset %d = %d+(%d:%d:%d << %d)\n",group->number,
-	  group->base,group->value_base,group->offset,group->length,
-	  group->shift);
+	if (ext_binary) {
+	    ext_bin_begin(file,teb_offset);
+	    ext_bin_u32(group->number);
+	    ext_bin_u32(group->base);
+	    ext_bin_field(group->value_base,group->offset,group->length);
+	    ext_bin_u32(group->shift);
+	    ext_bin_end();
+	}
+	else fprintf(file,"offset %d = %d+(%d:%d:%d << %d)\n",group->number,
+	      group->base,group->value_base,group->offset,group->length,
+	      group->shift);
 }
 
 
@@ -316,6 +325,27 @@ static void collect_bits(FILE *file)
 }
 
 
+static void collect_bits_bin(void)
+{
+    struct bit_match *walk,*end;
+
+    for (walk = bits; walk; walk = end) {
+	struct bit_match *scan;
+	int length = 1;
+	int next_offset = walk->offset;
+	int value,i;
+
+	for (end = walk->next; end && walk->offset_group == end->offset_group
+	  && end->offset == ++next_offset; end = end->next)
+	    length++;
+	ext_bin_field(walk->offset_group,walk->offset,length);
+	value = ext_bin_value(length);
+	for (scan = walk, i = 0; scan != end; scan = scan->next, i++)
+	    if (scan->value) ext_bin_value_bit(value,length,i);
+    }
+}
+
+
 static void drop_bits(void)
 {
     struct bit_match *next;
@@ -448,14 +478,33 @@ static int dump_match(DATA d,int offset_group)
 
 static void dump_action(FILE *file,const DATA *d)
 {
-    fprintf(file,"match");
     sort_bits();
+    if (ext_binary) {
+	ext_bin_begin(file,teb_match);
+	ext_bin_u32(action_number(*d));
+	collect_bits_bin();
+	ext_bin_end();
+	drop_bits();
+	return;
+    }
+    fprintf(file,"match");
     collect_bits(file);
     drop_bits();
     fprintf(file," action %d\n",action_number(*d));
 }
 
 
+static void dump_barrier(FILE *file)
+{
+    if (!ext_binary) {
+	fprintf(file,"barrier\n");
+	return;
+    }
+    ext_bin_begin(file,teb_barrier);
+    ext_bin_end();
+}
+
+
 static int dump_or(FILE *file,const DATA *d,int offset_group);
 
 
@@ -518,6 +567,13 @@ void dump_pragma(FILE *file)
     const DATA_LIST *walk;
 
     if (!pragma) return;
+    if (ext_binary) {
+	ext_bin_begin(file,teb_pragma);
+	for (walk = pragma; walk; walk = walk->next)
+	    ext_bin_string(walk->ref->u.string);
+	ext_bin_end();
+	return;
+    }
     fprintf(file,"pragma");
     for (walk = pragma; walk; walk = walk->next)
 	fprintf(file," %s",walk->ref->u.string);
@@ -532,6 +588,21 @@ void dump_block(FILE *file,const QDISC *q)
 {
     const DEVICE *dev = q->parent.device;
 
+    if (ext_binary) {
+	ext_bin_begin(file,teb_block);
+	ext_bin_u32(dev->ingress == q ? TCCEXT_BIN_INGRESS :
+	  TCCEXT_BIN_EGRESS);
+	ext_bin_string(dev->name);
+	if (prm_present(dev->params,&prm_pragma)) {
+	    const DATA_LIST *pragma;
+
+	    for (pragma = prm_data(dev->params,&prm_pragma).u.list;
+	      pragma; pragma = pragma->next)
+		ext_bin_string(pragma->ref->u.string);
+	}
+	ext_bin_end();
+	return;
+    }
     fprintf(file,"block %s %s",dev->name,dev->ingress == q ? "ingress" :
       "egress");
     if (prm_present(dev->params,&prm_pragma)) {
@@ -599,19 +670,30 @@ static void dump_buckets(FILE *file)
 	if (prm_present(bucket->p->params,&prm_overflow))
 	    overflow =
 	      prm_data(bucket->p->params,&prm_overflow).u.police->number;
-	fprintf(file,"bucket %d = %lu %lu %lu %lu %d",
-	  (int) bucket->p->number,(unsigned long) prm_rate.v,
-	  prm_mpu.present ? (unsigned long) prm_mpu.v : 0,
-	  (unsigned long) prm_burst.v,(unsigned long) prm_burst.v,
-	  overflow);
+	if (ext_binary) {
+	    ext_bin_begin(file,teb_bucket);
+	    ext_bin_u32(bucket->p->number);
+	    ext_bin_u32(prm_rate.v);
+	    ext_bin_u32(prm_mpu.present ? prm_mpu.v : 0);
+	    ext_bin_u32(prm_burst.v);
+	    ext_bin_u32(prm_burst.v);
+	    ext_bin_u32(overflow);
+	}
+	else fprintf(file,"bucket %d = %lu %lu %lu %lu %d",
+	      (int) bucket->p->number,(unsigned long) prm_rate.v,
+	      prm_mpu.present ? (unsigned long) prm_mpu.v : 0,
+	      (unsigned long) prm_burst.v,(unsigned long) prm_burst.v,
+	      overflow);
 	if (prm_present(bucket->p->params,&prm_pragma)) {
 	    const DATA_LIST *pragma;
 
 	    for (pragma = prm_data(bucket->p->params,&prm_pragma).u.list;
 	      pragma; pragma = pragma->next)
-		fprintf(file," %s",pragma->ref->u.string);
+		if (ext_binary) ext_bin_string(pragma->ref->u.string);
+		else fprintf(file," %s",pragma->ref->u.string);
 	}
-	fputc('\n',file);
+	if (ext_binary) ext_bin_end();
+	else fputc('\n',file);
     }
     while (buckets) {
 	struct bucket *next;
@@ -638,6 +720,9 @@ static void dump_if_ext_expr(const FILTER *filter,DATA *d)
 	iflib_reduce(d);
 	iflib_normalize(d);
 	iflib_actions(filter->location,d);
+	iflib_shadow(d);
+	expr_release(); /* iflib_actions leaves *d unshared */
+	iflib_profile(filter,d);
     }
     iflib_offset(d,0); /* don't combine */
     debug_expr("BEFORE dumping",*d);
@@ -723,7 +808,7 @@ static void dump_if_ext_dump_rules_callback(const ELEMENT *e,void *user)
 {
     FILE *file = user;
 
-    if (need_barrier) fprintf(file,"barrier\n");
+    if (need_barrier) dump_barrier(file);
     dump_rules(file,prm_data_ptr(e->params,&prm_if_expr));
     need_barrier = 1;
 }
@@ -733,6 +818,7 @@ void dump_if_ext_local(const FILTER *filter,FILE *file)
 {
     QDISC *qdisc = filter->parent.qdisc;
     DATA d = qdisc->if_expr;
+    FILE *text;
 
     if (!use_bit_tree) {
 	if (!no_combine) {
@@ -747,7 +833,7 @@ void dump_if_ext_local(const FILTER *filter,FILE *file)
 	    need_barrier = 0;
 	    iflib_comb_iterate(qdisc,dump_if_ext_dump_rules_callback,file);
 	    if (generate_default_class) {
-		if (need_barrier) fprintf(file,"barrier\n");
+		if (need_barrier) dump_barrier(file);
 		dump_rules(file,&d);
 	    }
 	}
@@ -756,13 +842,19 @@ void dump_if_ext_local(const FILTER *filter,FILE *file)
     }
     switch (alg_mode) {
 	case 0:
-	    iflib_bit(file,filter->parent.qdisc,d);
+	    text = ext_bin_text_begin(file);
+	    iflib_bit(text,filter->parent.qdisc,d);
+	    ext_bin_text_end(file,text);
 	    break;
 	case 1:
-	    iflib_newbit(file,d);
+	    iflib_newbit(file,filter->parent.qdisc,d);
 	    break;
 	case 2:
-	    iflib_fastbit(file,d);
+	    /*
+	     * -N -N used to select iflib_fastbit, which never generated a bit
+	     * tree and only printed its intermediate DAGs for debugging.
+	     */
+	    error("-N -N is no longer supported");
 	    break;
 	default:
 	    errorf("unknown bit tree algorithm mode %d",alg_mode);
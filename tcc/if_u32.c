@@ -10,6 +10,8 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <netinet/in.h>
 #include <netinet/if_ether.h>
@@ -141,6 +143,8 @@ static uint32_t handle;
 
 static uint32_t new_handle(void)
 {
+    if (TC_U32_USERHTID(handle) == MAX_U32_TABLES)
+	errorf("too many u32 hash tables (max %d)",MAX_U32_TABLES);
     handle += 0x100000;
     return handle;
 }
@@ -149,7 +153,7 @@ static uint32_t new_handle(void)
 static void dump_handle(const char *tag,uint32_t handle)
 {
     tc_more(" %s %x:%x:%x",tag,TC_U32_USERHTID(handle),TC_U32_HASH(handle),
-      TC_U32_KEY(handle));
+      TC_U32_NODE(handle));
 }
 
 
@@ -174,7 +178,7 @@ static void sync_meta(void)
 }
 
 
-static void cached_hash(const FILTER *filter)
+static void cached_hash(const FILTER *filter,int divisor)
 {
     if (is_meta == 1)
 	lerror(filter->location,"invalid combination of meta and non-meta "
@@ -184,7 +188,7 @@ static void cached_hash(const FILTER *filter)
     cached = 0;
     __tc_filter_add2(filter,cached_protocol,prio_offset);
     dump_handle("handle",cached_handle);
-    tc_more(" u32 divisor 1");
+    tc_more(" u32 divisor %d",divisor);
     tc_nl();
 }
 
@@ -305,7 +309,7 @@ static void dump_rule(const FILTER *filter,const RULE *rule,uint32_t my_handle)
     else {
 	dump_handle("handle",my_handle);
 	tc_more(" u32");
-	dump_handle("ht",TC_U32_HTID(my_handle));
+	dump_handle("ht",my_handle & ~TC_U32_NODE(~0U));
     }
     for (match = rule->matches; match; match = match->next)
 	tc_more(" match u%d 0x%lx 0x%lx at %d",match->bits,match->value,
@@ -501,7 +505,7 @@ static void dump_offset(const FILTER *filter,DATA d,int at_end,int field_root)
 {
     DATA off;
 
-    cached_hash(filter);
+    cached_hash(filter,1);
     dump_match(filter);
     off = d.op->b;
     if (!off.op) {
@@ -1109,7 +1113,7 @@ static int dump_other(const FILTER *filter,DATA d,uint32_t curr_handle,
     }
     else {
 	 if (d.op->dsc == &op_logical_or) {
-	    cached_hash(filter);
+	    cached_hash(filter,1);
 	    dump_match(filter);
 	    dump_link(filter,d,at_end,field_root);
 	    return 0;
@@ -1121,7 +1125,7 @@ static int dump_other(const FILTER *filter,DATA d,uint32_t curr_handle,
 #if 0
 	    /* field roots just got simpler :-) */
 	    dump_failed(d,"unexpected field root");
-	    cached_hash(filter);
+	    cached_hash(filter,1);
 	    dump_match(filter);
 	    dump_link(filter,d.op->a,at_end,offset);
 	    return 0;
@@ -1192,12 +1196,444 @@ static int dump_and(const FILTER *filter,DATA d,uint32_t curr_handle,
 }
 
 
+/* ----- Hash tables ------------------------------------------------------- */
+
+
+/*
+ * A run of alternatives that all compare the same packet byte with a constant
+ * (under a common mask) can be moved into a hash table with 256 buckets, keyed
+ * by that byte. A packet can only match the alternatives in the bucket selected
+ * by its own byte value, and since we keep the original order within each
+ * bucket, first-match semantics are preserved.
+ */
+
+struct hash_alt {
+    DATA d;				/* left-hand side of || */
+    uint8_t value[U32_HASH_BYTES];	/* value of byte at offset */
+    uint8_t mask[U32_HASH_BYTES];	/* bits of byte tested; 0 if none */
+};
+
+
+static int hash_eq(DATA d,struct hash_alt *alt)
+{
+    DATA constant,var;
+    U128 value,mask;
+    int default_mask = 1;
+    int offset,bytes,i;
+
+    if (!d.op || d.op->dsc != &op_eq) return 0;
+    if ((d.op->a.type == dt_unum || d.op->a.type == dt_ipv6) && !d.op->a.op) {
+	constant = d.op->a;
+	var = d.op->b;
+    }
+    else {
+	if ((d.op->b.type != dt_unum && d.op->b.type != dt_ipv6) || d.op->b.op)
+	    return 0;
+	constant = d.op->b;
+	var = d.op->a;
+    }
+    mask = u128_not(u128_from_32(0)); /* ~0 */
+    while (var.op && var.op->dsc == &op_and) {
+	if ((var.op->a.type == dt_unum || var.op->a.type == dt_ipv6) &&
+	  !var.op->a.op) {
+	    mask = u128_and(mask,data_convert(var.op->a,dt_ipv6).u.u128);
+	    var = var.op->b;
+	}
+	else {
+	    if ((var.op->b.type != dt_unum && var.op->b.type != dt_ipv6) ||
+	      var.op->b.op)
+		return 0;
+	    mask = u128_and(mask,data_convert(var.op->b,dt_ipv6).u.u128);
+	    var = var.op->a;
+	}
+	default_mask = 0;
+    }
+    if (!var.op || var.op->dsc != &op_access) return 0;
+    if (var.op->b.op || var.op->b.type != dt_unum) return 0;
+    if (var.op->c.op || var.op->c.type != dt_unum || (var.op->c.u.unum & 7))
+	return 0;
+    offset = var.op->b.u.unum;
+    bytes = var.op->c.u.unum/8;
+    value = data_convert(constant,dt_ipv6).u.u128;
+    if (default_mask) mask = u128_shift_right(mask,128-var.op->c.u.unum);
+    if (!u128_is_zero(u128_and(value,u128_not(mask)))) return 0;
+    for (i = 0; i < bytes; i++) {
+	int shift = (bytes-1-i)*8;
+	uint8_t v = u128_shift_right(value,shift).v[0];
+	uint8_t m = u128_shift_right(mask,shift).v[0];
+
+	if (offset+i >= U32_HASH_BYTES) break;
+	if ((alt->value[offset+i] ^ v) & alt->mask[offset+i] & m) return 0;
+	alt->value[offset+i] |= v & m;
+	alt->mask[offset+i] |= m;
+    }
+    return 1;
+}
+
+
+/*
+ * Only alternatives consisting of plain comparisons, followed by actions that
+ * map to a single rule, are put into a hash table. Everything else would need
+ * links or repeated rules.
+ */
+
+static int hash_alt(DATA d,struct hash_alt *alt)
+{
+    const char *out;
+    int terms = 0;
+
+    alt->d = d;
+    memset(alt->value,0,sizeof(alt->value));
+    memset(alt->mask,0,sizeof(alt->mask));
+    while (d.op && d.op->dsc == &op_logical_and) {
+	if (!hash_eq(d.op->a,alt)) return 0;
+	terms++;
+	d = d.op->b;
+    }
+    if (!terms || !action_tree(d)) return 0;
+    out = map_actions(get_action(d),0);
+    return out && !strchr(out,' ');
+}
+
+
+/*
+ * Alternatives that test only some of the bits of the key, e.g. short
+ * prefixes, go into all the buckets they can match. Returns the number of
+ * buckets.
+ */
+
+static int alt_buckets(const struct hash_alt *alt,int pos,uint8_t key_mask,
+  uint8_t *buckets)
+{
+    uint8_t base = alt->value[pos] & alt->mask[pos] & key_mask;
+    uint8_t free_bits = key_mask & ~alt->mask[pos];
+    uint8_t bits = 0;
+    int n = 0;
+
+    do {
+	buckets[n++] = base | bits;
+	bits = (bits-free_bits) & free_bits;
+    }
+    while (bits);
+    return n;
+}
+
+
+static int bits_set(uint8_t v)
+{
+    int n = 0;
+
+    while (v) {
+	n += v & 1;
+	v >>= 1;
+    }
+    return n;
+}
+
+
+/*
+ * Find the longest run of alternatives at the beginning of "alts" that can
+ * share a hash table, and the byte to use as the key. We stop adding
+ * alternatives when no byte is tested by all of them, when an alternative
+ * would have to be copied to more than 2^U32_HASH_SPREAD buckets, or when no
+ * byte tested by all of them tells them apart.
+ *
+ * Returns the length of the run. "*pos" is -1 if the run is too short or if
+ * there is no suitable key.
+ */
+
+struct hash_state {
+    uint8_t any[U32_HASH_BYTES];	/* bits tested by any alternative */
+    uint8_t all[U32_HASH_BYTES];	/* bits tested by all alternatives */
+    uint8_t ok[U32_HASH_BYTES];		/* byte can be the key */
+    uint8_t varies[U32_HASH_BYTES];	/* byte tells alternatives apart */
+};
+
+
+static int hash_run(const struct hash_alt *alts,int n,int *pos,
+  uint8_t *key_mask)
+{
+    struct hash_state curr,next;
+    uint8_t buckets[256];
+    int best_buckets = 1;
+    int i,j;
+
+    memset(curr.any,0,sizeof(curr.any));
+    memset(curr.all,0xff,sizeof(curr.all));
+    memset(curr.ok,1,sizeof(curr.ok));
+    memset(curr.varies,0,sizeof(curr.varies));
+    for (j = 0; j < n; j++) {
+	const struct hash_alt *alt = alts+j;
+	int alive = 0,now_useful = 0;
+
+	for (i = 0; i < U32_HASH_BYTES; i++) {
+	    next.any[i] = curr.any[i] | alt->mask[i];
+	    next.all[i] = curr.all[i] & alt->mask[i];
+	    next.ok[i] = curr.ok[i] && alt->mask[i] &&
+	      bits_set(next.any[i] & ~next.all[i]) <= U32_HASH_SPREAD;
+	    next.varies[i] = curr.varies[i] ||
+	      ((alt->value[i] ^ alts->value[i]) & alt->mask[i] & alts->mask[i]);
+	    if (next.ok[i]) {
+		alive = 1;
+		if (next.varies[i]) now_useful = 1;
+	    }
+	}
+	if (!alive || (j && !now_useful)) break;
+	curr = next;
+    }
+    *pos = -1;
+    if (j < U32_HASH_MIN) return j;
+    for (i = 0; i < U32_HASH_BYTES; i++) {
+	uint8_t seen[256];
+	int k,buckets_used = 0;
+
+	/*
+	 * Old kernels use the masked byte as the bucket number, while newer
+	 * ones shift it right to the first bit of the mask. We only agree with
+	 * both if that bit is bit zero.
+	 */
+	if (!curr.ok[i] || !curr.varies[i] || !(curr.any[i] & 1)) continue;
+	memset(seen,0,sizeof(seen));
+	for (k = 0; k < j; k++) {
+	    int copies = alt_buckets(alts+k,i,curr.any[i],buckets);
+
+	    while (copies--) {
+		if (!seen[buckets[copies]]) buckets_used++;
+		seen[buckets[copies]] = 1;
+	    }
+	}
+	if (buckets_used > best_buckets) {
+	    *pos = i;
+	    *key_mask = curr.any[i];
+	    best_buckets = buckets_used;
+	}
+    }
+    return j;
+}
+
+
+static void dump_alts(const FILTER *filter,struct hash_alt *alts,int n,
+  uint32_t *curr_handle,int nested,int field_root,int *useful);
+
+
+/*
+ * Each bucket is dumped like a sequence of alternatives of its own, so if a
+ * bucket contains enough rules, it gets its own hash table, keyed by another
+ * byte. For prefix lists, this yields a trie with one level per octet. To
+ * avoid picking the same byte again, we record the bucket number as the value
+ * of the key byte.
+ */
+
+static void dump_hash_table(const FILTER *filter,struct hash_alt *alts,int n,
+  int pos,uint8_t key_mask,uint32_t *curr_handle,int field_root,int *useful)
+{
+    uint8_t buckets[256];
+    int count[256];
+    uint32_t table;
+    int i,bucket;
+
+    debugf("u32 hash: %d rules, key at %d, mask 0x%02x",n,pos,key_mask);
+    (*curr_handle)++;
+    begin_match(*curr_handle);
+    cached_hash(filter,256);
+    dump_match(filter);
+    tc_more(" hashkey mask 0x%08lx at %d",
+      (unsigned long) key_mask << (8*(3-(pos & 3))),pos & ~3);
+    table = __dump_link(filter);
+    memset(count,0,sizeof(count));
+    for (i = 0; i < n; i++) {
+	int copies = alt_buckets(alts+i,pos,key_mask,buckets);
+
+	while (copies--) count[buckets[copies]]++;
+    }
+    for (bucket = 0; bucket < 256; bucket++) {
+	uint32_t bucket_handle = table | bucket << 12;
+	struct hash_alt *sub;
+	int m = 0;
+
+	if (!count[bucket]) continue;
+	sub = alloc(count[bucket]*sizeof(struct hash_alt));
+	for (i = 0; i < n; i++) {
+	    if ((bucket ^ alts[i].value[pos]) & alts[i].mask[pos]) continue;
+	    sub[m] = alts[i];
+	    sub[m].value[pos] = bucket;
+	    sub[m].mask[pos] = key_mask;
+	    m++;
+	}
+	dump_alts(filter,sub,m,&bucket_handle,1,field_root,useful);
+	free(sub);
+    }
+    pop_rule();
+}
+
+
+static void dump_alts(const FILTER *filter,struct hash_alt *alts,int n,
+  uint32_t *curr_handle,int nested,int field_root,int *useful)
+{
+    int trie = !nested || registry_probe(&optimization_switches,"u32trie");
+    int i = 0;
+
+    while (i < n) {
+	uint8_t key_mask;
+	int pos,run;
+
+	run = trie ? hash_run(alts+i,n-i,&pos,&key_mask) : n-i;
+	if (trie && pos >= 0 && TC_U32_USERHTID(handle) < MAX_U32_TABLES) {
+	    dump_hash_table(filter,alts+i,run,pos,key_mask,curr_handle,
+	      field_root,useful);
+	    i += run;
+	    continue;
+	}
+	if (!run) run = 1;
+	while (run--) {
+	    if (TC_U32_NODE(*curr_handle) == TC_U32_NODE(~0U))
+		errorf("too many rules in u32 hash table (max %d)",
+		  TC_U32_NODE(~0U));
+	    (*curr_handle)++;
+	    begin_match(*curr_handle);
+	    if (dump_and(filter,alts[i].d,*curr_handle,0,field_root))
+		*useful = 1;
+	    i++;
+	}
+    }
+}
+
+
+/*
+ * Returns 0 if there are not enough alternatives that could be hashed.
+ * Otherwise, returns 1 and advances "d" to the first alternative following
+ * them. If we're not at the end of the classifier, the last alternative can be
+ * hashed too, and "d" becomes dt_none if that happened.
+ */
+
+static int dump_hash(const FILTER *filter,DATA *d,uint32_t *curr_handle,
+  int at_end,int field_root,int *useful)
+{
+    struct hash_alt *alts;
+    DATA next = *d;
+    int n = 0,size = U32_HASH_MIN;
+
+    if (field_root || !registry_probe(&optimization_switches,"u32hash"))
+	return 0;
+    alts = alloc(size*sizeof(struct hash_alt));
+    while (next.op && !action_tree(next)) {
+	int last = next.op->dsc != &op_logical_or;
+
+	if (last && at_end) break;
+	if (n == size) {
+	    size *= 2;
+	    alts = realloc(alts,size*sizeof(struct hash_alt));
+	    if (!alts) {
+		perror("realloc");
+		exit(1);
+	    }
+	}
+	if (!hash_alt(last ? next : next.op->a,alts+n)) break;
+	n++;
+	next = last ? data_none() : next.op->b;
+    }
+    if (n < U32_HASH_MIN) {
+	free(alts);
+	return 0;
+    }
+    dump_alts(filter,alts,n,curr_handle,0,field_root,useful);
+    free(alts);
+    *d = next;
+    return 1;
+}
+
+
+/*
+ * Alternatives with a field behind an offset, e.g. a port number, look like
+ * this:
+ *
+ *   a && b && offset(x1,off) || a && b && offset(x2,off) || ...
+ *
+ * so each of them gets its own link to a table with a single rule. If there
+ * are enough of them to be worth hashing, we turn them into
+ *
+ *   a && b && offset(x1 || x2 || ...,off) || ...
+ *
+ * which yields one sub-table, where dump_hash can then do its work. If none of
+ * x1, x2, ... matches, u32 returns from the sub-table and continues with the
+ * next alternative, so the semantics are unchanged.
+ */
+
+static DATA *offset_tail(DATA *d)
+{
+    while (d->op && d->op->dsc == &op_logical_and) d = &d->op->b;
+    return d->op && d->op->dsc == &op_offset ? d : NULL;
+}
+
+
+static int same_prefix(DATA a,DATA b)
+{
+    while (a.op && a.op->dsc == &op_logical_and) {
+	if (!b.op || b.op->dsc != &op_logical_and) return 0;
+	if (!expr_equal(a.op->a,b.op->a)) return 0;
+	a = a.op->b;
+	b = b.op->b;
+    }
+    if (!a.op || a.op->dsc != &op_offset) return 0;
+    if (!b.op || b.op->dsc != &op_offset) return 0;
+    return expr_equal(a.op->b,b.op->b);
+}
+
+
+static void group_offsets(DATA *d)
+{
+    while (d->op && d->op->dsc == &op_logical_or) {
+	DATA *tail = offset_tail(&d->op->a);
+	DATA *next = &d->op->b;
+	DATA *inner;
+	int n = 1;
+
+	if (!tail) {
+	    d = next;
+	    continue;
+	}
+	while (next->op && next->op->dsc == &op_logical_or &&
+	  same_prefix(d->op->a,next->op->a)) {
+	    n++;
+	    next = &next->op->b;
+	}
+	if (n >= U32_HASH_MIN) {
+	    const OP *stop = next->op; /* next points into a node we free */
+
+	    debugf("u32 hash: grouping %d alternatives behind offset",n);
+	    inner = &tail->op->a;
+	    while (d->op->b.op != stop) {
+		DATA alt = d->op->b.op->a;
+		DATA rest = d->op->b.op->b;
+		DATA *alt_tail = offset_tail(&alt);
+
+		*inner = op_binary(&op_logical_or,*inner,alt_tail->op->a);
+		inner = &inner->op->b;
+		alt_tail->op->a = data_none();
+		data_destroy(alt);
+		data_destroy_1(d->op->b);
+		d->op->b = rest;
+	    }
+	}
+	group_offsets(&tail->op->a);
+	d = &d->op->b;
+    }
+}
+
+
+/* ----- Dump alternatives ------------------------------------------------- */
+
+
 static int dump_or(const FILTER *filter,DATA d,uint32_t curr_handle,int at_end,
   int field_root)
 {
     int useful = 0;
 
     while (d.op && d.op->dsc == &op_logical_or) {
+	if (dump_hash(filter,&d,&curr_handle,at_end,field_root,&useful)) {
+	    if (d.type == dt_none) return useful;
+	    continue;
+	}
 	curr_handle++;
 	begin_match(curr_handle);
 	if (dump_action(filter,d,at_end)) return 1;
@@ -1288,10 +1724,13 @@ void dump_if_u32(const FILTER *filter)
 	iflib_reduce(&d);
 	iflib_normalize(&d);
 	iflib_actions(filter->location,&d);
+	iflib_shadow(&d);
+	iflib_profile(filter,&d);
 	iflib_offset(&d,1);
 	if (!d.op && d.type == dt_unum && !d.u.unum) return;
 	if (!i && continue_at_end(d)) break;
     }
+    if (registry_probe(&optimization_switches,"u32hash")) group_offsets(&d);
     dump_actions(d);
     collect_protocols(filter,d);
     protocol = protocols;
@@ -14,6 +14,7 @@
 
 #include "location.h"
 #include "data.h"
+#include "op.h"
 #include "tree.h"
 
 
@@ -47,12 +48,27 @@ void iflib_actions(LOCATION loc,DATA *d);
  * matches.
  */
 
+void iflib_profile(const FILTER *filter,DATA *d);
+
+/*
+ * Move alternatives leading to frequently used classes to the front, as far
+ * as this doesn't change the result of the expression. Does nothing if no
+ * profile was given.
+ */
+
 void iflib_arith(DATA *d);
 
 /*
  * Perform various simple arithmetic optimizations.
  */
 
+void iflib_range(DATA *d);
+
+/*
+ * Turn sets of ranges of the same field into the smallest list of prefix
+ * matches. Called by iflib_arith.
+ */
+
 void iflib_not(DATA *d);
 
 /*
@@ -60,11 +76,93 @@ void iflib_not(DATA *d);
  * around || and &&.
  */
 
+void iflib_shadow(DATA *d);
+
+/*
+ * Remove tests that are implied by other tests of the same alternative, and
+ * alternatives that can never match, because their tests contradict each
+ * other, or because an earlier alternative always takes all their packets.
+ */
+
+/* Rule sets, from iflib_shadow.c: */
+
+struct shadow *shadow_open(void);
+void shadow_close(struct shadow *shadow);
+
+int shadow_dead(struct shadow *shadow,DATA *d,const void *owner,
+  const void **by);
+
+/*
+ * Adds the if expression d of a rule that always selects a class to the set,
+ * and returns non-zero if the rule can never match, because of the rules
+ * added before. In this case, *by is the owner of a rule that takes its
+ * packets, or NULL if the tests of d contradict each other.
+ */
+
+/* Hash-consed expressions, from iflib_dag.c: */
+
+typedef struct _expr_node {
+    OP op;			/* interned operation; op.node points back */
+    uint32_t hash;
+    struct _expr_node *next;	/* next in hash chain */
+    int pass;			/* pass "memo" belongs to */
+    DATA memo;			/* result of that pass for this node */
+    signed char self_contained,side_effect,action_tree;
+				/* cached results; -1 if not known yet */
+} EXPR_NODE;
+
+DATA expr_intern(DATA d);
+
+/*
+ * Returns the interned equivalent of d, consuming d. Interned expressions
+ * share all structurally equal sub-expressions, and must not be changed in
+ * place.
+ */
+
+DATA expr_unshare(DATA d);
+
+/*
+ * Returns a private copy of the interned parts of d, consuming d. Passes that
+ * change expressions in place must call expr_unshare first. The copy does not
+ * refer to any interned node.
+ */
+
+DATA expr_rebuild(DATA d,DATA a,DATA b,DATA c);
+
+/*
+ * Returns the interned operation of d with operands a, b, and c, which must
+ * be interned too. Returns d if the operands didn't change.
+ */
+
+void expr_release(void);
+
+/*
+ * Releases all interned expressions at once. Nothing may refer to them
+ * afterwards.
+ */
+
+void expr_new_pass(void);
+int expr_memo(DATA d,DATA *res);
+DATA expr_set_memo(DATA d,DATA res);
+
+/*
+ * Remember the result of the current pass for interned node d. expr_memo
+ * returns non-zero if there is a result for the current pass.
+ */
+
+uint32_t expr_hash(DATA d);
+
+/*
+ * Returns a hash of interned expression d, such that expressions that are
+ * equal according to expr_equal have the same hash.
+ */
+
 int expr_equal(DATA a,DATA b);
 
 /*
  * Actually, this is a test for whether the expressions are _identical_, not
- * only equal. Returns non-zero if they are.
+ * only equal. Returns non-zero if they are. This is a pointer comparison if
+ * both expressions are interned.
  */
 
 int action_tree(DATA d);
@@ -111,8 +209,7 @@ void iflib_cheap_ops(LOCATION loc,DATA d);
  */
 
 void iflib_bit(FILE *file,QDISC *qdisc,DATA d);
-void iflib_newbit(FILE *file,DATA d);
-void iflib_fastbit(FILE *file,DATA d);
+void iflib_newbit(FILE *file,QDISC *qdisc,DATA d);
 
 
 /* New action database handling from iflib_actdb.c: */
@@ -27,6 +27,7 @@
 #include "data.h"
 #include "op.h"
 #include "iflib.h"
+#include "stats.h"
 
 
 /*
@@ -39,7 +40,7 @@
  */
 
 
-SELF_CONTAINED self_contained(DATA d)
+static SELF_CONTAINED do_self_contained(DATA d)
 {
     if (!d.op) {
 	if (d.type == dt_unum) return d.u.unum ? sc_no_true : sc_no_false;
@@ -106,7 +107,21 @@ SELF_CONTAINED self_contained(DATA d)
 }
 
 
-int action_tree(DATA d)
+/*
+ * self_contained, action_tree, and side_effect are called a lot while
+ * normalizing expressions, so we remember their results for interned nodes.
+ */
+
+SELF_CONTAINED self_contained(DATA d)
+{
+    if (!d.op || !d.op->node) return do_self_contained(d);
+    if (d.op->node->self_contained == -1)
+	d.op->node->self_contained = do_self_contained(d);
+    return d.op->node->self_contained;
+}
+
+
+static int do_action_tree(DATA d)
 {
     if (!d.op) return d.type == dt_decision;
     if (d.op->dsc == &op_conform || d.op->dsc == &op_count) return 1;
@@ -117,7 +132,16 @@ int action_tree(DATA d)
 }
 
 
-int side_effect(DATA d)
+int action_tree(DATA d)
+{
+    if (!d.op || !d.op->node) return do_action_tree(d);
+    if (d.op->node->action_tree == -1)
+	d.op->node->action_tree = do_action_tree(d);
+    return d.op->node->action_tree;
+}
+
+
+static int do_side_effect(DATA d)
 {
     if (!d.op) return d.type == dt_decision;
     if (d.op->dsc == &op_count) return 1;
@@ -125,6 +149,15 @@ int side_effect(DATA d)
 }
 
 
+int side_effect(DATA d)
+{
+    if (!d.op || !d.op->node) return do_side_effect(d);
+    if (d.op->node->side_effect == -1)
+	d.op->node->side_effect = do_side_effect(d);
+    return d.op->node->side_effect;
+}
+
+
 /*
  * Transforms  A && M  ->  M && A
  */
@@ -278,6 +311,8 @@ static void trim_self_contained(DATA *d)
 
 void iflib_actions(LOCATION loc,DATA *d)
 {
+    stats_begin("iflib_actions",NULL);
+    *d = expr_unshare(*d);
     trim_self_contained(d);
     debug_expr("AFTER trim_self_contained",*d);
     iflib_cheap_actions(loc,*d);
@@ -287,6 +322,8 @@ void iflib_actions(LOCATION loc,DATA *d)
     debug_expr("AFTER prune_shortcuts (3)",*d);
     iflib_normalize(d);
     debug_expr("AFTER iflib_normalize (again)",*d);
+    *d = expr_unshare(*d);
     push_action(d); /* better safe than sorry */
     debug_expr("AFTER push_action (2)",*d);
+    stats_end();
 }
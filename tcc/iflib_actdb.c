@@ -18,7 +18,9 @@
 #include "data.h"
 #include "op.h"
 #include "iflib.h"
+#include "ext.h"
 #include "ext_all.h"
+#include "ext/tccextbin.h"
 
 
 static struct action *root = NULL;
@@ -316,6 +318,45 @@ static void dump_items(FILE *file,QDISC *qdisc,const struct action *a,int top)
 }
 
 
+static void dump_items_bin(FILE *file,QDISC *qdisc,const struct action *a,
+  int top)
+{
+    if (a->number != -1 && !top) {
+	ext_bin_u32(tea_action);
+	ext_bin_u32(a->number);
+	return;
+    }
+    switch (a->type) {
+	case at_conform:
+	    ext_bin_u32(tea_conform);
+	    ext_bin_u32(a->u.conform->number);
+	    dump_items_bin(file,qdisc,a->c[1],0);
+	    dump_items_bin(file,qdisc,a->c[0],0);
+	    break;
+	case at_count:
+	    ext_bin_u32(tea_count);
+	    ext_bin_u32(a->u.count->number);
+	    dump_items_bin(file,qdisc,a->c[1],0);
+	    break;
+	case at_class:
+	    if (dump_all_decision(file,qdisc,a->u.decision->number)) break;
+	    ext_bin_u32(tea_class);
+	    ext_bin_u32(1);
+	    ext_bin_u32(CLASS_TO_QDISC_NUM(a->u.decision));
+	    ext_bin_u32(a->u.decision->number);
+	    break;
+	case at_drop:
+	    ext_bin_u32(tea_drop);
+	    break;
+	case at_unspec:
+	    ext_bin_u32(tea_unspec);
+	    break;
+	default:
+	    abort();
+    }
+}
+
+
 static void dump_subtree(FILE *file,QDISC *qdisc,struct action *a,int top)
 {
     switch (a->type) {
@@ -334,6 +375,13 @@ static void dump_subtree(FILE *file,QDISC *qdisc,struct action *a,int top)
     }
     if (!a->dumped) {
 	a->dumped = 1;
+	if (ext_binary) {
+	    ext_bin_begin(file,teb_action);
+	    ext_bin_u32(a->number);
+	    dump_items_bin(file,qdisc,a,1);
+	    ext_bin_end();
+	    return;
+	}
 	fprintf(file,"action %d =",a->number);
 	dump_items(file,qdisc,a,1);
 	fputc('\n',file);
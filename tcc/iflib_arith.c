@@ -948,6 +948,10 @@ void iflib_arith(DATA *d)
     debug_expr("AFTER rel_eq_or",*d);
     rel_access(d);
     debug_expr("AFTER rel_access",*d);
+    if (registry_probe(&optimization_switches,"range")) {
+	iflib_range(d);
+	debug_expr("AFTER iflib_range",*d);
+    }
     rel_to_eq(d);
     debug_expr("AFTER rel_to_eq",*d);
     rel_general(d);
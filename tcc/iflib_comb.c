@@ -9,12 +9,16 @@
 
 #include <stdlib.h>
 
+#include "config.h"
+#include "registry.h"
+#include "error.h"
 #include "data.h"
 #include "tree.h"
 #include "param.h"
 #include "op.h"
 #include "filter.h"
 #include "iflib.h"
+#include "stats.h"
 
 
 /*
@@ -89,21 +93,63 @@ void iflib_comb_iterate(const QDISC *qdisc,
 /* ----- Combine all ifs into single expression ---------------------------- */
 
 
+struct combine {
+    DATA root;
+    struct shadow *shadow;	/* NULL if not removing dead elements */
+    int dead;			/* number of elements left out */
+};
+
+
+/*
+ * Elements that can never match are left out. Since we still know where they
+ * are at this point, this is also where we warn about them. Elements that are
+ * just a constant are probably meant to be that way, so we keep them.
+ */
+
+static int dead_element(struct shadow *shadow,const ELEMENT *e)
+{
+    DATA expr = prm_data(e->params,&prm_if_expr);
+    const ELEMENT *by;
+
+    if (!shadow_dead(shadow,&expr,e,(const void **) &by) || !expr.op)
+	return 0;
+    if (!warn_shadow) return 1;
+    if (!by) lwarn(e->location,"rule can never match");
+    else lwarnf(e->location,
+	  "rule can never match, because the rule at %s:%d takes all its "
+	  "packets",by->location.file,by->location.line);
+    return 1;
+}
+
+
 static void iflib_combine_callback(const ELEMENT *e,void *user)
 {
-    DATA *root = user;
-    DATA expr = data_clone(prm_data(e->params,&prm_if_expr));
+    struct combine *comb = user;
+    DATA expr;
 
+    if (comb->shadow && dead_element(comb->shadow,e)) {
+	comb->dead++;
+	return;
+    }
+    expr = data_clone(prm_data(e->params,&prm_if_expr));
     complement_decisions(&expr,e->parent.class);
-    if (root->type == dt_none) *root = expr;
-    else *root = op_binary(&op_logical_or,*root,expr);
+    if (comb->root.type == dt_none) comb->root = expr;
+    else comb->root = op_binary(&op_logical_or,comb->root,expr);
 }
 
 
 DATA iflib_combine(const QDISC *qdisc)
 {
-    DATA d = data_none();
-
-    iflib_comb_iterate(qdisc,iflib_combine_callback,&d);
-    return d;
+    struct combine comb;
+
+    stats_begin("iflib_combine",NULL);
+    comb.root = data_none();
+    comb.dead = 0;
+    comb.shadow = registry_probe(&optimization_switches,"shadow") ?
+      shadow_open() : NULL;
+    iflib_comb_iterate(qdisc,iflib_combine_callback,&comb);
+    if (comb.shadow) shadow_close(comb.shadow);
+    if (comb.root.type == dt_none && comb.dead) comb.root = data_unum(0);
+    stats_end();
+    return comb.root;
 }
@@ -0,0 +1,267 @@
+/*
+ * iflib_dag.c - Hash-consed if expressions
+ */
+
+/*
+ * Interned expressions form a directed acyclic graph in which structurally
+ * equal sub-expressions share a single node. They are still made of normal
+ * DATA and OP structures, so everything that only reads expressions works on
+ * them unchanged, but:
+ *
+ * - two interned expressions are equal if they point to the same OP,
+ * - data_clone just returns its argument, and data_destroy does nothing,
+ * - interned nodes must never be changed in place. Passes that do this have
+ *   to call expr_unshare first.
+ *
+ * Interned nodes are allocated from a region, and are all released at once by
+ * expr_release, when the back end is done with the filter.
+ *
+ * Each node can also remember the result of the current pass over the DAG
+ * (see expr_memo), so that shared sub-expressions are only processed once.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "util.h"
+#include "error.h"
+#include "data.h"
+#include "op.h"
+#include "iflib.h"
+#include "stats.h"
+
+
+static EXPR_NODE *hash[IFLIB_DAG_HASH];
+static REGION region = REGION_INIT; /* all nodes */
+static unsigned long nodes = 0;
+static int pass = 0;
+
+
+/* ----- Hashing and comparison of operands -------------------------------- */
+
+
+static uint32_t hash_string(const char *s)
+{
+    uint32_t h = 0;
+
+    while (*s) h = h*31+(unsigned char) *s++;
+    return h;
+}
+
+
+static uint32_t hash_fnum(double f)
+{
+    uint32_t w[sizeof(double)/sizeof(uint32_t)];
+    uint32_t h = 0;
+    int i;
+
+    if (f == 0) return 0; /* -0.0 == 0.0 */
+    memcpy(w,&f,sizeof(w));
+    for (i = 0; i < sizeof(w)/sizeof(uint32_t); i++) h = h*31+w[i];
+    return h;
+}
+
+
+static uint32_t hash_leaf(DATA d)
+{
+    uint32_t h = d.type;
+
+    switch (d.type) {
+	case dt_unum:
+	case dt_ipv4:
+	    return h*31+d.u.unum;
+	case dt_ipv6:
+	    return (((h*31+d.u.u128.v[0])*31+d.u.u128.v[1])*31+
+	      d.u.u128.v[2])*31+d.u.u128.v[3];
+	case dt_fnum:
+	case dt_rate:
+	case dt_prate:
+	case dt_size:
+	case dt_psize:
+	case dt_time:
+	    return h*31+hash_fnum(d.u.fnum);
+	case dt_string:
+	    return h*31+hash_string(d.u.string);
+	case dt_decision:
+	    h = h*31+d.u.decision.result;
+	    /* like data_equal, ignore the class unless we use it */
+	    if (d.u.decision.result != dr_class &&
+	      d.u.decision.result != dr_reclassify)
+		return h;
+	    return h*31+(uint32_t) (unsigned long) d.u.decision.class;
+	case dt_none:
+	    return h;
+	default:
+	    /* all other types are pointers */
+	    return h*31+(uint32_t) (unsigned long) d.u.qdisc;
+    }
+}
+
+
+static uint32_t hash_operand(DATA d)
+{
+    if (d.op) return d.type*31+(uint32_t) (unsigned long) d.op;
+    return hash_leaf(d);
+}
+
+
+uint32_t expr_hash(DATA d)
+{
+    if (d.op) return (uint32_t) (unsigned long) d.op;
+    return hash_leaf(d);
+}
+
+
+static int same_operand(DATA a,DATA b)
+{
+    if (a.type != b.type) return 0;
+    if (a.op || b.op) return a.op == b.op;
+    switch (a.type) {
+	case dt_none:
+	case dt_unum:
+	case dt_ipv4:
+	case dt_ipv6:
+	case dt_fnum:
+	case dt_rate:
+	case dt_prate:
+	case dt_size:
+	case dt_psize:
+	case dt_time:
+	case dt_string:
+	case dt_qdisc:
+	case dt_class:
+	case dt_decision:
+	case dt_filter:
+	case dt_police:
+	case dt_bucket:
+	case dt_field_root:
+	    return data_equal(a,b);
+	default:
+	    return a.u.qdisc == b.u.qdisc;
+    }
+}
+
+
+/* ----- Interning --------------------------------------------------------- */
+
+
+/*
+ * Returns the node for *op, whose operands must already be interned. *op is
+ * copied if it isn't interned yet.
+ */
+
+static OP *intern_op(const OP *op)
+{
+    EXPR_NODE *node;
+    uint32_t h;
+
+    h = (((uint32_t) (unsigned long) op->dsc*31+hash_operand(op->a))*31+
+      hash_operand(op->b))*31+hash_operand(op->c);
+    for (node = hash[h % IFLIB_DAG_HASH]; node; node = node->next)
+	if (node->hash == h && node->op.dsc == op->dsc &&
+	  same_operand(node->op.a,op->a) && same_operand(node->op.b,op->b) &&
+	  same_operand(node->op.c,op->c))
+	    return &node->op;
+    node = region_alloc_t(&region,EXPR_NODE);
+    node->op = *op;
+    node->op.node = node;
+    node->hash = h;
+    node->pass = 0;
+    node->self_contained = node->side_effect = node->action_tree = -1;
+    node->next = hash[h % IFLIB_DAG_HASH];
+    hash[h % IFLIB_DAG_HASH] = node;
+    nodes++;
+    IR_NODE_NEW();
+    return &node->op;
+}
+
+
+DATA expr_intern(DATA d)
+{
+    OP *op;
+
+    if (!d.op || d.op->node) return d;
+    d.op->a = expr_intern(d.op->a);
+    d.op->b = expr_intern(d.op->b);
+    d.op->c = expr_intern(d.op->c);
+    op = intern_op(d.op);
+    free(d.op);
+    IR_NODES_FREED(1);
+    d.op = op;
+    return d;
+}
+
+
+DATA expr_unshare(DATA d)
+{
+    if (!d.op) return d;
+    if (d.op->node) {
+	OP *op = alloc_t(OP);
+
+	IR_NODE_NEW();
+	*op = *d.op;
+	op->node = NULL;
+	d.op = op;
+    }
+    d.op->a = expr_unshare(d.op->a);
+    d.op->b = expr_unshare(d.op->b);
+    d.op->c = expr_unshare(d.op->c);
+    return d;
+}
+
+
+DATA expr_rebuild(DATA d,DATA a,DATA b,DATA c)
+{
+    OP op;
+
+    if (same_operand(d.op->a,a) && same_operand(d.op->b,b) &&
+      same_operand(d.op->c,c))
+	return d;
+    op = *d.op;
+    op.node = NULL;
+    op.a = a;
+    op.b = b;
+    op.c = c;
+    d.op = intern_op(&op);
+    return d;
+}
+
+
+void expr_release(void)
+{
+    if (!nodes) return;
+    debugf("expr_release: %lu nodes",nodes);
+    region_free(&region);
+    IR_NODES_FREED(nodes);
+    memset(hash,0,sizeof(hash));
+    nodes = 0;
+}
+
+
+/* ----- Per-pass results -------------------------------------------------- */
+
+
+void expr_new_pass(void)
+{
+    pass++;
+}
+
+
+int expr_memo(DATA d,DATA *res)
+{
+    if (!d.op || !d.op->node || d.op->node->pass != pass) return 0;
+    *res = d.op->node->memo;
+    return 1;
+}
+
+
+DATA expr_set_memo(DATA d,DATA res)
+{
+    if (d.op && d.op->node) {
+	d.op->node->pass = pass;
+	d.op->node->memo = res;
+    }
+    return res;
+}
@@ -1,35 +1,43 @@
 /*
- * iflib_newbit.c - FSM based on single-bit decisions (improved version)
+ * iflib_newbit.c - FSM based on single-bit decisions, using a reduced ordered
+ *		    binary decision diagram
  *
  * Written 2001 by Werner Almesberger
  * Copyright 2001 Network Robots
  */
 
 /*
- * UNDER CONSTRUCTION - DOESN'T PRODUCE USEFUL OUTPUT YET
- */
-
-/*
- * Known problems:
+ * The "if" expression is turned into a multi-terminal ROBDD: inner nodes test
+ * single bits of the packet, and terminals are the actions taken for the
+ * packet. Actions are trees of "conform", "count", and decisions. Since
+ * policing has side-effects, actions always stay below all bit tests. Bit
+ * tests have no side-effects, so they can be ordered freely.
+ *
+ * Each variable (i.e. packet bit) has its own unique table, so that sifting
+ * can swap adjacent levels in place. Nodes are reference-counted. When the
+ * last reference to a node goes away, it becomes dead, but stays in its
+ * unique table until the next garbage collection, so a later hit in the
+ * unique or the computed table can revive it.
+ *
+ * Variables are initially ordered by offset group and bit number. With
+ * -Osift (the default), each variable is then moved to the level where the
+ * diagram has the fewest nodes.
+ *
+ * The number of live nodes is limited to BDD_MAX_NODES. Garbage collection
+ * starts when BDD_GC_NODES nodes are allocated, and whenever the number of
+ * nodes has doubled since the last collection.
  *
- * - path selection doesn't produce useful results
- * - to add insult to injury, path selection is also dreadfully slow
- * - data provided by count_out_frequency is probably too fine-grained for path
- *   selection. Should try cuonting nodes, but instead not removing all paths
- *   to an edge, but rather individual paths.
- * - among themselves, consolidate_nodes and consolidate_node iterate with N^2
- *   over the referers. By pre-sorting the list, this could be cut to N.
- * - output has not been validated for correctness other than for trivial cases
- * - code is sprinkled to too many debugging/checking/diagnostic/profiling
- *   functions
+ * The result is written to the external interface twice: as an FSM of "bit"
+ * statements, and as an equivalent list of rules.
  */
 
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 #include <assert.h>
-#include <math.h>
 
 #include "config.h"
 #include "util.h"
@@ -39,645 +47,637 @@
 #include "field.h"
 #include "tree.h"
 #include "iflib.h"
+#include "ext.h"
+#include "ext_all.h"
+#include "ext/tccextbin.h"
 
 
-typedef enum { bt_data,bt_conform,bt_count,bt_decision } BIT_TYPE;
+extern int get_offset_group(DATA d,int base); /* borrowing from if_ext.c */
+
+
+#define SIFT_GROWTH	1.2	/* abandon direction if size grows this much */
+#define VAR_HASH	1024	/* hash buckets for finding variables */
 
-typedef struct _bit {
-    BIT_TYPE type;
-    union {
-	struct {
-	    int bit_num;
-	    int offset_group;
-	} data;
-	DATA decision;
-	const POLICE *bucket;
-    } u;
-    struct _node *node; /* for terminals: identify unique node; NULL if none */
-    struct _bit *next;
-    /* ----- Fields used when printing a DAG ----- */
-    int action;			/* action number */
-int scratch;
-} BIT;
+
+typedef enum { nt_data,nt_conform,nt_count,nt_decision,nt_const } NODE_TYPE;
 
 typedef struct _node {
-    BIT *bit;
-    int ref;			/* reference count */
-    struct _node *edge[2];
-    unsigned long mark;		/* generic mark, used to traverse the DAG. Each
-				 * traversal uses its own unique mark, so we
-				 * never have to "clean up". */
-    /* ----- Fields used for validating reference counts ----- */
-    int ref_validation;		/* references recount; 0 if not visited */
-    int referer_validation;	/* separate count for referers */
-    /* ----- Fields used when sorting the DAG ----- */
-    struct _node *curr_self;	/* in visited nodes, points to self or clone */
-    /* ----- Fields used when decomposing the DAG ----- */
-    int leaf[2];		/* leaf edge index; 0 if not leaf edge */
-    /* ----- Fields used when printing a DAG ----- */
-    int action;			/* action number; undefined if not action */
-    int number;			/* node number, for debugging dumps */
-    /* ----- Fields used when counting frequencies ----- */
-    int in_frequency;		/* paths entering this node */
-    int *out_frequency;		/* paths leaving this node */
-    /* ----- Fields used when merging tails ----- */
-    struct referer *referers;	/* table of referers; NULL if not set */
-    int num_referers;		/* number of referers in table (<= ref) */
-int consolidated;
+    NODE_TYPE type;
+    int var;			/* nt_data: variable tested */
+    union {
+	const POLICE *bucket;	/* nt_conform, nt_count */
+	DATA decision;		/* nt_decision */
+	int value;		/* nt_const */
+    } u;
+    struct _node *edge[2];	/* false and true branch; "count" only uses
+				   edge[1] */
+    int ref;			/* references from live parents and from us */
+    uint32_t hash;		/* hash value in unique table */
+    struct _node *next;		/* next node in unique table; next free node */
+    /* ----- Fields used when writing the result ----- */
+    unsigned long mark;		/* last traversal that visited this node */
+    int rank;			/* actions: order in "if" expression */
+    int number;			/* action number */
+    int bit;			/* bit number */
+    double share;		/* share of packets reaching this node */
 } NODE;
 
-struct referer {
-    NODE *node;		/* NULL if node inaccessible (or at root) */
-    int edge;
-    NODE **anchor;	/* NULL if anchor inaccssible (NB: node -> anchor) */
+struct table {
+    NODE **bucket;
+    int size;			/* number of buckets, power of two */
+    int nodes;			/* nodes in table, including dead ones */
 };
 
+typedef struct {
+    int offset_group;
+    int bit_num;
+    int level;			/* position in variable order, 0 is on top */
+    struct table table;		/* unique table */
+    int next;			/* next variable with same hash; -1 if none */
+} VAR;
+
+enum { op_ite = 1,op_conform_apply,op_count_apply,op_restrict,op_select };
+
+struct cache_entry {
+    int op;
+    const void *key;
+    const NODE *f,*g,*h;
+    NODE *res;
+};
 
-/* ----- Functions to define total order for "bits" ------------------------ */
 
- 
-/*
- * Note: although we include "conform" and "count" in the total order, they are
- * never sorted in the DAG.
- */
+static NODE zero = { .type = nt_const, .u.value = 0 };
+static NODE one = { .type = nt_const, .u.value = 1 };
 
+static VAR *vars = NULL;
+static int *var_at = NULL;	/* variable at each level */
+static int num_vars = 0,max_vars = 0;
+static int var_hash[VAR_HASH];
 
-static int compare_decision(DECISION_RESULT res,const CLASS *a,const CLASS *b)
-{
-    switch (res) {
-	case dr_continue:
-	    return 0;
-	case dr_class:
-	    if (a->number != b->number)
-		return a->number < b->number ? -1 : 1;
-	    return 0;
-	case dr_drop:
-	    return 0;
-	case dr_reclassify:
-	    if (a->number != b->number)
-		return a->number < b->number ? -1 : 1;
-	    return 0;
-	default:
-	    abort();
-    }
+static struct table actions;	/* unique table for actions */
+static struct cache_entry *cache = NULL;
+static NODE *free_nodes = NULL;
+static int nodes = 0;		/* allocated nodes, including dead ones */
+static int dead = 0;		/* nodes without references */
+static int gc_threshold;
+static int in_swap = 0;		/* no garbage collection while swapping */
+static unsigned long curr_mark = 0;
 
-}
+
+/* ----- Unique tables ----------------------------------------------------- */
 
 
-static int compare_bit(const BIT *a,const BIT *b)
+static void init_table(struct table *t)
 {
-    if (a->type != b->type) return a->type < b->type ? -1 : 1;
-    switch (a->type) {
-	case bt_data:
-	    if (a->u.data.offset_group != b->u.data.offset_group)
-		return a->u.data.offset_group < b->u.data.offset_group ? -1 : 1;
-	    if (a->u.data.bit_num != b->u.data.bit_num)
-		return a->u.data.bit_num < b->u.data.bit_num ? -1 : 1;
-	    return 0;
-	case bt_conform:
-	    if (a->u.bucket->number != b->u.bucket->number)
-		return a->u.bucket->number < b->u.bucket->number ? -1 : 1;
-	    return 0;
-	case bt_count:
-	    if (a->u.bucket->number != b->u.bucket->number)
-		return a->u.bucket->number < b->u.bucket->number ? -1 : 1;
-	    return 0;
-	case bt_decision:
-	    if (a->u.decision.u.decision.result !=
-	      b->u.decision.u.decision.result)
-		/*
-		 * Not so good: this sorts "drop" between "class" and
-		 * "reclassify"
-		 */
-		return a->u.decision.u.decision.result <
-		  b->u.decision.u.decision.result ? -1 : 1;
-	    return compare_decision(a->u.decision.u.decision.result,
-	      a->u.decision.u.decision.class,b->u.decision.u.decision.class);
-	default:
-	    abort();
-    }
+    t->size = 16;
+    t->bucket = alloc(sizeof(NODE *)*t->size);
+    memset(t->bucket,0,sizeof(NODE *)*t->size);
+    t->nodes = 0;
 }
 
 
-/* ----- Validation of reference counts and structure ---------------------- */
- 
-
-#ifdef NDEBUG
-
-#define validate_references(x)
-#define validate_structure(x)
-#define validate_dag(x)
+static void insert_node(struct table *t,NODE *n)
+{
+    if (t->nodes >= 2*t->size) {
+	NODE **old = t->bucket;
+	int old_size = t->size;
+	int i;
 
-#else
+	t->size *= 4;
+	t->bucket = alloc(sizeof(NODE *)*t->size);
+	memset(t->bucket,0,sizeof(NODE *)*t->size);
+	for (i = 0; i < old_size; i++)
+	    while (old[i]) {
+		NODE *next = old[i]->next;
 
-/*
- * recount_references uses "ref_validation" instead of "mark" to record which
- * nodes have already been visited. This way, validate_references can be
- * invoked even while traversing the tree.
- *
- * Because of this, we need to count referers separately, in
- * "referer_validation"
- *
- * validate_structure uses "ref_validation" for the same purpose.
- */
+		old[i]->next = t->bucket[old[i]->hash & (t->size-1)];
+		t->bucket[old[i]->hash & (t->size-1)] = old[i];
+		old[i] = next;
+	    }
+	free(old);
+    }
+    n->next = t->bucket[n->hash & (t->size-1)];
+    t->bucket[n->hash & (t->size-1)] = n;
+    t->nodes++;
+}
 
 
-static void recount_references(NODE *node)
+static uint32_t hash_ptr(const void *p)
 {
-    if (!node || node->ref_validation) return;
-    if (node->edge[0]) {
-	recount_references(node->edge[0]);
-	node->edge[0]->ref_validation++;
-    }
-    if (node->edge[1]) {
-	recount_references(node->edge[1]);
-	node->edge[1]->ref_validation++;
-    }
-    if (node->referers) {
-	struct referer *ref;
+    unsigned long v = (unsigned long) p;
 
-	for (ref = node->referers; ref != node->referers+node->num_referers;
-	  ref++)
-	    if (ref->node) ref->node->referer_validation++;
-    }
+    return (uint32_t) (v ^ (v >> 7) ^ (v >> 19));
 }
 
 
-static void check_references(NODE *node)
+/* ----- Reference counting and garbage collection ------------------------- */
+
+
+static NODE *ref(NODE *n)
 {
-    if (!node || !node->ref_validation) return;
-    /*
-     * Decision nodes also have one reference from node->bit->node
-     */
-    if (node->bit->type == bt_decision) node->ref_validation++;
-    if (node->ref != node->ref_validation+node->referer_validation) {
-	fprintf(stderr,"check_references: ref %d, counted %d+%d\n",node->ref,
-	  node->ref_validation,node->referer_validation);
-	abort();
+    if (n->type != nt_const && !n->ref++) {
+	dead--;
+	if (n->edge[0]) ref(n->edge[0]);
+	if (n->edge[1]) ref(n->edge[1]);
     }
-    node->ref_validation = node->referer_validation = 0;
-    check_references(node->edge[0]);
-    check_references(node->edge[1]);
+    return n;
 }
 
 
-static void validate_references(NODE *root)
+static void deref(NODE *n)
 {
-    recount_references(root);
-    root->ref_validation++;
-    check_references(root);
+    if (n->type == nt_const) return;
+    assert(n->ref > 0);
+    if (!--n->ref) {
+	dead++;
+	if (n->edge[0]) deref(n->edge[0]);
+	if (n->edge[1]) deref(n->edge[1]);
+    }
 }
 
 
-static void do_validate_structure(NODE *node)
+static void free_node(NODE *n)
 {
-    if (!node || node->ref_validation) return;
-    node->ref_validation = 1;
-    if (node->edge[0])
-	assert(compare_bit(node->bit,node->edge[0]->bit) < 0);
-    if (node->edge[1])
-	assert(compare_bit(node->bit,node->edge[1]->bit) < 0);
-    assert(node->bit->type == bt_data || (
-      (!node->edge[0] || node->edge[0]->bit->type != bt_data) &&
-      (!node->edge[1] || node->edge[1]->bit->type != bt_data)));
-    assert(node->bit->type == bt_decision || node->edge[0] != node->edge[1]);
-    do_validate_structure(node->edge[0]);
-    do_validate_structure(node->edge[1]);
+    n->next = free_nodes;
+    free_nodes = n;
+    nodes--;
+    dead--;
 }
 
 
-static void clear_ref_validation(NODE *node)
+static void sweep_table(struct table *t)
 {
-    if (!node || !node->ref_validation) return;
-    node->ref_validation = 0;
-    clear_ref_validation(node->edge[0]);
-    clear_ref_validation(node->edge[1]);
-}
+    int i;
 
+    for (i = 0; i < t->size; i++) {
+	NODE **walk = &t->bucket[i];
 
-static void validate_structure(NODE *root)
-{
-    do_validate_structure(root);
-    clear_ref_validation(root);
+	while (*walk)
+	    if ((*walk)->ref) walk = &(*walk)->next;
+	    else {
+		NODE *n = *walk;
+
+		*walk = n->next;
+		t->nodes--;
+		free_node(n);
+	    }
+    }
 }
 
 
-static void validate_dag(NODE *root)
+static void clear_cache(void)
 {
-    validate_references(root);
-    validate_structure(root);
+    memset(cache,0,sizeof(struct cache_entry)*BDD_CACHE);
 }
 
-#endif /* NDEBUG */
 
+/*
+ * Dead nodes don't hold references to their children, so we can free them
+ * all in a single pass.
+ */
 
-/* ----- Unique storage of "bits" ------------------------------------------ */
+static void collect_garbage(void)
+{
+    int i;
 
+    debugf("bdd: collecting garbage, %d nodes, %d dead",nodes,dead);
+    for (i = 0; i < num_vars; i++) sweep_table(&vars[i].table);
+    sweep_table(&actions);
+    clear_cache();
+    gc_threshold = 2*nodes > BDD_GC_NODES ? 2*nodes : BDD_GC_NODES;
+}
 
-static BIT *bits = NULL;
 
+static NODE *new_node(NODE_TYPE type,uint32_t hash)
+{
+    NODE *n;
+
+    if (nodes >= gc_threshold && !in_swap) collect_garbage();
+    if (nodes-dead >= BDD_MAX_NODES)
+	errorf("bit tree needs more than %d nodes",BDD_MAX_NODES);
+    if (free_nodes) {
+	n = free_nodes;
+	free_nodes = n->next;
+    }
+    else n = alloc_t(NODE);
+    memset(n,0,sizeof(NODE));
+    n->type = type;
+    n->hash = hash;
+    n->ref = 1;
+    nodes++;
+    return n;
+}
 
-static void put_node(NODE *node);
 
+/* ----- Variables --------------------------------------------------------- */
 
-static void free_bit(BIT *bit)
+
+static int level(const NODE *n)
 {
-    put_node(bit->node);
-    free(bit);
+    return n->type == nt_data ? vars[n->var].level : INT_MAX;
 }
 
 
-static BIT *store_bit(BIT *bit)
+static int var_before(int offset_group,int bit_num,const VAR *v)
 {
-    BIT **walk;
+    if (offset_group != v->offset_group) return offset_group < v->offset_group;
+    return bit_num < v->bit_num;
+}
 
-    for (walk = &bits; *walk; walk = &(*walk)->next) {
-	int cmp;
 
-	cmp = compare_bit(*walk,bit);
-	if (cmp > 0) break;
-	if (!cmp) {
-	    free_bit(bit);
-	    return *walk;
+/*
+ * New variables are inserted into the order by offset group and bit number.
+ * This doesn't disturb existing nodes, since the relative order of the other
+ * variables stays the same.
+ */
+
+static int get_var(int offset_group,int bit_num)
+{
+    uint32_t h = (offset_group*31+bit_num) % VAR_HASH;
+    int i,low,high;
+
+    for (i = var_hash[h]; i != -1; i = vars[i].next)
+	if (vars[i].offset_group == offset_group && vars[i].bit_num == bit_num)
+	    return i;
+    if (num_vars == max_vars) {
+	max_vars = max_vars ? 2*max_vars : 64;
+	vars = realloc(vars,sizeof(VAR)*max_vars);
+	var_at = realloc(var_at,sizeof(int)*max_vars);
+	if (!vars || !var_at) {
+	    perror("realloc");
+	    exit(1);
 	}
     }
-    bit->next = *walk;
-    *walk = bit;
-    return bit;
+    low = 0;
+    high = num_vars;
+    while (low < high) {
+	int mid = (low+high)/2;
+
+	if (var_before(offset_group,bit_num,vars+var_at[mid])) high = mid;
+	else low = mid+1;
+    }
+    memmove(var_at+low+1,var_at+low,sizeof(int)*(num_vars-low));
+    var_at[low] = num_vars;
+    for (i = low; i <= num_vars; i++) vars[var_at[i]].level = i;
+    vars[num_vars].offset_group = offset_group;
+    vars[num_vars].bit_num = bit_num;
+    init_table(&vars[num_vars].table);
+    vars[num_vars].next = var_hash[h];
+    var_hash[h] = num_vars;
+    return num_vars++;
 }
 
 
-static BIT *make_bit(BIT_TYPE type)
+/* ----- Node construction ------------------------------------------------- */
+
+
+/*
+ * mk_data and mk_action take over the caller's references to their children,
+ * and return a new reference.
+ */
+
+static NODE *mk_data(int var,NODE *lo,NODE *hi)
 {
-    BIT *bit;
+    struct table *t = &vars[var].table;
+    uint32_t h;
+    NODE *n;
 
-    bit = alloc_t(BIT);
-    bit->type = type;
-    bit->node = NULL;
-    bit->next = NULL;
-    return bit;
+    if (lo == hi) {
+	deref(hi);
+	return lo;
+    }
+    h = hash_ptr(lo)*31+hash_ptr(hi);
+    for (n = t->bucket[h & (t->size-1)]; n; n = n->next)
+	if (n->edge[0] == lo && n->edge[1] == hi) {
+	    ref(n);
+	    deref(lo);
+	    deref(hi);
+	    return n;
+	}
+    n = new_node(nt_data,h);
+    n->var = var;
+    n->edge[0] = lo;
+    n->edge[1] = hi;
+    insert_node(&vars[var].table,n);
+    return n;
 }
 
 
-/* ----- Basic node operations --------------------------------------------- */
+static int same_action(const NODE *a,NODE_TYPE type,const POLICE *bucket,
+  DATA decision,const NODE *no,const NODE *yes)
+{
+    if (a->type != type || a->edge[0] != no || a->edge[1] != yes) return 0;
+    if (type != nt_decision) return a->u.bucket == bucket;
+    return data_equal(a->u.decision,decision);
+}
 
 
-static NODE *make_node(BIT *bit,NODE *true,NODE *false)
+static NODE *mk_action(NODE_TYPE type,const POLICE *bucket,DATA decision,
+  NODE *no,NODE *yes)
 {
-    NODE *node;
-
-    node = alloc_t(NODE);
-    node->bit = bit;
-    node->ref = 1;
-    node->edge[0] = false;
-    node->edge[1] = true;
-    node->mark = 0;
-    node->ref_validation = node->referer_validation = 0;
-    node->in_frequency = 0;
-    node->referers = NULL;
-    return node;
+    uint32_t h;
+    NODE *n;
+
+    if (type == nt_conform && no == yes) {
+	deref(no);
+	return yes;
+    }
+    h = type*31+hash_ptr(no)*31+hash_ptr(yes);
+    if (type != nt_decision) h = h*31+hash_ptr(bucket);
+    else {
+	h = h*31+decision.u.decision.result;
+	/* like data_equal, ignore the class unless we use it */
+	if (decision.u.decision.result == dr_class ||
+	  decision.u.decision.result == dr_reclassify)
+	    h = h*31+hash_ptr(decision.u.decision.class);
+    }
+    for (n = actions.bucket[h & (actions.size-1)]; n; n = n->next)
+	if (same_action(n,type,bucket,decision,no,yes)) {
+	    ref(n);
+	    if (no) deref(no);
+	    if (yes) deref(yes);
+	    return n;
+	}
+    n = new_node(type,h);
+    if (type == nt_decision) n->u.decision = decision;
+    else {
+	n->u.bucket = bucket;
+	n->rank = yes->rank;
+	if (no && no->rank < n->rank) n->rank = no->rank;
+    }
+    n->edge[0] = no;
+    n->edge[1] = yes;
+    insert_node(&actions,n);
+    return n;
 }
 
 
-static void free_node(NODE *node)
+/* ----- Computed table ---------------------------------------------------- */
+
+
+static struct cache_entry *cache_entry(int op,const void *key,const NODE *f,
+  const NODE *g,const NODE *h)
 {
-    put_node(node->edge[0]);
-    put_node(node->edge[1]);
-    if (node->referers) free(node->referers);
-    free(node);
+    uint32_t hash;
+
+    hash = (((op*31+hash_ptr(key))*31+hash_ptr(f))*31+hash_ptr(g))*31+
+      hash_ptr(h);
+    return cache+(hash % BDD_CACHE);
 }
 
 
-static NODE *get_node(NODE *node)
+static NODE *cache_lookup(int op,const void *key,const NODE *f,const NODE *g,
+  const NODE *h)
 {
-    if (node) node->ref++;
-    return node;
+    const struct cache_entry *e = cache_entry(op,key,f,g,h);
+
+    if (e->op != op || e->key != key || e->f != f || e->g != g || e->h != h)
+	return NULL;
+    return ref(e->res);
 }
 
 
-static void put_node(NODE *node)
+static NODE *cache_insert(int op,const void *key,const NODE *f,const NODE *g,
+  const NODE *h,NODE *res)
 {
-//if (node) fprintf(stderr,"put_node(%p) [%d]\n",node,node->ref);
-    if (node)
-	if (!--node->ref) free_node(node);
+    struct cache_entry *e = cache_entry(op,key,f,g,h);
+
+    e->op = op;
+    e->key = key;
+    e->f = f;
+    e->g = g;
+    e->h = h;
+    e->res = res;
+    return res;
 }
 
 
-static unsigned long curr_mark = 0;
+/* ----- Operations -------------------------------------------------------- */
 
 
-static void new_mark(void)
+static NODE *cofactor(NODE *n,int var,int value)
 {
-    curr_mark++;
-    assert(curr_mark); /* better dead than wrapped */
+    return n->type == nt_data && n->var == var ? n->edge[value] : n;
 }
 
 
-/* ----- Debugging DAG dump ------------------------------------------------ */
+static int top_var(const NODE *f,const NODE *g,const NODE *h)
+{
+    int top = level(f);
+
+    if (level(g) < top) top = level(g);
+    if (h && level(h) < top) top = level(h);
+    return var_at[top];
+}
 
 
 /*
- * set_node_numbers is done in a separate pass so that we can access the number
- * with any link that may exist between nodes (e.g. edge and referers)
+ * If f then g else h. f only tests bits, and its terminals are "zero" and
+ * "one".
  */
 
-
-static void set_node_numbers(NODE *node,int *number)
+static NODE *ite(NODE *f,NODE *g,NODE *h)
 {
-    if (!node || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    node->number = (*number)++;
-    set_node_numbers(node->edge[0],number);
-    set_node_numbers(node->edge[1],number);
+    NODE *res,*lo,*hi;
+    int v;
+
+    if (f == &one) return ref(g);
+    if (f == &zero) return ref(h);
+    if (g == h) return ref(g);
+    if (g == &one && h == &zero) return ref(f);
+    res = cache_lookup(op_ite,NULL,f,g,h);
+    if (res) return res;
+    v = top_var(f,g,h);
+    lo = ite(cofactor(f,v,0),cofactor(g,v,0),cofactor(h,v,0));
+    hi = ite(cofactor(f,v,1),cofactor(g,v,1),cofactor(h,v,1));
+    return cache_insert(op_ite,NULL,f,g,h,mk_data(v,lo,hi));
 }
 
 
-static void do_dump_dag(FILE *file,NODE *node)
+/*
+ * Removes "conform bucket" from action n, assuming it yields "value". We stop
+ * at "count", since it may change the result of "conform" (also through
+ * overflow buckets).
+ */
+
+static NODE *restrict_conform(const POLICE *bucket,NODE *n,int value)
 {
-    const BIT *bit;
-    char *tmp;
-    DATA d;
-
-    if (!node || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    bit = node->bit;
-    switch (bit->type) {
-	case bt_data:
-	    tmp = alloc_sprintf("bit(%d:%d)",bit->u.data.offset_group,
-	      bit->u.data.bit_num);
-	    break;
-	case bt_conform:
-	    tmp = alloc_sprintf("conform(%u)",(unsigned) bit->u.bucket->number);
-	    break;
-	case bt_count:
-	    tmp = alloc_sprintf("count(%u)",(unsigned) bit->u.bucket->number);
-	    break;
-	case bt_decision:
-	    d = bit->u.decision;
-	    switch (d.u.decision.result) {
-		case dr_continue:
-		    tmp = stralloc("continue");
-		    break;
-		case dr_class:
-		    tmp = alloc_sprintf("class(%u)",
-		      (unsigned) d.u.decision.class->number);
-		    break;
-		case dr_drop:
-		    tmp = stralloc("drop");
-		    break;
-		case dr_reclassify:
-		    tmp = alloc_sprintf("reclassify(%u)",
-		      (unsigned) d.u.decision.class->number);
-		    break;
-		default:
-		    abort();
-	    }
-	    break;
-	default:
-	    abort();
-    }
-    do_dump_dag(file,node->edge[1]);
-    do_dump_dag(file,node->edge[0]);
-    fprintf(file,"%d: %-10s %5d %5d # %p, ref %d",node->number,tmp,
-      node->edge[1] ? node->edge[1]->number : -1,
-      node->edge[0] ? node->edge[0]->number : -1,node,node->ref);
-    free(tmp);
-    if (node->referers) {
-	int i;
+    NODE *res;
+
+    if (n->type != nt_conform) return ref(n);
+    if (n->u.bucket == bucket)
+	return restrict_conform(bucket,n->edge[value],value);
+    res = cache_lookup(op_restrict,bucket,n,value ? &one : &zero,NULL);
+    if (res) return res;
+    res = mk_action(nt_conform,n->u.bucket,data_none(),
+      restrict_conform(bucket,n->edge[0],value),
+      restrict_conform(bucket,n->edge[1],value));
+    return cache_insert(op_restrict,bucket,n,value ? &one : &zero,NULL,res);
+}
 
-	fprintf(file," %d",node->num_referers);
-	for (i = 0; i < node->num_referers; i++) {
-	    const struct referer *ref = node->referers+i;
 
-	    fprintf(file,"%c%d.%d",i ? ' ' : '[',
-	      ref->node ? ref->node->number : -1,ref->edge);
-	    if (!ref->node) {
-		if (ref->anchor) fprintf(file,",%p",ref->anchor);
-	    }
-	    else {
-		assert(ref->anchor == ref->node->edge+ref->edge);
-	    }
-	}
-	fprintf(file,"]");
-    }
-    fprintf(file,"\n");
+/*
+ * "conform" and "count" are applied to each terminal, so bit tests end up
+ * above policing.
+ */
+
+static NODE *conform(const POLICE *bucket,NODE *yes,NODE *no)
+{
+    NODE *res,*lo,*hi;
+    int v;
+
+    if (yes->type != nt_data && no->type != nt_data)
+	return mk_action(nt_conform,bucket,data_none(),
+	  restrict_conform(bucket,no,0),restrict_conform(bucket,yes,1));
+    res = cache_lookup(op_conform_apply,bucket,yes,no,NULL);
+    if (res) return res;
+    v = top_var(yes,no,NULL);
+    lo = conform(bucket,cofactor(yes,v,0),cofactor(no,v,0));
+    hi = conform(bucket,cofactor(yes,v,1),cofactor(no,v,1));
+    return cache_insert(op_conform_apply,bucket,yes,no,NULL,mk_data(v,lo,hi));
 }
 
 
-static void dump_dag(NODE *root,const char *fmt,...)
+static NODE *count(const POLICE *bucket,NODE *next)
 {
-    int node_number = 0;
-    va_list ap;
-
-    if (!debug) return;
-    va_start(ap,fmt);
-    fprintf(stderr,"----- ");
-    vfprintf(stderr,fmt,ap);
-    fprintf(stderr," -----\n");
-    va_end(ap);
-    new_mark();
-    set_node_numbers(root,&node_number);
-    new_mark();
-    (void) do_dump_dag(stderr,root);
+    NODE *res,*lo,*hi;
+
+    if (next->type != nt_data)
+	return mk_action(nt_count,bucket,data_none(),NULL,ref(next));
+    res = cache_lookup(op_count_apply,bucket,next,NULL,NULL);
+    if (res) return res;
+    lo = count(bucket,next->edge[0]);
+    hi = count(bucket,next->edge[1]);
+    return cache_insert(op_count_apply,bucket,next,NULL,NULL,
+      mk_data(next->var,lo,hi));
 }
 
 
-/* ----- DAG construction -------------------------------------------------- */
+/* ----- Building the diagram ---------------------------------------------- */
 
 
-extern int get_offset_group(DATA d,int base); /* borrowing from if_ext.c */
+struct literal {
+    int var;
+    int value;
+};
 
 
-static NODE *value_dag(int offset,uint32_t value,uint32_t mask,
-  int length,NODE *true,NODE *false,int offset_group)
+static int compare_literals(const void *a,const void *b)
 {
-    NODE *last;
-    int i;
+    const struct literal *la = a,*lb = b;
 
-    last = true;
-    for (i = 0; i < length; i++)
-	if ((mask >> i) & 1) {
-	    BIT *bit;
-
-	    bit = make_bit(bt_data);
-	    bit->u.data.bit_num = length-i-1+offset*8;
-	    bit->u.data.offset_group = offset_group;
-	    bit = store_bit(bit);
-	    last = (value >> i) & 1 ? make_node(bit,last,get_node(false)) :
-	      make_node(bit,get_node(false),last);
-	}
-    put_node(false);
-    return last;
+    return vars[lb->var].level-vars[la->var].level; /* deepest first */
 }
 
 
-static NODE *eq_dag(DATA a,DATA b,NODE *true,NODE *false,int offset_group)
+static NODE *eq_bdd(DATA a,DATA b,NODE *yes,NODE *no,int offset_group)
 {
-    uint32_t value;
-    uint32_t field_mask = 0xffffffff,value_mask = 0xffffffff;
-    int shift = 0; /* negative means shift value right */
-    int constant = 0; /* 0: field content affects result; -1: always false;
-			 1: always true */
+    struct literal lit[32];
+    uint32_t value,field_mask = 0xffffffff,value_mask = 0xffffffff;
+    int offset,length,lits = 0;
+    NODE *cube,*res;
+    int i;
+
     /*
-     * We expect the expression to follow the following constraints:
+     * Same constraints as in iflib_bit.c:
      * - left-hand side must contain a packet data access
      * - the offsets must be constant (iflib_off does this for us)
      * - right-hand side must be a constant (iflib_arith does this)
      */
     if (b.op || b.type != dt_unum) dump_failed(b,"\"eq const\" expected");
-
     value = b.u.unum;
     while (!a.op || a.op->dsc != &op_access) {
 	if (!a.op) dump_failed(a,"operator expected");
-	if (a.op->dsc == &op_field_root) {
-	    offset_group = a.op->b.u.field_root->offset_group;
-	    a = a.op->a;
-	    continue;
-	}
 	if (a.op->dsc == &op_offset) {
 	    offset_group = get_offset_group(a,offset_group);
 	    a = a.op->a;
-	    continue;
 	}
-	if (a.op->dsc == &op_shift_left || a.op->dsc == &op_shift_right) {
-	    int n;
-
-	    if (a.op->b.op || a.op->b.type != dt_unum)
-		dump_failed(a,"bad shift");
-	    n = a.op->b.u.unum;
-	    if (a.op->dsc == &op_shift_left) {
-		shift -= n;
-		field_mask >>= n;
-		value_mask >>= n;
-	    }
-	    else {
-		shift += n;
-		field_mask <<= n;
-		value_mask <<= n;
-	    }
-	    a = a.op->a;
-	    continue;
-	}
-	if (a.op->dsc == &op_and) {
+	else if (a.op->dsc == &op_and) {
 	    if (!a.op->a.op && a.op->a.type == dt_unum) {
 		b = a.op->a;
 		a = a.op->b;
 	    }
 	    else {
 		if (a.op->b.op || a.op->b.type != dt_unum)
-		    dump_failed(a,"bad shift");
+		    dump_failed(a,"no constant in and");
 		b = a.op->b;
 		a = a.op->a;
 	    }
 	    field_mask &= b.u.unum;
 	    value_mask &= b.u.unum;
-	    continue;
 	}
-	dump_failed(a,"bad operator");
+	else dump_failed(a,"bad operator");
     }
     if (a.op->b.op || a.op->b.type != dt_unum) dump_failed(a,"bad offset");
     if (a.op->c.op || a.op->c.type != dt_unum) dump_failed(a,"bad size");
-#if 0
-fprintf(stderr,"value 0x%lx, shift %d\n",(unsigned long) value,shift);
-#endif
-    if (shift) {
-	if (shift < 0) {
-	    if (value << (32+shift)) constant = -1;
-	    value >>= -shift;
-	}
-	else {
-	    if (value >> (32-shift)) constant = -1;
-	    value <<= shift;
-	}
+    offset = a.op->b.u.unum;
+    length = a.op->c.u.unum;
+    if (length != 32) field_mask &= (1 << length)-1;
+    if (value & ~value_mask) {
+	yywarn("comparison is always false");
+	return ref(no);
     }
-#if 0
-fprintf(stderr,"(field & 0x%lx) == (0x%lx & 0x%lx) [0x%lx]\n",
-  (unsigned long) field_mask,(unsigned long) value,(unsigned long) value_mask,
-  (unsigned long) (value & value_mask));
-#endif
-    if (a.op->c.u.unum != 32) field_mask &= (1 << a.op->c.u.unum)-1;
-    if (!constant && (shift < -32 || shift > 32))
-	constant = field_mask ? -1 : 1;
-    if (!constant && (value & ~value_mask)) constant = -1;
-    if (constant) {
-	yywarnf("comparison is always %s",constant > 0 ? "true" : "false");
-	if (constant > 0) {
-	    put_node(false);
-	    return true;
-	}
-	else {
-	    put_node(true);
-	    return false;
+    value &= value_mask;
+    for (i = 0; i < length; i++)
+	if ((field_mask >> i) & 1) {
+	    lit[lits].var = get_var(offset_group,length-i-1+offset*8);
+	    lit[lits].value = (value >> i) & 1;
+	    lits++;
 	}
-    }
-    return value_dag(a.op->b.u.unum,value & value_mask,field_mask,
-      a.op->c.u.unum,true,false,offset_group);
+    qsort(lit,lits,sizeof(struct literal),compare_literals);
+    cube = &one;
+    for (i = 0; i < lits; i++)
+	cube = lit[i].value ? mk_data(lit[i].var,&zero,cube) :
+	  mk_data(lit[i].var,cube,&zero);
+    res = ite(cube,yes,no);
+    deref(cube);
+    return res;
 }
 
 
-static NODE *make_dag(DATA d,NODE *true,NODE *false,int offset_group)
+/*
+ * Returns the diagram for "if d then yes else no", without consuming the
+ * references to "yes" and "no".
+ */
+
+static NODE *build(DATA d,NODE *yes,NODE *no,int offset_group)
 {
-    BIT *bit;
+    NODE *tmp,*res;
 
     if (d.op) {
-	if (d.op->dsc == &op_logical_or)
-	    return make_dag(d.op->a,true,
-	      make_dag(d.op->b,get_node(true),false,offset_group),offset_group);
-	if (d.op->dsc == &op_logical_and)
-	    return make_dag(d.op->a,
-	      make_dag(d.op->b,true,get_node(false),offset_group),
-	      false,offset_group);
-	if (d.op->dsc == &op_logical_not)
-	    return make_dag(d.op->a,false,true,offset_group);
-	if (d.op->dsc == &op_field_root)
-	    return make_dag(d.op->a,true,false,
-	      d.op->b.u.field_root->offset_group);
-	if (d.op->dsc == &op_offset)
-	    return make_dag(d.op->a,true,false,
-	      get_offset_group(d,offset_group));
-	if (d.op->dsc == &op_count) {
-	    bit = make_bit(bt_count);
-	    bit->u.bucket = d.op->a.u.police;
-	    put_node(false);
-	    return make_node(store_bit(bit),true,NULL);
+	if (d.op->dsc == &op_logical_or) {
+	    tmp = build(d.op->b,yes,no,offset_group);
+	    res = build(d.op->a,yes,tmp,offset_group);
+	    deref(tmp);
+	    return res;
 	}
-	/*
-	 * From	now on, no terminals may be inserted, and we don't have any
-	 * side-effects either, so we can remove expressions where
-	 * true == false
-	 */
-	if (true == false) {
-	    put_node(false);
-	    return true;
+	if (d.op->dsc == &op_logical_and) {
+	    tmp = build(d.op->b,yes,no,offset_group);
+	    res = build(d.op->a,tmp,no,offset_group);
+	    deref(tmp);
+	    return res;
 	}
+	if (d.op->dsc == &op_logical_not)
+	    return build(d.op->a,no,yes,offset_group);
 	if (d.op->dsc == &op_eq)
-	    return eq_dag(d.op->a,d.op->b,true,false,offset_group);
-	if (d.op->dsc == &op_conform) {
-	    bit = make_bit(bt_conform);
-	    bit->u.bucket = d.op->a.u.police;
-	    return make_node(store_bit(bit),true,false);
-	}
+	    return eq_bdd(d.op->a,d.op->b,yes,no,offset_group);
+	if (d.op->dsc == &op_field_root)
+	    return build(d.op->a,yes,no,d.op->b.u.field_root->offset_group);
+	if (d.op->dsc == &op_offset)
+	    return build(d.op->a,yes,no,get_offset_group(d,offset_group));
+	if (d.op->dsc == &op_conform)
+	    return conform(d.op->a.u.police,yes,no);
+	if (d.op->dsc == &op_count)
+	    return count(d.op->a.u.police,yes);
 	dump_failed(d,"bad operator");
     }
     switch (d.type) {
 	case dt_unum:
-	    if (d.u.unum) {
-		put_node(false);
-		return true;
-	    }
-	    else {
-		put_node(true);
-		return false;
-	    }
-	    break;
+	    return ref(d.u.unum ? yes : no);
 	case dt_decision:
-	    put_node(true);
-	    put_node(false);
-	    bit = make_bit(bt_decision);
-	    bit->u.decision = d;
-	    bit = store_bit(bit);
-	    if (!bit->node) bit->node = make_node(bit,NULL,NULL);
-	    return get_node(bit->node);
+	    if (d.u.decision.result == dr_reclassify)
+		dump_failed(d,"can't handle reclassify");
+	    return mk_action(nt_decision,NULL,d,NULL,NULL);
 	default:
 	    dump_failed(d,"bad terminal");
     }
@@ -685,896 +685,751 @@ static NODE *make_dag(DATA d,NODE *true,NODE *false,int offset_group)
 }
 
 
-/* ----- Sort and uniquify the DAG ----------------------------------------- */
+/*
+ * Decisions are ranked by their last occurrence in the expression. This
+ * yields the order of the corresponding "class" constructs, even if iflib_not
+ * has copied the remainder of the expression into a negated branch. We keep
+ * the ranked nodes alive until we're done.
+ */
+
+static NODE **ranked = NULL;
+static int num_ranked = 0,max_ranked = 0;
+static int last_rank = 0;
 
 
-static int find_bit_in_dag(const BIT *bit,NODE *root)
+static void rank_decision(DATA d)
 {
-    if (!root) return 0;
-    if (root->bit == bit) return 1;
-    if (root->mark == curr_mark) return 0;
-    root->mark = curr_mark;
-    return find_bit_in_dag(bit,root->edge[0]) ||
-      find_bit_in_dag(bit,root->edge[1]);
+    NODE *n;
+
+    n = mk_action(nt_decision,NULL,d,NULL,NULL);
+    if (n->rank) {
+	n->rank = ++last_rank;
+	deref(n);
+	return;
+    }
+    if (num_ranked == max_ranked) {
+	max_ranked = max_ranked ? 2*max_ranked : 64;
+	ranked = realloc(ranked,sizeof(NODE *)*max_ranked);
+	if (!ranked) {
+	    perror("realloc");
+	    exit(1);
+	}
+    }
+    ranked[num_ranked++] = n;
+    n->rank = ++last_rank;
 }
 
 
-/*
- * reduce_dag does _not_ consume references. Returns item with one reference.
- */
+static void rank_decisions(DATA d)
+{
+    if (d.op) {
+	rank_decisions(d.op->a);
+	rank_decisions(d.op->b);
+	rank_decisions(d.op->c);
+    }
+    else if (d.type == dt_decision && d.u.decision.result != dr_reclassify)
+	rank_decision(d);
+}
 
 
-static NODE *reduce_dag(const BIT *bit,int edge,NODE *node)
+static void unrank_decisions(void)
 {
-    NODE *true,*false,*new;
-
-    if (!node) return NULL;
-    if (node->mark == curr_mark) return get_node(node->curr_self);
-    if (node->bit == bit)
-	return reduce_dag(bit,edge,node->edge[edge]);
-    node->mark = curr_mark;
-    node->curr_self = node;
-    true = reduce_dag(bit,edge,node->edge[1]);
-    false = reduce_dag(bit,edge,node->edge[0]);
-    if (true == node->edge[1] && false == node->edge[0]) {
-	put_node(true);
-	put_node(false);
-	return get_node(node);
-    }
-    new = make_node(node->bit,true,false);
-    new->mark = curr_mark;
-    node->curr_self = new->curr_self = new;
-    return new;
+    while (num_ranked) deref(ranked[--num_ranked]);
+    last_rank = 0;
+}
+
+
+/* ----- Sifting ----------------------------------------------------------- */
+
+
+static int live_nodes(void)
+{
+    return nodes-dead;
 }
 
 
 /*
- * sort_subdag consumes one reference on node, returns item with one
- * reference.
+ * Swaps the variables at levels i and i+1. Nodes of the upper variable that
+ * depend on the lower one are rewritten in place, so references to them stay
+ * valid.
  */
 
-
-static NODE *sort_subdag(BIT *start_bit,NODE *node)
+static void swap_levels(int i)
 {
-    BIT *bit;
-
-    for (bit = start_bit; bit && bit->type == bt_data; bit = bit->next) {
-	new_mark();
-	if (find_bit_in_dag(bit,node)) {
-	    NODE *true,*false;
-
-	    new_mark();
-	    true = reduce_dag(bit,1,node);
-	    new_mark();
-	    false = reduce_dag(bit,0,node);
-	    /*
-	     * BUG: does not catch graphs with changes that become identical
-	     * after removal of BIT. Such graphs are probably _very_ rare.
-	     */
-	    put_node(node);
-	    if (true == false) {
-		put_node(false);
-		return sort_subdag(bit->next,true);
+    int x = var_at[i],y = var_at[i+1];
+    struct table *tx = &vars[x].table;
+    NODE *list = NULL,*keep = NULL,*n;
+    int j;
+
+    in_swap = 1;
+    for (j = 0; j < tx->size; j++)
+	while (tx->bucket[j]) {
+	    n = tx->bucket[j];
+	    tx->bucket[j] = n->next;
+	    if (!n->ref) free_node(n);
+	    else if (level(n->edge[0]) != i+1 && level(n->edge[1]) != i+1) {
+		n->next = keep;
+		keep = n;
 	    }
-	    true = sort_subdag(bit->next,true);
-	    false = sort_subdag(bit->next,false);
-	    if (true == false) {
-		put_node(false);
-		return true;
-	    }
-	    /*
-	     * Optimization warning: the following two optimizations look
-	     * tempting, but their main effect seems to be to extend the code
-	     * path so much that things actually get a little slower
-	     *
-	    if (true == node->edge[1] && false == node->edge[0]) {
-		put_node(true);
-		put_node(false);
-		return node;
-	    }
-	     *
-	     *
-	    if (node->ref == 1) {
-		put_node(node->edge[1]);
-		put_node(node->edge[0]);
-		node->edge[1] = true;
-		node->edge[0] = false;
-		return node;
+	    else {
+		n->next = list;
+		list = n;
 	    }
-	     *
-	     * Also note that put_node(node) has to move if enabling these two
-	     * "optimizations".
-	     */
-	    return make_node(bit,true,false);
 	}
+    tx->nodes = 0;
+    vars[x].level = i+1;
+    vars[y].level = i;
+    var_at[i] = y;
+    var_at[i+1] = x;
+    while (keep) {
+	n = keep;
+	keep = n->next;
+	insert_node(tx,n);
+    }
+    while (list) {
+	NODE *f0,*f1,*lo,*hi;
+
+	n = list;
+	list = n->next;
+	f0 = n->edge[0];
+	f1 = n->edge[1];
+	lo = mk_data(x,ref(cofactor(f0,y,0)),ref(cofactor(f1,y,0)));
+	hi = mk_data(x,ref(cofactor(f0,y,1)),ref(cofactor(f1,y,1)));
+	n->var = y;
+	n->edge[0] = lo;
+	n->edge[1] = hi;
+	n->hash = hash_ptr(lo)*31+hash_ptr(hi);
+	insert_node(&vars[y].table,n);
+	deref(f0);
+	deref(f1);
+    }
+    sweep_table(&vars[y].table);
+    in_swap = 0;
+}
+
+
+static void sift_var(int v)
+{
+    int best_size = live_nodes(),size;
+    int best = vars[v].level,curr = best;
+
+    while (curr < num_vars-1) {
+	swap_levels(curr++);
+	size = live_nodes();
+	if (size < best_size) {
+	    best_size = size;
+	    best = curr;
+	}
+	if (size > SIFT_GROWTH*best_size || size > BDD_MAX_NODES/2) break;
     }
-    return node;
+    while (curr > 0) {
+	swap_levels(--curr);
+	size = live_nodes();
+	if (size < best_size) {
+	    best_size = size;
+	    best = curr;
+	}
+	if (size > SIFT_GROWTH*best_size || size > BDD_MAX_NODES/2) break;
+    }
+    while (curr < best) swap_levels(curr++);
+    while (curr > best) swap_levels(--curr);
+}
+
+
+static int compare_table_size(const void *a,const void *b)
+{
+    return vars[*(const int *) b].table.nodes-vars[*(const int *) a].table.nodes;
 }
 
 
-static void sort_dag(NODE **root)
+static void sift(void)
 {
-    NODE *sorted;
+    int *order;
+    int i;
 
-    sorted = sort_subdag(bits,*root);
-    *root = sorted;
+    collect_garbage();
+    order = alloc(sizeof(int)*(num_vars+1));
+    for (i = 0; i < num_vars; i++) order[i] = i;
+    qsort(order,num_vars,sizeof(int),compare_table_size);
+    for (i = 0; i < num_vars; i++) sift_var(order[i]);
+    free(order);
+    collect_garbage();
 }
 
 
-/* ----- Number actions ---------------------------------------------------- */
+/* ----- Debugging output -------------------------------------------------- */
 
 
-static void number_actions_in_dag(NODE *node,int *curr_num)
+static void do_dump_bdd(FILE *file,NODE *n,int *number)
 {
-    if (!node || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    switch (node->bit->type) {
-	case bt_data:
+    if (n->mark == curr_mark) return;
+    n->mark = curr_mark;
+    if (n->edge[0]) do_dump_bdd(file,n->edge[0],number);
+    if (n->edge[1]) do_dump_bdd(file,n->edge[1],number);
+    n->number = (*number)++;
+    fprintf(file,"%d: ",n->number);
+    switch (n->type) {
+	case nt_data:
+	    fprintf(file,"data %d %d",vars[n->var].offset_group,
+	      vars[n->var].bit_num);
+	    break;
+	case nt_conform:
+	    fprintf(file,"conform %d",(int) n->u.bucket->number);
+	    break;
+	case nt_count:
+	    fprintf(file,"count %d",(int) n->u.bucket->number);
 	    break;
-	case bt_conform:
-	case bt_count:
-	    node->action = (*curr_num)++;
+	case nt_decision:
+	    print_data(file,n->u.decision);
 	    break;
-	case bt_decision:
-	    node->action = node->bit->action;
+	case nt_const:
+	    fprintf(file,"%d",n->u.value);
 	    break;
 	default:
 	    abort();
     }
-    number_actions_in_dag(node->edge[0],curr_num);
-    number_actions_in_dag(node->edge[1],curr_num);
+    if (n->edge[1]) fprintf(file," %d",n->edge[1]->number);
+    if (n->edge[0]) fprintf(file," %d",n->edge[0]->number);
+    fprintf(file," # ref %d\n",n->ref);
 }
 
 
-static void number_actions(NODE *root)
+static void debug_bdd(const char *label,NODE *root)
 {
-    int action_num = 0;
-    BIT *bit;
+    int number = 0;
 
-    /* 
-     * We mark terminals first so that we can later on assign preferred numbers
-     * to them, like class IDs, or drop == 0
-     */
-    for (bit = bits; bit; bit = bit->next)
-	if (bit->type != bt_data) bit->action = action_num++;
-    new_mark();
-    number_actions_in_dag(root,&action_num);
+    if (!debug) return;
+    fprintf(stderr,"----- %s: %d nodes (%d dead), %d variables -----\n",label,
+      nodes,dead,num_vars);
+    curr_mark++;
+    do_dump_bdd(stderr,root,&number);
 }
 
 
-/* ----- Number leaf edges ------------------------------------------------- */
+/* ----- Actions ----------------------------------------------------------- */
 
 
-static struct edge {
-    NODE *border;	/* border node; DO NOT DEREFERENCE */
-    int edge;		/* edge to actions */
-} *edges = NULL;
-
-static int num_data_nodes; /* bt_data nodes */
-static int num_action_peers; /* first-level action nodes */
-static int num_leaf_edges; /* edges between data and action */
-
-
-static void number_leaf_edges_in_dag(NODE *node)
+static void dump_decision_bin(FILE *file,QDISC *qdisc,DATA d)
 {
-    if (!node || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    if (node->bit->type != bt_data) {
-	num_action_peers++;
-	return;
+    switch (d.u.decision.result) {
+	case dr_continue:
+	    ext_bin_u32(tea_unspec);
+	    break;
+	case dr_class:
+	    if (dump_all_decision(file,qdisc,d.u.decision.class->number))
+		break;
+	    ext_bin_u32(tea_class);
+	    ext_bin_u32(1);
+	    ext_bin_u32(d.u.decision.class->parent.qdisc->number);
+	    ext_bin_u32(d.u.decision.class->number);
+	    break;
+	case dr_drop:
+	    ext_bin_u32(tea_drop);
+	    break;
+	default:
+	    abort();
     }
-    num_data_nodes++;
-    if (node->edge[0]->bit->type == bt_data) node->leaf[0] = 0;
-    else node->leaf[0] = ++num_leaf_edges;
-    if (node->edge[1]->bit->type == bt_data) node->leaf[1] = 0;
-    else node->leaf[1] = ++num_leaf_edges;
-    number_leaf_edges_in_dag(node->edge[0]);
-    number_leaf_edges_in_dag(node->edge[1]);
 }
 
 
-static void register_leaf_edges_in_dag(NODE *node)
+static void dump_decision(FILE *file,QDISC *qdisc,DATA d)
 {
-    if (!node || node->mark == curr_mark) return;
-    if (node->bit->type != bt_data) return;
-    node->mark = curr_mark;
-    /*
-     * We scribble over edges[0], but this is okay since the index is special,
-     * and its entry is never accessed.
-     */
-    edges[node->leaf[0]].border = node;
-    edges[node->leaf[0]].edge = 0;
-    edges[node->leaf[1]].border = node;
-    edges[node->leaf[1]].edge = 1;
-    register_leaf_edges_in_dag(node->edge[0]);
-    register_leaf_edges_in_dag(node->edge[1]);
+    switch (d.u.decision.result) {
+	case dr_continue:
+	    fprintf(file," unspec");
+	    break;
+	case dr_class:
+	    if (dump_all_decision(file,qdisc,d.u.decision.class->number))
+		break;
+	    fprintf(file," class %u:%u",
+	      (unsigned) d.u.decision.class->parent.qdisc->number,
+	      (unsigned) d.u.decision.class->number);
+	    break;
+	case dr_drop:
+	    fprintf(file," drop");
+	    break;
+	default:
+	    abort();
+    }
 }
 
 
-static void number_leaf_edges(NODE *root)
+static void number_actions(FILE *file,QDISC *qdisc,NODE *n,int *number)
 {
-    num_data_nodes = num_action_peers = num_leaf_edges = 0;
-    new_mark();
-    number_leaf_edges_in_dag(root);
-    if (edges) free(edges);
-    edges = alloc(sizeof(struct edge)*(num_leaf_edges+1));
-    new_mark();
-    register_leaf_edges_in_dag(root);
+    if (!n || n->mark == curr_mark) return;
+    n->mark = curr_mark;
+    number_actions(file,qdisc,n->edge[1],number);
+    number_actions(file,qdisc,n->edge[0],number);
+    if (n->type == nt_data) return;
+    n->number = (*number)++;
+    if (ext_binary) {
+	ext_bin_begin(file,teb_action);
+	ext_bin_u32(n->number);
+	switch (n->type) {
+	    case nt_conform:
+		ext_bin_u32(tea_conform);
+		ext_bin_u32(n->u.bucket->number);
+		ext_bin_u32(tea_action);
+		ext_bin_u32(n->edge[1]->number);
+		ext_bin_u32(tea_action);
+		ext_bin_u32(n->edge[0]->number);
+		break;
+	    case nt_count:
+		ext_bin_u32(tea_count);
+		ext_bin_u32(n->u.bucket->number);
+		ext_bin_u32(tea_action);
+		ext_bin_u32(n->edge[1]->number);
+		break;
+	    case nt_decision:
+		dump_decision_bin(file,qdisc,n->u.decision);
+		break;
+	    default:
+		abort();
+	}
+	ext_bin_end();
+	return;
+    }
+    fprintf(file,"action %d =",n->number);
+    switch (n->type) {
+	case nt_conform:
+	    fprintf(file," conform %d action %d action %d",
+	      (int) n->u.bucket->number,n->edge[1]->number,n->edge[0]->number);
+	    break;
+	case nt_count:
+	    fprintf(file," count %d action %d",(int) n->u.bucket->number,
+	      n->edge[1]->number);
+	    break;
+	case nt_decision:
+	    dump_decision(file,qdisc,n->u.decision);
+	    break;
+	default:
+	    abort();
+    }
+    fprintf(file,"\n");
 }
 
 
-/* ----- Count leaf edge frequency ----------------------------------------- */
+/* ----- FSM --------------------------------------------------------------- */
 
 
 /*
- * We store nodes we need to visit in a list ordered by bit order. Since our
- * DAG is already sorted by bit order, processing nodes in this order ensures
- * that we never visit a node before all parent nodes have been visited.
+ * Bits are numbered from one, since zero stands for "no next bit". Each bit is
+ * defined before it is used, so the root comes last.
  */
 
-static struct count_todo {
-    NODE *node;
-    struct count_todo *next;
-} *count_todo = NULL;
-
-
-static void add_node_todo(NODE *node)
+static void dump_bit_bin(FILE *file,const NODE *n)
 {
-    struct count_todo **walk,*new;
-
-    for (walk = &count_todo; *walk; walk = &(*walk)->next) {
-	int cmp;
-
-	if ((*walk)->node == node) return;
-	cmp = compare_bit(node->bit,(*walk)->node->bit);
-	if (cmp < 0) break; 
+    ext_bin_begin(file,teb_bit);
+    ext_bin_u32(n->bit);
+    if (n->type != nt_data) {
+	ext_bin_u32(n->number);
+	ext_bin_field(0,0,0);
+	ext_bin_u32(0);
+	ext_bin_u32(0);
     }
-    new = alloc_t(struct count_todo);
-    new->node = node;
-    new->next = *walk;
-    *walk = new;
-}
-
-
-static NODE *get_node_todo(void)
-{
-    NODE *node;
-    struct count_todo *next;
-
-    if (!count_todo) return NULL;
-    node = count_todo->node;
-    next = count_todo->next;
-    free(count_todo);
-    count_todo = next;
-    return node;
+    else {
+	ext_bin_u32(TCCEXT_BIN_NO_ACTION);
+	ext_bin_field(vars[n->var].offset_group,vars[n->var].bit_num,1);
+	ext_bin_u32(n->edge[1]->bit);
+	ext_bin_u32(n->edge[0]->bit);
+    }
+    ext_bin_end();
 }
 
 
-/*
- * Sets in_frequency of all bt_data nodes to the number of paths that would go
- * through that node if the node was a leaf. (I.e. for all leaf nodes, this is
- * the actual number of paths going through the node.)
- */
-
-
-static void count_in_frequency(void)
+static void dump_bits(FILE *file,NODE *n,int *number)
 {
-    while (1) {
-	NODE *node;
-
-	node = get_node_todo();
-	if (!node) break;
-	debugf2("count_in_frequency node %p %d",node,node->in_frequency);
-	if (node->edge[0] && node->edge[0]->bit->type == bt_data) {
-	    node->edge[0]->in_frequency += node->in_frequency;
-	    add_node_todo(node->edge[0]);
-	}
-	if (node->edge[1] && node->edge[1]->bit->type == bt_data) {
-	    node->edge[1]->in_frequency += node->in_frequency;
-	    add_node_todo(node->edge[1]);
-	}
+    if (n->mark == curr_mark) return;
+    n->mark = curr_mark;
+    if (n->type != nt_data) {
+	n->bit = (*number)++;
+	if (ext_binary) dump_bit_bin(file,n);
+	else fprintf(file,"bit %d = action %d 0 0\n",n->bit,n->number);
+	return;
     }
+    dump_bits(file,n->edge[1],number);
+    dump_bits(file,n->edge[0],number);
+    n->bit = (*number)++;
+    if (ext_binary) dump_bit_bin(file,n);
+    else fprintf(file,"bit %d = %d:%d:1 %d %d\n",n->bit,
+	  vars[n->var].offset_group,vars[n->var].bit_num,n->edge[1]->bit,
+	  n->edge[0]->bit);
 }
 
 
+/* ----- Rules ------------------------------------------------------------- */
+
 /*
- * Sets the out_frequency array of all bt_data to the number of paths leaving
- * the node to the respective edge. The total number of paths to leaf i
- * traversing the node is therefore in_frequency*out_frequency[i]
+ * Enumerating all paths through the diagram can yield exponentially many
+ * rules. Instead, we cover the packets selecting each action with a set of
+ * possibly overlapping cubes, using Minato's ISOP algorithm. Since rules are
+ * tried in order, packets selecting actions whose rules have already been
+ * written are "don't care" for the remaining actions. We therefore write the
+ * actions in the order of their decisions in the expression, so that each
+ * class only needs to cover its own condition. The action that gets the
+ * largest share of packets gets the final catch-all rule.
  */
 
 
-static void add_frequencies(const NODE *to,const NODE *from)
-{
-    int i;
+struct cube {
+    struct literal *lit;
+    int lits;
+};
 
-    for (i = 0; i <= num_leaf_edges; i++)
-	to->out_frequency[i] += from->out_frequency[i];
-}
 
-
-static void count_out_frequency(NODE *node)
-{
-    if (!node || node->mark == curr_mark) return;
-    assert(node->bit->type == bt_data);
-    assert(node->in_frequency);
-    node->mark = curr_mark;
-    node->out_frequency =
-      alloc(sizeof(*node->out_frequency)*(num_leaf_edges+1));
-    memset(node->out_frequency,0,
-      sizeof(*node->out_frequency)*(num_leaf_edges+1));
-    if (node->leaf[0]) node->out_frequency[node->leaf[0]]++;
-    else {
-	count_out_frequency(node->edge[0]);
-	add_frequencies(node,node->edge[0]);
-    }
-    if (node->leaf[1]) node->out_frequency[node->leaf[1]]++;
-    else {
-	count_out_frequency(node->edge[1]);
-	add_frequencies(node,node->edge[1]);
-    }
-}
+static struct cube *cubes = NULL;
+static int num_cubes = 0,max_cubes = 0;
 
 
-static void count_frequencies(NODE *root)
+static NODE *bdd_and(NODE *a,NODE *b)
 {
-    root->in_frequency = 1;
-    if (root->bit->type == bt_data) {
-	add_node_todo(root);
-	count_in_frequency();
-    }
-    new_mark();
-    count_out_frequency(root);
+    return ite(a,b,&zero);
 }
 
 
-static void do_clear_frequency_counters(NODE *node)
+static NODE *bdd_or(NODE *a,NODE *b)
 {
-    if (!node || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    node->in_frequency = 0;
-    if (node->bit->type != bt_data) return;
-    free(node->out_frequency);
-    do_clear_frequency_counters(node->edge[0]);
-    do_clear_frequency_counters(node->edge[1]);
+    return ite(a,&one,b);
 }
 
 
-static void clear_frequency_counters(NODE *root)
+static NODE *bdd_and_not(NODE *a,NODE *b)
 {
-    new_mark();
-    do_clear_frequency_counters(root);
+    return ite(b,&zero,a);
 }
 
 
-/* ----- Dump frequency table ---------------------------------------------- */
-
-
-static void do_dump_frequencies(FILE *file,NODE *node)
+static void new_cube(void)
 {
-    int i;
-
-    if (!node || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    fprintf(file,"%3d%6d",node->number,node->in_frequency);
-    if (node->bit->type == bt_data)
-	for (i = 1; i <= num_leaf_edges; i++)
-	    fprintf(file,"%6d",node->out_frequency[i]);
-    fprintf(file,"\n");
-    do_dump_frequencies(file,node->edge[0]);
-    do_dump_frequencies(file,node->edge[1]);
+    if (num_cubes == max_cubes) {
+	max_cubes = max_cubes ? 2*max_cubes : 64;
+	cubes = realloc(cubes,sizeof(struct cube)*max_cubes);
+	if (!cubes) {
+	    perror("realloc");
+	    exit(1);
+	}
+    }
+    cubes[num_cubes].lit = alloc(sizeof(struct literal)*(num_vars+1));
+    cubes[num_cubes].lits = 0;
+    num_cubes++;
 }
 
 
-static void dump_frequencies(NODE *root,const char *label)
+static void add_literal(int from,int var,int value)
 {
     int i;
 
-    if (debug < 2) return;
-    fprintf(stderr,"----- %s -----\n",label);
-    fprintf(stderr,"BIT in___");
-    for (i = 1; i <= num_leaf_edges; i++)
-	fprintf(stderr,"%4d.%d",edges[i].border->number,edges[i].edge);
-    fprintf(stderr,"\n");
-    new_mark();
-    do_dump_frequencies(stderr,root);
+    for (i = from; i < num_cubes; i++) {
+	cubes[i].lit[cubes[i].lits].var = var;
+	cubes[i].lit[cubes[i].lits].value = value;
+	cubes[i].lits++;
+    }
 }
 
 
-/* ----- Merge tails ------------------------------------------------------- */
-
-
 /*
- * This is a fairly complex function. It works from the terminals towards the
- * root and combines nodes that reference the same sub-trees, e.g.
- *
- * (0:1)-->(0:2)-->C1
- *   |       |
- *   |       `---->C2
- *   v
- * (0:2)-->C1
- *   |
- *   `---->C2
- *
- * In a first step, it notices that the two nodes testing (0:2) are equivalent,
- * so it replaces them with a single instance, i.e.
- *
- * (0:1)-----.
- *   |       |
- *   |       v
- *   `---->(0:2)-->C1
- *           |
- *           `---->C2
- *
- * Afterwards, it checks whether, by combining the (0:2) nodes, it has found
- * a redundancy. If yes, it replaces all references to (0:1) by references to
- * (0:2), and repeats the same check with the former parents of (0:1).
+ * Adds an irredundant cover of a function f with l <= f <= u to "cubes", and
+ * returns the diagram of the cover.
  */
 
-
-static void record_referer(NODE *referer,int edge)
+static NODE *isop(NODE *l,NODE *u)
 {
-    NODE *node = referer->edge[edge];
-    struct referer *ref;
+    NODE *l0,*l1,*u0,*u1,*tmp,*c0,*c1,*cd,*a,*b,*res;
+    int v,from;
 
-    if (!node) return;
-    if (!node->referers) {
-	node->referers = alloc(sizeof(struct referer)*node->ref);
-	node->num_referers = 0;
+    if (l == &zero) return &zero;
+    if (u == &one) {
+	new_cube();
+	return &one;
     }
-    ref = node->referers+node->num_referers++;
-    ref->node = get_node(referer);
-    ref->edge = edge;
-    ref->anchor = referer->edge+edge;
+    v = top_var(l,u,NULL);
+    l0 = cofactor(l,v,0);
+    l1 = cofactor(l,v,1);
+    u0 = cofactor(u,v,0);
+    u1 = cofactor(u,v,1);
+    from = num_cubes;
+    tmp = bdd_and_not(l0,u1);
+    c0 = isop(tmp,u0);
+    deref(tmp);
+    add_literal(from,v,0);
+    from = num_cubes;
+    tmp = bdd_and_not(l1,u0);
+    c1 = isop(tmp,u1);
+    deref(tmp);
+    add_literal(from,v,1);
+    a = bdd_and_not(l0,c0);
+    b = bdd_and_not(l1,c1);
+    tmp = bdd_or(a,b);
+    deref(a);
+    deref(b);
+    a = bdd_and(u0,u1);
+    cd = isop(tmp,a);
+    deref(tmp);
+    deref(a);
+    res = mk_data(v,bdd_or(c0,cd),bdd_or(c1,cd));
+    deref(c0);
+    deref(c1);
+    deref(cd);
+    return res;
 }
 
 
-static void record_referers(NODE *node)
+/*
+ * Returns the function that is true for all packets selecting action.
+ */
+
+static NODE *select_action(NODE *n,const NODE *action)
 {
-    if (!node || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    record_referer(node,0);
-    record_referer(node,1);
-    record_referers(node->edge[0]);
-    record_referers(node->edge[1]);
+    NODE *res,*lo,*hi;
+
+    if (n->type != nt_data) return n == action ? &one : &zero;
+    res = cache_lookup(op_select,action,n,NULL,NULL);
+    if (res) return res;
+    lo = select_action(n->edge[0],action);
+    hi = select_action(n->edge[1],action);
+    return cache_insert(op_select,action,n,NULL,NULL,mk_data(n->var,lo,hi));
 }
 
 
-static void free_referer_slot(NODE *node,int referer)
+static void topo_sort(NODE *n,NODE ***list)
 {
-    struct referer *ref = node->referers+referer;
-
-    debugf2("free_referer_slot(node %p,referer %d)",node,referer);
-    put_node(ref->node);
-    ref->node = NULL;
-    ref->anchor = NULL;
+    if (n->mark == curr_mark) return;
+    n->mark = curr_mark;
+    n->share = 0;
+    if (n->type != nt_data) return;
+    topo_sort(n->edge[1],list);
+    topo_sort(n->edge[0],list);
+    *--*list = n;
 }
 
 
-static void remove_referer(NODE *referer,int edge)
+static void add_action(NODE *n,NODE **actions,int *num_actions)
 {
-    NODE *node = referer->edge[edge];
-    int i;
-
-    debugf2("remove_referer(referer %p, edge %d, node %p)",referer,edge,node);
-    if (!node) return; /* bt_count */
-    for (i = 0; i < node->num_referers; i++) {
-	struct referer *ref = node->referers+i;
-
-	if (ref->node == referer && ref->edge == edge) {
-	    free_referer_slot(node,i);
-	    return;
-	}
-    }
-    abort();
+    if (n->type == nt_data || n->mark == curr_mark) return;
+    n->mark = curr_mark;
+    actions[(*num_actions)++] = n;
 }
 
 
-static void replace_node(NODE *old,NODE *new)
+static int compare_rank(const void *a,const void *b)
 {
-    int i;
+    const NODE *na = *(const NODE **) a;
+    const NODE *nb = *(const NODE **) b;
 
-    debugf2("replace_node(old %p,new %p)",old,new);
-    get_node(old); /* avoid deallocation before last loop check */
-    new->referers = realloc(new->referers,
-      sizeof(struct referer)*(old->ref+new->ref));
-    if (!new->referers) {
-	perror("realloc");
-	exit(1);
-    }
-    remove_referer(old,0);
-    remove_referer(old,1);
-    for (i = 0; i < old->num_referers; i++) {
-	struct referer *ref = old->referers+i;
-
-	debugf2("| %d: anchor %p",i,ref->anchor);
-	if (ref->anchor) {
-	    struct referer *ref2;
-
-	    put_node(old);
-	    *ref->anchor = get_node(new);
-	    ref2 = new->referers+new->num_referers++;
-	    *ref2 = *ref;
-	    ref->node = NULL;
-	    ref->anchor = NULL;
-	    if (ref2->node && ref2->node->edge[0] == ref2->node->edge[1])
-		replace_node(ref2->node,new);
-	}
-    }
-    put_node(old);
+    if (na->rank != nb->rank) return na->rank-nb->rank;
+    return na->number-nb->number;
 }
 
 
-static void consolidate_nodes(NODE *node);
-
+/*
+ * Returns the actions reached from root, in order of their rank, except for
+ * the one with the largest share of packets, which comes last. We assume that
+ * all bits are equally likely to be zero or one.
+ */
 
-static void consolidate_node(NODE *node,int referer)
+static int sort_actions(NODE *root,NODE **actions)
 {
-    int edge = node->referers[referer].edge;
-    NODE *other = node->referers[referer].node->edge[!edge];
-      /* the inverse of us */
-    int i;
+    NODE **order,**first,**end,**walk,*tmp;
+    int num_actions = 0,best = 0,i;
 
-    debugf2("consolidate_node(node %p,referer %d,other %p)",node,referer,other);
-    if (other && (other->mark != curr_mark || !other->consolidated)) return;
-      /* other node will do the consolidation */
-
-    for (i = referer+1; i < node->num_referers; i++) {
-	struct referer *ref1 = node->referers+referer;
-	struct referer *ref2 = node->referers+i;
-
-	debugf2("| %d: nodes %p, %p",i,ref1->node,ref2->node);
-	assert(ref1->node != ref2->node);
-	if (!ref2->node) continue; /* already removed @@@ ? */
-	if (ref1->node->bit == ref2->node->bit && ref2->edge == edge &&
-	  ref2->node->edge[!edge] == other) {
-	   /*
-	    * Not super-efficient: replace_node does not have to walk both
-	    * lists of referers, because one is always known. Anyway, this
-	    * keeps the code simpler.
-	    */
-	    replace_node(ref2->node,ref1->node);
-	}
+    order = alloc(sizeof(NODE *)*(nodes+1));
+    end = first = order+nodes+1;
+    curr_mark++;
+    topo_sort(root,&first);
+    root->share = 1;
+    for (walk = first; walk != end; walk++) {
+	(*walk)->edge[0]->share += (*walk)->share/2;
+	(*walk)->edge[1]->share += (*walk)->share/2;
     }
+    curr_mark++;
+    add_action(root,actions,&num_actions);
+    for (walk = first; walk != end; walk++) {
+	add_action((*walk)->edge[1],actions,&num_actions);
+	add_action((*walk)->edge[0],actions,&num_actions);
+    }
+    free(order);
+    for (i = 1; i < num_actions; i++)
+	if (actions[i]->share > actions[best]->share) best = i;
+    tmp = actions[best];
+    actions[best] = actions[num_actions-1];
+    actions[num_actions-1] = tmp;
+    qsort(actions,num_actions-1,sizeof(NODE *),compare_rank);
+    return num_actions;
 }
 
 
-static void consolidate_nodes(NODE *node)
+static int compare_fields(const void *a,const void *b)
 {
-    int i;
+    const VAR *va = vars+((const struct literal *) a)->var;
+    const VAR *vb = vars+((const struct literal *) b)->var;
 
-    debugf2("consolidate_nodes(node %p)",node);
-    if (!node) return;
-    if (node->mark == curr_mark) return;
-    get_node(node); /* make sure child doesn't kill us */
-    node->mark = curr_mark;
-    node->consolidated = 0;
-    consolidate_nodes(node->edge[0]);
-    consolidate_nodes(node->edge[1]);
-    node->consolidated = 1;
-
-    /*
-     * Since replace_node may realloc node->referers, we must not keep pointers
-     * to node->referers+i across calls to consolidate_node.
-     */
-    for (i = 0; i < node->num_referers; i++) {
-	debugf2("| %d: node %p",i,node->referers[i].node);
-	if (node->referers[i].node) consolidate_node(node,i);
-    }
-    put_node(node);
+    if (va->offset_group != vb->offset_group)
+	return va->offset_group-vb->offset_group;
+    return va->bit_num-vb->bit_num;
 }
 
 
-static void remove_referers(NODE *node)
+static void dump_match(FILE *file,const struct literal *lit,int length)
 {
-    struct referer *ref;
-
-    if (!node || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    for (ref = node->referers; ref != node->referers+node->num_referers; ref++)
-	if (ref->node) put_node(ref->node);
-    free(node->referers);
-    node->referers = NULL;
-    remove_referers(node->edge[0]);
-    remove_referers(node->edge[1]);
+    int i,curr = 0,first = 1;
+
+    fprintf(file," %d:%d:%d=0x",vars[lit->var].offset_group,
+      vars[lit->var].bit_num,length);
+    for (i = 1; i <= length; i++) {
+	int in_nibble;
+
+	in_nibble = (length-i) & 3;
+	if (lit[i-1].value) curr |= 1 << in_nibble;
+	if (!in_nibble && (curr || !first)) {
+	    fprintf(file,"%x",curr);
+	    first = curr = 0;
+	}
+    }
+    if (first) putc('0',file);
 }
 
 
-static void merge_tails(NODE **root)
+static void dump_match_bin(const struct literal *lit,int length)
 {
-    debugf("merge_tails(&root %p, root %p)",root,*root);
-    new_mark();
-    (*root)->referers = alloc_t(struct referer);
-    (*root)->referers->node = NULL;
-    (*root)->referers->edge = 0;
-    (*root)->referers->anchor = root;
-    (*root)->num_referers = 1;
-    record_referers(*root);
-    if (debug > 1) dump_dag(*root,"After record_referers");
-    validate_references(*root);
-
-    new_mark();
-    consolidate_nodes(*root);
-    if (debug > 1) dump_dag(*root,"After consolidate_nodes");
-    validate_references(*root);
-
-    new_mark();
-    remove_referers(*root);
-    validate_references(*root);
-}
-
+    int value,i;
 
-/* ----- Print out all paths with a give terminal edge --------------------- */
-
-
-int rules;
-
-struct prev {
-    const NODE *node;
-    int edge;
-    const struct prev *prev;
-};
+    ext_bin_field(vars[lit->var].offset_group,vars[lit->var].bit_num,length);
+    value = ext_bin_value(length);
+    for (i = 0; i < length; i++)
+	if (lit[i].value) ext_bin_value_bit(value,length,i);
+}
 
 
-static int print_path(FILE *file,const struct prev *last,
-  const struct prev *curr,int length,int nibble)
+static void dump_cube(FILE *file,struct cube *cube,const NODE *action)
 {
-    if (curr && curr->node->bit->u.data.offset_group ==
-      last->node->bit->u.data.offset_group &&
-      curr->node->bit->u.data.bit_num+length ==
-      last->node->bit->u.data.bit_num) {
-	int non_zero;
-
-	non_zero = print_path(file,last,curr->prev,length+1,
-	  (length & 3 ? nibble : 0) | curr->edge << (length & 3));
-	non_zero = non_zero || nibble;
-	/* print each full nibble we receive */
-	if (!(length & 3) && (length <= 4 || non_zero))
-	    fprintf(file,"%x",nibble);
-	return non_zero;
+    struct literal *lit = cube->lit;
+    int start,i;
+
+    qsort(lit,cube->lits,sizeof(struct literal),compare_fields);
+    if (ext_binary) {
+	ext_bin_begin(file,teb_match);
+	ext_bin_u32(action->number);
     }
-    else {
-	if (curr) print_path(file,curr,curr->prev,1,curr->edge);
-	fprintf(file," %d:%d:%d=0x",last->node->bit->u.data.offset_group,
-	  last->node->bit->u.data.bit_num-length+1,length);
-	if (length <= 4 || nibble) fprintf(file,"%x",nibble);
-	return !!nibble;
+    else fprintf(file,"match");
+    for (start = 0; start < cube->lits; start = i) {
+	for (i = start+1; i < cube->lits; i++)
+	    if (vars[lit[i].var].offset_group !=
+	      vars[lit[start].var].offset_group ||
+	      vars[lit[i].var].bit_num != vars[lit[start].var].bit_num+i-start)
+		break;
+	if (ext_binary) dump_match_bin(lit+start,i-start);
+	else dump_match(file,lit+start,i-start);
     }
+    if (ext_binary) ext_bin_end();
+    else fprintf(file," action %d\n",action->number);
 }
 
 
-static int do_print_with_edge(FILE *file,const struct prev *prev,NODE *node,
-  const NODE *last,int edge)
+static void dump_rules(FILE *file,NODE *root)
 {
-    struct prev this;
-
-    if (node->mark == curr_mark) return 0;
-    if (node->bit->type != bt_data) return 0;
-    this.node = node;
-    this.prev = prev;
-    if (node == last) {
-	this.edge = edge;
-rules++;
-	fprintf(file,"match");
-	print_path(file,&this,prev,1,edge);
-	fprintf(file," action %d\n",last->edge[edge]->action);
-	return 1;
+    NODE **actions,*done = &zero;
+    int num_actions,i,j;
+
+    actions = alloc(sizeof(NODE *)*(nodes+1));
+    num_actions = sort_actions(root,actions);
+    for (i = 0; i < num_actions-1; i++) {
+	NODE *f,*u,*tmp;
+
+	f = select_action(root,actions[i]);
+	u = bdd_or(f,done);
+	num_cubes = 0;
+	deref(isop(f,u));
+	deref(u);
+	for (j = 0; j < num_cubes; j++) {
+	    dump_cube(file,cubes+j,actions[i]);
+	    free(cubes[j].lit);
+	}
+	tmp = bdd_or(done,f);
+	deref(done);
+	deref(f);
+	done = tmp;
     }
-    else {
-	int more;
-
-	this.edge = 0;
-	more = do_print_with_edge(file,&this,node->edge[0],last,edge);
-	this.edge = 1;
-	if (do_print_with_edge(file,&this,node->edge[1],last,edge)) more = 1;
-	if (!more) node->mark = curr_mark;
-	return more;
+    deref(done);
+    if (ext_binary) {
+	ext_bin_begin(file,teb_match);
+	ext_bin_u32(actions[num_actions-1]->number);
+	ext_bin_end();
     }
+    else fprintf(file,"match action %d\n",actions[num_actions-1]->number);
+    free(actions);
 }
 
 
-static void print_with_edge(FILE *file,NODE *root,const NODE *last,int edge)
-{
-    new_mark();
-    if (!do_print_with_edge(file,NULL,root,last,edge)) abort();
-}
-
-
-/* ----- Select the best path for removal ---------------------------------- */
+/* ----- Initialization and cleanup ---------------------------------------- */
 
 
-static void do_select_path(NODE *node,NODE **last,int *edge,double *quality)
+static void bdd_init(void)
 {
     int i;
 
-    if (!node || node->bit->type != bt_data || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    do_select_path(node->edge[0],last,edge,quality);
-    do_select_path(node->edge[1],last,edge,quality);
-    for (i = 1; i <= num_leaf_edges; i++) {
-	if (node->out_frequency[i]) {
-	    double q;
-	    int out,j;
-
-	    for (j = 1; j <= num_leaf_edges; j++)
-		edges[j].border->edge[edges[j].edge]->bit->scratch = 0;
-	    for (j = 1; j <= num_leaf_edges; j++)
-		if (i != j)
-		    edges[j].border->edge[edges[j].edge]->bit->scratch +=
-		      node->out_frequency[j];
-	    out = 0;
-	    for (j = 1; j <= num_leaf_edges; j++)
-		if (edges[j].border->edge[edges[j].edge]->bit->scratch > out)
-		    out = edges[j].border->edge[edges[j].edge]->bit->scratch;
-	    q = (double) node->in_frequency*
-	      (double) (out-node->out_frequency[i]-1);
-	    if (q > *quality) {
-//fprintf(stderr,"SELECT: node %p, edge %d, q %f\n",node,i,(float) q);
-		*quality = q;
-		*last = edges[i].border;
-		*edge = edges[i].edge;
-	    }
-	}
-    }
-//    assert(best_i);
-    assert(node->in_frequency);
-}
-#if 0
-static void do_select_path(NODE *node,NODE **last,int *edge,double *quality)
-{
-    double q;
-    int i,best_i = 0,best_out = 1 << 30;
-    int total = 0;
-
-    if (!node || node->bit->type != bt_data || node->mark == curr_mark) return;
-    node->mark = curr_mark;
-    do_select_path(node->edge[0],last,edge,quality);
-    do_select_path(node->edge[1],last,edge,quality);
-    for (i = 1; i <= num_leaf_edges; i++)
-	if (node->out_frequency[i]) {
-	    int out,j;
-
-	    out = 0;
-	    total += node->out_frequency[i];
-	    for (j = 1; j <= num_leaf_edges; j++)
-		if (edges[i].border->edge[edges[i].edge]->bit ==
-		  edges[j].border->edge[edges[j].edge]->bit)
-		    out += node->out_frequency[j];
-//	    if (out < best_out) {
-//		best_out = out;
-//	    out = node->out_frequency[i];
-//	out = edges[i].border->in_frequency;
-//fprintf(stderr,"%d*%d=%d\n",node->out_frequency[i],edges[i].border->in_frequency,out);
-	    if (out < best_out) {
-		best_out = out;
-		best_i = i;
-	    }
-	}
-    assert(best_i);
-    assert(node->in_frequency);
-//    q = (double) (total-best_out)/(double) best_out/log((double) node->in_frequency);
-//    q = (double) total/((double) node->out_frequency[best_i]*
-//     (double) edges[best_i].border->in_frequency);
-//    q = (double) total/(double) best_out/log(node->in_frequency);
-    q = (double) total/(double) best_out/sqrt(node->in_frequency);
-//    q = (double) total/(double) best_out/(double) node->in_frequency;
-//    q = (double) (total-best_out)/
-//      ((double) best_out*(double) node->in_frequency);
-#if 0
-fprintf(stderr,"total %d, out[%d] %d, in %d = q %f\n",total,best_i,
-  node->out_frequency[best_i],node->in_frequency,(float) q);
-#endif
-    if (q > *quality) {
-	*quality = q;
-	*last = edges[best_i].border;
-	*edge = edges[best_i].edge;
-    }
+    if (!cache) cache = alloc(sizeof(struct cache_entry)*BDD_CACHE);
+    clear_cache();
+    for (i = 0; i < VAR_HASH; i++) var_hash[i] = -1;
+    init_table(&actions);
+    gc_threshold = BDD_GC_NODES;
 }
-#endif
 
 
-static void select_path(NODE *root,NODE **last,int *edge)
+static void free_table(struct table *t)
 {
-    double quality = -1e30;
-
-#if 1
-    new_mark();
-    do_select_path(root,last,edge,&quality);
-    debugf("do_select_path selected %p %d (%f)",*last,*edge,(float) quality);
-#else
-    while (!root->leaf[0]) root = root->edge[0];
-    *last = root;
-    *edge = 0;
-#endif
+    sweep_table(t);
+    assert(!t->nodes);
+    free(t->bucket);
 }
 
 
-/* ----- Remove an edge from the DAG and optimize the result --------------- */
-
-
-static NODE *remove_edge(NODE *node,const NODE *last,int edge)
+static void bdd_cleanup(void)
 {
-    if (node->bit->type != bt_data || node->mark == curr_mark) return node;
-    if (node == last) {
-	put_node(node->edge[edge]);
-	node->edge[edge] = get_node(node->edge[1-edge]);
-    }
-    else {
-	node->edge[0] = remove_edge(node->edge[0],last,edge);
-	node->edge[1] = remove_edge(node->edge[1],last,edge);
-    }
-    if (node->edge[0] == node->edge[1]) {
-	NODE *next;
+    int i;
 
-	next = get_node(node->edge[0]);
-	put_node(node);
-	return next;
-    }
-    else {
-	node->mark = curr_mark;
-	return node;
+    for (i = 0; i < num_vars; i++) free_table(&vars[i].table);
+    free_table(&actions);
+    assert(!nodes && !dead);
+    while (free_nodes) {
+	NODE *next = free_nodes->next;
+
+	free(free_nodes);
+	free_nodes = next;
     }
-    
+    num_vars = 0;
 }
 
 
-/* ----- Extract paths from DAG -------------------------------------------- */
+/* ----- Entry point ------------------------------------------------------- */
 
 
-static void extract_paths(FILE *file,NODE *root)
+void iflib_newbit(FILE *file,QDISC *qdisc,DATA d)
 {
-rules = 1;
-    number_actions(root);
-    while (root->bit->type == bt_data) {
-	NODE *last;
-	int edge;
-
-	merge_tails(&root);
-	dump_dag(root,"After merge_tails");
-	validate_references(root);
-print_timer("# tails merged");
-
-	number_leaf_edges(root);
-	  /* sigh, merge_tails and remove_edge change this */
-	debugf("counts: %d data nodes, %d leaf edges, %d action peers",
-	  num_data_nodes,num_leaf_edges,num_action_peers);
-	count_frequencies(root);
-	dump_frequencies(root,"After count_frequencies");
-	select_path(root,&last,&edge);
-	clear_frequency_counters(root);
-	print_with_edge(file,root,last,edge);
-	new_mark();
-	root = remove_edge(root,last,edge);
-	dump_dag(root,"After remove_edge (%p,%d)",last,edge);
-#if 0
-exit(1);
-#endif
-	validate_dag(root);
+    NODE *cont,*root;
+    int number;
+
+    bdd_init();
+    rank_decisions(d);
+    rank_decision(data_decision(dr_continue,NULL));
+    cont = mk_action(nt_decision,NULL,data_decision(dr_continue,NULL),NULL,
+      NULL);
+    root = build(d,cont,cont,0);
+    deref(cont);
+    debug_bdd("after build",root);
+    if (registry_probe(&optimization_switches,"sift")) {
+	sift();
+	debug_bdd("after sift",root);
     }
-    fprintf(file,"match action %d\n",root->action);
-fprintf(stderr,"# %d rules !\n",rules);
+    number = 0;
+    curr_mark++;
+    number_actions(file,qdisc,root,&number);
+    number = 1;
+    curr_mark++;
+    dump_bits(file,root,&number);
+    dump_rules(file,root);
+    deref(root);
+    unrank_decisions();
+    bdd_cleanup();
 }
 
 
-/* ------------------------------------------------------------------------- */
-
-
-void iflib_newbit(FILE *file,DATA d)
-{
-    NODE *dag;
-
-    start_timer();
-    dag = make_dag(d,NULL,NULL,0);
-    dump_dag(dag,"After make_dag");
-    validate_references(dag);
-
-    sort_dag(&dag);
-    dump_dag(dag,"After sort_dag");
-    validate_dag(dag);
-
-    print_timer("# new bit after sort_dag");
-//    extract_paths(file,dag);
-    extract_paths(stderr,dag);
-    print_timer("# new bit done");
-    exit(1);
-}
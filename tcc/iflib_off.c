@@ -16,6 +16,7 @@
 #include "field.h"
 #include "tc.h"
 #include "iflib.h"
+#include "stats.h"
 
 #include "tccmeta.h"
 
@@ -396,6 +397,7 @@ static void push_offset(DATA *d)
 
 void iflib_offset(DATA *d,int for_u32)
 {
+    stats_begin("iflib_offset",NULL);
     use_offset(d);
     debug_expr("AFTER use_offset",*d);
     bubble_roots(d,for_u32);
@@ -408,4 +410,5 @@ void iflib_offset(DATA *d,int for_u32)
     }
     push_offset(d);
     debug_expr("AFTER push_offset",*d);
+    stats_end();
 }
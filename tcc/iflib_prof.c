@@ -0,0 +1,303 @@
+/*
+ * iflib_prof.c - Profile-guided ordering of alternatives
+ */
+
+/*
+ * A profile is a text file with one line per class:
+ *
+ *   [device] major:minor packets
+ *
+ * where "packets" is the number of packets that were classified into that
+ * class, e.g. as counted in the output of tcsim -v. Instead of major:minor,
+ * "drop" stands for packets that were dropped. Lines without a device name
+ * apply to all devices. Empty lines and lines beginning with # are ignored.
+ *
+ * iflib_profile moves alternatives that lead to frequently used classes
+ * towards the beginning of the expression, so that u32 and external
+ * classifiers find them after fewer tests. An alternative is only moved past
+ * another one if the two can never match the same packet, or if both have
+ * the same action. Therefore, first-match semantics are preserved.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <u128.h>
+
+#include "config.h"
+#include "util.h"
+#include "error.h"
+#include "data.h"
+#include "tree.h"
+#include "op.h"
+#include "iflib.h"
+
+
+/* ----- Profile file ------------------------------------------------------ */
+
+
+static struct prof_entry {
+    char *device;		/* NULL if any */
+    int drop;			/* non-zero if entry is for "drop" */
+    uint32_t major,minor;
+    unsigned long packets;
+    struct prof_entry *next;
+} *profile = NULL;
+
+static int profile_loaded = 0;
+
+
+static void load_profile(void)
+{
+    FILE *file;
+    char buf[MAX_PROFILE_LINE];
+    int line = 0;
+
+    profile_loaded = 1;
+    file = fopen(profile_file,"r");
+    if (!file) {
+	perror(profile_file);
+	exit(1);
+    }
+    while (fgets(buf,sizeof(buf),file)) {
+	struct prof_entry *entry;
+	char *field[3];
+	char *p = buf,*end;
+	int n = 0;
+
+	line++;
+	while (n < 3) {
+	    while (isspace(*p)) p++;
+	    if (!*p || *p == '#') break;
+	    field[n++] = p;
+	    while (*p && !isspace(*p)) p++;
+	    if (*p) *p++ = 0;
+	}
+	while (isspace(*p)) p++;
+	if (!n) continue;
+	if (n == 1 || (*p && *p != '#'))
+	    errorf("%s:%d: invalid profile entry",profile_file,line);
+	entry = alloc_t(struct prof_entry);
+	entry->device = n == 3 ? stralloc(field[0]) : NULL;
+	entry->drop = !strcmp(field[n-2],"drop");
+	if (!entry->drop) {
+	    entry->major = strtoul(field[n-2],&end,16);
+	    if (*end != ':')
+		errorf("%s:%d: invalid class ID \"%s\"",profile_file,line,
+		  field[n-2]);
+	    entry->minor = strtoul(end+1,&end,16);
+	    if (*end)
+		errorf("%s:%d: invalid class ID \"%s\"",profile_file,line,
+		  field[n-2]);
+	}
+	entry->packets = strtoul(field[n-1],&end,0);
+	if (*end)
+	    errorf("%s:%d: invalid packet count \"%s\"",profile_file,line,
+	      field[n-1]);
+	entry->next = profile;
+	profile = entry;
+    }
+    if (ferror(file)) {
+	perror(profile_file);
+	exit(1);
+    }
+    (void) fclose(file);
+}
+
+
+static unsigned long decision_packets(const char *device,DATA d)
+{
+    const struct prof_entry *entry;
+    const CLASS *class = d.u.decision.class;
+    unsigned long sum = 0;
+
+    for (entry = profile; entry; entry = entry->next) {
+	if (entry->device && strcmp(entry->device,device)) continue;
+	if (d.u.decision.result == dr_drop) {
+	    if (entry->drop) sum += entry->packets;
+	    continue;
+	}
+	if (entry->drop || !class) continue;
+	if (entry->major == class->parent.qdisc->number &&
+	  entry->minor == class->number)
+	    sum += entry->packets;
+    }
+    return sum;
+}
+
+
+static unsigned long action_packets(const char *device,DATA d)
+{
+    if (d.type == dt_decision) return decision_packets(device,d);
+    if (!d.op) return 0;
+    return action_packets(device,d.op->a)+action_packets(device,d.op->b)+
+      action_packets(device,d.op->c);
+}
+
+
+/* ----- Alternatives ------------------------------------------------------ */
+
+
+struct test {
+    DATA access;
+    U128 value,mask;
+};
+
+struct alt {
+    DATA d;
+    DATA action;
+    int fixed;			/* never move anything past this one */
+    unsigned long packets;
+    struct test *tests;
+    int n_tests;
+};
+
+
+static int is_constant(DATA d)
+{
+    return !d.op && (d.type == dt_unum || d.type == dt_ipv6);
+}
+
+
+/*
+ * Record tests of the form  access == constant  or
+ * (access & constant) == constant, which is all we need to tell that two
+ * alternatives are disjoint. Other terms are simply ignored.
+ */
+
+static void add_test(struct alt *alt,DATA d)
+{
+    DATA constant,var;
+    U128 mask;
+    int default_mask = 1;
+    struct test *test;
+
+    if (!d.op || d.op->dsc != &op_eq) return;
+    if (is_constant(d.op->a)) {
+	constant = d.op->a;
+	var = d.op->b;
+    }
+    else {
+	if (!is_constant(d.op->b)) return;
+	constant = d.op->b;
+	var = d.op->a;
+    }
+    mask = u128_not(u128_from_32(0));
+    if (var.op && var.op->dsc == &op_and) {
+	if (is_constant(var.op->b)) {
+	    mask = data_convert(var.op->b,dt_ipv6).u.u128;
+	    var = var.op->a;
+	}
+	else {
+	    if (!is_constant(var.op->a)) return;
+	    mask = data_convert(var.op->a,dt_ipv6).u.u128;
+	    var = var.op->b;
+	}
+	default_mask = 0;
+    }
+    if (!var.op || var.op->dsc != &op_access) return;
+    if (var.op->c.op || var.op->c.type != dt_unum) return;
+    if (default_mask) mask = u128_shift_right(mask,128-var.op->c.u.unum);
+    alt->tests = realloc(alt->tests,(alt->n_tests+1)*sizeof(struct test));
+    if (!alt->tests) {
+	perror("realloc");
+	exit(1);
+    }
+    test = alt->tests+alt->n_tests++;
+    test->access = var;
+    test->value = data_convert(constant,dt_ipv6).u.u128;
+    test->mask = mask;
+}
+
+
+static void make_alt(const char *device,struct alt *alt,DATA d)
+{
+    alt->d = d;
+    alt->tests = NULL;
+    alt->n_tests = 0;
+    while (d.op && d.op->dsc == &op_logical_and && !action_tree(d)) {
+	add_test(alt,d.op->a);
+	d = d.op->b;
+    }
+    alt->action = d;
+    alt->fixed = !action_tree(d) || self_contained(d) != sc_yes;
+    alt->packets = alt->fixed ? 0 : action_packets(device,d);
+}
+
+
+static int disjoint(const struct alt *a,const struct alt *b)
+{
+    int i,j;
+
+    for (i = 0; i < a->n_tests; i++)
+	for (j = 0; j < b->n_tests; j++) {
+	    const struct test *ta = a->tests+i,*tb = b->tests+j;
+
+	    if (!expr_equal(ta->access,tb->access)) continue;
+	    if (!u128_is_zero(u128_and(u128_xor(ta->value,tb->value),
+	      u128_and(ta->mask,tb->mask))))
+		return 1;
+	}
+    return 0;
+}
+
+
+static int independent(const struct alt *a,const struct alt *b)
+{
+    if (a->fixed || b->fixed) return 0;
+    return expr_equal(a->action,b->action) || disjoint(a,b);
+}
+
+
+/* ----- Reordering -------------------------------------------------------- */
+
+
+void iflib_profile(const FILTER *filter,DATA *d)
+{
+    const char *device = filter->parent.device->name;
+    struct alt *alts,tmp;
+    OP **ors;
+    DATA walk;
+    int n = 1,moved = 0;
+    int i,j;
+
+    if (!profile_file) return;
+    if (!profile_loaded) load_profile();
+    for (walk = *d; walk.op && walk.op->dsc == &op_logical_or;
+      walk = walk.op->b)
+	n++;
+    if (n < 2) return;
+    alts = alloc(n*sizeof(struct alt));
+    ors = alloc((n-1)*sizeof(OP *));
+    walk = *d;
+    for (i = 0; i < n-1; i++) {
+	ors[i] = walk.op;
+	make_alt(device,alts+i,walk.op->a);
+	walk = walk.op->b;
+    }
+    make_alt(device,alts+n-1,walk);
+
+    /*
+     * Insertion sort, where we only swap neighbours that are independent of
+     * each other. Alternatives with the same number of packets keep their
+     * order.
+     */
+    for (i = 1; i < n; i++)
+	for (j = i; j && alts[j-1].packets < alts[j].packets &&
+	  independent(alts+j-1,alts+j); j--) {
+	    tmp = alts[j-1];
+	    alts[j-1] = alts[j];
+	    alts[j] = tmp;
+	    moved++;
+	}
+    debugf("iflib_profile: %d alternatives, %d swaps",n,moved);
+    for (i = 0; i < n-1; i++) ors[i]->a = alts[i].d;
+    ors[n-2]->b = alts[n-1].d;
+    for (i = 0; i < n; i++) free(alts[i].tests);
+    free(alts);
+    free(ors);
+    debug_expr("AFTER iflib_profile",*d);
+}
@@ -0,0 +1,687 @@
+/*
+ * iflib_range.c - Turn ranges of field values into value/mask matches
+ */
+
+/*
+ * After rel_access, each relational test has the form  (X & M) rel C . If M
+ * is a contiguous block of bits, the values  X & M  can take form a range of
+ * integers, and every test, or combination of tests, on the same  X & M
+ * selects a set of intervals in that range. E.g.
+ *
+ *   tcp_dport >= 1000 && tcp_dport <= 2000
+ *
+ * selects the interval [1000,2000]. rel_general would turn each relation
+ * into its own chain of matches, and iflib_normalize then multiplies them
+ * out, which yields a lot of matches that test more bits than necessary.
+ * Instead, we turn the whole set into the smallest list of prefix matches
+ * that covers it. (An interval of a w bit field never needs more than 2w-2
+ * prefixes.)
+ *
+ * Note that testing the complement of the set with  !=  may need fewer
+ * prefixes, but a chain of  !=  makes iflib_normalize and iflib_actions
+ * multiply out all the rules that follow, so we never do this.
+ *
+ * This happens in two passes:
+ *
+ * - merge_alternatives looks for adjacent alternatives of an || chain that
+ *   are identical except for the range of the same  X & M , e.g. filter
+ *   elements that select the same class for adjacent port ranges. They
+ *   become a single alternative with the union of these ranges.
+ * - cover_ranges combines the tests on the same  X & M  in each && or ||
+ *   chain, and replaces them with the prefix cover of their set.
+ *
+ * Tests never move across terms with side-effects, and alternatives are only
+ * merged if they have no side-effects other than the decision at their end.
+ */
+
+
+#include <stdlib.h>
+
+#include <u128.h>
+
+#include "util.h"
+#include "data.h"
+#include "op.h"
+#include "iflib.h"
+
+
+struct interval {
+    U128 lo,hi;
+};
+
+struct range {
+    DATA operand;		/* X & M, in the expression */
+    int shift;			/* lowest bit set in M */
+    U128 max;			/* M >> shift */
+    struct interval *iv;	/* sorted, disjoint, and not adjacent */
+    int n;
+    int alloc;
+    int leaves;			/* number of relational tests */
+    int inequality;		/* any <, <=, >, >= among them */
+};
+
+
+/* ----- Interval sets ----------------------------------------------------- */
+
+
+static void range_init(struct range *r)
+{
+    r->iv = NULL;
+    r->n = r->alloc = 0;
+    r->leaves = r->inequality = 0;
+}
+
+
+static void range_free(struct range *r)
+{
+    free(r->iv);
+}
+
+
+static void range_add(struct range *r,U128 lo,U128 hi)
+{
+    if (r->n == r->alloc) {
+	r->alloc = r->alloc ? r->alloc*2 : 4;
+	r->iv = realloc(r->iv,r->alloc*sizeof(struct interval));
+	if (!r->iv) {
+	    perror("realloc");
+	    exit(1);
+	}
+    }
+    r->iv[r->n].lo = lo;
+    r->iv[r->n].hi = hi;
+    r->n++;
+}
+
+
+static int comp_interval(const void *a,const void *b)
+{
+    return u128_cmp(((const struct interval *) a)->lo,
+      ((const struct interval *) b)->lo);
+}
+
+
+/*
+ * Sorts the intervals and merges the ones that overlap or touch.
+ */
+
+static void range_merge(struct range *r)
+{
+    int i,n = 0;
+
+    if (!r->n) return;
+    qsort(r->iv,r->n,sizeof(struct interval),comp_interval);
+    for (i = 1; i < r->n; i++) {
+	struct interval *last = r->iv+n;
+
+	if (u128_cmp(r->iv[i].lo,last->hi) <= 0 ||
+	  !u128_cmp(r->iv[i].lo,u128_add_32(last->hi,1))) {
+	    if (u128_cmp(r->iv[i].hi,last->hi) > 0) last->hi = r->iv[i].hi;
+	}
+	else r->iv[++n] = r->iv[i];
+    }
+    r->n = n+1;
+}
+
+
+static void range_union(struct range *r,const struct range *b)
+{
+    int i;
+
+    for (i = 0; i != b->n; i++)
+	range_add(r,b->iv[i].lo,b->iv[i].hi);
+    range_merge(r);
+    r->leaves += b->leaves;
+    r->inequality |= b->inequality;
+}
+
+
+static void range_intersect(struct range *r,const struct range *b)
+{
+    struct interval *iv = r->iv;
+    int n = r->n,i = 0,j = 0;
+
+    r->iv = NULL;
+    r->n = r->alloc = 0;
+    while (i != n && j != b->n) {
+	U128 lo,hi;
+
+	lo = u128_cmp(iv[i].lo,b->iv[j].lo) > 0 ? iv[i].lo : b->iv[j].lo;
+	hi = u128_cmp(iv[i].hi,b->iv[j].hi) < 0 ? iv[i].hi : b->iv[j].hi;
+	if (u128_cmp(lo,hi) <= 0) range_add(r,lo,hi);
+	if (u128_cmp(iv[i].hi,b->iv[j].hi) < 0) i++;
+	else j++;
+    }
+    free(iv);
+    r->leaves += b->leaves;
+    r->inequality |= b->inequality;
+}
+
+
+static int range_full(const struct range *r)
+{
+    return r->n == 1 && u128_is_zero(r->iv[0].lo) &&
+      !u128_cmp(r->iv[0].hi,r->max);
+}
+
+
+/* ----- Recognize ranges -------------------------------------------------- */
+
+
+static int is_const(DATA d)
+{
+    return !d.op && (d.type == dt_unum || d.type == dt_ipv6);
+}
+
+
+static int lowest_bit(U128 v)
+{
+    int i;
+
+    for (i = 0; i != 128; i++)
+	if (u128_shift_right(v,i).v[0] & 1) return i;
+    return -1;
+}
+
+
+/*
+ * Returns non-zero if d is a relational test on  X & M , where M is a
+ * contiguous block of bits, and sets r to the set of values it accepts.
+ * Values are shifted right such that the lowest bit of M becomes bit 0.
+ */
+
+static int leaf_range(DATA d,struct range *r)
+{
+    const OP_DSC *dsc;
+    U128 mask,c,floor,ceil;
+
+    if (!d.op) return 0;
+    dsc = d.op->dsc;
+    if (dsc != &op_eq && dsc != &op_lt && dsc != &op_le && dsc != &op_gt &&
+      dsc != &op_ge)
+	return 0;
+    if (!d.op->a.op || d.op->a.op->dsc != &op_and ||
+      !is_const(d.op->a.op->b) || !is_const(d.op->b))
+	return 0;
+    mask = data_convert(d.op->a.op->b,dt_ipv6).u.u128;
+    c = data_convert(d.op->b,dt_ipv6).u.u128;
+    range_init(r);
+    r->operand = d.op->a;
+    r->shift = lowest_bit(mask);
+    if (r->shift < 0) return 0;
+    r->max = u128_shift_right(mask,r->shift);
+    if (!u128_is_zero(u128_and(r->max,u128_add_32(r->max,1)))) return 0;
+    if (u128_cmp(c,mask) > 0) return 0; /* rel_access took care of this */
+    floor = u128_shift_right(c,r->shift);
+    ceil = floor;
+    if (!u128_is_zero(u128_and(c,u128_sub_32(
+      u128_shift_left(u128_from_32(1),r->shift),1))))
+	ceil = u128_add_32(ceil,1);
+    r->leaves = 1;
+    r->inequality = dsc != &op_eq;
+    if (dsc == &op_eq) {
+	if (u128_cmp(floor,ceil)) return 0; /* rel_access took care of this */
+	range_add(r,floor,floor);
+    }
+    else if (dsc == &op_lt) {
+	if (!u128_is_zero(ceil))
+	    range_add(r,u128_from_32(0),u128_sub_32(ceil,1));
+    }
+    else if (dsc == &op_le) range_add(r,u128_from_32(0),floor);
+    else if (dsc == &op_gt) {
+	if (u128_cmp(floor,r->max)) range_add(r,u128_add_32(floor,1),r->max);
+    }
+    else range_add(r,ceil,r->max);
+    return 1;
+}
+
+
+/*
+ * Returns non-zero if d only consists of relational tests on the same
+ * X & M , combined with && and || , and sets r to the set of values it
+ * accepts.
+ */
+
+static int get_range(DATA d,struct range *r)
+{
+    struct range b;
+
+    if (!d.op) return 0;
+    if (d.op->dsc != &op_logical_and && d.op->dsc != &op_logical_or)
+	return leaf_range(d,r);
+    if (!get_range(d.op->a,r)) return 0;
+    if (!get_range(d.op->b,&b)) {
+	range_free(r);
+	return 0;
+    }
+    if (!expr_equal(r->operand,b.operand)) {
+	range_free(r);
+	range_free(&b);
+	return 0;
+    }
+    if (d.op->dsc == &op_logical_and) range_intersect(r,&b);
+    else range_union(r,&b);
+    range_free(&b);
+    return 1;
+}
+
+
+/* ----- Build expressions ------------------------------------------------- */
+
+
+static DATA constant(U128 v)
+{
+    return u128_is_32(v) ? data_unum(u128_to_32(v)) : data_ipv6(v);
+}
+
+
+static DATA join(const OP_DSC *dsc,DATA a,DATA b)
+{
+    if (a.type == dt_none) return b;
+    return op_binary(dsc,a,b);
+}
+
+
+static DATA compare(const OP_DSC *dsc,const struct range *r,U128 value)
+{
+    return op_binary(dsc,data_clone(r->operand),
+      constant(u128_shift_left(value,r->shift)));
+}
+
+
+/*
+ * Expresses r with relational operators on  X & M , so that get_range can
+ * find it again.
+ */
+
+static DATA range_expr(const struct range *r)
+{
+    DATA d = data_none();
+    int i;
+
+    if (!r->n) return data_unum(0);
+    if (range_full(r)) return data_unum(1);
+    for (i = 0; i != r->n; i++) {
+	const struct interval *iv = r->iv+i;
+	DATA t = data_none();
+
+	if (!u128_cmp(iv->lo,iv->hi)) t = compare(&op_eq,r,iv->lo);
+	else {
+	    if (!u128_is_zero(iv->lo)) t = compare(&op_ge,r,iv->lo);
+	    if (u128_cmp(iv->hi,r->max))
+		t = join(&op_logical_and,t,compare(&op_le,r,iv->hi));
+	}
+	d = join(&op_logical_or,d,t);
+    }
+    return d;
+}
+
+
+/*
+ * Splits the intervals of r into aligned blocks of power-of-two size. If d
+ * is non-NULL, adds the test  (X & M') == value  for each block to d, where
+ * M' only has the bits of M that are the same in the whole block. Returns the
+ * number of blocks.
+ */
+
+static int prefixes(const struct range *r,DATA *d)
+{
+    int i,n = 0;
+
+    for (i = 0; i != r->n; i++) {
+	U128 lo = r->iv[i].lo;
+
+	while (1) {
+	    U128 size_1; /* block size - 1 */
+	    int bits;
+
+	    bits = lowest_bit(lo);
+	    if (bits < 0) bits = 128;
+	    while (1) {
+		size_1 = u128_sub_32(u128_shift_left(u128_from_32(1),bits),1);
+		if (u128_cmp(size_1,u128_sub(r->iv[i].hi,lo)) <= 0) break;
+		bits--;
+	    }
+	    n++;
+	    if (d) {
+		U128 mask = u128_and(r->max,u128_not(size_1));
+
+		*d = join(&op_logical_or,*d,op_binary(&op_eq,
+		  op_binary(&op_and,data_clone(r->operand.op->a),
+		    constant(u128_shift_left(mask,r->shift))),
+		  constant(u128_shift_left(lo,r->shift))));
+	    }
+	    if (!u128_cmp(u128_add(lo,size_1),r->iv[i].hi)) break;
+	    lo = u128_add_32(u128_add(lo,size_1),1);
+	}
+    }
+    return n;
+}
+
+
+static int cover_size(const struct range *r)
+{
+    return prefixes(r,NULL);
+}
+
+
+static DATA cover_expr(const struct range *r)
+{
+    DATA d = data_none();
+
+    if (!r->n) return data_unum(0);
+    if (range_full(r)) return data_unum(1);
+    prefixes(r,&d);
+    return d;
+}
+
+
+/* ----- Chains ------------------------------------------------------------ */
+
+
+struct chain {
+    DATA **slot;		/* operands of the chain, in the expression */
+    int n;
+    int alloc;
+};
+
+
+static void add_slot(struct chain *c,DATA *slot)
+{
+    if (c->n == c->alloc) {
+	c->alloc = c->alloc ? c->alloc*2 : 8;
+	c->slot = realloc(c->slot,c->alloc*sizeof(DATA *));
+	if (!c->slot) {
+	    perror("realloc");
+	    exit(1);
+	}
+    }
+    c->slot[c->n++] = slot;
+}
+
+
+static void get_chain(struct chain *c,DATA *d,const OP_DSC *dsc)
+{
+    if (d->op && d->op->dsc == dsc) {
+	get_chain(c,&d->op->a,dsc);
+	get_chain(c,&d->op->b,dsc);
+    }
+    else add_slot(c,d);
+}
+
+
+static void destroy_chain(DATA d,const OP_DSC *dsc)
+{
+    if (!d.op || d.op->dsc != dsc) return;
+    destroy_chain(d.op->a,dsc);
+    destroy_chain(d.op->b,dsc);
+    data_destroy_1(d);
+}
+
+
+/*
+ * Rebuilds the chain at d from the operands that are not of type dt_none.
+ */
+
+static void rebuild_chain(DATA *d,const OP_DSC *dsc,const struct chain *c)
+{
+    DATA *values,res = data_none();
+    int i;
+
+    values = alloc(sizeof(DATA)*c->n);
+    for (i = 0; i != c->n; i++) {
+	values[i] = *c->slot[i];
+	*c->slot[i] = data_none(); /* don't destroy operands that are chains */
+    }
+    destroy_chain(*d,dsc);
+    for (i = 0; i != c->n; i++)
+	if (values[i].type != dt_none || values[i].op)
+	    res = join(dsc,res,values[i]);
+    free(values);
+    *d = res;
+}
+
+
+/*
+ * Finds the operands of the chain that are ranges, and combines the ranges of
+ * operands that test the same  X & M  into the one of the first such
+ * operand. head[i] is the first operand of the group of operand i, or -1 if
+ * operand i is not a range. Groups end at operands with side-effects.
+ */
+
+static struct range *group_ranges(const struct chain *c,const OP_DSC *dsc,
+  int *head)
+{
+    struct range *r;
+    int i,j;
+
+    r = alloc(sizeof(struct range)*c->n);
+    for (i = 0; i != c->n; i++)
+	head[i] = get_range(*c->slot[i],r+i) ? i : -1;
+    for (i = 0; i != c->n; i++) {
+	if (head[i] != i) continue;
+	for (j = i+1; j != c->n; j++) {
+	    if (head[j] == -1) {
+		if (side_effect(*c->slot[j])) break;
+		continue;
+	    }
+	    if (head[j] != j || !expr_equal(r[i].operand,r[j].operand))
+		continue;
+	    if (dsc == &op_logical_and) range_intersect(r+i,r+j);
+	    else range_union(r+i,r+j);
+	    range_free(r+j);
+	    head[j] = i;
+	}
+    }
+    return r;
+}
+
+
+static void free_ranges(const struct chain *c,struct range *r,const int *head)
+{
+    int i;
+
+    for (i = 0; i != c->n; i++)
+	if (head[i] == i) range_free(r+i);
+    free(r);
+}
+
+
+/*
+ * Replaces the first operand of a group with "new", and removes the others.
+ */
+
+static void replace_group(const struct chain *c,const int *head,int first,
+  DATA new)
+{
+    int i;
+
+    for (i = first; i != c->n; i++)
+	if (head[i] == first) {
+	    data_destroy(*c->slot[i]);
+	    *c->slot[i] = i == first ? new : data_none();
+	}
+}
+
+
+/* ----- Merge alternatives ------------------------------------------------ */
+
+
+static int range_equal(const struct range *a,const struct range *b)
+{
+    int i;
+
+    if (a->n != b->n) return 0;
+    for (i = 0; i != a->n; i++)
+	if (u128_cmp(a->iv[i].lo,b->iv[i].lo) ||
+	  u128_cmp(a->iv[i].hi,b->iv[i].hi))
+	    return 0;
+    return 1;
+}
+
+
+/*
+ * Only the last operand of an alternative may have side-effects, and only if
+ * it is a decision, which ends the evaluation.
+ */
+
+static int pure_alternative(const struct chain *c)
+{
+    int i;
+
+    for (i = 0; i != c->n; i++)
+	if (side_effect(*c->slot[i]) && (i != c->n-1 || c->slot[i]->op ||
+	  c->slot[i]->type != dt_decision))
+	    return 0;
+    return 1;
+}
+
+
+/*
+ * Returns non-zero if the && chains a and b only differ in the set of values
+ * of one  X & M , and changes a such that it accepts the union of both sets.
+ * We only do this if the union has a smaller prefix cover than the two sets.
+ */
+
+static int merge_alternative(DATA *a,DATA b)
+{
+    struct chain ca = { NULL, 0, 0 },cb = { NULL, 0, 0 };
+    struct range *ra = NULL,*rb = NULL;
+    int *ha = NULL,*hb = NULL;
+    int i,j,diff_a = -1,diff_b = -1,ok = 0;
+
+    get_chain(&ca,a,&op_logical_and);
+    get_chain(&cb,&b,&op_logical_and);
+    if (ca.n != cb.n || !pure_alternative(&ca) || !pure_alternative(&cb))
+	goto out;
+    ha = alloc(sizeof(int)*ca.n);
+    hb = alloc(sizeof(int)*cb.n);
+    ra = group_ranges(&ca,&op_logical_and,ha);
+    rb = group_ranges(&cb,&op_logical_and,hb);
+    i = j = 0;
+    while (1) {
+	while (i != ca.n && ha[i] != -1 && ha[i] != i) i++;
+	while (j != cb.n && hb[j] != -1 && hb[j] != j) j++;
+	if (i == ca.n || j == cb.n) break;
+	if ((ha[i] == -1) != (hb[j] == -1)) goto out;
+	if (ha[i] == -1) {
+	    if (!expr_equal(*ca.slot[i],*cb.slot[j])) goto out;
+	}
+	else {
+	    if (!expr_equal(ra[i].operand,rb[j].operand)) goto out;
+	    if (!range_equal(ra+i,rb+j)) {
+		if (diff_a != -1) goto out;
+		diff_a = i;
+		diff_b = j;
+	    }
+	}
+	i++;
+	j++;
+    }
+    if (i != ca.n || j != cb.n || diff_a == -1) goto out;
+    i = cover_size(ra+diff_a)+cover_size(rb+diff_b);
+    range_union(ra+diff_a,rb+diff_b);
+    if (cover_size(ra+diff_a) < i) {
+	replace_group(&ca,ha,diff_a,range_expr(ra+diff_a));
+	rebuild_chain(a,&op_logical_and,&ca);
+	ok = 1;
+    }
+out:
+    if (ra) free_ranges(&ca,ra,ha);
+    if (rb) free_ranges(&cb,rb,hb);
+    free(ha);
+    free(hb);
+    free(ca.slot);
+    free(cb.slot);
+    return ok;
+}
+
+
+static void merge_alternatives(DATA *d)
+{
+    struct chain c = { NULL, 0, 0 };
+    int i,j,changed = 0;
+
+    if (!d->op) return;
+    if (d->op->dsc != &op_logical_and && d->op->dsc != &op_logical_or) {
+	merge_alternatives(&d->op->a);
+	merge_alternatives(&d->op->b);
+	merge_alternatives(&d->op->c);
+	return;
+    }
+    get_chain(&c,d,d->op->dsc);
+    for (i = 0; i != c.n; i++)
+	merge_alternatives(c.slot[i]);
+    if (d->op->dsc == &op_logical_or)
+	for (i = 0; i < c.n-1; i++) {
+	    if (c.slot[i]->type == dt_none && !c.slot[i]->op) continue;
+	    for (j = i+1; j != c.n; j++) {
+		if (!merge_alternative(c.slot[i],*c.slot[j])) break;
+		data_destroy(*c.slot[j]);
+		*c.slot[j] = data_none();
+		changed = 1;
+	    }
+	}
+    if (changed) rebuild_chain(d,&op_logical_or,&c);
+    free(c.slot);
+}
+
+
+/* ----- Cover ranges ------------------------------------------------------ */
+
+
+static void cover_ranges(DATA *d);
+
+
+/*
+ * Single tests are left to rel_to_eq and rel_general, which already find the
+ * optimum for them. So are sets of  ==  that have no shorter cover, and we
+ * then also leave the order of tests alone.
+ */
+
+static void cover_chain(DATA *d,const OP_DSC *dsc)
+{
+    struct chain c = { NULL, 0, 0 };
+    struct range *r;
+    int *head;
+    int i,changed = 0;
+
+    get_chain(&c,d,dsc);
+    head = alloc(sizeof(int)*c.n);
+    r = group_ranges(&c,dsc,head);
+    for (i = 0; i != c.n; i++) {
+	if (head[i] == -1) cover_ranges(c.slot[i]);
+	if (head[i] != i || r[i].leaves < 2) continue;
+	if (!r[i].inequality && cover_size(r+i) >= r[i].leaves) continue;
+	replace_group(&c,head,i,cover_expr(r+i));
+	changed = 1;
+    }
+    free_ranges(&c,r,head);
+    free(head);
+    if (changed) rebuild_chain(d,dsc,&c);
+    free(c.slot);
+}
+
+
+static void cover_ranges(DATA *d)
+{
+    if (!d->op) return;
+    if (d->op->dsc == &op_logical_and || d->op->dsc == &op_logical_or) {
+	cover_chain(d,d->op->dsc);
+	return;
+    }
+    cover_ranges(&d->op->a);
+    cover_ranges(&d->op->b);
+    cover_ranges(&d->op->c);
+}
+
+
+/* ------------------------------------------------------------------------- */
+
+
+void iflib_range(DATA *d)
+{
+    merge_alternatives(d);
+    debug_expr("AFTER merge_alternatives",*d);
+    cover_ranges(d);
+}
@@ -7,6 +7,7 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "config.h"
 #include "util.h"
@@ -16,6 +17,7 @@
 #include "tree.h"
 #include "op.h"
 #include "iflib.h"
+#include "stats.h"
 
 
 /*
@@ -30,102 +32,101 @@
 /* --------------------- Normalize boolean expression ---------------------- */
 
 
-static void bubble_or(DATA *d)
+/*
+ * All passes work on interned expressions (see iflib_dag.c) and return new
+ * ones, instead of changing the expression in place. Each pass remembers its
+ * result for every node, so shared sub-expressions are processed only once.
+ */
+
+
+static DATA logical(const OP_DSC *dsc,DATA a,DATA b)
 {
-    DATA new;
+    return expr_intern(op_binary(dsc,a,b));
+}
 
-    while (1) {
-	SELF_CONTAINED sc;
 
-	if (d->type == dt_none) return;
-	if (d->op) {
-	    bubble_or(&d->op->a);
-	    bubble_or(&d->op->b);
-	    bubble_or(&d->op->c);
-	}
-	if (!d->op || d->op->dsc != &op_logical_and) return;
-
-	sc = self_contained(d->op->a);
-	if (sc == sc_yes || sc == sc_no_false) {
-	    new = d->op->a;
-	    data_destroy(d->op->b);
-	    data_destroy_1(*d);
-	    *d = new;
-	    continue;
-	}
+static DATA run_pass(DATA (*pass)(DATA d),DATA d)
+{
+    expr_new_pass();
+    return pass(expr_intern(d));
+}
 
-	/*
-	 * (a || b) && c -> (a && c) || (b && c)
-	 *
-	 * Exception: if b has a side-effect, this transformation is only
-	 * valid if c is self-contained or if a is self-contained or always
-	 * true.
-	 */
-	if (d->op->a.op && d->op->a.op->dsc == &op_logical_or) {
-	    sc = self_contained(d->op->a.op->a);
-	    if (!side_effect(d->op->a.op->b) ||
-	      self_contained(d->op->b) == sc_yes ||
-	      sc == sc_yes || sc == sc_no_true) {
-		new = op_binary(&op_logical_or,
-		  op_binary(&op_logical_and,data_clone(d->op->a.op->a),
-		    data_clone(d->op->b)),
-		  op_binary(&op_logical_and,data_clone(d->op->a.op->b),
-		    data_clone(d->op->b)));
-		data_destroy(*d);
-		*d = new;
-		continue;
-	    }
-	}
 
-	/* a && (b || c) -> (a && b) || (a && c) */
-	if (d->op->b.op && d->op->b.op->dsc == &op_logical_or) {
-	    if (action_tree(d->op->b) &&
-	      self_contained(d->op->b) == sc_yes)
-		break;
+static DATA bubble_or(DATA d)
+{
+    DATA in = d,res,a,b;
+    SELF_CONTAINED sc;
+
+    if (!d.op) return d;
+    if (expr_memo(d,&res)) return res;
+    d = expr_rebuild(d,bubble_or(d.op->a),bubble_or(d.op->b),
+      bubble_or(d.op->c));
+    if (d.op->dsc != &op_logical_and) return expr_set_memo(in,d);
+    a = d.op->a;
+    b = d.op->b;
+
+    sc = self_contained(a);
+    if (sc == sc_yes || sc == sc_no_false)
+	return expr_set_memo(in,bubble_or(a));
+
+    /*
+     * (a || b) && c -> (a && c) || (b && c)
+     *
+     * Exception: if b has a side-effect, this transformation is only
+     * valid if c is self-contained or if a is self-contained or always
+     * true.
+     */
+    if (a.op && a.op->dsc == &op_logical_or) {
+	sc = self_contained(a.op->a);
+	if (!side_effect(a.op->b) || self_contained(b) == sc_yes ||
+	  sc == sc_yes || sc == sc_no_true)
+	    return expr_set_memo(in,bubble_or(logical(&op_logical_or,
+	      logical(&op_logical_and,a.op->a,b),
+	      logical(&op_logical_and,a.op->b,b))));
+    }
+
+    /* a && (b || c) -> (a && b) || (a && c) */
+    if (b.op && b.op->dsc == &op_logical_or) {
+	if (action_tree(b) && self_contained(b) == sc_yes)
+	    return expr_set_memo(in,d);
 		  /* Do NOT normalize actions */
-	    new = op_binary(&op_logical_or,
-	      op_binary(&op_logical_and,data_clone(d->op->a),
-		data_clone(d->op->b.op->a)),
-	      op_binary(&op_logical_and,data_clone(d->op->a),
-		data_clone(d->op->b.op->b)));
-	    data_destroy(*d);
-	    *d = new;
-	    continue;
-	}
-	break;
+	return expr_set_memo(in,bubble_or(logical(&op_logical_or,
+	  logical(&op_logical_and,a,b.op->a),
+	  logical(&op_logical_and,a,b.op->b))));
     }
+    return expr_set_memo(in,d);
 }
 
 
-static void linearize(DATA *d)
+static DATA linearize(DATA d)
 {
-    if (d->type == dt_none) return;
+    DATA in = d,res;
+
+    if (!d.op) return d;
+    if (expr_memo(d,&res)) return res;
 
     /* (a || b) || c -> a || (b || c)   (idem for &&) */
-    while (d->op &&
-      (d->op->dsc == &op_logical_or || d->op->dsc == &op_logical_and) &&
-      d->op->a.op && d->op->a.op->dsc == d->op->dsc) {
-	DATA tmp;
-
-	tmp = d->op->a;
-	d->op->a = tmp.op->b;
-	tmp.op->b = *d;
-	*d = tmp;
-    }
-    if (d->op) {
-	linearize(&d->op->a);
-	linearize(&d->op->b);
-	linearize(&d->op->c);
+    while ((d.op->dsc == &op_logical_or || d.op->dsc == &op_logical_and) &&
+      d.op->a.op && d.op->a.op->dsc == d.op->dsc) {
+	DATA tmp = d.op->a;
+
+	d = expr_rebuild(tmp,tmp.op->a,
+	  expr_rebuild(d,tmp.op->b,d.op->b,d.op->c),tmp.op->c);
     }
+    res = expr_rebuild(d,linearize(d.op->a),linearize(d.op->b),
+      linearize(d.op->c));
+    return expr_set_memo(in,res);
 }
 
 
 void iflib_normalize(DATA *d)
 {
-    bubble_or(d);
+    stats_begin("iflib_normalize",NULL);
+    *d = run_pass(bubble_or,*d);
     debug_expr("AFTER bubble_or",*d);
-    linearize(d);
+    *d = run_pass(linearize,*d);
     debug_expr("AFTER linearize (2)",*d);
+    stats_end();
 }
 
 
@@ -136,6 +137,7 @@ int expr_equal(DATA a,DATA b)
 {
     if (a.op) {
 	if (!b.op) return 0;
+	if (a.op->node && b.op->node) return a.op == b.op;
 	if (a.op->dsc != b.op->dsc) return 0;
 	return expr_equal(a.op->a,b.op->a) && expr_equal(a.op->b,b.op->b) &&
 	  expr_equal(a.op->c,b.op->c);
@@ -145,43 +147,149 @@ int expr_equal(DATA a,DATA b)
 }
 
 
-static void common_subexpressions(DATA *d)
+/*
+ * Builds the chain  nodes[from]->a op ... op nodes[to]->a op tail
+ */
+
+static DATA build_chain(DATA *nodes,int from,int to,DATA tail)
 {
-    while (d->op && (d->op->dsc == &op_or || d->op->dsc == &op_and ||
-      d->op->dsc == &op_logical_or || d->op->dsc == &op_logical_and)) {
-	DATA *walk;
-	int again = 0;
+    int i;
+
+    for (i = to; i >= from; i--)
+	tail = expr_rebuild(nodes[i],nodes[i].op->a,tail,nodes[i].op->c);
+    return tail;
+}
 
-	for (walk = &d->op->b; walk->op && walk->op->dsc == d->op->dsc;
-	  walk = &walk->op->b) {
-	    DATA next;
+
+/*
+ * Removes repeated operands from the chain  x[0] op ... op x[n-1] op tail,
+ * where no x[i] is itself such a chain. This has the same result as applying
+ * the two rules in common_subexpressions to the chain and then to each of its
+ * suffixes, but finds repeated operands by hashing them, instead of comparing
+ * all pairs:
+ *
+ * - each x[i] removes all the later operands that are equal to it,
+ * - if x[i] is equal to the tail, and at least one more operand follows
+ *   x[i], the last operand becomes the new tail.
+ *
+ * "nodes" is changed to contain only the nodes that remain. Returns the new
+ * tail, and sets *n to the new number of nodes.
+ */
+
+static DATA remove_repeated(DATA *nodes,int *n,DATA tail)
+{
+    int *slot,*same;
+    char *dead;
+    int size,live,end,i,j;
+
+    for (size = 2; size < 2**n; size <<= 1);
+    slot = alloc(sizeof(int)*size);
+    same = alloc(sizeof(int)**n);
+    dead = alloc(*n);
+    for (i = 0; i < size; i++) slot[i] = -1;
+    /* link each operand to the next one that is equal to it */
+    for (i = 0; i < *n; i++) {
+	DATA x = nodes[i].op->a;
+
+	same[i] = -1;
+	dead[i] = 0;
+	for (j = expr_hash(x) & (size-1); slot[j] != -1; j = (j+1) & (size-1))
+	    if (expr_equal(nodes[slot[j]].op->a,x)) break;
+	if (slot[j] != -1) same[slot[j]] = i;
+	slot[j] = i;
+    }
+    live = *n;
+    end = *n-1;
+    for (i = 0; i < *n; i++) {
+	if (dead[i]) continue;
+	/* a && ... && a && ... -> a && ... && ... */
+	for (j = same[i]; j != -1; j = same[j])
+	    if (!dead[j]) {
+		dead[j] = 1;
+		live--;
+	    }
+	/* a && ... && a -> a && ... */
+	if (live > 1 && expr_equal(nodes[i].op->a,tail)) {
+	    while (dead[end]) end--;
+	    tail = nodes[end].op->a;
+	    dead[end] = 1;
+	    live--;
+	}
+	live--;
+    }
+    for (i = j = 0; i < *n; i++)
+	if (!dead[i]) nodes[j++] = nodes[i];
+    *n = j;
+    free(slot);
+    free(same);
+    free(dead);
+    return tail;
+}
+
+
+static DATA common_subexpressions(DATA d)
+{
+    DATA in = d,res;
+
+    if (!d.op) return d;
+    if (expr_memo(d,&res)) return res;
+    if (d.op->dsc == &op_or || d.op->dsc == &op_and ||
+      d.op->dsc == &op_logical_or || d.op->dsc == &op_logical_and) {
+	const OP_DSC *dsc = d.op->dsc;
+	DATA *nodes = NULL,walk,tail,first = d.op->a;
+	int n = 0,nested = 0,i;
+
+	for (walk = d; walk.op && walk.op->dsc == dsc; walk = walk.op->b) {
+	    if (!(n & 15))
+		nodes = realloc(nodes,(n+16)*sizeof(DATA));
+	    if (!nodes) {
+		perror("realloc");
+		exit(1);
+	    }
+	    if (walk.op->a.op && walk.op->a.op->dsc == dsc) nested = 1;
+	    nodes[n++] = walk;
+	}
+	tail = walk;
+	if (!nested) {
+	    /*
+	     * Since all suffixes are done here too, we only need to descend into
+	     * the operands.
+	     */
+	    tail = common_subexpressions(remove_repeated(nodes,&n,tail));
+	    for (i = n-1; i >= 0; i--)
+		tail = expr_rebuild(nodes[i],
+		  common_subexpressions(nodes[i].op->a),tail,
+		  common_subexpressions(nodes[i].op->c));
+	    free(nodes);
+	    return expr_set_memo(in,tail);
+	}
+again:
+	for (i = 1; i < n; i++) {
+	    DATA rest;
 
 	    /* a && ... && a && ... -> a && ... && ... */
-	    if (expr_equal(d->op->a,walk->op->a)) {
-		next = walk->op->b;
-		data_destroy(walk->op->a);
-		data_destroy_1(*walk);
-		*walk = next;
-		again = 1;
-		break;
+	    if (expr_equal(first,nodes[i].op->a)) {
+		memmove(nodes+i,nodes+i+1,(n-i-1)*sizeof(DATA));
+		n--;
+		goto again;
 	    }
 
 	    /* a && ... && a -> a && ... */
-	    if (expr_equal(d->op->a,walk->op->b)) {
-		next = walk->op->a;
-		data_destroy(walk->op->b);
-		data_destroy_1(*walk);
-		*walk = next;
+	    if (first.op && first.op->dsc == dsc && i < n-1)
+		rest = build_chain(nodes,i+1,n-1,tail);
+	    else rest = i < n-1 ? nodes[i+1] : tail;
+	    if (expr_equal(first,rest)) {
+		tail = nodes[i].op->a;
+		n = i;
 		break;
 	    }
 	}
-	if (!again) break;
-    }
-    if (d->op) {
-	common_subexpressions(&d->op->a);
-	common_subexpressions(&d->op->b);
-	common_subexpressions(&d->op->c);
+	d = build_chain(nodes,0,n-1,tail);
+	free(nodes);
     }
+    res = expr_rebuild(d,common_subexpressions(d.op->a),
+      common_subexpressions(d.op->b),common_subexpressions(d.op->c));
+    return expr_set_memo(in,res);
 }
 
 
@@ -303,42 +411,65 @@ static void bundle_free_matrix(struct matrix *m)
  * Find best optimization. Actually, this isn't optimal yet. We should also
  * take into account how we could bundle adjacent areas. But this is probably
  * overkill.
+ *
+ * Since cells are interned, equality is transitive, and the number of leading
+ * cells rows first_or ... first_or+ors-1 have in common is the minimum of the
+ * prefixes each pair of adjacent rows has in common. Finding the best bundle
+ * is therefore the same as finding the largest rectangle under a histogram of
+ * these prefix lengths, which we can do in linear time, with a stack. For
+ * each prefix length, we find how far it extends to either side. Of equally
+ * good bundles, we pick the first one, and then the one with fewer rows.
  */
 
 
 static void bundle_find_best(struct matrix *m,int *best_or,int *best_ors,
   int *best_ands)
 {
-    int first_or;
+    int *common,*left,*right,*stack;
+    int n = m->ors-1,sp,i;
 
     *best_ors = *best_ands = 0;
-    for (first_or = 0; first_or < m->ors; first_or++) {
-	int ors;
-
-	for (ors = 2; first_or+ors <= m->ors; ors++) {
-	    int min_ands = -1;
-	    int i,j,ands;
-
-	    for (i = first_or; i < first_or+ors; i++)
-		if (m->rows[i].ands < min_ands || min_ands == -1)
-		    min_ands = m->rows[i].ands;
-	    if (ors*min_ands < *best_ors**best_ands) continue;
-	    for (ands = 1; ands <= min_ands; ands++) {
-		for (i = first_or+1; i < first_or+ors; i++)
-		    for (j = 0; j < ands; j++)
-			if (!expr_equal(*m->rows[first_or].cells[j],
-			  *m->rows[i].cells[j]))
-			    goto out;
-		if (ors*ands > *best_ors**best_ands) {
-		    *best_or = first_or;
-		    *best_ors = ors;
-		    *best_ands = ands;
-		}
-	    }
-out:
-	    ; /* semicolon required for "new" C syntax */
+    if (n < 1) return;
+    common = alloc(sizeof(int)*n);
+    left = alloc(sizeof(int)*n);
+    right = alloc(sizeof(int)*n);
+    stack = alloc(sizeof(int)*n);
+    for (i = 0; i < n; i++) {
+	const struct or_row *a = m->rows+i,*b = m->rows+i+1;
+	int j;
+
+	for (j = 0; j < a->ands && j < b->ands; j++)
+	    if (!expr_equal(*a->cells[j],*b->cells[j])) break;
+	common[i] = j;
+    }
+    sp = 0;
+    for (i = 0; i < n; i++) {
+	while (sp && common[stack[sp-1]] >= common[i]) sp--;
+	left[i] = sp ? stack[sp-1]+1 : 0;
+	stack[sp++] = i;
+    }
+    sp = 0;
+    for (i = n-1; i >= 0; i--) {
+	while (sp && common[stack[sp-1]] >= common[i]) sp--;
+	right[i] = sp ? stack[sp-1]-1 : n-1;
+	stack[sp++] = i;
+    }
+    for (i = 0; i < n; i++) {
+	int ors = right[i]-left[i]+2;
+	int size = ors*common[i];
+
+	if (!size) continue;
+	if (size > *best_ors**best_ands || (size == *best_ors**best_ands &&
+	  (left[i] < *best_or || (left[i] == *best_or && ors < *best_ors)))) {
+	    *best_or = left[i];
+	    *best_ors = ors;
+	    *best_ands = common[i];
 	}
     }
+    free(common);
+    free(left);
+    free(right);
+    free(stack);
 }
 
 
@@ -355,8 +486,8 @@ out:
  * becomes
  * (a && b && c) || (d && e && (f || g)) || h || (i && j && k)
  *
- * Note: we data_clone a lot here. This keeps the whole design reasonably
- * simple, but it's bad for performance.
+ * The cells are interned, so data_clone just shares them, and only the new
+ * && and || nodes are allocated.
  */
 
 
@@ -409,22 +540,60 @@ static DATA bundle_rebuild(struct matrix *m,int from,int ors,int ands)
 }
 
 
+static DATA bundle(DATA d);
+
+
+/*
+ * Nothing can be bundled in the || chain d, and therefore also not in any of
+ * its suffixes, so we only need to descend into the rows. We do this without
+ * recursing along the chain, which may be very long.
+ */
+
+static DATA bundle_rows(DATA d)
+{
+    DATA *nodes = NULL,walk,res;
+    int n = 0,i;
+
+    for (walk = d; walk.op && walk.op->dsc == &op_logical_or;
+      walk = walk.op->b) {
+	if (n && expr_memo(walk,&res)) break;
+	if (!(n & 15))
+	    nodes = realloc(nodes,(n+16)*sizeof(DATA));
+	if (!nodes) {
+	    perror("realloc");
+	    exit(1);
+	}
+	nodes[n++] = walk;
+    }
+    if (!walk.op || walk.op->dsc != &op_logical_or) res = bundle(walk);
+    for (i = n-1; i >= 0; i--) {
+	res = expr_rebuild(nodes[i],bundle(nodes[i].op->a),res,
+	  bundle(nodes[i].op->c));
+	if (i) expr_set_memo(nodes[i],res);
+    }
+    free(nodes);
+    return res;
+}
+
+
 /*
  * Skip all ors
  */
 
 
-static void bundle(DATA *d)
+static DATA bundle(DATA d)
 {
+    DATA in = d,res;
+
+    if (expr_memo(d,&res)) return res;
     while (1) {
 	struct matrix m;
 	int from,ors,ands;
-	DATA old = *d;
 
-	debug_expr("BEFORE bundle iteration",*d);
-	if (!d->op) return;
-	if (d->op->dsc != &op_logical_or) break;
-	bundle_make_matrix(d,&m);
+	debug_expr("BEFORE bundle iteration",d);
+	if (!d.op) return expr_set_memo(in,d);
+	if (d.op->dsc != &op_logical_or) break;
+	bundle_make_matrix(&d,&m);
 	bundle_dump_matrix(stdout,m);
 	bundle_find_best(&m,&from,&ors,&ands);
 	if (ors*ands < BUNDLE_THRESHOLD) {
@@ -433,99 +602,66 @@ static void bundle(DATA *d)
 	}
 	debugf("BEFORE bundle_rebuild (from %d, ors %d, ands %d)\n",from,ors,
 	  ands);
-	*d = bundle_rebuild(&m,from,ors,ands);
-	debug_expr("AFTER bundle_rebuild",*d);
-	data_destroy(old);
+	d = expr_intern(bundle_rebuild(&m,from,ors,ands));
+	debug_expr("AFTER bundle_rebuild",d);
 	bundle_free_matrix(&m);
     }
-    bundle(&d->op->a);
-    bundle(&d->op->b);
-    bundle(&d->op->c);
+    if (d.op->dsc == &op_logical_or) return expr_set_memo(in,bundle_rows(d));
+    res = expr_rebuild(d,bundle(d.op->a),bundle(d.op->b),bundle(d.op->c));
+    return expr_set_memo(in,res);
 }
 
 
 /* ---------- Remove dead branches caused by shortcut evaluation ----------- */
 
 
-void prune_shortcuts(DATA *d)
+static DATA prune(DATA d)
 {
-    DATA old = *d;
+    DATA in = d,res,a,b;
 
-    if (!d->op) return;
-    prune_shortcuts(&d->op->a);
-    prune_shortcuts(&d->op->b);
-    prune_shortcuts(&d->op->c);
+    if (!d.op) return d;
+    if (expr_memo(d,&res)) return res;
+    d = expr_rebuild(d,prune(d.op->a),prune(d.op->b),prune(d.op->c));
+    a = d.op->a;
+    b = d.op->b;
 
     /* <class X> || ... -> <class X>  and <class X> && ... -> <class X> */
-    if ((d->op->dsc == &op_logical_or || d->op->dsc == &op_logical_and) &&
-      d->op->a.type == dt_decision) {
-	*d = d->op->a;
-	data_destroy(old.op->b);
-	data_destroy_1(old);
-	return;
-    }
-
-    if (d->op->dsc == &op_logical_and) {
-	if (!d->op->a.op && d->op->a.type == dt_unum) {
-	    /* 0 && X -> 0 */
-	    if (!d->op->a.u.unum) {
-		*d = data_unum(0);
-		data_destroy(old);
-		return;
-	    }
-	    /* 1 && X -> X */
-	    if (d->op->a.u.unum) {
-		*d = old.op->b;
-		data_destroy_1(old);
-		return;
-	    }
-	}
-	if (!d->op->b.op && d->op->b.type == dt_unum) {
+    if ((d.op->dsc == &op_logical_or || d.op->dsc == &op_logical_and) &&
+      a.type == dt_decision)
+	return expr_set_memo(in,a);
+
+    if (d.op->dsc == &op_logical_and) {
+	if (!a.op && a.type == dt_unum)
+	    /* 0 && X -> 0,  1 && X -> X */
+	    return expr_set_memo(in,a.u.unum ? b : data_unum(0));
+	if (!b.op && b.type == dt_unum) {
 	    /* X && 0 -> 0, unless X has side-effect */
-	    if (!d->op->b.u.unum && !side_effect(d->op->a)) {
-		*d = data_unum(0);
-		data_destroy(old);
-		return;
-	    }
+	    if (!b.u.unum && !side_effect(a))
+		return expr_set_memo(in,data_unum(0));
 	    /* X && 1 -> X */
-	    if (d->op->b.u.unum) {
-		*d = old.op->a;
-		data_destroy_1(old);
-		return;
-	    }
+	    if (b.u.unum) return expr_set_memo(in,a);
 	}
     }
 
-    if (d->op->dsc == &op_logical_or) {
-	if (!d->op->a.op && d->op->a.type == dt_unum) {
-	    /* 1 || X -> 1 */
-	    if (d->op->a.u.unum) {
-		*d = data_unum(1);
-		data_destroy(old);
-		return;
-	    }
-	    /* 0 || X -> X */
-	    if (!d->op->a.u.unum) {
-		*d = old.op->b;
-		data_destroy_1(old);
-		return;
-	    }
-	}
-	if (!d->op->b.op && d->op->b.type == dt_unum) {
+    if (d.op->dsc == &op_logical_or) {
+	if (!a.op && a.type == dt_unum)
+	    /* 1 || X -> 1,  0 || X -> X */
+	    return expr_set_memo(in,a.u.unum ? data_unum(1) : b);
+	if (!b.op && b.type == dt_unum) {
 	    /* X || 1 -> 1, unless X has side-effect */
-	    if (d->op->b.u.unum && !side_effect(d->op->a)) {
-		*d = data_unum(1);
-		data_destroy(old);
-		return;
-	    }
+	    if (b.u.unum && !side_effect(a))
+		return expr_set_memo(in,data_unum(1));
 	    /* X || 0 -> X */
-	    if (!d->op->b.u.unum) {
-		*d = old.op->a;
-		data_destroy_1(old);
-		return;
-	    }
+	    if (!b.u.unum) return expr_set_memo(in,a);
 	}
     }
+    return expr_set_memo(in,d);
+}
+
+
+void prune_shortcuts(DATA *d)
+{
+    *d = run_pass(prune,*d);
 }
 
 
@@ -534,6 +670,7 @@ void prune_shortcuts(DATA *d)
 
 void iflib_reduce(DATA *d)
 {
+    stats_begin("iflib_reduce",NULL);
     debug_expr("BEFORE iflib_reduce",*d);
     /*
      * There's a bit white magic going on here.
@@ -559,21 +696,23 @@ void iflib_reduce(DATA *d)
      * steps expect to find the expression in a linear structure, we have to
      * call "linearize" again after "bubble_or" (both in "iflib_normalize").
      */
-    linearize(d);
+    *d = run_pass(linearize,*d);
     debug_expr("AFTER linearize (1)",*d);
     prune_shortcuts(d);
     debug_expr("AFTER prune_shortcuts (1)",*d);
     if (alg_mode || !registry_probe(&optimization_switches,"cse")) {
 	iflib_normalize(d);
+	stats_end();
 	return;
     }
-    bundle(d);
+    *d = run_pass(bundle,*d);
     debug_expr("AFTER bundle",*d);
     iflib_normalize(d);
-    common_subexpressions(d);
+    *d = run_pass(common_subexpressions,*d);
     debug_expr("AFTER common_subexpressions",*d);
-    bundle(d);
+    *d = run_pass(bundle,*d);
     debug_expr("AFTER bundle",*d);
     prune_shortcuts(d);
     debug_expr("AFTER prune_shortcuts (2)",*d);
+    stats_end();
 }
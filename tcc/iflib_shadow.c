@@ -0,0 +1,589 @@
+/*
+ * iflib_shadow.c - Removal of rules and terms that make no difference
+ */
+
+/*
+ * Tests of the form  access == constant  or  (access & mask) == constant
+ * restrict the field the access reads to a value/mask pair. If we merge all
+ * such tests of a rule that read the same field, the rule describes a
+ * hyper-rectangle in the space of packets, with one dimension per field:
+ *
+ * - the rule can never match if the rectangle is empty, i.e. if two of its
+ *   tests contradict each other,
+ * - a test is redundant if another test of the same rule already implies it,
+ * - the rule is shadowed if an earlier rule, which always takes the packets
+ *   it matches, and whose tests are all of the above form, has a rectangle
+ *   that contains the one of the rule. (Other terms of the later rule only
+ *   make its rectangle smaller, so we can simply ignore them.)
+ *
+ * For the last test, we group the earlier rules by the fields and masks they
+ * test, and look up the values the later rule has under each such mask in a
+ * hash table. This way, the cost per rule only depends on the number of
+ * different groups, not on the number of rules.
+ *
+ * iflib_combine uses this to leave out elements that can never match, and
+ * iflib_shadow does the same for the alternatives of normalized expressions,
+ * and also removes redundant tests.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <u128.h>
+
+#include "config.h"
+#include "util.h"
+#include "registry.h"
+#include "error.h"
+#include "data.h"
+#include "op.h"
+#include "iflib.h"
+#include "stats.h"
+
+
+struct term {
+    DATA access;		/* interned */
+    U128 value,mask;
+    DATA *link;			/* where the term is in the expression */
+    int redundant;		/* term is implied by another one */
+};
+
+struct box {
+    struct term *terms;
+    int n;
+    int alloc;
+    int complete;		/* non-zero if we know all tests */
+    int side_effect;		/* ignore terms after one with side-effects */
+    int empty;			/* tests contradict each other */
+};
+
+struct shape {
+    int n;
+    DATA *access;		/* sorted like merged terms */
+    U128 *mask;
+    struct shape *next;
+};
+
+struct cover {
+    const struct shape *shape;
+    uint32_t hash;
+    U128 *value;
+    int seq;			/* position in the rule set */
+    const void *owner;
+    struct cover *next;
+};
+
+struct shadow {
+    struct shape *shapes;
+    struct cover **table;
+    int size;			/* power of two */
+    int entries;
+    int seq;
+    U128 *key;			/* values of the rule we're looking up */
+    int key_alloc;
+};
+
+
+/* ----- Terms ------------------------------------------------------------- */
+
+
+static int is_constant(DATA d)
+{
+    return !d.op &&
+      (d.type == dt_unum || d.type == dt_ipv4 || d.type == dt_ipv6);
+}
+
+
+/*
+ * Like add_test in iflib_prof.c, but we also accept constants that are still
+ * IPv4 addresses, since iflib_combine looks at expressions before iflib_arith
+ * has converted them.
+ */
+
+static int add_term(struct box *box,DATA *link)
+{
+    DATA d = *link;
+    DATA constant,var;
+    U128 mask;
+    int default_mask = 1;
+    struct term *term;
+
+    if (is_constant(d) && d.type == dt_unum) {
+	if (!d.u.unum) box->empty = 1;
+	return 1;
+    }
+    if (!d.op || d.op->dsc != &op_eq) return 0;
+    if (is_constant(d.op->a)) {
+	constant = d.op->a;
+	var = d.op->b;
+    }
+    else {
+	if (!is_constant(d.op->b)) return 0;
+	constant = d.op->b;
+	var = d.op->a;
+    }
+    mask = u128_not(u128_from_32(0));
+    if (var.op && var.op->dsc == &op_and) {
+	if (is_constant(var.op->b)) {
+	    mask = data_convert(var.op->b,dt_ipv6).u.u128;
+	    var = var.op->a;
+	}
+	else {
+	    if (!is_constant(var.op->a)) return 0;
+	    mask = data_convert(var.op->a,dt_ipv6).u.u128;
+	    var = var.op->b;
+	}
+	default_mask = 0;
+    }
+    if (!var.op || var.op->dsc != &op_access) return 0;
+    if (var.op->c.op || var.op->c.type != dt_unum) return 0;
+    if (var.op->c.u.unum > 128) return 0;
+    if (default_mask) mask = u128_shift_right(mask,128-var.op->c.u.unum);
+    if (box->n == box->alloc) {
+	box->alloc = box->alloc ? box->alloc*2 : 4;
+	box->terms = realloc(box->terms,box->alloc*sizeof(struct term));
+	if (!box->terms) {
+	    perror("realloc");
+	    exit(1);
+	}
+    }
+    term = box->terms+box->n++;
+    term->access = expr_intern(data_clone(var));
+    term->value = data_convert(constant,dt_ipv6).u.u128;
+    term->mask = mask;
+    term->link = link;
+    term->redundant = 0;
+    if (!u128_is_zero(u128_and(term->value,u128_not(mask)))) box->empty = 1;
+    return 1;
+}
+
+
+/*
+ * Terms are evaluated in order, so a term with side-effects only takes effect
+ * if all the terms before it are true. We therefore only look at the terms up
+ * to the first one with side-effects. Then, even if that term is reached, the
+ * rule is still bound by what the tests before it say.
+ */
+
+static void add_other(struct box *box,DATA *link)
+{
+    if (box->side_effect) return;
+    if (add_term(box,link)) return;
+    box->complete = 0;
+    if (side_effect(*link)) box->side_effect = 1;
+}
+
+
+/*
+ * Collects the tests of the && chain at *link. Anything else makes the box
+ * incomplete.
+ */
+
+static void add_terms(struct box *box,DATA *link)
+{
+    if (link->op && link->op->dsc == &op_logical_and) {
+	add_terms(box,&link->op->a);
+	add_terms(box,&link->op->b);
+	return;
+    }
+    add_other(box,link);
+}
+
+
+static int implies(const struct term *a,const struct term *b)
+{
+    if (a->access.op != b->access.op) return 0;
+    if (!u128_is_zero(u128_and(b->mask,u128_not(a->mask)))) return 0;
+    return u128_is_zero(u128_and(u128_xor(a->value,b->value),b->mask));
+}
+
+
+static int contradicts(const struct term *a,const struct term *b)
+{
+    if (a->access.op != b->access.op) return 0;
+    return !u128_is_zero(u128_and(u128_xor(a->value,b->value),
+      u128_and(a->mask,b->mask)));
+}
+
+
+/*
+ * Marks tests that are implied by another one, and returns their number. If
+ * two tests are equal, the first one stays.
+ */
+
+static int find_redundant(struct box *box)
+{
+    int i,j,found = 0;
+
+    for (i = 0; i < box->n; i++)
+	for (j = i+1; j < box->n; j++)
+	    if (contradicts(box->terms+i,box->terms+j)) box->empty = 1;
+    for (i = 0; i < box->n; i++)
+	for (j = 0; j < box->n; j++) {
+	    struct term *a = box->terms+j,*b = box->terms+i;
+
+	    if (i == j || !implies(a,b)) continue;
+	    if (j > i && !u128_cmp(a->mask,b->mask)) continue;
+	    b->redundant = 1;
+	    found++;
+	    break;
+	}
+    return found;
+}
+
+
+static int term_cmp(const void *a,const void *b)
+{
+    const struct term *ta = a,*tb = b;
+
+    if (ta->access.op == tb->access.op) return 0;
+    return ta->access.op < tb->access.op ? -1 : 1;
+}
+
+
+/*
+ * Sorts the tests by field and merges tests of the same field, so that each
+ * field appears only once. Only use on boxes that aren't empty.
+ */
+
+static void merge_terms(struct box *box)
+{
+    int i,n = 0;
+
+    qsort(box->terms,box->n,sizeof(struct term),term_cmp);
+    for (i = 0; i < box->n; i++) {
+	struct term *t = box->terms+i;
+
+	if (n && box->terms[n-1].access.op == t->access.op) {
+	    struct term *prev = box->terms+n-1;
+
+	    prev->value = u128_or(prev->value,t->value);
+	    prev->mask = u128_or(prev->mask,t->mask);
+	}
+	else box->terms[n++] = *t;
+    }
+    box->n = n;
+}
+
+
+static void box_init(struct box *box)
+{
+    box->terms = NULL;
+    box->n = box->alloc = 0;
+    box->complete = 1;
+    box->side_effect = 0;
+    box->empty = 0;
+}
+
+
+/* ----- Rule sets --------------------------------------------------------- */
+
+
+struct shadow *shadow_open(void)
+{
+    struct shadow *shadow = alloc_t(struct shadow);
+
+    shadow->shapes = NULL;
+    shadow->size = 64;
+    shadow->table = alloc(shadow->size*sizeof(struct cover *));
+    memset(shadow->table,0,shadow->size*sizeof(struct cover *));
+    shadow->entries = 0;
+    shadow->seq = 0;
+    shadow->key = NULL;
+    shadow->key_alloc = 0;
+    return shadow;
+}
+
+
+void shadow_close(struct shadow *shadow)
+{
+    int i;
+
+    for (i = 0; i < shadow->size; i++)
+	while (shadow->table[i]) {
+	    struct cover *next = shadow->table[i]->next;
+
+	    free(shadow->table[i]->value);
+	    free(shadow->table[i]);
+	    shadow->table[i] = next;
+	}
+    while (shadow->shapes) {
+	struct shape *next = shadow->shapes->next;
+
+	free(shadow->shapes->access);
+	free(shadow->shapes->mask);
+	free(shadow->shapes);
+	shadow->shapes = next;
+    }
+    free(shadow->table);
+    free(shadow->key);
+    free(shadow);
+}
+
+
+static uint32_t hash_key(const struct shape *shape,const U128 *value)
+{
+    uint32_t h = (uint32_t) (unsigned long) shape;
+    int i,j;
+
+    for (i = 0; i < shape->n; i++)
+	for (j = 0; j < 4; j++) h = h*31+value[i].v[j];
+    return h;
+}
+
+
+static void grow_table(struct shadow *shadow)
+{
+    struct cover **old = shadow->table;
+    int old_size = shadow->size;
+    int i;
+
+    shadow->size *= 2;
+    shadow->table = alloc(shadow->size*sizeof(struct cover *));
+    memset(shadow->table,0,shadow->size*sizeof(struct cover *));
+    for (i = 0; i < old_size; i++)
+	while (old[i]) {
+	    struct cover *next = old[i]->next;
+	    struct cover **bucket =
+	      shadow->table+(old[i]->hash & (shadow->size-1));
+
+	    old[i]->next = *bucket;
+	    *bucket = old[i];
+	    old[i] = next;
+	}
+    free(old);
+}
+
+
+static const struct shape *find_shape(struct shadow *shadow,
+  const struct box *box)
+{
+    struct shape *shape;
+    int i;
+
+    for (shape = shadow->shapes; shape; shape = shape->next) {
+	if (shape->n != box->n) continue;
+	for (i = 0; i < box->n; i++)
+	    if (shape->access[i].op != box->terms[i].access.op ||
+	      u128_cmp(shape->mask[i],box->terms[i].mask))
+		break;
+	if (i == box->n) return shape;
+    }
+    shape = alloc_t(struct shape);
+    shape->n = box->n;
+    shape->access = alloc((box->n ? box->n : 1)*sizeof(DATA));
+    shape->mask = alloc((box->n ? box->n : 1)*sizeof(U128));
+    for (i = 0; i < box->n; i++) {
+	shape->access[i] = box->terms[i].access;
+	shape->mask[i] = box->terms[i].mask;
+    }
+    shape->next = shadow->shapes;
+    shadow->shapes = shape;
+    return shape;
+}
+
+
+/*
+ * Adds a merged box to the set. Packets in it never get past the rule.
+ */
+
+static void add_cover(struct shadow *shadow,const struct box *box,
+  const void *owner)
+{
+    struct cover *cover = alloc_t(struct cover);
+    struct cover **bucket;
+    int i;
+
+    cover->shape = find_shape(shadow,box);
+    cover->value = alloc((box->n ? box->n : 1)*sizeof(U128));
+    for (i = 0; i < box->n; i++) cover->value[i] = box->terms[i].value;
+    cover->hash = hash_key(cover->shape,cover->value);
+    cover->seq = shadow->seq++;
+    cover->owner = owner;
+    if (shadow->entries >= shadow->size) grow_table(shadow);
+    bucket = shadow->table+(cover->hash & (shadow->size-1));
+    cover->next = *bucket;
+    *bucket = cover;
+    shadow->entries++;
+}
+
+
+/*
+ * Returns the earliest entry whose box contains the merged box, or NULL if
+ * there is none.
+ */
+
+static const struct cover *find_cover(struct shadow *shadow,
+  const struct box *box)
+{
+    const struct shape *shape;
+    const struct cover *best = NULL;
+
+    for (shape = shadow->shapes; shape; shape = shape->next) {
+	const struct cover *cover;
+	uint32_t h;
+	int i,j = 0;
+
+	if (shape->n > box->n) continue;
+	if (shape->n > shadow->key_alloc) {
+	    shadow->key_alloc = shape->n*2;
+	    free(shadow->key);
+	    shadow->key = alloc(shadow->key_alloc*sizeof(U128));
+	}
+	for (i = 0; i < shape->n; i++) {
+	    while (j < box->n && box->terms[j].access.op < shape->access[i].op)
+		j++;
+	    if (j == box->n || box->terms[j].access.op != shape->access[i].op)
+		break;
+	    if (!u128_is_zero(u128_and(shape->mask[i],
+	      u128_not(box->terms[j].mask))))
+		break;
+	    shadow->key[i] = u128_and(box->terms[j].value,shape->mask[i]);
+	}
+	if (i != shape->n) continue;
+	h = hash_key(shape,shadow->key);
+	for (cover = shadow->table[h & (shadow->size-1)]; cover;
+	  cover = cover->next)
+	    if (cover->hash == h && cover->shape == shape &&
+	      !memcmp(cover->value,shadow->key,shape->n*sizeof(U128))) {
+		if (!best || cover->seq < best->seq) best = cover;
+		break;
+	    }
+    }
+    return best;
+}
+
+
+int shadow_dead(struct shadow *shadow,DATA *d,const void *owner,
+  const void **by)
+{
+    int dead = 1;
+
+    *by = NULL;
+    if (d->op && d->op->dsc == &op_logical_or) {
+	const void *by_b;
+	int dead_a,dead_b;
+
+	dead_a = shadow_dead(shadow,&d->op->a,owner,by);
+	dead_b = shadow_dead(shadow,&d->op->b,owner,&by_b);
+	if (!*by) *by = by_b;
+	return dead_a && dead_b;
+    }
+    else {
+	struct box box;
+
+	box_init(&box);
+	add_terms(&box,d);
+	find_redundant(&box);
+	if (!box.empty) {
+	    const struct cover *cover;
+
+	    merge_terms(&box);
+	    cover = find_cover(shadow,&box);
+	    if (cover) *by = cover->owner;
+	    else {
+		dead = 0;
+		if (box.complete) add_cover(shadow,&box,owner);
+	    }
+	}
+	free(box.terms);
+    }
+    return dead;
+}
+
+
+/* ----- Alternatives of normalized expressions ---------------------------- */
+
+
+/*
+ * Returns the number of terms removed from the alternative at *link, or -1 if
+ * the whole alternative can never match.
+ */
+
+static int do_alternative(struct shadow *shadow,DATA *link)
+{
+    struct box box;
+    DATA *walk = link;
+    int terminal,removed,i;
+
+    box_init(&box);
+    while (walk->op && walk->op->dsc == &op_logical_and &&
+      !action_tree(*walk)) {
+	add_other(&box,&walk->op->a);
+	walk = &walk->op->b;
+    }
+    terminal = action_tree(*walk) && self_contained(*walk) == sc_yes;
+    removed = find_redundant(&box);
+    if (box.empty) {
+	free(box.terms);
+	return -1;
+    }
+
+    /*
+     * Terms are in expression order, and each one links to the && whose left
+     * operand it is, so we can unlink them from the back.
+     */
+    for (i = box.n-1; i >= 0; i--)
+	if (box.terms[i].redundant) {
+	    DATA *and = link;
+	    DATA tmp;
+
+	    while (&and->op->a != box.terms[i].link) and = &and->op->b;
+	    tmp = *and;
+	    *and = tmp.op->b;
+	    data_destroy(tmp.op->a);
+	    data_destroy_1(tmp);
+	}
+    merge_terms(&box);
+    if (find_cover(shadow,&box)) removed = -1;
+    else if (box.complete && terminal) add_cover(shadow,&box,NULL);
+    free(box.terms);
+    return removed;
+}
+
+
+void iflib_shadow(DATA *d)
+{
+    struct shadow *shadow;
+    DATA *walk = d,*last_or = NULL;
+    int dead = 0,terms = 0;
+
+    if (!registry_probe(&optimization_switches,"shadow")) return;
+    stats_begin("iflib_shadow",NULL);
+    shadow = shadow_open();
+    while (1) {
+	DATA *alt = walk->op && walk->op->dsc == &op_logical_or ?
+	  &walk->op->a : walk;
+	int removed = do_alternative(shadow,alt);
+
+	if (removed >= 0) terms += removed;
+	else {
+	    DATA tmp;
+
+	    dead++;
+	    if (alt != walk) {
+		tmp = *walk;
+		*walk = tmp.op->b;
+		data_destroy(tmp.op->a);
+		data_destroy_1(tmp);
+		continue;
+	    }
+	    data_destroy(*walk);
+	    if (!last_or) *walk = data_unum(0);
+	    else {
+		tmp = *last_or;
+		*last_or = tmp.op->a;
+		data_destroy_1(tmp);
+	    }
+	    break;
+	}
+	if (alt == walk) break;
+	last_or = walk;
+	walk = &walk->op->b;
+    }
+    shadow_close(shadow);
+    debugf("iflib_shadow: removed %d alternatives, %d terms",dead,terms);
+    debug_expr("AFTER iflib_shadow",*d);
+    stats_end();
+}
@@ -0,0 +1,753 @@
+
+/*
+ * tcng.l - New TC configuration language
+ *
+ * Written 2001,2002 by Werner Almesberger
+ * Copyright 2001 EPFL-ICA, Network Robots
+ * Copyright 2002 Bivio Networks, Network Robots, Werner Almesberger
+ */
+
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <addr.h>
+
+#include "config.h"
+#include "error.h"
+#include "util.h"
+#include "location.h"
+#include "var.h"
+#include "param.h"
+#include "tree.h"
+#include "device.h"
+#include "field.h"
+#include "named.h"
+
+#include "y.tab.h"
+
+
+#include <regex.h>
+#define INITIAL 1
+#define ANCHOR 2
+#define BEGIN(s) (yy_state = (s))
+char *yytext;
+FILE *yyin;
+static int yy_state = INITIAL;
+struct yy_rule { int states; int bol; const char *re; regex_t rx; };
+static struct yy_rule yy_rules[] = {
+  { INITIAL|ANCHOR, 0, "^(warn)" },
+  { INITIAL|ANCHOR, 0, "^(dev)" },
+  { INITIAL|ANCHOR, 0, "^(qdisc)" },
+  { INITIAL|ANCHOR, 0, "^(ingress)" },
+  { INITIAL|ANCHOR, 0, "^(class)" },
+  { INITIAL|ANCHOR, 0, "^(on)" },
+  { INITIAL, 0, "^(if)" },
+  { ANCHOR, 0, "^(if)" },
+  { INITIAL|ANCHOR, 0, "^(filter)" },
+  { INITIAL|ANCHOR, 0, "^(element)" },
+  { INITIAL|ANCHOR, 0, "^(tunnel)" },
+  { INITIAL|ANCHOR, 0, "^(police)" },
+  { INITIAL|ANCHOR, 0, "^(bucket)" },
+  { INITIAL|ANCHOR, 0, "^(conform)" },
+  { INITIAL|ANCHOR, 0, "^(count)" },
+  { INITIAL|ANCHOR, 0, "^(else)" },
+  { INITIAL|ANCHOR, 0, "^(pass)" },
+  { INITIAL|ANCHOR, 0, "^(reclassify)" },
+  { INITIAL|ANCHOR, 0, "^(drop)" },
+  { INITIAL|ANCHOR, 0, "^(continue)" },
+  { INITIAL|ANCHOR, 0, "^(field)" },
+  { INITIAL|ANCHOR, 0, "^(field_root)" },
+  { INITIAL|ANCHOR, 0, "^(pragma)" },
+  { INITIAL|ANCHOR, 0, "^(tag)" },
+  { INITIAL|ANCHOR, 0, "^(cbq)" },
+  { INITIAL|ANCHOR, 0, "^(dsmark)" },
+  { INITIAL|ANCHOR, 0, "^(egress)" },
+  { INITIAL|ANCHOR, 0, "^(fifo)" },
+  { INITIAL|ANCHOR, 0, "^(gred)" },
+  { INITIAL|ANCHOR, 0, "^(htb)" },
+  { INITIAL|ANCHOR, 0, "^(prio)" },
+  { INITIAL|ANCHOR, 0, "^(red)" },
+  { INITIAL|ANCHOR, 0, "^(sfq)" },
+  { INITIAL|ANCHOR, 0, "^(tbf)" },
+  { INITIAL|ANCHOR, 0, "^(fw)" },
+  { INITIAL|ANCHOR, 0, "^(route)" },
+  { INITIAL|ANCHOR, 0, "^(rsvp)" },
+  { INITIAL|ANCHOR, 0, "^(tcindex)" },
+  { INITIAL|ANCHOR, 0, "^(ah)" },
+  { INITIAL|ANCHOR, 0, "^(allot)" },
+  { INITIAL|ANCHOR, 0, "^(avpkt)" },
+  { INITIAL|ANCHOR, 0, "^(bandwidth)" },
+  { INITIAL|ANCHOR, 0, "^(bands)" },
+  { INITIAL|ANCHOR, 0, "^(bounded)" },
+  { INITIAL|ANCHOR, 0, "^(burst)" },
+  { INITIAL|ANCHOR, 0, "^(cburst)" },
+  { INITIAL|ANCHOR, 0, "^(ceil)" },
+  { INITIAL|ANCHOR, 0, "^(default)" },
+  { INITIAL|ANCHOR, 0, "^(default_index)" },
+  { INITIAL|ANCHOR, 0, "^(dport)" },
+  { INITIAL|ANCHOR, 0, "^(dst)" },
+  { INITIAL|ANCHOR, 0, "^(ecn)" },
+  { INITIAL|ANCHOR, 0, "^(esp)" },
+  { INITIAL|ANCHOR, 0, "^(ewma)" },
+  { INITIAL|ANCHOR, 0, "^(fall_through)" },
+  { INITIAL|ANCHOR, 0, "^(from)" },
+  { INITIAL|ANCHOR, 0, "^(fromif)" },
+  { INITIAL|ANCHOR, 0, "^(grio)" },
+  { INITIAL|ANCHOR, 0, "^(hash)" },
+  { INITIAL|ANCHOR, 0, "^(isolated)" },
+  { INITIAL|ANCHOR, 0, "^(indices)" },
+  { INITIAL|ANCHOR, 0, "^(ipproto)" },
+  { INITIAL|ANCHOR, 0, "^(limit)" },
+  { INITIAL|ANCHOR, 0, "^(mask)" },
+  { INITIAL|ANCHOR, 0, "^(max)" },
+  { INITIAL|ANCHOR, 0, "^(maxburst)" },
+  { INITIAL|ANCHOR, 0, "^(min)" },
+  { INITIAL|ANCHOR, 0, "^(minburst)" },
+  { INITIAL|ANCHOR, 0, "^(mpu)" },
+  { INITIAL|ANCHOR, 0, "^(mtu)" },
+  { INITIAL|ANCHOR, 0, "^(order)" },
+  { INITIAL|ANCHOR, 0, "^(overflow)" },
+  { INITIAL|ANCHOR, 0, "^(pass_on)" },
+  { INITIAL|ANCHOR, 0, "^(peakrate)" },
+  { INITIAL|ANCHOR, 0, "^(perturb)" },
+  { INITIAL|ANCHOR, 0, "^(priomap)" },
+  { INITIAL|ANCHOR, 0, "^(probability)" },
+  { INITIAL|ANCHOR, 0, "^(protocol)" },
+  { INITIAL|ANCHOR, 0, "^(quantum)" },
+  { INITIAL|ANCHOR, 0, "^(rate)" },
+  { INITIAL|ANCHOR, 0, "^(r2q)" },
+  { INITIAL|ANCHOR, 0, "^(set_tc_index)" },
+  { INITIAL|ANCHOR, 0, "^(shift)" },
+  { INITIAL|ANCHOR, 0, "^(skip)" },
+  { INITIAL|ANCHOR, 0, "^(sport)" },
+  { INITIAL|ANCHOR, 0, "^(src)" },
+  { INITIAL|ANCHOR, 0, "^(to)" },
+  { INITIAL|ANCHOR, 0, "^(value)" },
+  { INITIAL|ANCHOR, 0, "^(weight)" },
+  { INITIAL|ANCHOR, 0, "^(@)" },
+  { INITIAL|ANCHOR, 0, "^(host)" },
+  { INITIAL|ANCHOR, 0, "^(host4)" },
+  { INITIAL|ANCHOR, 0, "^(host6)" },
+  { INITIAL|ANCHOR, 0, "^(precond)" },
+  { INITIAL|ANCHOR, 0, "^(sprintf)" },
+  { INITIAL|ANCHOR, 0, "^(\\$[a-zA-Z_][a-zA-Z0-9_]*)" },
+  { INITIAL|ANCHOR, 0, "^(0[Xx]([0-9A-Fa-f])+|0[0-7]+|[0-9]+)" },
+  { INITIAL|ANCHOR, 0, "^(0[Bb][01]+)" },
+  { INITIAL|ANCHOR, 0, "^([0-9]+(\\.[0-9]*)?([eE][-+]?[0-9]+)?)" },
+  { INITIAL|ANCHOR, 0, "^(::|::(([0-9A-Fa-f])+:)*(([0-9A-Fa-f])+|([0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+))|(([0-9A-Fa-f])+:)*([0-9A-Fa-f])+::([0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+)?|(([0-9A-Fa-f])+:)+(:([0-9A-Fa-f])+)+(:([0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+))?|(([0-9A-Fa-f])+:){7}(([0-9A-Fa-f])+)|(([0-9A-Fa-f])+:){6}([0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+))" },
+  { INITIAL|ANCHOR, 0, "^(([0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+))" },
+  { INITIAL|ANCHOR, 0, "^(\n?[\t ]*)" },
+  { INITIAL|ANCHOR, 1, "^(# [0-9]+ \"[^\"]*\"( [0-9]+)*\n)" },
+  { INITIAL|ANCHOR, 0, "^(\"[^\"\n\t]*\")" },
+  { INITIAL|ANCHOR, 0, "^([a-zA-Z_][a-zA-Z0-9_]*)" },
+  { INITIAL|ANCHOR, 0, "^(<<)" },
+  { INITIAL|ANCHOR, 0, "^(>>)" },
+  { INITIAL|ANCHOR, 0, "^(==)" },
+  { INITIAL|ANCHOR, 0, "^(!=)" },
+  { INITIAL|ANCHOR, 0, "^(<=)" },
+  { INITIAL|ANCHOR, 0, "^(>=)" },
+  { INITIAL|ANCHOR, 0, "^(&&)" },
+  { INITIAL|ANCHOR, 0, "^(\\|\\|)" },
+  { INITIAL|ANCHOR, 0, "^(=)" },
+  { INITIAL|ANCHOR, 0, "^(\\})" },
+  { INITIAL|ANCHOR, 0, "^(.)" },
+};
+#define YY_NRULES (sizeof(yy_rules)/sizeof(*yy_rules))
+static char *yy_buf, *yy_pos;
+static size_t yy_len;
+static long yy_win = 256;
+static char *yy_save_ptr; static char yy_save_ch;
+int yylex(void)
+{
+    static int init = 0;
+    size_t i;
+    if (!init) {
+	size_t cap = 65536;
+	FILE *f = yyin ? yyin : stdin;
+	yy_buf = malloc(cap);
+	while (1) {
+	    size_t n = fread(yy_buf+yy_len,1,cap-yy_len-1,f);
+	    yy_len += n;
+	    if (!n) break;
+	    if (yy_len+1 >= cap) { cap *= 2; yy_buf = realloc(yy_buf,cap); }
+	}
+	yy_buf[yy_len] = 0;
+	yy_pos = yy_buf;
+	for (i = 0; i < YY_NRULES; i++)
+	    if (regcomp(&yy_rules[i].rx,yy_rules[i].re,REG_EXTENDED|REG_NEWLINE))
+		{ fprintf(stderr,"bad re %s\n",yy_rules[i].re); exit(1); }
+	init = 1;
+    }
+    while (1) {
+	char *end, *line;
+	int best = -1; int best_len = 0;
+	if (yy_save_ptr) { *yy_save_ptr = yy_save_ch; yy_save_ptr = NULL; }
+	if (!*yy_pos) return 0;
+	end = strchr(yy_pos,'\n');
+	if (end) { end = strchr(end+1,'\n'); }
+	if (!end) end = yy_pos+strlen(yy_pos); else end++;
+	if (end-yy_pos > yy_win) end = yy_pos+yy_win;
+	line = malloc(end-yy_pos+1);
+	memcpy(line,yy_pos,end-yy_pos); line[end-yy_pos] = 0;
+	for (i = 0; i < YY_NRULES; i++) {
+	    regmatch_t m;
+	    if (!(yy_rules[i].states & yy_state)) continue;
+	    if (yy_rules[i].bol && yy_pos != yy_buf && yy_pos[-1] != '\n')
+		continue;
+	    if (regexec(&yy_rules[i].rx,line,1,&m,0)) continue;
+	    if (m.rm_so) continue;
+	    if ((int) m.rm_eo > best_len) { best = i; best_len = m.rm_eo; }
+	}
+	free(line);
+	if (best >= 0 && best_len == end-yy_pos && yy_pos[best_len] &&
+	  yy_win < 1 << 24) { yy_win *= 4; continue; }
+	yy_win = 256;
+	if (best < 0) { fprintf(stderr,"lexer jam\n"); exit(1); }
+	yytext = yy_pos;
+	yy_pos += best_len;
+	yy_save_ptr = yy_pos; yy_save_ch = *yy_pos; *yy_pos = 0;
+	switch (best) {
+	case 0:
+	    return TOK_WARN;
+	    break;
+	case 1:
+	    return TOK_DEV;
+	    break;
+	case 2:
+	    return TOK_QDISC;
+	    break;
+	case 3:
+	    return TOK_INGRESS;
+	    break;
+	case 4:
+	    { BEGIN(INITIAL);
+				  return TOK_CLASS; }
+	    break;
+	case 5:
+	    return TOK_ON;
+	    break;
+	case 6:
+	    return TOK_IF;
+	    break;
+	case 7:
+	    return TOK_IF_ANCHOR;
+	    break;
+	case 8:
+	    return TOK_FILTER;
+	    break;
+	case 9:
+	    return TOK_ELEMENT;
+	    break;
+	case 10:
+	    return TOK_TUNNEL;
+	    break;
+	case 11:
+	    return TOK_POLICE;
+	    break;
+	case 12:
+	    return TOK_BUCKET;
+	    break;
+	case 13:
+	    return TOK_CONFORM;
+	    break;
+	case 14:
+	    return TOK_COUNT;
+	    break;
+	case 15:
+	    return TOK_ELSE;
+	    break;
+	case 16:
+	    return TOK_PASS;
+	    break;
+	case 17:
+	    return TOK_RECLASSIFY;
+	    break;
+	case 18:
+	    { BEGIN(INITIAL);
+				  return TOK_DROP; }
+	    break;
+	case 19:
+	    return TOK_CONTINUE;
+	    break;
+	case 20:
+	    return TOK_FIELD;
+	    break;
+	case 21:
+	    return TOK_FIELD_ROOT;
+	    break;
+	case 22:
+	    return TOK_PRAGMA;
+	    break;
+	case 23:
+	    return TOK_TAG;
+	    break;
+	case 24:
+	    return TOK_CBQ;
+	    break;
+	case 25:
+	    return TOK_DSMARK;
+	    break;
+	case 26:
+	    return TOK_EGRESS;
+	    break;
+	case 27:
+	    return TOK_FIFO;
+	    break;
+	case 28:
+	    return TOK_GRED;
+	    break;
+	case 29:
+	    return TOK_HTB;
+	    break;
+	case 30:
+	    return TOK_PRIO;
+	    break;
+	case 31:
+	    return TOK_RED;
+	    break;
+	case 32:
+	    return TOK_SFQ;
+	    break;
+	case 33:
+	    return TOK_TBF;
+	    break;
+	case 34:
+	    return TOK_FW;
+	    break;
+	case 35:
+	    return TOK_ROUTE;
+	    break;
+	case 36:
+	    return TOK_RSVP;
+	    break;
+	case 37:
+	    return TOK_TCINDEX;
+	    break;
+	case 38:
+	    return TOK_AH;
+	    break;
+	case 39:
+	    return TOK_ALLOT;
+	    break;
+	case 40:
+	    return TOK_AVPKT;
+	    break;
+	case 41:
+	    return TOK_BANDWIDTH;
+	    break;
+	case 42:
+	    return TOK_BANDS;
+	    break;
+	case 43:
+	    return TOK_BOUNDED;
+	    break;
+	case 44:
+	    return TOK_BURST;
+	    break;
+	case 45:
+	    return TOK_CBURST;
+	    break;
+	case 46:
+	    return TOK_CEIL;
+	    break;
+	case 47:
+	    return TOK_DEFAULT;
+	    break;
+	case 48:
+	    return TOK_DEFAULT_INDEX;
+	    break;
+	case 49:
+	    return TOK_DPORT;
+	    break;
+	case 50:
+	    return TOK_DST;
+	    break;
+	case 51:
+	    return TOK_ECN;
+	    break;
+	case 52:
+	    return TOK_ESP;
+	    break;
+	case 53:
+	    return TOK_EWMA;
+	    break;
+	case 54:
+	    return TOK_FALL_THROUGH;
+	    break;
+	case 55:
+	    return TOK_FROM;
+	    break;
+	case 56:
+	    return TOK_FROMIF;
+	    break;
+	case 57:
+	    return TOK_GRIO;
+	    break;
+	case 58:
+	    return TOK_HASH;
+	    break;
+	case 59:
+	    return TOK_ISOLATED;
+	    break;
+	case 60:
+	    return TOK_INDICES;
+	    break;
+	case 61:
+	    return TOK_IPPROTO;
+	    break;
+	case 62:
+	    return TOK_LIMIT;
+	    break;
+	case 63:
+	    return TOK_MASK;
+	    break;
+	case 64:
+	    return TOK_MAX;
+	    break;
+	case 65:
+	    return TOK_MAXBURST;
+	    break;
+	case 66:
+	    return TOK_MIN;
+	    break;
+	case 67:
+	    return TOK_MINBURST;
+	    break;
+	case 68:
+	    return TOK_MPU;
+	    break;
+	case 69:
+	    return TOK_MTU;
+	    break;
+	case 70:
+	    return TOK_ORDER;
+	    break;
+	case 71:
+	    return TOK_OVERFLOW;
+	    break;
+	case 72:
+	    return TOK_PASS_ON;
+	    break;
+	case 73:
+	    return TOK_PEAKRATE;
+	    break;
+	case 74:
+	    return TOK_PERTURB;
+	    break;
+	case 75:
+	    return TOK_PRIOMAP;
+	    break;
+	case 76:
+	    return TOK_PROBABILITY;
+	    break;
+	case 77:
+	    return TOK_PROTOCOL;
+	    break;
+	case 78:
+	    return TOK_QUANTUM;
+	    break;
+	case 79:
+	    return TOK_RATE;
+	    break;
+	case 80:
+	    return TOK_R2Q;
+	    break;
+	case 81:
+	    return TOK_SET_TC_INDEX;
+	    break;
+	case 82:
+	    return TOK_SHIFT;
+	    break;
+	case 83:
+	    return TOK_SKIP;
+	    break;
+	case 84:
+	    return TOK_SPORT;
+	    break;
+	case 85:
+	    return TOK_SRC;
+	    break;
+	case 86:
+	    return TOK_TO;
+	    break;
+	case 87:
+	    return TOK_VALUE;
+	    break;
+	case 88:
+	    return TOK_WEIGHT;
+	    break;
+	case 89:
+	    return TOK_HOST;
+	    break;
+	case 90:
+	    return TOK_HOST;
+	    break;
+	case 91:
+	    return TOK_HOST4;
+	    break;
+	case 92:
+	    return TOK_HOST6;
+	    break;
+	case 93:
+	    return TOK_PRECOND;
+	    break;
+	case 94:
+	    return TOK_SPRINTF;
+	    break;
+	case 95:
+	    { yylval.str = stralloc(yytext+1);
+				  return VARIABLE; }
+	    break;
+	case 96:
+	    { char *end;
+				  yylval.unum = strtoul(yytext,&end,0);
+				  if (*end) yyerror("invalid digit in number");
+				  return UNUM; }
+	    break;
+	case 97:
+	    { yylval.unum = strtoul(yytext+2,NULL,2);
+				  return UNUM; }
+	    break;
+	case 98:
+	    { yylval.fnum = atof(yytext);
+				  return FNUM; }
+	    break;
+	case 99:
+	    {
+				    yylval.u128 = ipv6_host(yytext,0);
+				    return IPV6;
+				}
+	    break;
+	case 100:
+	    { yylval.unum = ipv4_host(yytext,1);
+				  return IPV4; }
+	    break;
+	case 101:
+	    lineno += *yytext == '\n';
+	    break;
+	case 102:
+	    { char *start = strchr(yytext,'"')+1;
+				  *strchr(start,'"') = 0;
+				  /*
+				   * /lib/cpp converts  # 1 ""  to  # 1 "."
+				   * so we need to filter this when we're
+				   * invoked from tcsim
+				   */
+				  input_file(strcmp(start,".") ? start : "");
+				  lineno = strtol(yytext+2,NULL,0); }
+	    break;
+	case 103:
+	    { *strrchr(yytext,'"') = 0;
+				  yylval.str = stralloc(yytext+1);
+				  return STRING; }
+	    break;
+	case 104:
+	    { FIELD *field = field_find(yytext);
+				  if (field) {
+					yylval.field = field;
+					return FIELD_NAME;
+				  }
+				  yylval.str = stralloc(yytext);
+				  return WORD; }
+	    break;
+	case 105:
+	    return SHIFT_LEFT;
+	    break;
+	case 106:
+	    return SHIFT_RIGHT;
+	    break;
+	case 107:
+	    return REL_EQ;
+	    break;
+	case 108:
+	    return REL_NE;
+	    break;
+	case 109:
+	    return REL_LE;
+	    break;
+	case 110:
+	    return REL_GE;
+	    break;
+	case 111:
+	    return LOGICAL_AND;
+	    break;
+	case 112:
+	    return LOGICAL_OR;
+	    break;
+	case 113:
+	    { BEGIN(ANCHOR);
+				  return '='; }
+	    break;
+	case 114:
+	    { BEGIN(INITIAL);
+				  return '}'; }
+	    break;
+	case 115:
+	    return *yytext;
+	    break;
+	}
+    }
+}
+
+
+/* -------------------------------- *yy...* -------------------------------- */
+
+
+void vyyerrorf(const char *fmt,va_list ap)
+{
+    fflush(stdout);
+    print_current_location(stderr);
+    fprintf(stderr,": ");
+    vfprintf(stderr,fmt,ap);
+    fprintf(stderr," near \"%s\"\n",yytext);
+    exit(1);
+}
+
+
+void yyerrorf(const char *fmt,...)
+{
+    va_list ap;
+
+    va_start(ap,fmt);
+    vyyerrorf(fmt,ap);
+    va_end(ap);
+}
+
+
+void yyerror(const char *s)
+{
+    yyerrorf("%s",s);
+}
+
+
+void vyywarnf(const char *fmt,va_list ap)
+{
+    if (no_warn) return;
+    fflush(stdout);
+    print_current_location(stderr);
+    fprintf(stderr,": warning: ");
+    vfprintf(stderr,fmt,ap);
+    fprintf(stderr," near \"%s\"\n",yytext);
+    fflush(stderr);
+}
+
+
+void yywarnf(const char *fmt,...)
+{
+    va_list ap;
+
+    va_start(ap,fmt);
+    vyywarnf(fmt,ap);
+    va_end(ap);
+}
+
+
+void yywarn(const char *s)
+{
+    yywarnf("%s",s);
+}
+
+
+/* --------------------------------- *l...* -------------------------------- */
+
+
+void vlerrorf(LOCATION loc,const char *fmt,va_list ap)
+{
+    fflush(stdout);
+    print_location(stderr,loc);
+    fprintf(stderr,": ");
+    vfprintf(stderr,fmt,ap);
+    fprintf(stderr,"\n",yytext);
+    exit(1);
+}
+
+
+void lerrorf(LOCATION loc,const char *fmt,...)
+{
+    va_list ap;
+
+    va_start(ap,fmt);
+    vlerrorf(loc,fmt,ap);
+    va_end(ap);
+}
+
+
+void lerror(LOCATION loc,const char *s)
+{
+    lerrorf(loc,"%s",s);
+}
+
+
+void lwarnf(LOCATION loc,const char *fmt,...)
+{
+    va_list ap;
+
+    if (no_warn) return;
+    fflush(stdout);
+    print_location(stderr,loc);
+    va_start(ap,fmt);
+    fprintf(stderr,": warning: ");
+    vfprintf(stderr,fmt,ap);
+    fprintf(stderr,"\n");
+    va_end(ap);
+    fflush(stderr);
+}
+
+
+void lwarn(LOCATION loc,const char *s)
+{
+    lwarnf(loc,"%s",s);
+}
+
+
+/* --------------------------------- *...* --------------------------------- */
+
+
+void verrorf(const char *fmt,va_list ap)
+{
+    fflush(stdout);
+    vfprintf(stderr,fmt,ap);
+    fprintf(stderr,"\n");
+    exit(1);
+}
+
+
+void errorf(const char *fmt,...)
+{
+    va_list ap;
+
+    va_start(ap,fmt);
+    verrorf(fmt,ap);
+    va_end(ap);
+}
+
+
+void error(const char *s)
+{
+    errorf("%s",s);
+    exit(1);
+}
+
+
+void warnf(const char *fmt,...)
+{
+    va_list ap;
+
+    if (no_warn) return;
+    fflush(stdout);
+    va_start(ap,fmt);
+    fprintf(stderr,"warning: ");
+    vfprintf(stderr,fmt,ap);
+    fprintf(stderr,"\n");
+    va_end(ap);
+    fflush(stderr);
+}
+
+
+void warn(const char *s)
+{
+    warnf("%s",s);
+}
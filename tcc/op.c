@@ -19,6 +19,7 @@
 #include "error.h"
 #include "data.h"
 #include "op.h"
+#include "stats.h"
 
 
 #define UNTYPED_NUMBER(d) \
@@ -746,6 +747,7 @@ static OP *alloc_op(void)
 {
     OP *op = alloc_t(OP);
 
+    IR_NODE_NEW();
     memset(op,0,sizeof(*op));
     return op;
 }
@@ -756,7 +758,10 @@ static DATA eval_op(OP *op)
     DATA d;
 
     d = op->dsc->eval(op);
-    if (!d.op) free(op);
+    if (!d.op) {
+	free(op);
+	IR_NODES_FREED(1);
+    }
     return d;
 }
 
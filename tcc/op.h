@@ -31,6 +31,8 @@ typedef struct _op {
     const OP_DSC *dsc;
     DATA a,b;		/* unused operands are initialized to dt_none */
     DATA c;		/* for : : */
+    struct _expr_node *node;
+	/* non-NULL if hash-consed, see iflib_dag.c; must not be changed then */
 } OP;
 
 
@@ -21,6 +21,7 @@
 
 
 POLICE *policers = NULL;
+unsigned long police_changes = 0;
 static POLICE **last = &policers;
 
 
@@ -133,6 +134,7 @@ static void dump_police_tc(POLICE *police)
     tc_more(" index %lu",(unsigned long) police->number);
     if (police->created) return;
     police->created = 1;
+    police_changes++;
     if (prm_avrate.present) tc_add_rate("avrate",prm_avrate.v);
     if (prm_rate.present) {
 	tc_add_rate("rate",prm_rate.v);
@@ -233,6 +235,7 @@ POLICE *get_drop_policer(LOCATION loc)
     if (!police->used) {
 	assign_policer_ids(policers);
 	police->used = 1;
+	police_changes++;
     }
     return police;
 }
@@ -254,6 +257,7 @@ void add_police(POLICE *police)
     }
     police->used = 0;
     police->created = 0;
+    police_changes++;
     *last = police;
     last = &police->next;
     police->next = NULL;
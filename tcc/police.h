@@ -17,6 +17,7 @@
 
 
 extern POLICE *policers;
+extern unsigned long police_changes; /* policers added or first dumped */
 
 extern PARAM_DEF police_def;
 extern PARAM_DEF bucket_def;
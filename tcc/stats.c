@@ -0,0 +1,263 @@
+/*
+ * stats.c - Per-phase compile time and memory statistics
+ */
+
+/*
+ * Each phase is accounted for in a record per qdisc and phase name. Records
+ * are kept in the order in which they were first used, so the JSON output
+ * roughly follows the order of processing.
+ *
+ * Times and allocations are exclusive, i.e., when a phase begins, what has
+ * accumulated since the enclosing phase began or last resumed is charged to
+ * the enclosing phase, and the enclosing phase resumes when the nested one
+ * ends. The sum over all records is therefore the total. The peak number of
+ * expression nodes is inclusive, since nested phases hold the nodes of their
+ * callers.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "config.h"
+#include "util.h"
+#include "error.h"
+#include "tree.h"
+#include "stats.h"
+
+
+unsigned long ir_nodes = 0;
+unsigned long ir_peak = 0;
+
+
+struct phase_stats {
+    const char *phase;
+    const QDISC *qdisc;
+    int child;			/* external process; no allocations or nodes */
+    unsigned long calls;
+    double wall,cpu;		/* seconds */
+    unsigned long allocs,bytes;
+    unsigned long peak_nodes;
+    struct phase_stats *next;
+};
+
+struct snapshot {
+    double wall,cpu;
+    unsigned long allocs,bytes;
+};
+
+struct frame {
+    struct phase_stats *stats;
+    struct snapshot since;	/* when we began or last resumed */
+    unsigned long outer_peak;	/* ir_peak of the enclosing phase */
+    struct frame *next;
+};
+
+
+static struct phase_stats *records = NULL,**last = &records;
+static struct frame *stack = NULL;
+
+
+/* ----- Measurements ------------------------------------------------------ */
+
+
+static double seconds(const struct timeval *tv)
+{
+    return tv->tv_sec+tv->tv_usec/1000000.0;
+}
+
+
+static void take_snapshot(struct snapshot *s)
+{
+    struct timeval now;
+    struct rusage usage;
+
+    gettimeofday(&now,NULL);
+    s->wall = seconds(&now);
+    if (getrusage(RUSAGE_SELF,&usage) < 0) {
+	perror("getrusage");
+	exit(1);
+    }
+    s->cpu = seconds(&usage.ru_utime)+seconds(&usage.ru_stime);
+    s->allocs = alloc_count;
+    s->bytes = alloc_bytes;
+}
+
+
+static void charge(struct frame *f,const struct snapshot *now)
+{
+    f->stats->wall += now->wall-f->since.wall;
+    f->stats->cpu += now->cpu-f->since.cpu;
+    f->stats->allocs += now->allocs-f->since.allocs;
+    f->stats->bytes += now->bytes-f->since.bytes;
+    f->since = *now;
+}
+
+
+static struct phase_stats *lookup(const char *phase,const QDISC *qdisc)
+{
+    struct phase_stats *s;
+
+    for (s = records; s; s = s->next)
+	if (s->phase == phase && s->qdisc == qdisc) return s;
+    s = alloc_t(struct phase_stats);
+    memset(s,0,sizeof(*s));
+    s->phase = phase;
+    s->qdisc = qdisc;
+    *last = s;
+    last = &s->next;
+    return s;
+}
+
+
+/* ----- Phases ------------------------------------------------------------ */
+
+
+void stats_begin(const char *phase,const QDISC *qdisc)
+{
+    struct frame *f;
+    struct snapshot now;
+
+    if (!stats_file) return;
+    take_snapshot(&now);
+    if (stack) {
+	charge(stack,&now);
+	if (!qdisc) qdisc = stack->stats->qdisc;
+    }
+    f = alloc_t(struct frame);
+    f->stats = lookup(phase,qdisc);
+    f->stats->calls++;
+    f->outer_peak = ir_peak;
+    f->next = stack;
+    stack = f;
+    ir_peak = ir_nodes;
+    /* don't charge our own bookkeeping to the new phase */
+    take_snapshot(&f->since);
+}
+
+
+void stats_end(void)
+{
+    struct frame *f = stack;
+    struct snapshot now;
+
+    if (!stats_file) return;
+    take_snapshot(&now);
+    charge(f,&now);
+    if (ir_peak > f->stats->peak_nodes) f->stats->peak_nodes = ir_peak;
+    if (f->outer_peak > ir_peak) ir_peak = f->outer_peak;
+    stack = f->next;
+    free(f);
+    if (stack) take_snapshot(&stack->since);
+}
+
+
+void stats_child(const char *phase,const struct timeval *start)
+{
+    struct phase_stats *s;
+    struct timeval now;
+    struct rusage usage;
+
+    if (!stats_file) return;
+    gettimeofday(&now,NULL);
+    if (getrusage(RUSAGE_CHILDREN,&usage) < 0) {
+	perror("getrusage");
+	exit(1);
+    }
+    s = lookup(phase,NULL);
+    s->child = 1;
+    s->calls++;
+    s->wall += seconds(&now)-seconds(start);
+    s->cpu = seconds(&usage.ru_utime)+seconds(&usage.ru_stime);
+	/* RUSAGE_CHILDREN is cumulative, so this only works for the first */
+}
+
+
+/* ----- JSON output ------------------------------------------------------- */
+
+
+static void json_string(FILE *file,const char *s)
+{
+    putc('"',file);
+    while (*s) {
+	if (*s == '"' || *s == '\\') fprintf(file,"\\%c",*s);
+	else if ((unsigned char) *s < ' ')
+	    fprintf(file,"\\u%04x",(unsigned char) *s);
+	else putc(*s,file);
+	s++;
+    }
+    putc('"',file);
+}
+
+
+static void write_record(FILE *file,const struct phase_stats *s)
+{
+    fprintf(file,"    { ");
+    if (s->qdisc) {
+	fprintf(file,"\"device\": ");
+	json_string(file,s->qdisc->parent.device->name);
+	fprintf(file,", \"qdisc\": \"%x:0\", ",(int) s->qdisc->number);
+    }
+    fprintf(file,"\"phase\": ");
+    json_string(file,s->phase);
+    fprintf(file,", \"calls\": %lu, \"wall\": %.6f, \"cpu\": %.6f",
+      s->calls,s->wall,s->cpu);
+    if (!s->child)
+	fprintf(file,", \"allocs\": %lu, \"bytes\": %lu, \"peak_nodes\": %lu",
+	  s->allocs,s->bytes,s->peak_nodes);
+    fprintf(file," }");
+}
+
+
+void write_stats(const char *file_name)
+{
+    const struct phase_stats *s;
+    struct phase_stats total;
+    struct rusage usage;
+    FILE *file;
+
+    memset(&total,0,sizeof(total));
+    for (s = records; s; s = s->next) {
+	if (s->child) continue; /* overlaps with parsing */
+	total.wall += s->wall;
+	total.cpu += s->cpu;
+	total.allocs += s->allocs;
+	total.bytes += s->bytes;
+	if (s->peak_nodes > total.peak_nodes) total.peak_nodes = s->peak_nodes;
+    }
+    if (getrusage(RUSAGE_SELF,&usage) < 0) {
+	perror("getrusage");
+	exit(1);
+    }
+    fflush(stdout);
+    fflush(stderr);
+    if (!strcmp(file_name,"stderr")) file = stderr;
+    else {
+	file = fopen(file_name,"w");
+	if (!file) {
+	    perror(file_name);
+	    exit(1);
+	}
+    }
+    fprintf(file,"{\n  \"wall\": %.6f,\n  \"cpu\": %.6f,\n",total.wall,
+      total.cpu);
+    fprintf(file,"  \"allocs\": %lu,\n  \"bytes\": %lu,\n",total.allocs,
+      total.bytes);
+    fprintf(file,"  \"peak_nodes\": %lu,\n  \"maxrss\": %ld,\n",
+      total.peak_nodes,usage.ru_maxrss);
+    fprintf(file,"  \"phases\": [\n");
+    for (s = records; s; s = s->next) {
+	write_record(file,s);
+	fprintf(file,"%s\n",s->next ? "," : "");
+    }
+    fprintf(file,"  ]\n}\n");
+    fflush(file);
+    if (ferror(file)) errorf("error writing to \"%s\"",file_name);
+    if (file != stderr && fclose(file) == EOF) {
+	perror(file_name);
+	exit(1);
+    }
+}
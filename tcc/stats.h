@@ -0,0 +1,51 @@
+/*
+ * stats.h - Per-phase compile time and memory statistics
+ */
+
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <sys/time.h>
+
+#include "tree.h"
+
+
+/*
+ * Number of live expression nodes (OPs), and the highest number seen since
+ * the innermost phase began. These are updated whether statistics are
+ * collected or not.
+ */
+
+extern unsigned long ir_nodes;
+extern unsigned long ir_peak;
+
+#define IR_NODE_NEW() \
+  do { if (++ir_nodes > ir_peak) ir_peak = ir_nodes; } while (0)
+#define IR_NODES_FREED(n) \
+  do { ir_nodes -= (n); } while (0)
+
+
+/*
+ * stats_begin and stats_end bracket a phase. Phases can nest, and time and
+ * allocations of a nested phase are not counted for the enclosing one. A phase
+ * that has no qdisc of its own belongs to the qdisc of the enclosing phase.
+ * Phases are accumulated per qdisc and phase name, so "phase" must be a
+ * string constant.
+ *
+ * All of this does nothing unless "stats_file" is set.
+ */
+
+void stats_begin(const char *phase,const QDISC *qdisc);
+void stats_end(void);
+
+/*
+ * stats_child records the time and resource usage of a child process that has
+ * just been reaped, e.g., cpp. "start" is the time when it was started.
+ */
+
+void stats_child(const char *phase,const struct timeval *start);
+
+void write_stats(const char *file_name);
+
+#endif /* STATS_H */
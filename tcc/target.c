@@ -121,10 +121,20 @@ void ext_target_register(const char *target)
 }
 
 
+struct ext_target *ext_target_find(const char *name)
+{
+    struct ext_target *target;
+
+    for (target = ext_targets; target; target = target->next)
+	if (!strcmp(target->name,name)) break;
+    return target;
+}
+
+
 void ext_targets_configure(void)
 {
-    const struct ext_target *target;
+    struct ext_target *target;
 
     for (target = ext_targets; target; target = target->next)
-	ext_config(target->name);
+	ext_config(target);
 }
@@ -16,6 +16,7 @@
 
 struct ext_target {
     const char *name;
+    int binary;			/* reads the binary encoding */
     struct ext_target *next;
 };
 
@@ -25,6 +26,7 @@ void target_register(const char *element,const char *target,int on);
 int have_target(const char *element,const char *target);
 void switch_target(const char *arg); /* [element:][no]target */
 void ext_target_register(const char *target);
+struct ext_target *ext_target_find(const char *name);
 void ext_targets_configure(void);
 
 #endif /* TARGET_H */
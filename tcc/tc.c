@@ -24,9 +24,70 @@
 #include "tc.h"
 
 
+static int commands = 0; /* number of tc commands issued */
+
+
+/*
+ * In batch mode, we omit the leading "tc", so that the output can be fed to
+ * tc -batch.
+ */
+
+void tc_begin(void)
+{
+    commands++;
+    if (!tc_batch) printf("tc ");
+}
+
+
+/*
+ * tc -batch can't load modules, so we only mention them.
+ */
+
+void tc_insmod(const char *type,const char *name)
+{
+    printf("%sinsmod %s_%s.o\n",tc_batch ? "# " : "",type,name);
+}
+
+
+void tc_reset_count(void)
+{
+    commands = 0;
+}
+
+
+int tc_count(void)
+{
+    return commands;
+}
+
+
+void tc_add_count(int n)
+{
+    commands += n;
+}
+
+
+void tc_summary(void)
+{
+    if (!tc_batch) return;
+    printf("%s# %d command%s, estimated install time %.3f s (%.3f s with one "
+      "tc per command)\n",quiet ? "" : "\n",commands,
+      commands == 1 ? "" : "s",
+      commands*TC_BATCH_CMD_USEC/1000000.0,commands*TC_CMD_USEC/1000000.0);
+    /*
+     * Removing a qdisc the device doesn't have (usually the ingress qdisc)
+     * fails, and plain tc -batch stops at the first error.
+     */
+    if (remove_qdiscs)
+	printf("# install with \"tc -force -batch\", some \"qdisc del\" may "
+	  "fail\n");
+}
+
+
 static void tc_qdisc_op(const QDISC *qdisc,const char *name,const char *op)
 {
-    printf("tc qdisc %s dev %s ",op,qdisc->parent.device->name);
+    tc_begin();
+    printf("qdisc %s dev %s ",op,qdisc->parent.device->name);
     if (qdisc->dsc != &ingress_dsc) {
 	printf("handle %x:0 ",(int) qdisc->number);
 	if (qdisc->parent.qdisc)
@@ -66,7 +127,8 @@ void tc_add_classid(const CLASS *class,int accept_invalid)
 
 void __tc_class_op(const CLASS *class,const char *name,const char *op)
 {
-    printf("tc class %s dev %s",op,class->parent.device->name);
+    tc_begin();
+    printf("class %s dev %s",op,class->parent.device->name);
     if (class->parent.class)
 	printf(" parent %x:%x",(int) class->parent.qdisc->number,
 	  (int) class->parent.class->number);
@@ -125,7 +187,8 @@ static void tc_protocol_add(const FILTER *filter,uint16_t protocol)
 
 void __tc_filter_add2(const FILTER *filter,uint16_t protocol,int prio_offset)
 {
-    printf("tc filter add dev %s parent %x:%x",
+    tc_begin();
+    printf("filter add dev %s parent %x:%x",
       filter->parent.device->name,(int) filter->parent.qdisc->number,
       filter->parent.class ? (int) filter->parent.class->number : 0);
     tc_protocol_add(filter,protocol);
@@ -148,7 +211,8 @@ void tc_filter_add(const FILTER *filter,uint16_t protocol)
 
 void tc_element_add(const ELEMENT *element,uint16_t protocol)
 {
-    printf("tc filter add dev %s parent %x:%x",
+    tc_begin();
+    printf("filter add dev %s parent %x:%x",
       element->parent.filter->parent.device->name,
       (int) element->parent.filter->parent.qdisc->number,
       element->parent.filter->parent.class ?
@@ -17,6 +17,12 @@
 #include "tree.h"
 
 
+void tc_begin(void);
+void tc_reset_count(void);
+int tc_count(void);
+void tc_add_count(int n);
+void tc_summary(void);
+void tc_insmod(const char *type,const char *name);
 void __tc_qdisc_add(const QDISC *qdisc,const char *name);
 void tc_qdisc_add(const QDISC *qdisc);
 void __tc_class_op(const CLASS *class,const char *name,const char *op);
@@ -44,4 +50,6 @@ void tc_nl(void);
 
 void tc_pragma(const PARAM *params);
 
+void tc_diff(const char *old_file);
+
 #endif /* TC_H */
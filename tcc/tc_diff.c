@@ -0,0 +1,532 @@
+/*
+ * tc_diff.c - Incremental reconfiguration
+ */
+
+/*
+ * tc_diff generates the tc commands that turn a configuration previously
+ * generated by tcc into the current one, without touching the parts that
+ * didn't change.
+ *
+ * Both configurations are read as lists of tc commands, and grouped into
+ * elements:
+ *
+ * - a qdisc, with the "add" and any "change" commands for its handle
+ * - a class, with all commands for its class ID
+ * - a filter, with all the commands for the same parent, protocol, and
+ *   priority (i.e. all the elements of one filter, or a u32 filter with all
+ *   its hash tables)
+ *
+ * Elements that are identical in both configurations are left alone.
+ * Qdiscs and classes whose parameters changed get "change" commands. If the
+ * kind or the parent of a qdisc or class changed, the qdisc (or the qdisc
+ * containing the class) is deleted and re-created with everything it
+ * contains. Filters can't be changed in place, so a filter that differs is
+ * deleted and added again. Elements that disappeared are deleted, unless
+ * they already went away with the qdisc containing them.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "util.h"
+#include "error.h"
+#include "device.h"
+#include "tc.h"
+
+
+enum tc_elem_type { te_qdisc,te_class,te_filter,te_insmod };
+
+struct tc_line {
+    const char *op;		/* "add", "change", ... (in text) */
+    char *text;			/* command without the leading "tc " */
+    struct tc_line *next;
+};
+
+struct tc_elem {
+    enum tc_elem_type type;
+    char *key;			/* identifies the element in both configs */
+    char *dev;
+    uint32_t major;		/* qdisc handle; 0 if not a qdisc */
+    uint32_t owner;		/* qdisc containing the element; 0 if none */
+    char *header;		/* "dev ... kind" of qdisc or class */
+    char *del;			/* arguments for "del" */
+    int has_add;		/* element is created, not just changed */
+    int replace;		/* qdisc must be re-created */
+    int gone;			/* old: deleted with its qdisc, or early */
+    int fresh;			/* new: must be created from scratch */
+    struct tc_line *lines;
+    struct tc_line **last;
+    struct tc_elem *next;	/* in command order */
+    struct tc_elem *hash_next;
+};
+
+struct tc_config {
+    struct tc_elem *elems;
+    struct tc_elem **last;
+    struct tc_elem *hash[TC_DIFF_HASH];
+    int n;			/* number of elements */
+};
+
+
+/* ----- Parsing ----------------------------------------------------------- */
+
+
+static uint32_t parse_major(const char *file,int line,const char *s)
+{
+    char *end;
+    unsigned long major;
+
+    major = strtoul(s,&end,16);
+    if (*end != ':') errorf("%s:%d: invalid handle \"%s\"",file,line,s);
+    return major;
+}
+
+
+static char *join(char **tok,int from,int to)
+{
+    char *s,*p;
+    int len = 1,i;
+
+    for (i = from; i < to; i++) len += strlen(tok[i])+1;
+    p = s = alloc(len);
+    for (i = from; i < to; i++)
+	p += sprintf(p,"%s%s",i == from ? "" : " ",tok[i]);
+    *p = 0;
+    return s;
+}
+
+
+static unsigned int hash_key(const char *key)
+{
+    unsigned int hash = 0;
+
+    while (*key) hash = hash*31+(unsigned char) *key++;
+    return hash % TC_DIFF_HASH;
+}
+
+
+static struct tc_elem *find_elem(const struct tc_config *cfg,const char *key)
+{
+    struct tc_elem *elem;
+
+    for (elem = cfg->hash[hash_key(key)]; elem; elem = elem->hash_next)
+	if (!strcmp(elem->key,key)) break;
+    return elem;
+}
+
+
+static struct tc_elem *find_qdisc(const struct tc_config *cfg,const char *dev,
+  uint32_t major)
+{
+    struct tc_elem *elem;
+    char *key;
+
+    key = alloc_sprintf("qdisc %s %x",dev,(int) major);
+    elem = find_elem(cfg,key);
+    free(key);
+    return elem;
+}
+
+
+static struct tc_elem *add_line(struct tc_config *cfg,enum tc_elem_type type,
+  char *key,const char *text,const char *op)
+{
+    struct tc_elem *elem;
+    struct tc_line *line;
+
+    elem = find_elem(cfg,key);
+    if (elem) free(key);
+    else {
+	unsigned int hash = hash_key(key);
+
+	elem = alloc_t(struct tc_elem);
+	memset(elem,0,sizeof(struct tc_elem));
+	elem->type = type;
+	elem->key = key;
+	elem->last = &elem->lines;
+	*cfg->last = elem;
+	cfg->last = &elem->next;
+	elem->hash_next = cfg->hash[hash];
+	cfg->hash[hash] = elem;
+	cfg->n++;
+    }
+    line = alloc_t(struct tc_line);
+    line->text = stralloc(text);
+    line->op = line->text+(op-text);
+    line->next = NULL;
+    *elem->last = line;
+    elem->last = &line->next;
+    return elem;
+}
+
+
+/*
+ * Commands look like this (see tc.c):
+ *
+ * qdisc add dev NAME handle MAJOR:0 root|parent MAJOR:MINOR KIND ...
+ * qdisc add dev NAME ingress
+ * class add dev NAME [parent MAJOR:MINOR] classid MAJOR:MINOR KIND ...
+ * filter add dev NAME parent MAJOR:MINOR protocol PROTO prio PRIO ...
+ *
+ * The header of a qdisc or class is everything from "dev" to the kind. The
+ * arguments for deleting an element are the header without the kind.
+ */
+
+static void parse_command(struct tc_config *cfg,const char *file,int line,
+  const char *text)
+{
+    char *buf,*tok[10],*key;
+    struct tc_elem *elem;
+    enum tc_elem_type type;
+    uint32_t major = 0,owner = 0;
+    int n = 0,del,header;
+    char *p;
+
+    buf = stralloc(text);
+    for (p = strtok(buf," "); p && n < 10; p = strtok(NULL," "))
+	tok[n++] = p;
+    if (n < 4 || strcmp(tok[2],"dev"))
+	errorf("%s:%d: unrecognized command",file,line);
+    if (!strcmp(tok[1],"del")) { /* tcc -r */
+	free(buf);
+	return;
+    }
+    if (!strcmp(tok[0],"qdisc")) {
+	type = te_qdisc;
+	if (n == 5 && !strcmp(tok[4],"ingress")) {
+	    major = 0xffff;
+	    del = header = 5;
+	}
+	else {
+	    if (n < 8 || strcmp(tok[4],"handle"))
+		errorf("%s:%d: unrecognized qdisc command",file,line);
+	    major = parse_major(file,line,tok[5]);
+	    if (!strcmp(tok[6],"root")) del = 7;
+	    else {
+		if (n < 9 || strcmp(tok[6],"parent"))
+		    errorf("%s:%d: unrecognized qdisc command",file,line);
+		owner = parse_major(file,line,tok[7]);
+		del = 8;
+	    }
+	    header = del+1;
+	}
+	key = alloc_sprintf("qdisc %s %x",tok[3],major);
+    }
+    else if (!strcmp(tok[0],"class")) {
+	type = te_class;
+	del = n > 4 && !strcmp(tok[4],"parent") ? 8 : 6;
+	if (n < del+1 || strcmp(tok[del-2],"classid"))
+	    errorf("%s:%d: unrecognized class command",file,line);
+	owner = parse_major(file,line,tok[del-1]);
+	header = del+1;
+	key = alloc_sprintf("class %s %s",tok[3],tok[del-1]);
+    }
+    else if (!strcmp(tok[0],"filter")) {
+	type = te_filter;
+	if (n < 10 || strcmp(tok[4],"parent") || strcmp(tok[6],"protocol") ||
+	  strcmp(tok[8],"prio"))
+	    errorf("%s:%d: unrecognized filter command",file,line);
+	owner = parse_major(file,line,tok[5]);
+	del = header = 10;
+	p = join(tok,3,10);
+	key = alloc_sprintf("filter %s",p);
+	free(p);
+    }
+    else errorf("%s:%d: unrecognized command",file,line);
+    elem = add_line(cfg,type,key,text,text+(tok[1]-buf));
+    if (!elem->dev) elem->dev = stralloc(tok[3]);
+    elem->major = major;
+    elem->owner = owner;
+    if (!elem->header || (!elem->has_add && !strcmp(tok[1],"add"))) {
+	free(elem->header);
+	free(elem->del);
+	elem->header = join(tok,2,header);
+	elem->del = join(tok,2,del);
+    }
+    if (!strcmp(tok[1],"add")) elem->has_add = 1;
+    free(buf);
+}
+
+
+static void read_config(struct tc_config *cfg,FILE *file,const char *name)
+{
+    char *buf = NULL;
+    size_t size = 0;
+    ssize_t len;
+    int line = 0;
+
+    cfg->last = &cfg->elems;
+    while ((len = getline(&buf,&size,file)) != -1) {
+	const char *p = buf;
+
+	line++;
+	if (len && buf[len-1] == '\n') buf[len-1] = 0;
+	if (!strncmp(p,"# insmod ",9)) p += 2;
+	if (!strncmp(p,"insmod ",7)) {
+	    if (!find_elem(cfg,p))
+		(void) add_line(cfg,te_insmod,stralloc(p),p,p);
+	    continue;
+	}
+	if (!*p || *p == '#') continue;
+	if (!strncmp(p,"tc ",3)) p += 3;
+	parse_command(cfg,name,line,p);
+    }
+    if (ferror(file)) {
+	perror(name);
+	exit(1);
+    }
+    free(buf);
+}
+
+
+/* ----- Comparing --------------------------------------------------------- */
+
+
+static struct tc_config old,new;
+
+
+static int same_lines(const struct tc_elem *a,const struct tc_elem *b)
+{
+    const struct tc_line *la,*lb;
+
+    for (la = a->lines, lb = b->lines; la && lb; la = la->next, lb = lb->next)
+	if (strcmp(la->text,lb->text)) return 0;
+    return !la && !lb;
+}
+
+
+/*
+ * A qdisc has to be re-created if its kind or its parent changed, or if this
+ * is the case for one of its classes.
+ */
+
+static void find_replaced(void)
+{
+    struct tc_elem *elem;
+
+    for (elem = new.elems; elem; elem = elem->next) {
+	struct tc_elem *old_elem,*qdisc;
+
+	if (elem->type != te_qdisc && elem->type != te_class) continue;
+	old_elem = find_elem(&old,elem->key);
+	if (!old_elem || !strcmp(elem->header,old_elem->header)) continue;
+	if (elem->type == te_qdisc) {
+	    elem->replace = old_elem->replace = 1;
+	    continue;
+	}
+	qdisc = find_qdisc(&new,elem->dev,elem->owner);
+	if (qdisc) qdisc->replace = 1;
+	qdisc = find_qdisc(&old,elem->dev,elem->owner);
+	if (qdisc) qdisc->replace = 1;
+    }
+}
+
+
+/*
+ * Qdiscs always precede their content, so we can propagate "gone" and
+ * "fresh" in a single pass.
+ */
+
+static void find_gone(void)
+{
+    struct tc_elem *elem;
+
+    for (elem = old.elems; elem; elem = elem->next) {
+	const struct tc_elem *qdisc;
+
+	if (!elem->owner) continue;
+	qdisc = find_qdisc(&old,elem->dev,elem->owner);
+	if (!qdisc) continue;
+	elem->gone = qdisc->gone || qdisc->replace ||
+	  !find_elem(&new,qdisc->key);
+    }
+}
+
+
+static void find_fresh(void)
+{
+    struct tc_elem *elem;
+
+    for (elem = new.elems; elem; elem = elem->next) {
+	const struct tc_elem *qdisc;
+
+	elem->fresh = elem->replace || !find_elem(&old,elem->key);
+	if (elem->fresh || !elem->owner) continue;
+	qdisc = find_qdisc(&new,elem->dev,elem->owner);
+	elem->fresh = qdisc && qdisc->fresh;
+    }
+}
+
+
+/* ----- Output ------------------------------------------------------------ */
+
+
+static const char *elem_type_name(enum tc_elem_type type)
+{
+    switch (type) {
+	case te_qdisc:
+	    return "qdisc";
+	case te_class:
+	    return "class";
+	case te_filter:
+	    return "filter";
+	default:
+	    abort();
+    }
+}
+
+
+static void tc_del(const struct tc_elem *elem)
+{
+    tc_begin();
+    printf("%s del %s\n",elem_type_name(elem->type),elem->del);
+}
+
+
+static void tc_lines(const struct tc_elem *elem,int change)
+{
+    const struct tc_line *line;
+
+    for (line = elem->lines; line; line = line->next) {
+	tc_begin();
+	if (!change || strncmp(line->op,"add ",4))
+	    printf("%s\n",line->text);
+	else printf("%.*schange%s\n",(int) (line->op-line->text),line->text,
+	      line->op+3);
+    }
+}
+
+
+/*
+ * An old qdisc or class is deleted if it has to be re-created or if it is no
+ * longer there.
+ */
+
+static int deleted(const struct tc_elem *elem)
+{
+    if (elem->type != te_qdisc && elem->type != te_class) return 0;
+    if (elem->gone || !elem->has_add) return 0;
+    return elem->replace || !find_elem(&new,elem->key);
+}
+
+
+/*
+ * A changed filter is deleted early if it may refer to a class we delete.
+ * Otherwise, it is deleted right before it is added again, so that traffic
+ * keeps being classified while the classes it refers to are being set up.
+ */
+
+static int delete_early(const struct tc_elem *filter)
+{
+    const struct tc_elem *elem;
+
+    for (elem = old.elems; elem; elem = elem->next)
+	if (elem->type == te_class && elem->owner == filter->owner &&
+	  !strcmp(elem->dev,filter->dev) && deleted(elem))
+	    return 1;
+    return 0;
+}
+
+
+/*
+ * Order of operations:
+ *
+ * 1) load new modules
+ * 2) delete filters that were removed or that may refer to classes we delete
+ * 3) delete qdiscs and classes, innermost first
+ * 4) add or change everything else, in the order of the new configuration,
+ *    deleting each remaining changed filter just before adding it again
+ */
+
+static void dump_diff(void)
+{
+    struct tc_elem *elem,**elems;
+    int i;
+
+    for (elem = new.elems; elem; elem = elem->next)
+	if (elem->type == te_insmod && elem->fresh)
+	    printf("%s%s\n",tc_batch ? "# " : "",elem->key);
+    for (elem = old.elems; elem; elem = elem->next) {
+	const struct tc_elem *new_elem;
+
+	if (elem->type != te_filter || elem->gone) continue;
+	new_elem = find_elem(&new,elem->key);
+	if (!new_elem) tc_del(elem);
+	else if (!same_lines(elem,new_elem) && delete_early(elem)) {
+	    tc_del(elem);
+	    elem->gone = 1;
+	}
+    }
+    elems = alloc(sizeof(struct tc_elem *)*(old.n+1));
+    i = 0;
+    for (elem = old.elems; elem; elem = elem->next) elems[i++] = elem;
+    while (i--) {
+	elem = elems[i];
+	if (deleted(elem)) tc_del(elem);
+    }
+    free(elems);
+    for (elem = new.elems; elem; elem = elem->next) {
+	const struct tc_elem *old_elem;
+
+	if (elem->type == te_insmod) continue;
+	if (elem->fresh) {
+	    tc_lines(elem,0);
+	    continue;
+	}
+	old_elem = find_elem(&old,elem->key);
+	if (same_lines(elem,old_elem)) continue;
+	if (elem->type == te_filter && !old_elem->gone) tc_del(old_elem);
+	tc_lines(elem,elem->type != te_filter);
+    }
+}
+
+
+void tc_diff(const char *old_file)
+{
+    FILE *file;
+    int saved;
+
+    file = fopen(old_file,"r");
+    if (!file) {
+	perror(old_file);
+	exit(1);
+    }
+    read_config(&old,file,old_file);
+    (void) fclose(file);
+
+    /*
+     * Generate the new configuration as usual, but into a temporary file.
+     */
+    file = tmpfile();
+    if (!file) {
+	perror("tmpfile");
+	exit(1);
+    }
+    fflush(stdout);
+    saved = dup(1);
+    if (saved < 0 || dup2(fileno(file),1) < 0) {
+	perror("dup2");
+	exit(1);
+    }
+    dump_devices();
+    fflush(stdout);
+    if (dup2(saved,1) < 0) {
+	perror("dup2");
+	exit(1);
+    }
+    (void) close(saved);
+    rewind(file);
+    read_config(&new,file,"new configuration");
+    (void) fclose(file);
+
+    find_replaced();
+    find_gone();
+    find_fresh();
+    tc_reset_count();
+    dump_diff();
+    tc_summary();
+}
@@ -29,6 +29,8 @@
 #include "ext.h"
 #include "ext_all.h"
 #include "location.h"
+#include "tc.h"
+#include "stats.h"
 
 
 #define STRING(s) #s
@@ -41,8 +43,12 @@ DATA_LIST *pragma = NULL;
 const char *default_device = DEFAULT_DEVICE;
 const char *location_file = NULL;
 const char *var_use_file = NULL;
+const char *profile_file = NULL;
+const char *stats_file = NULL;
+const char *previous_file = NULL;
 int alg_mode = 0;
 int remove_qdiscs = 0;
+int tc_batch = 0;
 int quiet = 0;
 int debug = 0;
 int no_warn = 0;
@@ -55,6 +61,7 @@ REGISTRY optimization_switches;
 
 
 static pid_t pid;
+static struct timeval cpp_start;
 
 
 static void kill_cpp(void)
@@ -71,6 +78,7 @@ static void run_cpp(int argc,char *const *argv,int use_pipe)
 	perror("pipe");
 	exit(1);
     }
+    gettimeofday(&cpp_start,NULL);
     pid = fork();
     if (pid < 0) {
 	perror("fork");
@@ -110,6 +118,7 @@ static void finish_cpp(void)
 	exit(1);
     }
     pid = 0; /* already dead */
+    stats_child("cpp",&cpp_start);
     if (!WIFEXITED(status)) error("abnormal termination of cpp");
     if (WEXITSTATUS(status)) exit(WEXITSTATUS(status));
 }
@@ -120,16 +129,19 @@ static void finish_cpp(void)
 
 static void usage(const char *name)
 {
-    fprintf(stderr,"usage: %s [-c] [-d ...] [-E] [-f infile] "
+    fprintf(stderr,"usage: %s [-b] [-c] [-d ...] [-E] [-f infile] "
       "[-i default_interface]\n",name);
-    fprintf(stderr,"%10s [-l location_file] [-n] [-q] [-r] [-w] [-W[no]...]\n",
-      "");
-    fprintf(stderr,"%10s [-O[no]...] [-x elem:ext_target ...] "
-      "[-t [elem:][no]target ...]\n","");
-    fprintf(stderr,"%10s [-u var_use_file] [-Xphase,arg] [cpp_option ...]\n",
-      "");
-    fprintf(stderr,"%10s [infile]\n","");
+    fprintf(stderr,"%10s [-j jobs] [-l location_file] [-n] [-p old_config] "
+      "[-q] [-r] [-w]\n","");
+    fprintf(stderr,"%10s [-s stats_file] [-W[no]...] [-O[no]...] "
+      "[-P profile]\n","");
+    fprintf(stderr,"%10s [-x elem:ext_target ...]\n","");
+    fprintf(stderr,"%10s [-t [elem:][no]target ...] [-u var_use_file] "
+      "[-Xphase,arg]\n","");
+    fprintf(stderr,"%10s [cpp_option ...] [infile]\n","");
     fprintf(stderr,"%6s %s -V\n\n","",name);
+    fprintf(stderr,"  -b                    produce output for tc -batch "
+      "(tc only)\n");
     fprintf(stderr,"  -c                    only check validity\n");
     fprintf(stderr,"  -d ...                increase debugging level\n");
     fprintf(stderr,"  -E                    run cpp only\n");
@@ -139,17 +151,28 @@ static void usage(const char *name)
       "description file\n");
     fprintf(stderr,"                        (default: "
       STRING(DEFAULT_DEVICE) ")\n");
+    fprintf(stderr,"  -j jobs               dump up to this many devices in "
+      "parallel (0: one per\n");
+    fprintf(stderr,"                        CPU; default: 1)\n");
     fprintf(stderr,"  -l location_file      write a list of source code "
       "locations of traffic\n");
     fprintf(stderr,"                        control elements (\"stderr\" for "
       "standard error)\n");
     fprintf(stderr,"  -n                    do not include default.tc\n");
+    fprintf(stderr,"  -p old_config         only output commands to change "
+      "old_config (tc only)\n");
+    fprintf(stderr,"  -P profile            order rules by class hit counts "
+      "from profile\n");
     fprintf(stderr,"  -q                    quiet, produce terse output\n");
     fprintf(stderr,"  -r                    remove old qdiscs (tc only)\n");
+    fprintf(stderr,"  -s stats_file         write time and memory use per "
+      "phase as JSON\n");
+    fprintf(stderr,"                        (\"stderr\" for standard "
+      "error)\n");
     fprintf(stderr,"  -t [elem:][no]target  enable or disable target\n");
     fprintf(stderr,"                        elements: if\n");
-    fprintf(stderr,"                        targets: all, tc, c, ext; default: "
-      "tc\n");
+    fprintf(stderr,"                        targets: all, tc, c, bpf, ext; "
+      "default: tc\n");
     fprintf(stderr,"  -u variable_use_file  for each variable, write name and "
       "value\n");
     fprintf(stderr,"  -V                    print version number and exit\n");
@@ -171,12 +194,24 @@ static void usage(const char *name)
       "defined (default: on)\n");
     fprintf(stderr,"  -W[no]constpfx        warn if taking prefix of IP "
       "constant (default: off)\n");
+    fprintf(stderr,"  -W[no]shadow          warn about rules that can never "
+      "match (default: on)\n");
     fprintf(stderr,"  -O[no]cse             common subexpression "
       "elimination (default: on)\n");
+    fprintf(stderr,"  -O[no]ctree           generate a decision tree for "
+      "\"c\" target (def: off)\n");
     fprintf(stderr,"  -O[no]ne              turn != into multiple ==s "
       "(default: off)\n");
     fprintf(stderr,"  -O[no]prefix          generate prefix matches instead "
       "of bit tests (def: off)\n");
+    fprintf(stderr,"  -O[no]range           turn ranges into few prefix "
+      "matches (default: on)\n");
+    fprintf(stderr,"  -O[no]shadow          drop rules and tests that never "
+      "matter (default: on)\n");
+    fprintf(stderr,"  -O[no]u32hash         put long rule sequences into u32 "
+      "hash tables (def: on)\n");
+    fprintf(stderr,"  -O[no]u32trie         nest u32 hash tables, e.g. one per "
+      "octet (def: on)\n");
     fprintf(stderr,"  -x elem:ext_target    register external target\n");
     fprintf(stderr,"  -Xphase,arg           verbatim argument for specific "
       "build phase\n");
@@ -194,12 +229,19 @@ int main(int argc,char *const *argv)
 {
     static const char *opt_switch_names[] = {
 	"cse",
+	"ctree",
 	"ne",
 	"prefix",
+	"range",
+	"shadow",
+	"sift",
+	"u32hash",
+	"u32trie",
 	NULL
     };
     const char *tcng_topdir;
     char *include,*input = NULL;
+    char *end;
     char opt[3] = "-?";
     char **cpp_argv;
     int check_only = 0,cpp_only = 0;
@@ -208,9 +250,15 @@ int main(int argc,char *const *argv)
 
     target_register("if","tc",1);
     target_register("if","c",0);
+    target_register("if","bpf",0);
     target_register("if","ext",0);
     registry_open(&optimization_switches,opt_switch_names,NULL);
     registry_set(&optimization_switches,"cse");
+    registry_set(&optimization_switches,"range");
+    registry_set(&optimization_switches,"shadow");
+    registry_set(&optimization_switches,"sift");
+    registry_set(&optimization_switches,"u32hash");
+    registry_set(&optimization_switches,"u32trie");
     cpp_argv = alloc(sizeof(char *)*(argc*2+5)); /* generous allocation */
 	/*
          * +1 for -std=c99 or -$
@@ -235,8 +283,8 @@ int main(int argc,char *const *argv)
      * -o file  for some output
      * -v       verbose
      */
-    while ((c = getopt(argc,argv,"BNcdEf:Hhi:l:nO:qrSt:u:W:wx:D:U:I:VX:")) !=
-      EOF)
+    while ((c = getopt(argc,argv,
+      "BbNcdEf:Hhi:j:l:nO:p:P:qrs:St:u:W:wx:D:U:I:VX:")) != EOF)
 	switch (c) {
 	    case 'c':
 		check_only = 1;
@@ -244,6 +292,9 @@ int main(int argc,char *const *argv)
 	    case 'B':
 		use_bit_tree = 1;
 		break;
+	    case 'b':
+		tc_batch = 1;
+		break;
 	    case 'N':
 		alg_mode++;
 		break;
@@ -264,6 +315,11 @@ int main(int argc,char *const *argv)
 	    case 'i':
 		default_device = optarg;
 		break;
+	    case 'j':
+		max_jobs = strtoul(optarg,&end,0);
+		if (*end) usage(*argv);
+		if (!max_jobs) max_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+		break;
 	    case 'l':
 		location_file = optarg;
 		break;
@@ -274,12 +330,21 @@ int main(int argc,char *const *argv)
 		if (registry_set_no(&optimization_switches,optarg))
 		    usage(argv[0]);
 		break;
+	    case 'p':
+		previous_file = optarg;
+		break;
+	    case 'P':
+		profile_file = optarg;
+		break;
 	    case 'q':
 		quiet = 1;
 		break;
 	    case 'r':
 		remove_qdiscs = 1;
 		break;
+	    case 's':
+		stats_file = optarg;
+		break;
 	    case 'S':
 		no_struct_separator = 1;
 		break;
@@ -345,6 +410,7 @@ int main(int argc,char *const *argv)
 	  /* @@@ leak */
     }
     cpp_argv[cpp_argc] = NULL;
+    stats_begin("main",NULL);
     if (!cpp_only) run_cpp(cpp_argc,cpp_argv,1);
     else {
 	run_cpp(cpp_argc,cpp_argv,0);
@@ -353,7 +419,9 @@ int main(int argc,char *const *argv)
     }
     free(include);
     var_begin_scope(); /* create global scope */
+    stats_begin("parse",NULL);
     (void) yyparse();
+    stats_end();
     finish_cpp();
     check_devices();
     var_end_scope(); /* report unused variables */
@@ -362,8 +430,11 @@ int main(int argc,char *const *argv)
     if (!check_only) {
 	if (dump_all && ext_targets) dump_all_devices(ext_targets->name);
 		/* @@@ walk list of targets */
+	else if (previous_file) tc_diff(previous_file);
 	else dump_devices();
     }
     if (location_file) write_location_map(location_file);
+    stats_end();
+    if (stats_file) write_stats(stats_file);
     return 0;
 }
@@ -0,0 +1,424 @@
+/*
+ * tcm_bench.c - Benchmark for tcc-generated classifiers, user-space part
+ *
+ * Runs the classifier described by MDI_FILE over a corpus of packets, and
+ * reports the time per packet, the number of branches, field accesses, and
+ * policer calls per packet, and how many packets ended up in each class.
+ *
+ * A branch is a condition the classifier tests, i.e. an "if" or "switch" of
+ * the decision tree (-Octree), or an operand of && or || in the expression.
+ *
+ * The corpus is either a pcap file (Ethernet, Linux "cooked", or raw IP), or
+ * the output of tcsim -v, from which the packets of all enqueue events ("E")
+ * are taken. The latter is the easiest way to use the "send" commands of an
+ * existing tcsim script as a corpus.
+ *
+ * Policing is not simulated: conformance tests always succeed.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <endian.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+
+
+#define TC_POLICE_UNSPEC	-1
+#define TC_POLICE_OK		0
+#define TC_POLICE_RECLASSIFY	1
+#define TC_POLICE_SHOT		2
+
+#define PAD		512	/* zero bytes after each packet, so that
+				   accesses beyond its end are harmless */
+#define MIN_RUNS	1000000	/* classify at least that many packets */
+#define MAX_LINE	65536	/* maximum line length in tcsim output */
+
+#define ETH_P_IP	0x0800
+#define ETH_P_IPV6	0x86dd
+#define ETH_P_8021Q	0x8100
+
+
+#include MDI_FILE
+
+
+struct packet {
+    unsigned char *data;
+    int len;
+    uint16_t protocol;		/* in host byte order */
+};
+
+
+static struct packet *packets = NULL;
+static int n_packets = 0;
+static unsigned long branches,accesses,police_calls;
+
+
+/* ------------------------------- Classifier ------------------------------ */
+
+
+static inline uint32_t load16(const unsigned char *p)
+{
+    uint16_t v;
+
+    memcpy(&v,p,2);
+    return ntohs(v);
+}
+
+
+static inline uint32_t load32(const unsigned char *p)
+{
+    uint32_t v;
+
+    memcpy(&v,p,4);
+    return ntohl(v);
+}
+
+
+static inline uint64_t load64(const unsigned char *p)
+{
+    uint64_t v;
+
+    memcpy(&v,p,8);
+    return be64toh(v);
+}
+
+
+static int __attribute__((unused)) police_conform(const struct packet *skb,
+  int bucket)
+{
+    police_calls++;
+    return 1;
+}
+
+
+static void __attribute__((unused)) police_count(const struct packet *skb,
+  int bucket)
+{
+    police_calls++;
+}
+
+
+#define RESULT(r,n)		{ *result = (n); return (r); }
+#define BRANCH(c)		(c)
+
+#ifdef DECISION_TREE
+#define CLASSIFY		DECISION_TREE
+#else
+#define CLASSIFY		(void) EXPRESSION;
+#endif
+
+#define ACCESS8(off)		((uint32_t) skb->data[off])
+#define ACCESS16(off)		load16(skb->data+(off))
+#define ACCESS32(off)		load32(skb->data+(off))
+#define ACCESS64(off)		load64(skb->data+(off))
+#define ACCESS_META_PROTOCOL	((uint32_t) skb->protocol)
+
+
+static int classify(const struct packet *skb,int *result)
+{
+    CLASSIFY
+    return TC_POLICE_UNSPEC;
+}
+
+
+/*
+ * Same classifier again, but this time we count branches and accesses. We
+ * keep this out of the function we time.
+ */
+
+#undef BRANCH
+#undef ACCESS8
+#undef ACCESS16
+#undef ACCESS32
+#undef ACCESS64
+#undef ACCESS_META_PROTOCOL
+
+#define BRANCH(c)		(branches++, (c))
+#define ACCESS8(off)		(accesses++, (uint32_t) skb->data[off])
+#define ACCESS16(off)		(accesses++, load16(skb->data+(off)))
+#define ACCESS32(off)		(accesses++, load32(skb->data+(off)))
+#define ACCESS64(off)		(accesses++, load64(skb->data+(off)))
+#define ACCESS_META_PROTOCOL	(accesses++, (uint32_t) skb->protocol)
+
+
+static int classify_counting(const struct packet *skb,int *result)
+{
+    CLASSIFY
+    return TC_POLICE_UNSPEC;
+}
+
+
+/* --------------------------------- Corpus -------------------------------- */
+
+
+static void add_packet(const unsigned char *data,int len,uint16_t protocol)
+{
+    struct packet *p;
+
+    if (!(n_packets & 1023)) {
+	packets = realloc(packets,(n_packets+1024)*sizeof(struct packet));
+	if (!packets) {
+	    perror("realloc");
+	    exit(1);
+	}
+    }
+    p = packets+n_packets++;
+    p->data = calloc(1,len+PAD);
+    if (!p->data) {
+	perror("calloc");
+	exit(1);
+    }
+    memcpy(p->data,data,len);
+    p->len = len;
+    p->protocol = protocol;
+}
+
+
+static uint16_t ip_protocol(const unsigned char *data,int len)
+{
+    return len && (*data >> 4) == 6 ? ETH_P_IPV6 : ETH_P_IP;
+}
+
+
+static uint32_t swap32(uint32_t v,int swap)
+{
+    if (!swap) return v;
+    return (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+}
+
+
+static void read_pcap(const char *name,FILE *file)
+{
+    unsigned char hdr[24],rec[16],*buf;
+    uint32_t magic,link;
+    int swap;
+
+    if (fread(hdr,1,24,file) != 24) {
+	fprintf(stderr,"%s: short pcap header\n",name);
+	exit(1);
+    }
+    memcpy(&magic,hdr,4);
+    swap = magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1;
+    memcpy(&link,hdr+20,4);
+    link = swap32(link,swap);
+    buf = malloc(65536);
+    if (!buf) {
+	perror("malloc");
+	exit(1);
+    }
+    while (fread(rec,1,16,file) == 16) {
+	const unsigned char *data = buf;
+	uint32_t len;
+	uint16_t protocol;
+
+	memcpy(&len,rec+8,4);
+	len = swap32(len,swap);
+	if (len > 65536 || fread(buf,1,len,file) != len) {
+	    fprintf(stderr,"%s: truncated pcap file\n",name);
+	    exit(1);
+	}
+	switch (link) {
+	    case 1: /* Ethernet */
+		if (len < 14) continue;
+		protocol = load16(buf+12);
+		data += 14;
+		len -= 14;
+		if (protocol == ETH_P_8021Q && len >= 4) {
+		    protocol = load16(buf+16);
+		    data += 4;
+		    len -= 4;
+		}
+		break;
+	    case 113: /* Linux "cooked" */
+		if (len < 16) continue;
+		protocol = load16(buf+14);
+		data += 16;
+		len -= 16;
+		break;
+	    case 12: /* raw IP */
+	    case 101:
+		protocol = ip_protocol(buf,len);
+		break;
+	    default:
+		fprintf(stderr,"%s: unsupported link type %lu\n",name,
+		  (unsigned long) link);
+		exit(1);
+	}
+	add_packet(data,len,protocol);
+    }
+    free(buf);
+}
+
+
+/*
+ * Lines look like this:
+ * 0.000000 E : 0x00000000 28 : eth0: 4500001c 00000000 ...
+ * Packets that were truncated by tcsim -s are skipped.
+ */
+
+static void read_tcsim(const char *name,FILE *file)
+{
+    static char line[MAX_LINE];
+    unsigned char *buf;
+
+    buf = malloc(MAX_LINE/2);
+    if (!buf) {
+	perror("malloc");
+	exit(1);
+    }
+    while (fgets(line,MAX_LINE,file)) {
+	const char *p;
+	int len = 0,pos = 0;
+
+	(void) sscanf(line,"%*s E : %*s %*d : %*[^:]:%n",&pos);
+	if (!pos) continue;
+	if (strstr(line+pos,"...")) continue;
+	for (p = line+pos; *p; p++) {
+	    unsigned byte;
+
+	    if (*p == ' ' || *p == '\n') continue;
+	    if (sscanf(p,"%2x",&byte) != 1) break;
+	    buf[len++] = byte;
+	    p++;
+	}
+	add_packet(buf,len,ip_protocol(buf,len));
+    }
+    free(buf);
+}
+
+
+static void read_corpus(const char *name)
+{
+    FILE *file;
+    uint32_t magic;
+
+    file = fopen(name,"r");
+    if (!file) {
+	perror(name);
+	exit(1);
+    }
+    if (fread(&magic,1,4,file) == 4 &&
+      (magic == 0xa1b2c3d4 || magic == 0xd4c3b2a1 ||
+      magic == 0xa1b23c4d || magic == 0x4d3cb2a1)) {
+	rewind(file);
+	read_pcap(name,file);
+    }
+    else {
+	rewind(file);
+	read_tcsim(name,file);
+    }
+    (void) fclose(file);
+}
+
+
+/* --------------------------------- Report -------------------------------- */
+
+
+static unsigned long classes[ELEMENTS+1];
+
+
+static void get_class(int n,unsigned long classid)
+{
+    classes[n] = classid;
+}
+
+
+static void report(double ns)
+{
+    unsigned long ok[ELEMENTS+1],reclassify[ELEMENTS+1];
+    unsigned long shot = 0,unspec = 0;
+    int i;
+
+    #define __GET_CLASS(n,c) get_class(n,c);
+    ELEMENT(__GET_CLASS)
+    memset(ok,0,sizeof(ok));
+    memset(reclassify,0,sizeof(reclassify));
+    branches = accesses = police_calls = 0;
+    for (i = 0; i < n_packets; i++) {
+	int result = 0;
+
+	switch (classify_counting(packets+i,&result)) {
+	    case TC_POLICE_OK:
+		ok[result]++;
+		break;
+	    case TC_POLICE_RECLASSIFY:
+		reclassify[result]++;
+		break;
+	    case TC_POLICE_SHOT:
+		shot++;
+		break;
+	    default:
+		unspec++;
+	}
+    }
+    printf("%d packets, %.1f ns/packet\n",n_packets,ns);
+    printf("%.2f branches/packet, %.2f field accesses/packet\n",
+      (double) branches/n_packets,(double) accesses/n_packets);
+    printf("%.2f policer calls/packet\n",(double) police_calls/n_packets);
+    for (i = 0; i < ELEMENTS; i++) {
+	if (ok[i])
+	    printf("%lx:%lx %10lu %5.1f%%\n",classes[i] >> 16,
+	      classes[i] & 0xffff,ok[i],100.0*ok[i]/n_packets);
+	if (reclassify[i])
+	    printf("%lx:%lx reclassify %10lu %5.1f%%\n",classes[i] >> 16,
+	      classes[i] & 0xffff,reclassify[i],100.0*reclassify[i]/n_packets);
+    }
+    if (shot) printf("drop %10lu %5.1f%%\n",shot,100.0*shot/n_packets);
+    if (unspec)
+	printf("unclassified %10lu %5.1f%%\n",unspec,100.0*unspec/n_packets);
+}
+
+
+/* ---------------------------------- Main --------------------------------- */
+
+
+static void usage(const char *name)
+{
+    fprintf(stderr,"usage: %s [-n rounds] corpus ...\n",name);
+    fprintf(stderr,"  -n rounds  classify the corpus that many times "
+      "(default: at least %d packets)\n",MIN_RUNS);
+    fprintf(stderr,"  corpus     pcap file or output of tcsim -v\n");
+    exit(1);
+}
+
+
+int main(int argc,char **argv)
+{
+    int (*volatile fn)(const struct packet *skb,int *result) = classify;
+    struct timeval start,end;
+    int rounds = 0;
+    int c,i,r;
+    char *tmp;
+
+    while ((c = getopt(argc,argv,"n:")) != EOF)
+	switch (c) {
+	    case 'n':
+		rounds = strtoul(optarg,&tmp,0);
+		if (*tmp || !rounds) usage(*argv);
+		break;
+	    default:
+		usage(*argv);
+	}
+    if (optind == argc) usage(*argv);
+    while (optind < argc) read_corpus(argv[optind++]);
+    if (!n_packets) {
+	fprintf(stderr,"no packets in corpus\n");
+	return 1;
+    }
+    if (!rounds) rounds = (MIN_RUNS+n_packets-1)/n_packets;
+    gettimeofday(&start,NULL);
+    for (r = 0; r < rounds; r++)
+	for (i = 0; i < n_packets; i++) {
+	    int result;
+
+	    (void) fn(packets+i,&result);
+	}
+    gettimeofday(&end,NULL);
+    report(((end.tv_sec-start.tv_sec)*1e9+(end.tv_usec-start.tv_usec)*1e3)/
+      ((double) rounds*n_packets));
+    return 0;
+}
@@ -33,11 +33,12 @@
 #define _ACCESS8(off)		(*(u8 *) (skb->nh.raw+(off)))
 #define _ACCESS16(off)		ntohs(*(u16 *) (skb->nh.raw+(off)))
 #define _ACCESS32(off)		ntohl(*(u32 *) (skb->nh.raw+(off)))
+#define _ACCESS64(off)		be64_to_cpu(*(u64 *) (skb->nh.raw+(off)))
 #define _ACCESS_META(conv,acc)	conv(acc)
 
 #define _DEBUG_ACCESS(b,off) \
-  ({ printk(KERN_DEBUG "u%d @ %d -> 0x%lx\n",b,(off), \
-     (unsigned long) _ACCESS##b(off)); _ACCESS##b(off); })
+  ({ printk(KERN_DEBUG "u%d @ %d -> 0x%llx\n",b,(off), \
+     (unsigned long long) _ACCESS##b(off)); _ACCESS##b(off); })
 #define _DEBUG_ACCESS_META(conv,acc) \
   ({ printk(KERN_DEBUG #acc " -> 0x%lx\n", \
      (unsigned long) _ACCESS_META(conv,acc)); _ACCESS_META(conv,acc); })
@@ -47,6 +48,7 @@
 #define ACCESS8(off)		_ACCESS8(off)
 #define ACCESS16(off)		_ACCESS16(off)
 #define ACCESS32(off)		_ACCESS32(off)
+#define ACCESS64(off)		_ACCESS64(off)
 #define ACCESS_META_PROTOCOL	_ACCESS_META(ntohs,skb->protocol)
 
 #define DEBUGF(...)
@@ -56,6 +58,7 @@
 #define ACCESS8(off)		_DEBUG_ACCESS(8,off)
 #define ACCESS16(off)		_DEBUG_ACCESS(16,off)
 #define ACCESS32(off)		_DEBUG_ACCESS(32,off)
+#define ACCESS64(off)		_DEBUG_ACCESS(64,off)
 #define ACCESS_META_PROTOCOL	_DEBUG_ACCESS_META(ntohs,skb->protocol)
 
 #define DEBUGF(...)		printk(KERN_DEBUG __VA_ARGS__)
@@ -94,8 +97,19 @@
   _T2B_16(12,rate,scale,depth) _T2B_16(13,rate,scale,depth) \
   _T2B_16(14,rate,scale,depth) _T2B_16(15,rate,scale,depth)
 
-#define INIT_BUCKET(_rate,_mpu,_depth,_initial,_overflow,_max_time, \
-  _total_depth,_scale) \
+#define INIT_T2B(_rate,_scale,_total_depth) \
+  { T2B(_rate,_scale,_total_depth) }
+
+/*
+ * Buckets with the same rate, scale, and total depth share the same time to
+ * bytes table, so that struct bucket stays small.
+ */
+
+static const uint32_t t2b[][TIME_STEPS] = {
+    T2B_TABLES
+};
+
+#define INIT_BUCKET(_mpu,_depth,_initial,_overflow,_max_time,_t2b,_scale) \
   { \
     .tokens = (_initial), \
     .mpu = (_mpu), \
@@ -104,7 +118,7 @@
     .carry = 0, \
     .max_time = (_max_time), \
     .scale = (_scale), \
-    .t2b = { T2B(_rate,_scale,_total_depth) }, \
+    .t2b = t2b[_t2b], \
     .overflow = (_overflow) == -1 ? NULL : buckets+(_overflow), \
   }
   
@@ -117,7 +131,7 @@ static struct bucket {
     uint32_t max_time;		/* maximum time interval until bucket (plus
 				   overflow buckets) fills up */
     int scale;			/* divide time by 2^scale */
-    uint32_t t2b[TIME_STEPS];	/* time to bytes (tokens) translation */
+    const uint32_t *t2b;	/* time to bytes (tokens) translation */
     struct bucket *overflow;	/* bucket to overflow to; NULL if none */
 } buckets[] = {
     BUCKETS
@@ -196,7 +210,12 @@ static int C(NAME,_classify)(struct sk_buff *skb,struct tcf_proto *tp,
   struct tcf_result *res)
 {
 	#define RESULT(r,n) *res = results[n]; return (r);
+	#define BRANCH(c) (c)
+#ifdef DECISION_TREE
+	DECISION_TREE
+#else
 	(void) EXPRESSION;
+#endif
 	return TC_POLICE_UNSPEC;
 }
 
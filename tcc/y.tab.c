@@ -0,0 +1,5337 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 1 "tcng.y"
+
+/*
+ * tcng.y - New TC configuration language
+ *
+ * Written 2001-2003 by Werner Almesberger
+ * Copyright 2001 EPFL-ICA
+ * Copyright 2001,2002 Bivio Networks, Network Robots, Werner Almesberger
+ * Copyright 2003 Werner Almesberger
+ */
+
+/*
+ * Note: this parser is full of memory leaks. It makes it much easier to
+ * implement, and isn't a problem in real life, because it only runs for
+ * one translation pass, and then all memory is freed on process exit.
+ */
+
+
+#include <stdint.h>
+#include <stddef.h> /* for NULL */
+#include <stdio.h>
+#include <stdlib.h>
+#include <net/if.h> /* for IFNAMSIZ */
+
+#include <u128.h>
+#include <addr.h>
+
+#include "config.h"
+#include "tcdefs.h"
+#include "util.h"
+#include "location.h"
+#include "error.h"
+#include "var.h"
+#include "data.h"
+#include "op.h"
+#include "param.h"
+#include "sprintf.h"
+#include "tree.h"
+#include "field.h"
+#include "named.h"
+#include "device.h"
+#include "qdisc.h"
+#include "filter.h"
+#include "police.h"
+
+
+static ELEMENT *current_element = NULL;
+static PARAM_DEF *param_def = NULL;
+static uint32_t *number_anchor = NULL;
+static char **tag_anchor = NULL;
+static char *device_tag; /* devices are handled out-of-sequence */
+
+static PARENT parent;
+static PARENT tmp_parent = { .qdisc = NULL };
+
+
+#define NONZERO(dd) \
+  if (!(dd->data.type == dt_unum ? dd->data.u.unum : dd->data.u.fnum)) \
+    yyerrorf("parameter \"%s\" must be non-zero",dd->dsc->id);
+#define UNUM_RANGE(dd,fmt,lower,upper) \
+  if (dd->data.u.unum < lower) \
+    yyerrorf("parameter \"%s\" value " fmt " below limit " fmt, \
+      dd->dsc->id,(unsigned long) dd->data.u.unum,(unsigned long) lower); \
+  if (dd->data.u.unum > upper) \
+    yyerrorf("parameter \"%s\" value " fmt " above limit " fmt, \
+      dd->dsc->id,(unsigned long) dd->data.u.unum,(unsigned long) upper)
+
+
+static void begin_scope(DATA d)
+{
+    var_begin_scope();
+    field_begin_scope();
+    var_use_begin_scope(d);
+}
+
+
+static void end_scope(void)
+{
+    var_use_end_scope();
+    field_end_scope();
+    var_end_scope();
+}
+
+
+/*
+ * "device" may be allocated before calling create_device. Look for
+ * device_spec: to find the explanation. This kludge should be removed once
+ * curly braces around device bodies are mandatory.
+ */
+
+static DEVICE *create_device(DEVICE *device,const char *name,PARAM *params)
+{
+    if (strlen(name) >= IFNAMSIZ)
+	yyerrorf("interface name longer than %d characters",IFNAMSIZ-1);
+    if (!device) device = alloc_t(DEVICE);
+    device->name = name;
+    device->location = current_location();
+    device->params = params;
+    device->egress = NULL;
+    device->ingress = NULL;
+    device->next = NULL;
+    add_device(device);
+    parent.device = device;
+    parent.class = NULL;
+    parent.filter = NULL;
+    param_def = NULL;
+    number_anchor = NULL;
+    tag_anchor = NULL; /* we've already parsed this ! */
+    return device;
+}
+
+
+static CLASS *begin_class(int implicit)
+{
+    CLASS *class;
+
+    class = make_class(parent.qdisc,parent.class,implicit);
+    class->parent = parent; /* @@@ still necessary ? */
+    parent.class = class;
+    param_def = parent.qdisc->dsc->class_param;
+    class->location = current_location();
+    number_anchor = &class->number;
+    tag_anchor = &class->location.tag;
+    begin_scope(data_class(class));
+    return class;
+}
+
+
+static void end_class(PARAM *params,QDISC *qdisc)
+{
+    parent.class->params = params;
+    if (parent.qdisc->dsc->class_param)
+	check_required(params,parent.qdisc->dsc->class_param->required,
+	  parent.class->location);
+    parent.class->qdisc = qdisc;
+    parent = parent.class->parent;
+}
+
+
+static FILTER *begin_filter(const FILTER_DSC *dsc)
+{
+    FILTER *filter;
+
+    filter = alloc_t(FILTER);
+    filter->parent = parent;
+    add_filter(filter);
+    filter->number = UNDEF_U32;
+    filter->location = current_location();
+    filter->dsc = dsc;
+    filter->elements = NULL;
+    filter->next = NULL;
+    param_def = dsc->filter_param;
+    number_anchor = &filter->number;
+    tag_anchor = &filter->location.tag;
+    parent.filter = filter;
+    begin_scope(data_filter(filter));
+    return filter;
+}
+
+
+static void end_filter(FILTER *filter,PARAM *params)
+{
+    filter->params = params;
+    check_required(params,filter->dsc->filter_param->required,
+      filter->location);
+    end_scope();
+    parent = filter->parent;
+}
+
+
+static void begin_element(void)
+{
+    if (!parent.filter) yyerror("filter element without filter");
+    if (!parent.filter->dsc->element_param)
+	yyerrorf("filter %s has no elements",parent.filter->dsc->name);
+    if (!parent.class) yyerror("filter element without class");
+    current_element = alloc_t(ELEMENT);
+    add_element(current_element,parent);
+    current_element->number = UNDEF_U32;
+    current_element->location = current_location();
+    current_element->police = NULL;
+    current_element->next = NULL;
+    param_def = parent.filter->dsc->element_param;
+    number_anchor = &current_element->number;
+    tag_anchor = &current_element->location.tag;
+}
+
+
+static void end_element(PARAM *params,POLICE *police)
+{
+    current_element->params = params;
+    check_required(params,parent.filter->dsc->element_param->required,
+      current_element->location);
+    current_element->police = police; 
+    current_element = NULL;
+}
+
+
+static void add_tag(const char *tag)
+{
+    const char *s;
+
+    if (!tag_anchor) yyerror("tag not valid here");
+    if (*tag_anchor) yyerror("tag already set");
+    if (!*tag) return;
+    for (s = tag; *s; s++)
+	if (*s <= ' ' || *s > '~') yyerror("invalid character(s) in tag");
+    *tag_anchor = tag;
+}
+
+
+static double si_prefix(char prefix,double f,int warn_milli)
+{
+    static int print_milli_warning = 1;
+
+    switch (prefix) {
+	case 'm':
+	    /* Alright, they asked for it. They'll get it. Badly. */
+	    if (warn_milli && print_milli_warning) {
+		yywarn("\"m\" means \"milli\", not \"Mega\"");
+		print_milli_warning = 0;
+	    }
+	    /* I'm too kind ... */
+	    return 1.0/f;
+	case 'k':
+	    return f;
+	case 'M':
+	    return f*f;
+	case 'G':
+	    return f*f*f;
+	default:
+	    return 1.0;
+    }
+}
+
+
+#line 307 "y.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+/* Use api.header.include to #include this header
+   instead of duplicating it here.  */
+#ifndef YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    TOK_WARN = 258,                /* TOK_WARN  */
+    TOK_DEV = 259,                 /* TOK_DEV  */
+    TOK_QDISC = 260,               /* TOK_QDISC  */
+    TOK_CLASS = 261,               /* TOK_CLASS  */
+    TOK_FILTER = 262,              /* TOK_FILTER  */
+    TOK_ELEMENT = 263,             /* TOK_ELEMENT  */
+    TOK_TUNNEL = 264,              /* TOK_TUNNEL  */
+    TOK_ON = 265,                  /* TOK_ON  */
+    TOK_POLICE = 266,              /* TOK_POLICE  */
+    TOK_BUCKET = 267,              /* TOK_BUCKET  */
+    TOK_ELSE = 268,                /* TOK_ELSE  */
+    TOK_IF = 269,                  /* TOK_IF  */
+    TOK_IF_ANCHOR = 270,           /* TOK_IF_ANCHOR  */
+    TOK_HOST = 271,                /* TOK_HOST  */
+    TOK_HOST4 = 272,               /* TOK_HOST4  */
+    TOK_HOST6 = 273,               /* TOK_HOST6  */
+    TOK_SPRINTF = 274,             /* TOK_SPRINTF  */
+    TOK_PRAGMA = 275,              /* TOK_PRAGMA  */
+    TOK_PASS = 276,                /* TOK_PASS  */
+    TOK_RECLASSIFY = 277,          /* TOK_RECLASSIFY  */
+    TOK_CONTINUE = 278,            /* TOK_CONTINUE  */
+    TOK_FIELD = 279,               /* TOK_FIELD  */
+    TOK_TAG = 280,                 /* TOK_TAG  */
+    TOK_FIELD_ROOT = 281,          /* TOK_FIELD_ROOT  */
+    TOK_CONFORM = 282,             /* TOK_CONFORM  */
+    TOK_COUNT = 283,               /* TOK_COUNT  */
+    TOK_PRECOND = 284,             /* TOK_PRECOND  */
+    TOK_DROP = 285,                /* TOK_DROP  */
+    TOK_CBQ = 286,                 /* TOK_CBQ  */
+    TOK_DSMARK = 287,              /* TOK_DSMARK  */
+    TOK_FIFO = 288,                /* TOK_FIFO  */
+    TOK_GRED = 289,                /* TOK_GRED  */
+    TOK_HTB = 290,                 /* TOK_HTB  */
+    TOK_PRIO = 291,                /* TOK_PRIO  */
+    TOK_RED = 292,                 /* TOK_RED  */
+    TOK_SFQ = 293,                 /* TOK_SFQ  */
+    TOK_TBF = 294,                 /* TOK_TBF  */
+    TOK_INGRESS = 295,             /* TOK_INGRESS  */
+    TOK_EGRESS = 296,              /* TOK_EGRESS  */
+    TOK_FW = 297,                  /* TOK_FW  */
+    TOK_ROUTE = 298,               /* TOK_ROUTE  */
+    TOK_RSVP = 299,                /* TOK_RSVP  */
+    TOK_TCINDEX = 300,             /* TOK_TCINDEX  */
+    TOK_AH = 301,                  /* TOK_AH  */
+    TOK_ALLOT = 302,               /* TOK_ALLOT  */
+    TOK_AVPKT = 303,               /* TOK_AVPKT  */
+    TOK_BANDS = 304,               /* TOK_BANDS  */
+    TOK_BANDWIDTH = 305,           /* TOK_BANDWIDTH  */
+    TOK_BOUNDED = 306,             /* TOK_BOUNDED  */
+    TOK_BURST = 307,               /* TOK_BURST  */
+    TOK_CBURST = 308,              /* TOK_CBURST  */
+    TOK_CEIL = 309,                /* TOK_CEIL  */
+    TOK_DEFAULT = 310,             /* TOK_DEFAULT  */
+    TOK_DEFAULT_INDEX = 311,       /* TOK_DEFAULT_INDEX  */
+    TOK_DPORT = 312,               /* TOK_DPORT  */
+    TOK_DST = 313,                 /* TOK_DST  */
+    TOK_ECN = 314,                 /* TOK_ECN  */
+    TOK_ESP = 315,                 /* TOK_ESP  */
+    TOK_EWMA = 316,                /* TOK_EWMA  */
+    TOK_FALL_THROUGH = 317,        /* TOK_FALL_THROUGH  */
+    TOK_FROM = 318,                /* TOK_FROM  */
+    TOK_FROMIF = 319,              /* TOK_FROMIF  */
+    TOK_GRIO = 320,                /* TOK_GRIO  */
+    TOK_HASH = 321,                /* TOK_HASH  */
+    TOK_INDICES = 322,             /* TOK_INDICES  */
+    TOK_ISOLATED = 323,            /* TOK_ISOLATED  */
+    TOK_IPPROTO = 324,             /* TOK_IPPROTO  */
+    TOK_LIMIT = 325,               /* TOK_LIMIT  */
+    TOK_MASK = 326,                /* TOK_MASK  */
+    TOK_MAX = 327,                 /* TOK_MAX  */
+    TOK_MAXBURST = 328,            /* TOK_MAXBURST  */
+    TOK_MIN = 329,                 /* TOK_MIN  */
+    TOK_MINBURST = 330,            /* TOK_MINBURST  */
+    TOK_MPU = 331,                 /* TOK_MPU  */
+    TOK_MTU = 332,                 /* TOK_MTU  */
+    TOK_ORDER = 333,               /* TOK_ORDER  */
+    TOK_OVERFLOW = 334,            /* TOK_OVERFLOW  */
+    TOK_PASS_ON = 335,             /* TOK_PASS_ON  */
+    TOK_PEAKRATE = 336,            /* TOK_PEAKRATE  */
+    TOK_PERTURB = 337,             /* TOK_PERTURB  */
+    TOK_PRIOMAP = 338,             /* TOK_PRIOMAP  */
+    TOK_PROBABILITY = 339,         /* TOK_PROBABILITY  */
+    TOK_PROTOCOL = 340,            /* TOK_PROTOCOL  */
+    TOK_QUANTUM = 341,             /* TOK_QUANTUM  */
+    TOK_R2Q = 342,                 /* TOK_R2Q  */
+    TOK_RATE = 343,                /* TOK_RATE  */
+    TOK_SET_TC_INDEX = 344,        /* TOK_SET_TC_INDEX  */
+    TOK_SHIFT = 345,               /* TOK_SHIFT  */
+    TOK_SKIP = 346,                /* TOK_SKIP  */
+    TOK_SPORT = 347,               /* TOK_SPORT  */
+    TOK_SRC = 348,                 /* TOK_SRC  */
+    TOK_TO = 349,                  /* TOK_TO  */
+    TOK_VALUE = 350,               /* TOK_VALUE  */
+    TOK_WEIGHT = 351,              /* TOK_WEIGHT  */
+    SHIFT_RIGHT = 352,             /* SHIFT_RIGHT  */
+    SHIFT_LEFT = 353,              /* SHIFT_LEFT  */
+    LOGICAL_AND = 354,             /* LOGICAL_AND  */
+    LOGICAL_OR = 355,              /* LOGICAL_OR  */
+    REL_EQ = 356,                  /* REL_EQ  */
+    REL_NE = 357,                  /* REL_NE  */
+    REL_LE = 358,                  /* REL_LE  */
+    REL_GE = 359,                  /* REL_GE  */
+    UNUM = 360,                    /* UNUM  */
+    IPV4 = 361,                    /* IPV4  */
+    IPV6 = 362,                    /* IPV6  */
+    FNUM = 363,                    /* FNUM  */
+    WORD = 364,                    /* WORD  */
+    STRING = 365,                  /* STRING  */
+    VARIABLE = 366,                /* VARIABLE  */
+    FIELD_NAME = 367               /* FIELD_NAME  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
+#define TOK_WARN 258
+#define TOK_DEV 259
+#define TOK_QDISC 260
+#define TOK_CLASS 261
+#define TOK_FILTER 262
+#define TOK_ELEMENT 263
+#define TOK_TUNNEL 264
+#define TOK_ON 265
+#define TOK_POLICE 266
+#define TOK_BUCKET 267
+#define TOK_ELSE 268
+#define TOK_IF 269
+#define TOK_IF_ANCHOR 270
+#define TOK_HOST 271
+#define TOK_HOST4 272
+#define TOK_HOST6 273
+#define TOK_SPRINTF 274
+#define TOK_PRAGMA 275
+#define TOK_PASS 276
+#define TOK_RECLASSIFY 277
+#define TOK_CONTINUE 278
+#define TOK_FIELD 279
+#define TOK_TAG 280
+#define TOK_FIELD_ROOT 281
+#define TOK_CONFORM 282
+#define TOK_COUNT 283
+#define TOK_PRECOND 284
+#define TOK_DROP 285
+#define TOK_CBQ 286
+#define TOK_DSMARK 287
+#define TOK_FIFO 288
+#define TOK_GRED 289
+#define TOK_HTB 290
+#define TOK_PRIO 291
+#define TOK_RED 292
+#define TOK_SFQ 293
+#define TOK_TBF 294
+#define TOK_INGRESS 295
+#define TOK_EGRESS 296
+#define TOK_FW 297
+#define TOK_ROUTE 298
+#define TOK_RSVP 299
+#define TOK_TCINDEX 300
+#define TOK_AH 301
+#define TOK_ALLOT 302
+#define TOK_AVPKT 303
+#define TOK_BANDS 304
+#define TOK_BANDWIDTH 305
+#define TOK_BOUNDED 306
+#define TOK_BURST 307
+#define TOK_CBURST 308
+#define TOK_CEIL 309
+#define TOK_DEFAULT 310
+#define TOK_DEFAULT_INDEX 311
+#define TOK_DPORT 312
+#define TOK_DST 313
+#define TOK_ECN 314
+#define TOK_ESP 315
+#define TOK_EWMA 316
+#define TOK_FALL_THROUGH 317
+#define TOK_FROM 318
+#define TOK_FROMIF 319
+#define TOK_GRIO 320
+#define TOK_HASH 321
+#define TOK_INDICES 322
+#define TOK_ISOLATED 323
+#define TOK_IPPROTO 324
+#define TOK_LIMIT 325
+#define TOK_MASK 326
+#define TOK_MAX 327
+#define TOK_MAXBURST 328
+#define TOK_MIN 329
+#define TOK_MINBURST 330
+#define TOK_MPU 331
+#define TOK_MTU 332
+#define TOK_ORDER 333
+#define TOK_OVERFLOW 334
+#define TOK_PASS_ON 335
+#define TOK_PEAKRATE 336
+#define TOK_PERTURB 337
+#define TOK_PRIOMAP 338
+#define TOK_PROBABILITY 339
+#define TOK_PROTOCOL 340
+#define TOK_QUANTUM 341
+#define TOK_R2Q 342
+#define TOK_RATE 343
+#define TOK_SET_TC_INDEX 344
+#define TOK_SHIFT 345
+#define TOK_SKIP 346
+#define TOK_SPORT 347
+#define TOK_SRC 348
+#define TOK_TO 349
+#define TOK_VALUE 350
+#define TOK_WEIGHT 351
+#define SHIFT_RIGHT 352
+#define SHIFT_LEFT 353
+#define LOGICAL_AND 354
+#define LOGICAL_OR 355
+#define REL_EQ 356
+#define REL_NE 357
+#define REL_LE 358
+#define REL_GE 359
+#define UNUM 360
+#define IPV4 361
+#define IPV6 362
+#define FNUM 363
+#define WORD 364
+#define STRING 365
+#define VARIABLE 366
+#define FIELD_NAME 367
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 237 "tcng.y"
+
+    int unum;
+    U128 u128;
+    double fnum;
+    const char *str;
+    DATA data;
+    DATA_LIST *list;
+    VAR *var;
+    DEVICE *dev;
+    QDISC *qdisc;
+    QDISC_DSC *qddsc;
+    CLASS *class;
+    FILTER *filter;
+    FILTER_DSC *fdsc;
+    ELEMENT *element;
+    POLICE *police;
+    DECISION decis;
+    PARAM *param;
+    FIELD *field;
+    struct {
+	DATA b,c;
+    } mask;
+    LOCATION location; /* abuse for temporary variable */
+    PARENT parent; /* abuse for temporary variable */
+
+#line 610 "y.tab.c"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_Y_TAB_H_INCLUDED  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_TOK_WARN = 3,                   /* TOK_WARN  */
+  YYSYMBOL_TOK_DEV = 4,                    /* TOK_DEV  */
+  YYSYMBOL_TOK_QDISC = 5,                  /* TOK_QDISC  */
+  YYSYMBOL_TOK_CLASS = 6,                  /* TOK_CLASS  */
+  YYSYMBOL_TOK_FILTER = 7,                 /* TOK_FILTER  */
+  YYSYMBOL_TOK_ELEMENT = 8,                /* TOK_ELEMENT  */
+  YYSYMBOL_TOK_TUNNEL = 9,                 /* TOK_TUNNEL  */
+  YYSYMBOL_TOK_ON = 10,                    /* TOK_ON  */
+  YYSYMBOL_TOK_POLICE = 11,                /* TOK_POLICE  */
+  YYSYMBOL_TOK_BUCKET = 12,                /* TOK_BUCKET  */
+  YYSYMBOL_TOK_ELSE = 13,                  /* TOK_ELSE  */
+  YYSYMBOL_TOK_IF = 14,                    /* TOK_IF  */
+  YYSYMBOL_TOK_IF_ANCHOR = 15,             /* TOK_IF_ANCHOR  */
+  YYSYMBOL_TOK_HOST = 16,                  /* TOK_HOST  */
+  YYSYMBOL_TOK_HOST4 = 17,                 /* TOK_HOST4  */
+  YYSYMBOL_TOK_HOST6 = 18,                 /* TOK_HOST6  */
+  YYSYMBOL_TOK_SPRINTF = 19,               /* TOK_SPRINTF  */
+  YYSYMBOL_TOK_PRAGMA = 20,                /* TOK_PRAGMA  */
+  YYSYMBOL_TOK_PASS = 21,                  /* TOK_PASS  */
+  YYSYMBOL_TOK_RECLASSIFY = 22,            /* TOK_RECLASSIFY  */
+  YYSYMBOL_TOK_CONTINUE = 23,              /* TOK_CONTINUE  */
+  YYSYMBOL_TOK_FIELD = 24,                 /* TOK_FIELD  */
+  YYSYMBOL_TOK_TAG = 25,                   /* TOK_TAG  */
+  YYSYMBOL_TOK_FIELD_ROOT = 26,            /* TOK_FIELD_ROOT  */
+  YYSYMBOL_TOK_CONFORM = 27,               /* TOK_CONFORM  */
+  YYSYMBOL_TOK_COUNT = 28,                 /* TOK_COUNT  */
+  YYSYMBOL_TOK_PRECOND = 29,               /* TOK_PRECOND  */
+  YYSYMBOL_TOK_DROP = 30,                  /* TOK_DROP  */
+  YYSYMBOL_TOK_CBQ = 31,                   /* TOK_CBQ  */
+  YYSYMBOL_TOK_DSMARK = 32,                /* TOK_DSMARK  */
+  YYSYMBOL_TOK_FIFO = 33,                  /* TOK_FIFO  */
+  YYSYMBOL_TOK_GRED = 34,                  /* TOK_GRED  */
+  YYSYMBOL_TOK_HTB = 35,                   /* TOK_HTB  */
+  YYSYMBOL_TOK_PRIO = 36,                  /* TOK_PRIO  */
+  YYSYMBOL_TOK_RED = 37,                   /* TOK_RED  */
+  YYSYMBOL_TOK_SFQ = 38,                   /* TOK_SFQ  */
+  YYSYMBOL_TOK_TBF = 39,                   /* TOK_TBF  */
+  YYSYMBOL_TOK_INGRESS = 40,               /* TOK_INGRESS  */
+  YYSYMBOL_TOK_EGRESS = 41,                /* TOK_EGRESS  */
+  YYSYMBOL_TOK_FW = 42,                    /* TOK_FW  */
+  YYSYMBOL_TOK_ROUTE = 43,                 /* TOK_ROUTE  */
+  YYSYMBOL_TOK_RSVP = 44,                  /* TOK_RSVP  */
+  YYSYMBOL_TOK_TCINDEX = 45,               /* TOK_TCINDEX  */
+  YYSYMBOL_TOK_AH = 46,                    /* TOK_AH  */
+  YYSYMBOL_TOK_ALLOT = 47,                 /* TOK_ALLOT  */
+  YYSYMBOL_TOK_AVPKT = 48,                 /* TOK_AVPKT  */
+  YYSYMBOL_TOK_BANDS = 49,                 /* TOK_BANDS  */
+  YYSYMBOL_TOK_BANDWIDTH = 50,             /* TOK_BANDWIDTH  */
+  YYSYMBOL_TOK_BOUNDED = 51,               /* TOK_BOUNDED  */
+  YYSYMBOL_TOK_BURST = 52,                 /* TOK_BURST  */
+  YYSYMBOL_TOK_CBURST = 53,                /* TOK_CBURST  */
+  YYSYMBOL_TOK_CEIL = 54,                  /* TOK_CEIL  */
+  YYSYMBOL_TOK_DEFAULT = 55,               /* TOK_DEFAULT  */
+  YYSYMBOL_TOK_DEFAULT_INDEX = 56,         /* TOK_DEFAULT_INDEX  */
+  YYSYMBOL_TOK_DPORT = 57,                 /* TOK_DPORT  */
+  YYSYMBOL_TOK_DST = 58,                   /* TOK_DST  */
+  YYSYMBOL_TOK_ECN = 59,                   /* TOK_ECN  */
+  YYSYMBOL_TOK_ESP = 60,                   /* TOK_ESP  */
+  YYSYMBOL_TOK_EWMA = 61,                  /* TOK_EWMA  */
+  YYSYMBOL_TOK_FALL_THROUGH = 62,          /* TOK_FALL_THROUGH  */
+  YYSYMBOL_TOK_FROM = 63,                  /* TOK_FROM  */
+  YYSYMBOL_TOK_FROMIF = 64,                /* TOK_FROMIF  */
+  YYSYMBOL_TOK_GRIO = 65,                  /* TOK_GRIO  */
+  YYSYMBOL_TOK_HASH = 66,                  /* TOK_HASH  */
+  YYSYMBOL_TOK_INDICES = 67,               /* TOK_INDICES  */
+  YYSYMBOL_TOK_ISOLATED = 68,              /* TOK_ISOLATED  */
+  YYSYMBOL_TOK_IPPROTO = 69,               /* TOK_IPPROTO  */
+  YYSYMBOL_TOK_LIMIT = 70,                 /* TOK_LIMIT  */
+  YYSYMBOL_TOK_MASK = 71,                  /* TOK_MASK  */
+  YYSYMBOL_TOK_MAX = 72,                   /* TOK_MAX  */
+  YYSYMBOL_TOK_MAXBURST = 73,              /* TOK_MAXBURST  */
+  YYSYMBOL_TOK_MIN = 74,                   /* TOK_MIN  */
+  YYSYMBOL_TOK_MINBURST = 75,              /* TOK_MINBURST  */
+  YYSYMBOL_TOK_MPU = 76,                   /* TOK_MPU  */
+  YYSYMBOL_TOK_MTU = 77,                   /* TOK_MTU  */
+  YYSYMBOL_TOK_ORDER = 78,                 /* TOK_ORDER  */
+  YYSYMBOL_TOK_OVERFLOW = 79,              /* TOK_OVERFLOW  */
+  YYSYMBOL_TOK_PASS_ON = 80,               /* TOK_PASS_ON  */
+  YYSYMBOL_TOK_PEAKRATE = 81,              /* TOK_PEAKRATE  */
+  YYSYMBOL_TOK_PERTURB = 82,               /* TOK_PERTURB  */
+  YYSYMBOL_TOK_PRIOMAP = 83,               /* TOK_PRIOMAP  */
+  YYSYMBOL_TOK_PROBABILITY = 84,           /* TOK_PROBABILITY  */
+  YYSYMBOL_TOK_PROTOCOL = 85,              /* TOK_PROTOCOL  */
+  YYSYMBOL_TOK_QUANTUM = 86,               /* TOK_QUANTUM  */
+  YYSYMBOL_TOK_R2Q = 87,                   /* TOK_R2Q  */
+  YYSYMBOL_TOK_RATE = 88,                  /* TOK_RATE  */
+  YYSYMBOL_TOK_SET_TC_INDEX = 89,          /* TOK_SET_TC_INDEX  */
+  YYSYMBOL_TOK_SHIFT = 90,                 /* TOK_SHIFT  */
+  YYSYMBOL_TOK_SKIP = 91,                  /* TOK_SKIP  */
+  YYSYMBOL_TOK_SPORT = 92,                 /* TOK_SPORT  */
+  YYSYMBOL_TOK_SRC = 93,                   /* TOK_SRC  */
+  YYSYMBOL_TOK_TO = 94,                    /* TOK_TO  */
+  YYSYMBOL_TOK_VALUE = 95,                 /* TOK_VALUE  */
+  YYSYMBOL_TOK_WEIGHT = 96,                /* TOK_WEIGHT  */
+  YYSYMBOL_SHIFT_RIGHT = 97,               /* SHIFT_RIGHT  */
+  YYSYMBOL_SHIFT_LEFT = 98,                /* SHIFT_LEFT  */
+  YYSYMBOL_LOGICAL_AND = 99,               /* LOGICAL_AND  */
+  YYSYMBOL_LOGICAL_OR = 100,               /* LOGICAL_OR  */
+  YYSYMBOL_REL_EQ = 101,                   /* REL_EQ  */
+  YYSYMBOL_REL_NE = 102,                   /* REL_NE  */
+  YYSYMBOL_REL_LE = 103,                   /* REL_LE  */
+  YYSYMBOL_REL_GE = 104,                   /* REL_GE  */
+  YYSYMBOL_UNUM = 105,                     /* UNUM  */
+  YYSYMBOL_IPV4 = 106,                     /* IPV4  */
+  YYSYMBOL_IPV6 = 107,                     /* IPV6  */
+  YYSYMBOL_FNUM = 108,                     /* FNUM  */
+  YYSYMBOL_WORD = 109,                     /* WORD  */
+  YYSYMBOL_STRING = 110,                   /* STRING  */
+  YYSYMBOL_VARIABLE = 111,                 /* VARIABLE  */
+  YYSYMBOL_FIELD_NAME = 112,               /* FIELD_NAME  */
+  YYSYMBOL_113_ = 113,                     /* ','  */
+  YYSYMBOL_114_ = 114,                     /* '='  */
+  YYSYMBOL_115_ = 115,                     /* '('  */
+  YYSYMBOL_116_ = 116,                     /* ')'  */
+  YYSYMBOL_117_ = 117,                     /* '{'  */
+  YYSYMBOL_118_ = 118,                     /* '}'  */
+  YYSYMBOL_119_ = 119,                     /* '|'  */
+  YYSYMBOL_120_ = 120,                     /* '^'  */
+  YYSYMBOL_121_ = 121,                     /* '&'  */
+  YYSYMBOL_122_ = 122,                     /* '<'  */
+  YYSYMBOL_123_ = 123,                     /* '>'  */
+  YYSYMBOL_124_ = 124,                     /* '+'  */
+  YYSYMBOL_125_ = 125,                     /* '-'  */
+  YYSYMBOL_126_ = 126,                     /* '*'  */
+  YYSYMBOL_127_ = 127,                     /* '/'  */
+  YYSYMBOL_128_ = 128,                     /* '%'  */
+  YYSYMBOL_129_ = 129,                     /* '!'  */
+  YYSYMBOL_130_ = 130,                     /* '~'  */
+  YYSYMBOL_131_ = 131,                     /* ':'  */
+  YYSYMBOL_132_ = 132,                     /* '.'  */
+  YYSYMBOL_133_ = 133,                     /* '['  */
+  YYSYMBOL_134_ = 134,                     /* ']'  */
+  YYSYMBOL_135_ = 135,                     /* ';'  */
+  YYSYMBOL_YYACCEPT = 136,                 /* $accept  */
+  YYSYMBOL_all = 137,                      /* all  */
+  YYSYMBOL_138_1 = 138,                    /* $@1  */
+  YYSYMBOL_preamble_item = 139,            /* preamble_item  */
+  YYSYMBOL_warning_switches = 140,         /* warning_switches  */
+  YYSYMBOL_warning_switch = 141,           /* warning_switch  */
+  YYSYMBOL_assignments = 142,              /* assignments  */
+  YYSYMBOL_assignment = 143,               /* assignment  */
+  YYSYMBOL_variable_assignment = 144,      /* variable_assignment  */
+  YYSYMBOL_145_2 = 145,                    /* $@2  */
+  YYSYMBOL_global_assignments = 146,       /* global_assignments  */
+  YYSYMBOL_global_assignment = 147,        /* global_assignment  */
+  YYSYMBOL_148_3 = 148,                    /* $@3  */
+  YYSYMBOL_149_4 = 149,                    /* $@4  */
+  YYSYMBOL_global_variable_assignment = 150, /* global_variable_assignment  */
+  YYSYMBOL_151_5 = 151,                    /* $@5  */
+  YYSYMBOL_field = 152,                    /* field  */
+  YYSYMBOL_153_6 = 153,                    /* $@6  */
+  YYSYMBOL_154_7 = 154,                    /* $@7  */
+  YYSYMBOL_opt_condition = 155,            /* opt_condition  */
+  YYSYMBOL_device_specs = 156,             /* device_specs  */
+  YYSYMBOL_device_spec = 157,              /* device_spec  */
+  YYSYMBOL_158_8 = 158,                    /* $@8  */
+  YYSYMBOL_device_body = 159,              /* device_body  */
+  YYSYMBOL_160_9 = 160,                    /* $@9  */
+  YYSYMBOL_opt_no_dev_specs = 161,         /* opt_no_dev_specs  */
+  YYSYMBOL_162_10 = 162,                   /* $@10  */
+  YYSYMBOL_163_11 = 163,                   /* $@11  */
+  YYSYMBOL_164_12 = 164,                   /* $@12  */
+  YYSYMBOL_qdisc_expressions_noblock = 165, /* qdisc_expressions_noblock  */
+  YYSYMBOL_qdisc_expressions = 166,        /* qdisc_expressions  */
+  YYSYMBOL_167_13 = 167,                   /* $@13  */
+  YYSYMBOL_168_14 = 168,                   /* $@14  */
+  YYSYMBOL_single_qdisc_expression = 169,  /* single_qdisc_expression  */
+  YYSYMBOL_device = 170,                   /* device  */
+  YYSYMBOL_171_15 = 171,                   /* $@15  */
+  YYSYMBOL_device_name = 172,              /* device_name  */
+  YYSYMBOL_complex_expression = 173,       /* complex_expression  */
+  YYSYMBOL_global_expression = 174,        /* global_expression  */
+  YYSYMBOL_qdisc_expression = 175,         /* qdisc_expression  */
+  YYSYMBOL_176_16 = 176,                   /* @16  */
+  YYSYMBOL_class_expression = 177,         /* class_expression  */
+  YYSYMBOL_178_17 = 178,                   /* @17  */
+  YYSYMBOL_short_filter_expression = 179,  /* short_filter_expression  */
+  YYSYMBOL_filter_expression = 180,        /* filter_expression  */
+  YYSYMBOL_181_18 = 181,                   /* @18  */
+  YYSYMBOL_standalone_police_or_bucket_expression = 182, /* standalone_police_or_bucket_expression  */
+  YYSYMBOL_standalone_police_expression = 183, /* standalone_police_expression  */
+  YYSYMBOL_police_expression_with_parentheses = 184, /* police_expression_with_parentheses  */
+  YYSYMBOL_police_expression = 185,        /* police_expression  */
+  YYSYMBOL_opt_police_keyword = 186,       /* opt_police_keyword  */
+  YYSYMBOL_constant_expression = 187,      /* constant_expression  */
+  YYSYMBOL_expression = 188,               /* expression  */
+  YYSYMBOL_logical_or_expression = 189,    /* logical_or_expression  */
+  YYSYMBOL_logical_and_expression = 190,   /* logical_and_expression  */
+  YYSYMBOL_inclusive_or_expression = 191,  /* inclusive_or_expression  */
+  YYSYMBOL_exclusive_or_expression = 192,  /* exclusive_or_expression  */
+  YYSYMBOL_and_expression = 193,           /* and_expression  */
+  YYSYMBOL_equality_expression = 194,      /* equality_expression  */
+  YYSYMBOL_relational_expression = 195,    /* relational_expression  */
+  YYSYMBOL_shift_expression = 196,         /* shift_expression  */
+  YYSYMBOL_additive_expression = 197,      /* additive_expression  */
+  YYSYMBOL_multiplicative_expression = 198, /* multiplicative_expression  */
+  YYSYMBOL_unary_expression = 199,         /* unary_expression  */
+  YYSYMBOL_mask_expression = 200,          /* mask_expression  */
+  YYSYMBOL_mask_selector = 201,            /* mask_selector  */
+  YYSYMBOL_opt_mask_len = 202,             /* opt_mask_len  */
+  YYSYMBOL_simple_expression = 203,        /* simple_expression  */
+  YYSYMBOL_opt_unit_qualifier = 204,       /* opt_unit_qualifier  */
+  YYSYMBOL_primary_expression = 205,       /* primary_expression  */
+  YYSYMBOL_simple_primary_expression = 206, /* simple_primary_expression  */
+  YYSYMBOL_207_19 = 207,                   /* $@19  */
+  YYSYMBOL_208_20 = 208,                   /* $@20  */
+  YYSYMBOL_opt_sprintf_args = 209,         /* opt_sprintf_args  */
+  YYSYMBOL_assignments_with_expression = 210, /* assignments_with_expression  */
+  YYSYMBOL_primary_policing_expression = 211, /* primary_policing_expression  */
+  YYSYMBOL_variable_expression = 212,      /* variable_expression  */
+  YYSYMBOL_variable = 213,                 /* variable  */
+  YYSYMBOL_access_expression = 214,        /* access_expression  */
+  YYSYMBOL_opt_size_qualifier = 215,       /* opt_size_qualifier  */
+  YYSYMBOL_opt_index_expression = 216,     /* opt_index_expression  */
+  YYSYMBOL_qdisc_spec = 217,               /* qdisc_spec  */
+  YYSYMBOL_218_21 = 218,                   /* @21  */
+  YYSYMBOL_219_22 = 219,                   /* @22  */
+  YYSYMBOL_qdisc_name = 220,               /* qdisc_name  */
+  YYSYMBOL_opt_qdisc_or_class_body = 221,  /* opt_qdisc_or_class_body  */
+  YYSYMBOL_222_23 = 222,                   /* $@23  */
+  YYSYMBOL_qdisc_or_class_body = 223,      /* qdisc_or_class_body  */
+  YYSYMBOL_qdisc_or_class_body_element = 224, /* qdisc_or_class_body_element  */
+  YYSYMBOL_225_24 = 225,                   /* @24  */
+  YYSYMBOL_226_25 = 226,                   /* $@25  */
+  YYSYMBOL_227_26 = 227,                   /* $@26  */
+  YYSYMBOL_opt_parameters = 228,           /* opt_parameters  */
+  YYSYMBOL_parameters = 229,               /* parameters  */
+  YYSYMBOL_parameter_list = 230,           /* parameter_list  */
+  YYSYMBOL_parameter = 231,                /* parameter  */
+  YYSYMBOL_parameter_expression = 232,     /* parameter_expression  */
+  YYSYMBOL_233_27 = 233,                   /* $@27  */
+  YYSYMBOL_234_28 = 234,                   /* $@28  */
+  YYSYMBOL_host = 235,                     /* host  */
+  YYSYMBOL_primary_host = 236,             /* primary_host  */
+  YYSYMBOL_primary_host4 = 237,            /* primary_host4  */
+  YYSYMBOL_primary_host6 = 238,            /* primary_host6  */
+  YYSYMBOL_port = 239,                     /* port  */
+  YYSYMBOL_ipproto = 240,                  /* ipproto  */
+  YYSYMBOL_ether_proto = 241,              /* ether_proto  */
+  YYSYMBOL_forward_class_list = 242,       /* forward_class_list  */
+  YYSYMBOL_243_29 = 243,                   /* @29  */
+  YYSYMBOL_pragma_list = 244,              /* pragma_list  */
+  YYSYMBOL_class_spec = 245,               /* class_spec  */
+  YYSYMBOL_246_30 = 246,                   /* @30  */
+  YYSYMBOL_drop_expression = 247,          /* drop_expression  */
+  YYSYMBOL_248_31 = 248,                   /* @31  */
+  YYSYMBOL_249_32 = 249,                   /* $@32  */
+  YYSYMBOL_opt_selectors = 250,            /* opt_selectors  */
+  YYSYMBOL_selectors = 251,                /* selectors  */
+  YYSYMBOL_selector = 252,                 /* selector  */
+  YYSYMBOL_253_33 = 253,                   /* @33  */
+  YYSYMBOL_on_selector = 254,              /* on_selector  */
+  YYSYMBOL_255_34 = 255,                   /* $@34  */
+  YYSYMBOL_256_35 = 256,                   /* $@35  */
+  YYSYMBOL_257_36 = 257,                   /* $@36  */
+  YYSYMBOL_258_37 = 258,                   /* $@37  */
+  YYSYMBOL_259_38 = 259,                   /* $@38  */
+  YYSYMBOL_opt_filter = 260,               /* opt_filter  */
+  YYSYMBOL_opt_element = 261,              /* opt_element  */
+  YYSYMBOL_filter_spec = 262,              /* filter_spec  */
+  YYSYMBOL_263_39 = 263,                   /* @39  */
+  YYSYMBOL_short_filter_spec = 264,        /* short_filter_spec  */
+  YYSYMBOL_265_40 = 265,                   /* @40  */
+  YYSYMBOL_filter_name = 266,              /* filter_name  */
+  YYSYMBOL_opt_filter_body = 267,          /* opt_filter_body  */
+  YYSYMBOL_filter_body = 268,              /* filter_body  */
+  YYSYMBOL_filter_body_element = 269,      /* filter_body_element  */
+  YYSYMBOL_270_41 = 270,                   /* $@41  */
+  YYSYMBOL_271_42 = 271,                   /* $@42  */
+  YYSYMBOL_tunnel = 272,                   /* tunnel  */
+  YYSYMBOL_273_43 = 273,                   /* $@43  */
+  YYSYMBOL_274_44 = 274,                   /* $@44  */
+  YYSYMBOL_element_spec = 275,             /* element_spec  */
+  YYSYMBOL_276_45 = 276,                   /* $@45  */
+  YYSYMBOL_opt_police = 277,               /* opt_police  */
+  YYSYMBOL_police_spec = 278,              /* police_spec  */
+  YYSYMBOL_279_46 = 279,                   /* @46  */
+  YYSYMBOL_280_47 = 280,                   /* @47  */
+  YYSYMBOL_bucket_spec = 281,              /* bucket_spec  */
+  YYSYMBOL_282_48 = 282,                   /* @48  */
+  YYSYMBOL_opt_policing_decision = 283,    /* opt_policing_decision  */
+  YYSYMBOL_opt_else = 284,                 /* opt_else  */
+  YYSYMBOL_policing_decision = 285,        /* policing_decision  */
+  YYSYMBOL_semicolon = 286,                /* semicolon  */
+  YYSYMBOL_extra_semicolons = 287          /* extra_semicolons  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int16 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  3
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   1025
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  136
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  152
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  343
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  537
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   367
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_uint8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,   129,     2,     2,     2,   128,   121,     2,
+     115,   116,   126,   124,   113,   125,   132,   127,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,   131,   135,
+     122,   114,   123,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,   133,     2,   134,   120,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,   117,   119,   118,   130,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
+      45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    59,    60,    61,    62,    63,    64,
+      65,    66,    67,    68,    69,    70,    71,    72,    73,    74,
+      75,    76,    77,    78,    79,    80,    81,    82,    83,    84,
+      85,    86,    87,    88,    89,    90,    91,    92,    93,    94,
+      95,    96,    97,    98,    99,   100,   101,   102,   103,   104,
+     105,   106,   107,   108,   109,   110,   111,   112
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,   335,   335,   335,   353,   357,   358,   362,   372,   373,
+     377,   378,   379,   384,   383,   394,   395,   399,   400,   401,
+     403,   407,   402,   415,   414,   431,   430,   437,   436,   444,
+     447,   451,   461,   462,   466,   466,   496,   495,   502,   504,
+     504,   513,   519,   513,   526,   527,   531,   532,   533,   537,
+     533,   544,   561,   560,   577,   581,   585,   589,   600,   604,
+     608,   612,   619,   627,   626,   644,   652,   651,   673,   680,
+     687,   698,   697,   713,   723,   724,   728,   735,   739,   746,
+     750,   757,   763,   767,   771,   777,   778,   782,   796,   803,
+     807,   814,   818,   825,   829,   836,   840,   847,   851,   858,
+     862,   866,   873,   877,   881,   885,   889,   896,   900,   904,
+     911,   915,   919,   926,   930,   934,   947,   954,   958,   962,
+     966,   973,   977,   986,   993,   998,  1006,  1009,  1016,  1023,
+    1026,  1070,  1071,  1078,  1082,  1086,  1090,  1094,  1098,  1103,
+    1107,  1111,  1115,  1119,  1123,  1138,  1142,  1146,  1142,  1153,
+    1160,  1163,  1174,  1178,  1182,  1189,  1193,  1197,  1201,  1205,
+    1215,  1228,  1235,  1240,  1248,  1257,  1274,  1277,  1283,  1298,
+    1301,  1313,  1332,  1312,  1347,  1351,  1355,  1359,  1363,  1367,
+    1371,  1375,  1379,  1383,  1387,  1394,  1400,  1399,  1410,  1413,
+    1423,  1427,  1432,  1437,  1441,  1441,  1454,  1458,  1454,  1472,
+    1475,  1482,  1495,  1498,  1502,  1515,  1525,  1537,  1541,  1536,
+    1551,  1556,  1561,  1566,  1571,  1576,  1580,  1584,  1589,  1593,
+    1597,  1601,  1606,  1611,  1616,  1620,  1625,  1630,  1634,  1639,
+    1644,  1648,  1653,  1659,  1664,  1668,  1673,  1679,  1683,  1688,
+    1692,  1696,  1700,  1705,  1710,  1714,  1718,  1722,  1726,  1730,
+    1734,  1738,  1742,  1747,  1753,  1757,  1762,  1766,  1771,  1776,
+    1781,  1786,  1791,  1796,  1804,  1812,  1824,  1832,  1840,  1848,
+    1856,  1877,  1881,  1880,  1892,  1895,  1920,  1919,  1933,  1938,
+    1932,  1945,  1950,  1954,  1955,  1959,  1961,  1960,  1979,  1993,
+    1979,  2006,  2005,  2025,  2025,  2035,  2035,  2043,  2046,  2054,
+    2055,  2064,  2063,  2076,  2075,  2087,  2091,  2095,  2099,  2103,
+    2111,  2112,  2115,  2116,  2120,  2121,  2125,  2126,  2128,  2132,
+    2127,  2144,  2159,  2143,  2176,  2175,  2186,  2189,  2202,  2211,
+    2201,  2227,  2226,  2247,  2250,  2257,  2260,  2267,  2271,  2275,
+    2279,  2290,  2293,  2294
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "TOK_WARN", "TOK_DEV",
+  "TOK_QDISC", "TOK_CLASS", "TOK_FILTER", "TOK_ELEMENT", "TOK_TUNNEL",
+  "TOK_ON", "TOK_POLICE", "TOK_BUCKET", "TOK_ELSE", "TOK_IF",
+  "TOK_IF_ANCHOR", "TOK_HOST", "TOK_HOST4", "TOK_HOST6", "TOK_SPRINTF",
+  "TOK_PRAGMA", "TOK_PASS", "TOK_RECLASSIFY", "TOK_CONTINUE", "TOK_FIELD",
+  "TOK_TAG", "TOK_FIELD_ROOT", "TOK_CONFORM", "TOK_COUNT", "TOK_PRECOND",
+  "TOK_DROP", "TOK_CBQ", "TOK_DSMARK", "TOK_FIFO", "TOK_GRED", "TOK_HTB",
+  "TOK_PRIO", "TOK_RED", "TOK_SFQ", "TOK_TBF", "TOK_INGRESS", "TOK_EGRESS",
+  "TOK_FW", "TOK_ROUTE", "TOK_RSVP", "TOK_TCINDEX", "TOK_AH", "TOK_ALLOT",
+  "TOK_AVPKT", "TOK_BANDS", "TOK_BANDWIDTH", "TOK_BOUNDED", "TOK_BURST",
+  "TOK_CBURST", "TOK_CEIL", "TOK_DEFAULT", "TOK_DEFAULT_INDEX",
+  "TOK_DPORT", "TOK_DST", "TOK_ECN", "TOK_ESP", "TOK_EWMA",
+  "TOK_FALL_THROUGH", "TOK_FROM", "TOK_FROMIF", "TOK_GRIO", "TOK_HASH",
+  "TOK_INDICES", "TOK_ISOLATED", "TOK_IPPROTO", "TOK_LIMIT", "TOK_MASK",
+  "TOK_MAX", "TOK_MAXBURST", "TOK_MIN", "TOK_MINBURST", "TOK_MPU",
+  "TOK_MTU", "TOK_ORDER", "TOK_OVERFLOW", "TOK_PASS_ON", "TOK_PEAKRATE",
+  "TOK_PERTURB", "TOK_PRIOMAP", "TOK_PROBABILITY", "TOK_PROTOCOL",
+  "TOK_QUANTUM", "TOK_R2Q", "TOK_RATE", "TOK_SET_TC_INDEX", "TOK_SHIFT",
+  "TOK_SKIP", "TOK_SPORT", "TOK_SRC", "TOK_TO", "TOK_VALUE", "TOK_WEIGHT",
+  "SHIFT_RIGHT", "SHIFT_LEFT", "LOGICAL_AND", "LOGICAL_OR", "REL_EQ",
+  "REL_NE", "REL_LE", "REL_GE", "UNUM", "IPV4", "IPV6", "FNUM", "WORD",
+  "STRING", "VARIABLE", "FIELD_NAME", "','", "'='", "'('", "')'", "'{'",
+  "'}'", "'|'", "'^'", "'&'", "'<'", "'>'", "'+'", "'-'", "'*'", "'/'",
+  "'%'", "'!'", "'~'", "':'", "'.'", "'['", "']'", "';'", "$accept", "all",
+  "$@1", "preamble_item", "warning_switches", "warning_switch",
+  "assignments", "assignment", "variable_assignment", "$@2",
+  "global_assignments", "global_assignment", "$@3", "$@4",
+  "global_variable_assignment", "$@5", "field", "$@6", "$@7",
+  "opt_condition", "device_specs", "device_spec", "$@8", "device_body",
+  "$@9", "opt_no_dev_specs", "$@10", "$@11", "$@12",
+  "qdisc_expressions_noblock", "qdisc_expressions", "$@13", "$@14",
+  "single_qdisc_expression", "device", "$@15", "device_name",
+  "complex_expression", "global_expression", "qdisc_expression", "@16",
+  "class_expression", "@17", "short_filter_expression",
+  "filter_expression", "@18", "standalone_police_or_bucket_expression",
+  "standalone_police_expression", "police_expression_with_parentheses",
+  "police_expression", "opt_police_keyword", "constant_expression",
+  "expression", "logical_or_expression", "logical_and_expression",
+  "inclusive_or_expression", "exclusive_or_expression", "and_expression",
+  "equality_expression", "relational_expression", "shift_expression",
+  "additive_expression", "multiplicative_expression", "unary_expression",
+  "mask_expression", "mask_selector", "opt_mask_len", "simple_expression",
+  "opt_unit_qualifier", "primary_expression", "simple_primary_expression",
+  "$@19", "$@20", "opt_sprintf_args", "assignments_with_expression",
+  "primary_policing_expression", "variable_expression", "variable",
+  "access_expression", "opt_size_qualifier", "opt_index_expression",
+  "qdisc_spec", "@21", "@22", "qdisc_name", "opt_qdisc_or_class_body",
+  "$@23", "qdisc_or_class_body", "qdisc_or_class_body_element", "@24",
+  "$@25", "$@26", "opt_parameters", "parameters", "parameter_list",
+  "parameter", "parameter_expression", "$@27", "$@28", "host",
+  "primary_host", "primary_host4", "primary_host6", "port", "ipproto",
+  "ether_proto", "forward_class_list", "@29", "pragma_list", "class_spec",
+  "@30", "drop_expression", "@31", "$@32", "opt_selectors", "selectors",
+  "selector", "@33", "on_selector", "$@34", "$@35", "$@36", "$@37", "$@38",
+  "opt_filter", "opt_element", "filter_spec", "@39", "short_filter_spec",
+  "@40", "filter_name", "opt_filter_body", "filter_body",
+  "filter_body_element", "$@41", "$@42", "tunnel", "$@43", "$@44",
+  "element_spec", "$@45", "opt_police", "police_spec", "@46", "@47",
+  "bucket_spec", "@48", "opt_policing_decision", "opt_else",
+  "policing_decision", "semicolon", "extra_semicolons", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-461)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-329)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+    -461,    46,  -461,  -461,   -37,  -461,   121,    -8,  -461,   -55,
+    -461,   -22,  -461,  -461,  -461,   115,   433,     1,   -25,  -461,
+      45,  -461,    13,    19,    60,  -461,  -461,  -461,   115,    34,
+      67,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,
+    -461,  -461,  -461,   433,  -461,  -461,  -461,  -461,  -461,    86,
+      -8,   841,   793,   793,   -37,  -461,   189,  -461,  -461,    92,
+    -461,  -461,    88,  -461,    24,   120,   -37,   793,  -461,  -461,
+      67,    67,   857,   857,   857,   124,   127,   857,  -461,  -461,
+    -461,  -461,  -461,   112,   793,  -461,  -461,   825,   134,  -461,
+    -461,   139,  -461,  -461,  -461,  -461,  -461,    48,    48,  -461,
+     857,   857,   857,   154,   156,   158,   140,   138,   141,    81,
+      43,   116,   102,    71,  -461,  -461,   -51,   151,  -461,  -461,
+     154,  -461,  -461,  -461,  -461,   120,   -38,   -22,  -461,  -461,
+    -461,   -24,   678,  -461,  -461,   476,  -461,   -22,    88,   120,
+      88,   120,  -461,  -461,  -461,  -461,  -461,  -461,   793,   793,
+    -461,   793,   129,   147,  -461,   522,  -461,   153,    67,   793,
+    -461,  -461,    67,  -461,  -461,  -461,  -461,  -461,  -461,   793,
+     793,  -461,   793,   793,   793,   793,   793,   793,   793,   793,
+     793,   793,   793,   793,   793,   793,   793,   793,   793,   793,
+    -461,    65,  -461,  -461,  -461,   -37,  -461,  -461,  -461,  -461,
+    -461,  -461,   825,   793,   793,   793,   793,   793,   793,   793,
+    -461,   793,   793,   793,  -461,   793,   793,   793,  -461,   793,
+     793,  -461,   793,   793,  -461,   793,   793,  -461,   793,   793,
+     793,   793,   793,   793,   793,   793,   793,   793,    48,  -461,
+     793,   793,    67,   793,   793,   793,   793,   793,  -461,   793,
+     793,   793,   793,   793,   793,   793,  -461,  -461,  -461,   155,
+     157,  -461,   -38,  -461,   152,   794,  -461,  -461,  -461,   159,
+     164,   149,   -56,  -461,  -461,    67,    67,  -461,  -461,  -461,
+    -461,  -461,   522,   522,  -461,  -461,  -461,  -461,   -22,  -461,
+     -24,  -461,  -461,  -461,   -22,    88,   171,    88,  -461,  -461,
+     -22,   158,   140,   138,   141,    81,    43,    43,   116,   116,
+     116,   116,   102,   102,    71,    71,  -461,  -461,  -461,   857,
+    -461,   142,   -22,   476,   -37,   563,  -461,  -461,  -461,  -461,
+    -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,
+    -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,
+    -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,
+    -461,  -461,    88,  -461,  -461,  -461,  -461,  -461,  -461,  -461,
+    -461,  -461,  -461,  -461,  -461,  -461,  -461,    67,  -461,   678,
+    -461,   170,  -461,  -461,   163,   793,   173,   112,  -461,  -461,
+    -461,  -461,   120,  -461,  -461,  -461,  -461,   175,   120,  -461,
+    -461,  -461,  -461,   857,  -461,  -461,  -461,   222,  -461,    67,
+    -461,  -461,  -461,   -37,  -461,  -461,  -461,  -461,   261,  -461,
+     159,  -461,   129,    52,    52,   -21,  -461,   -21,  -461,   184,
+    -461,  -461,  -461,  -461,   185,  -461,   433,   174,  -461,  -461,
+     182,   -37,   476,   163,  -461,  -461,  -461,    42,  -461,   -38,
+      52,  -461,   -38,  -461,  -461,  -461,  -461,  -461,    52,  -461,
+    -461,  -461,  -461,    23,  -461,  -461,  -461,  -461,    26,   120,
+     267,   299,  -461,  -461,  -461,   -37,   -37,  -461,   -37,   -37,
+     190,   301,    67,  -461,  -461,  -461,   296,  -461,  -461,    67,
+     793,   307,    23,   -22,   338,  -461,  -461,   120,  -461,   267,
+     120,  -461,  -461,   120,  -461,  -461,  -461,  -461,  -461,  -461,
+    -461,  -461,  -461,  -461,  -461,   193,   -37,   296,  -461,  -461,
+     296,   120,   -37,   -37,  -461,    24,  -461,  -461,    52,  -461,
+     -37,  -461,    31,   -21,   197,  -461,  -461
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int16 yydefact[] =
+{
+       2,     0,   342,     1,    15,   343,    39,     0,    20,     0,
+     162,     0,    16,    17,    18,    34,     0,     0,     0,     7,
+       4,     5,     0,     0,     0,   342,    19,     3,    34,     0,
+       0,   175,   176,   178,   179,   180,   181,   182,   183,   184,
+     174,   177,    40,    44,     8,    65,   171,   342,    23,     0,
+       0,   146,   146,   146,   341,    33,   146,    55,    54,     0,
+      52,    63,   161,    45,    51,   199,     8,   146,   163,     6,
+     328,   331,   146,   146,   146,     0,     0,   146,   134,   135,
+     136,   137,   138,   169,   146,   149,    74,   274,     0,   133,
+     139,     0,    78,    76,   159,   158,   160,    85,    85,   157,
+     146,   146,   146,    29,    88,    89,    91,    93,    95,    97,
+      99,   102,   107,   110,   113,   117,   121,   129,   131,   132,
+      29,    56,    57,   342,    35,   199,     0,     0,     9,    10,
+      11,     0,   146,   172,   200,    48,    24,     0,    77,     0,
+      75,     0,   266,   140,   265,   141,   267,   142,   146,   146,
+     143,   146,   166,     0,   275,   146,    21,    86,   331,   146,
+     155,    79,     0,    83,    84,   156,   120,   118,   119,   146,
+     146,    25,   146,   146,   146,   146,   146,   146,   146,   146,
+     146,   146,   146,   146,   146,   146,   146,   146,   146,   146,
+     123,   146,   130,   128,    27,     8,    53,   342,    64,   185,
+      12,    13,   274,   146,   146,   146,   146,   146,   146,   146,
+     216,   146,   146,   146,   220,   146,   146,   146,   224,   146,
+     146,   227,   146,   146,   230,   146,   146,   234,   146,   146,
+     146,   146,   146,   146,   146,   146,   146,   146,    85,   245,
+     146,   146,   271,   146,   146,   146,   146,   146,   256,   146,
+     146,   146,   146,   146,   146,   146,   207,   206,    87,     0,
+     203,   205,     0,    42,     0,    46,    62,   329,   332,   150,
+       0,     0,     0,   164,   145,   276,     0,   309,   305,   306,
+     307,   308,   146,   146,   152,    59,    60,    61,     0,   147,
+     161,    68,    73,   301,     0,    82,     0,    81,    30,    31,
+       0,    90,    92,    94,    96,    98,   100,   101,   105,   106,
+     103,   104,   108,   109,   111,   112,   114,   115,   116,   146,
+     122,   126,     0,    48,   188,   146,   248,   210,   249,   211,
+     212,   213,   214,   215,   217,   218,   219,   221,   268,   222,
+     264,   223,   225,   226,   228,   229,   231,   232,   269,   233,
+     235,   236,   237,   238,   239,   240,   241,   242,   243,   244,
+     246,   247,   272,   250,   251,   270,   252,   253,   254,   255,
+     257,   258,   259,   260,   261,   262,   263,   271,   201,   146,
+     173,     0,   342,    47,   333,   146,     0,   169,   170,   167,
+     168,    66,   199,    71,   153,   154,    58,     0,   199,    22,
+      80,    26,   125,   146,   124,    28,    36,   194,    14,   271,
+     208,   204,   342,     8,   337,   338,   340,   339,   335,   334,
+     150,   144,   166,   281,   281,     0,   148,     0,   127,     0,
+     278,   190,   192,   191,     0,   189,     0,     0,   193,   273,
+       0,    15,    48,     0,   330,   151,   165,   288,   286,     0,
+     282,   283,     0,   342,    72,   310,   302,   342,   281,   342,
+     195,   342,   209,    43,    49,   336,   291,   285,     0,     0,
+       0,   297,    67,   284,   277,   312,    15,   279,   187,   188,
+       0,   299,     0,   289,    70,   303,   326,   324,   296,     0,
+     146,     0,    37,     0,   194,   342,   300,     0,    69,     0,
+     199,   327,   294,   199,   298,   287,   321,   342,   342,   314,
+     315,   316,   313,   317,   280,     0,     8,   326,   290,   304,
+     326,   199,   318,   311,   342,    50,   292,   325,   281,   312,
+     198,   322,   319,     0,     0,   323,   320
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+    -461,  -461,  -461,     0,  -461,   270,   -63,  -372,  -132,  -461,
+    -409,  -461,  -461,  -461,  -461,  -461,    -1,  -461,  -461,   201,
+     294,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,   280,
+    -250,  -461,  -461,    20,  -461,  -461,  -461,     2,  -461,  -144,
+    -461,  -368,  -461,  -461,  -383,  -461,  -461,  -442,   -76,  -461,
+    -461,   770,   -39,  -461,   160,   161,   150,   167,   172,    56,
+       8,    57,    64,    15,   122,  -461,  -461,  -182,  -461,    27,
+     -35,  -461,  -461,   -95,   -29,  -461,   -28,    -6,  -461,   -96,
+     -59,  -461,  -461,  -461,  -461,  -258,  -461,  -150,  -461,  -461,
+    -461,  -461,  -113,  -131,   -49,  -461,  -461,  -461,  -461,    83,
+    -461,   263,  -461,    96,  -461,  -461,  -335,  -461,   -62,  -461,
+    -461,  -460,  -461,  -461,  -373,  -461,  -107,  -461,  -461,  -461,
+    -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,  -461,
+    -119,  -397,  -178,  -461,  -461,  -461,  -461,  -461,  -461,  -147,
+    -461,  -414,   -79,  -461,  -461,   -77,  -461,  -461,  -461,   -89,
+     -10,   -18
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int16 yydefgoto[] =
+{
+       0,     1,     2,   127,    20,    21,    64,   128,   129,   325,
+       6,    12,    22,   294,    13,    67,   130,   300,   322,   171,
+      27,    28,    29,   124,   429,    15,    16,    17,   381,    42,
+     263,   264,   480,   265,    59,   125,    60,   284,   136,    44,
+     126,   286,   423,   483,   287,   425,    85,    86,   160,   161,
+     162,   257,   258,   104,   105,   106,   107,   108,   109,   110,
+     111,   112,   113,   114,   115,   320,   404,   116,   193,   117,
+     118,    88,   397,   386,   289,   119,    89,    62,    90,   273,
+     152,    45,    65,   262,    46,   198,   434,   407,   435,   436,
+     437,   515,   133,   134,   259,   260,   261,   377,   440,   341,
+     143,   144,   147,   339,   349,   366,   363,   409,    91,   291,
+     392,   438,   458,   493,   449,   450,   451,   471,   467,   468,
+     499,   481,   469,   470,   490,   497,   292,   398,   484,   500,
+     293,   454,   491,   512,   529,   534,   513,   521,   533,   488,
+     503,   502,    92,   139,   384,    93,   141,   418,   444,   419,
+     199,     4
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
+{
+      18,    26,    61,   135,   380,    14,    11,    54,   267,   321,
+     268,   285,   196,   103,   120,   383,    87,   122,   163,   163,
+     164,   164,   165,   282,   433,   154,     7,     7,   137,    66,
+     456,   511,   463,   482,     7,   431,    43,   275,    56,   432,
+     506,   277,   410,     8,   501,   153,     3,     9,     9,   389,
+    -295,   452,    87,   390,    23,     9,   190,    24,   131,   157,
+     158,   430,   447,    43,   138,   140,   448,   492,   278,   279,
+     280,   281,   511,   406,   439,   501,    70,    71,   501,   197,
+     191,    72,    73,    74,    75,   477,    94,    95,    96,    48,
+     201,    76,    97,    98,    77,    99,   453,    25,     5,   142,
+     142,   146,    19,   526,   150,   195,   527,    49,    49,   269,
+     270,   433,   271,    25,    25,   -32,   288,   200,    47,   509,
+     296,   -38,   431,   510,     7,   -38,   432,   266,    51,   131,
+     298,   299,   323,    52,    10,    10,   535,   402,   285,   285,
+     326,     8,    10,    57,    58,     9,   179,   180,   507,   290,
+     282,   282,   295,    10,   283,   531,   297,  -293,    50,   163,
+     509,   164,   359,   159,   510,   181,   182,    87,   169,   170,
+      78,    79,    80,    81,    53,    82,    10,    83,    10,   324,
+      84,   285,   177,   178,   414,   415,   416,   308,   309,   310,
+     311,   472,   464,   417,   474,    68,   319,   187,   188,   189,
+      70,    71,   316,   317,   318,    72,    73,    74,    75,   123,
+      94,    95,    96,   183,   184,    76,    97,    98,    77,    99,
+      49,   428,   166,   167,   168,     7,   185,   186,   275,   276,
+     -38,   -38,    10,   306,   307,   132,   362,   277,   -41,   148,
+     312,   313,   149,   288,   288,   151,     9,   391,   393,   314,
+     315,   155,   430,   394,   395,   156,   172,   173,   175,   174,
+     192,   272,   176,   274,   278,   279,   280,   281,  -328,   382,
+     379,   378,   385,   403,   443,   487,   290,   290,   396,   424,
+     387,   283,   283,   388,   399,   427,   288,   400,   412,   421,
+     401,   461,   460,   426,    78,    79,    80,    81,   121,    82,
+      10,    83,   457,   459,    84,   462,   489,    70,   495,   496,
+       7,   524,   405,   275,   100,   536,   506,   131,   101,   102,
+      69,   194,    55,    63,   303,   445,   446,   408,   422,   494,
+     411,     9,   301,    10,   302,   373,   145,   430,   486,  -196,
+    -186,     7,   304,   473,   275,   276,   420,   372,   305,   485,
+     442,   532,   518,   277,   465,     0,     0,     0,     0,     0,
+       0,     0,     9,     0,   413,     0,   517,     0,   430,     0,
+       0,   362,     0,     0,     0,     0,     0,     0,     0,     0,
+     278,   279,   280,   281,     0,     0,     0,   519,     0,     0,
+     520,     0,     0,     0,   441,     0,     0,     0,     0,     0,
+       0,   131,     0,   362,     0,     0,     0,     0,   528,     0,
+       0,     0,     0,     0,     0,   455,     0,   455,    10,   466,
+       0,     0,     0,     0,   507,   508,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,   475,   131,     0,    30,   476,
+       0,   478,     0,   479,     0,     0,     0,     0,     0,    10,
+       0,   505,     0,   525,   498,  -196,  -197,    18,     0,     0,
+       0,   504,    14,    11,    31,    32,    33,    34,    35,    36,
+      37,    38,    39,    40,    41,     0,     0,   516,     0,     7,
+       0,    30,     0,   514,     0,   131,    18,     0,   131,   522,
+     523,    14,    11,     0,     0,     0,     0,     0,     0,     0,
+       9,     0,     0,     0,     0,     0,   530,    31,    32,    33,
+      34,    35,    36,    37,    38,    39,    40,    41,     0,   131,
+       0,     0,     0,   455,     0,     0,   131,    30,   275,   276,
+       0,     0,     0,    70,    71,     0,     0,   277,    72,    73,
+      74,    75,     0,    94,    95,    96,     9,     0,    76,    97,
+      98,    77,    99,    31,    32,    33,    34,    35,    36,    37,
+      38,    39,    40,    41,   278,   279,   280,   281,    30,   275,
+     276,     0,     0,     0,    70,    71,     0,     0,   277,    72,
+      73,    74,    75,     0,    94,    95,    96,    10,     0,    76,
+      97,    98,    77,    99,    31,    32,    33,    34,    35,    36,
+      37,    38,    39,    40,    41,   278,   279,   280,   281,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    78,    79,    80,
+      81,     0,    82,    10,    83,     0,     0,    84,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,   100,     0,     0,
+       0,   101,   102,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    78,    79,
+      80,    81,     0,    82,    10,    83,     0,     0,    84,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,   100,    70,
+      71,     0,   101,   102,    72,    73,    74,    75,   202,    94,
+      95,    96,     0,   203,    76,    97,    98,    77,    99,     0,
+       0,     0,     0,     0,   204,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,   205,   206,   207,   208,   209,   210,
+     211,   212,   213,   214,   215,   216,   217,   218,   219,   220,
+     221,   222,   223,   224,   225,   226,   227,   228,   229,   230,
+     231,   232,   233,   234,   235,   236,   237,   238,   239,   240,
+     241,   242,   243,   244,   245,   246,   247,   248,   249,   250,
+     251,   252,   253,   254,   255,     0,     0,     0,     0,     0,
+       0,     0,     0,    78,    79,    80,    81,     0,    82,    10,
+      83,     0,     0,    84,  -202,     0,     0,     0,     0,    30,
+     256,     0,     0,   100,    70,    71,     0,   101,   102,    72,
+      73,    74,    75,     0,    94,    95,    96,     0,     0,    76,
+      97,    98,    77,    99,     0,    31,    32,    33,    34,    35,
+      36,    37,    38,    39,    40,    41,    70,    71,     0,     0,
+       0,    72,    73,    74,    75,     0,     0,     0,     0,     0,
+       0,    76,    70,    71,    77,     0,     0,    72,    73,    74,
+      75,     0,     0,     0,     0,     0,     0,    76,    70,    71,
+      77,     0,     0,    72,    73,    74,    75,     0,    94,    95,
+      96,     0,     0,    76,    97,    98,    77,    99,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    78,    79,
+      80,    81,     0,    82,    10,    83,     0,     0,    84,     0,
+       0,   -48,     0,     0,     0,     0,     0,     0,   100,     0,
+       0,     0,   101,   102,     0,     0,     0,     0,     0,     0,
+      78,    79,    80,    81,     0,    82,    10,    83,     0,     0,
+      84,     0,  -146,     0,     0,     0,    78,    79,    80,    81,
+       0,    82,    10,    83,     0,     0,    84,  -274,     0,     0,
+       0,     0,    78,    79,    80,    81,     0,    82,    10,    83,
+       0,     0,    84,   327,   328,   329,   330,   331,   332,   333,
+       0,   334,   335,   336,     0,   337,   338,   340,     0,   342,
+     343,     0,   344,   345,     0,   346,   347,     0,   348,   350,
+     351,   352,   353,   354,   355,   356,   357,   358,     0,     0,
+     360,   361,     0,   364,   365,   367,   368,   369,     0,   370,
+     371,   338,   340,   374,   375,   376
+};
+
+static const yytype_int16 yycheck[] =
+{
+       6,    11,    30,    66,   262,     6,     6,    25,   139,   191,
+     141,   155,   125,    52,    53,   265,    51,    56,    97,    98,
+      97,    98,    98,   155,   407,    87,     3,     3,    67,    47,
+     427,   491,   441,     7,     3,   407,    16,     6,     4,   407,
+       9,    15,   377,    20,   486,    84,     0,    24,    24,   105,
+       8,   424,    87,   109,   109,    24,   107,   112,    64,    11,
+      12,    30,    10,    43,    70,    71,    14,   476,    42,    43,
+      44,    45,   532,   323,   409,   517,    11,    12,   520,   117,
+     131,    16,    17,    18,    19,   458,    21,    22,    23,   114,
+     114,    26,    27,    28,    29,    30,   117,   135,   135,    72,
+      73,    74,   110,   517,    77,   123,   520,   132,   132,   148,
+     149,   494,   151,   135,   135,     0,   155,   127,   117,   491,
+     159,     0,   494,   491,     3,     4,   494,   137,   115,   135,
+     169,   170,   195,   114,   111,   111,   533,   319,   282,   283,
+     202,    20,   111,   109,   110,    24,   103,   104,   117,   155,
+     282,   283,   158,   111,   155,   528,   162,   115,   113,   238,
+     532,   238,   238,   115,   532,   122,   123,   202,    14,    15,
+     105,   106,   107,   108,   114,   110,   111,   112,   111,   197,
+     115,   325,   101,   102,    21,    22,    23,   179,   180,   181,
+     182,   449,   442,    30,   452,   109,   131,   126,   127,   128,
+      11,    12,   187,   188,   189,    16,    17,    18,    19,   117,
+      21,    22,    23,    97,    98,    26,    27,    28,    29,    30,
+     132,   403,   100,   101,   102,     3,   124,   125,     6,     7,
+     109,   110,   111,   177,   178,   115,   242,    15,   117,   115,
+     183,   184,   115,   282,   283,   133,    24,   275,   276,   185,
+     186,   117,    30,   282,   283,   116,   100,    99,   120,   119,
+     109,   132,   121,   116,    42,    43,    44,    45,   115,   117,
+     113,   116,   113,   131,    13,     8,   282,   283,   288,   392,
+     116,   282,   283,   134,   294,   398,   325,   116,   118,   116,
+     300,   117,   436,   118,   105,   106,   107,   108,   109,   110,
+     111,   112,   118,   118,   115,   123,     7,    11,   118,     8,
+       3,   118,   322,     6,   125,   118,     9,   323,   129,   130,
+      50,   120,    28,    43,   174,   420,   422,   325,   387,   479,
+     379,    24,   172,   111,   173,   252,    73,    30,   469,   117,
+     118,     3,   175,   450,     6,     7,   385,   251,   176,   468,
+     413,   529,   499,    15,   443,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    24,    -1,   382,    -1,   497,    -1,    30,    -1,
+      -1,   377,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      42,    43,    44,    45,    -1,    -1,    -1,   500,    -1,    -1,
+     503,    -1,    -1,    -1,   412,    -1,    -1,    -1,    -1,    -1,
+      -1,   407,    -1,   409,    -1,    -1,    -1,    -1,   521,    -1,
+      -1,    -1,    -1,    -1,    -1,   425,    -1,   427,   111,   447,
+      -1,    -1,    -1,    -1,   117,   118,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,   453,   442,    -1,     5,   457,
+      -1,   459,    -1,   461,    -1,    -1,    -1,    -1,    -1,   111,
+      -1,   490,    -1,   516,   482,   117,   118,   463,    -1,    -1,
+      -1,   489,   463,   463,    31,    32,    33,    34,    35,    36,
+      37,    38,    39,    40,    41,    -1,    -1,   495,    -1,     3,
+      -1,     5,    -1,   493,    -1,   491,   492,    -1,   494,   507,
+     508,   492,   492,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      24,    -1,    -1,    -1,    -1,    -1,   524,    31,    32,    33,
+      34,    35,    36,    37,    38,    39,    40,    41,    -1,   525,
+      -1,    -1,    -1,   533,    -1,    -1,   532,     5,     6,     7,
+      -1,    -1,    -1,    11,    12,    -1,    -1,    15,    16,    17,
+      18,    19,    -1,    21,    22,    23,    24,    -1,    26,    27,
+      28,    29,    30,    31,    32,    33,    34,    35,    36,    37,
+      38,    39,    40,    41,    42,    43,    44,    45,     5,     6,
+       7,    -1,    -1,    -1,    11,    12,    -1,    -1,    15,    16,
+      17,    18,    19,    -1,    21,    22,    23,   111,    -1,    26,
+      27,    28,    29,    30,    31,    32,    33,    34,    35,    36,
+      37,    38,    39,    40,    41,    42,    43,    44,    45,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,   105,   106,   107,
+     108,    -1,   110,   111,   112,    -1,    -1,   115,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,   125,    -1,    -1,
+      -1,   129,   130,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,   105,   106,
+     107,   108,    -1,   110,   111,   112,    -1,    -1,   115,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,   125,    11,
+      12,    -1,   129,   130,    16,    17,    18,    19,    20,    21,
+      22,    23,    -1,    25,    26,    27,    28,    29,    30,    -1,
+      -1,    -1,    -1,    -1,    36,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    46,    47,    48,    49,    50,    51,
+      52,    53,    54,    55,    56,    57,    58,    59,    60,    61,
+      62,    63,    64,    65,    66,    67,    68,    69,    70,    71,
+      72,    73,    74,    75,    76,    77,    78,    79,    80,    81,
+      82,    83,    84,    85,    86,    87,    88,    89,    90,    91,
+      92,    93,    94,    95,    96,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,   105,   106,   107,   108,    -1,   110,   111,
+     112,    -1,    -1,   115,   116,    -1,    -1,    -1,    -1,     5,
+     122,    -1,    -1,   125,    11,    12,    -1,   129,   130,    16,
+      17,    18,    19,    -1,    21,    22,    23,    -1,    -1,    26,
+      27,    28,    29,    30,    -1,    31,    32,    33,    34,    35,
+      36,    37,    38,    39,    40,    41,    11,    12,    -1,    -1,
+      -1,    16,    17,    18,    19,    -1,    -1,    -1,    -1,    -1,
+      -1,    26,    11,    12,    29,    -1,    -1,    16,    17,    18,
+      19,    -1,    -1,    -1,    -1,    -1,    -1,    26,    11,    12,
+      29,    -1,    -1,    16,    17,    18,    19,    -1,    21,    22,
+      23,    -1,    -1,    26,    27,    28,    29,    30,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,   105,   106,
+     107,   108,    -1,   110,   111,   112,    -1,    -1,   115,    -1,
+      -1,   117,    -1,    -1,    -1,    -1,    -1,    -1,   125,    -1,
+      -1,    -1,   129,   130,    -1,    -1,    -1,    -1,    -1,    -1,
+     105,   106,   107,   108,    -1,   110,   111,   112,    -1,    -1,
+     115,    -1,   117,    -1,    -1,    -1,   105,   106,   107,   108,
+      -1,   110,   111,   112,    -1,    -1,   115,   116,    -1,    -1,
+      -1,    -1,   105,   106,   107,   108,    -1,   110,   111,   112,
+      -1,    -1,   115,   203,   204,   205,   206,   207,   208,   209,
+      -1,   211,   212,   213,    -1,   215,   216,   217,    -1,   219,
+     220,    -1,   222,   223,    -1,   225,   226,    -1,   228,   229,
+     230,   231,   232,   233,   234,   235,   236,   237,    -1,    -1,
+     240,   241,    -1,   243,   244,   245,   246,   247,    -1,   249,
+     250,   251,   252,   253,   254,   255
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int16 yystos[] =
+{
+       0,   137,   138,     0,   287,   135,   146,     3,    20,    24,
+     111,   139,   147,   150,   152,   161,   162,   163,   213,   110,
+     140,   141,   148,   109,   112,   135,   286,   156,   157,   158,
+       5,    31,    32,    33,    34,    35,    36,    37,    38,    39,
+      40,    41,   165,   169,   175,   217,   220,   117,   114,   132,
+     113,   115,   114,   114,   287,   156,     4,   109,   110,   170,
+     172,   212,   213,   165,   142,   218,   287,   151,   109,   141,
+      11,    12,    16,    17,    18,    19,    26,    29,   105,   106,
+     107,   108,   110,   112,   115,   182,   183,   206,   207,   212,
+     214,   244,   278,   281,    21,    22,    23,    27,    28,    30,
+     125,   129,   130,   188,   189,   190,   191,   192,   193,   194,
+     195,   196,   197,   198,   199,   200,   203,   205,   206,   211,
+     188,   109,   188,   117,   159,   171,   176,   139,   143,   144,
+     152,   213,   115,   228,   229,   142,   174,   188,   213,   279,
+     213,   282,   205,   236,   237,   237,   205,   238,   115,   115,
+     205,   133,   216,   188,   244,   117,   116,    11,    12,   115,
+     184,   185,   186,   278,   281,   184,   200,   200,   200,    14,
+      15,   155,   100,    99,   119,   120,   121,   101,   102,   103,
+     104,   122,   123,    97,    98,   124,   125,   126,   127,   128,
+     107,   131,   109,   204,   155,   287,   228,   117,   221,   286,
+     286,   114,    20,    25,    36,    46,    47,    48,    49,    50,
+      51,    52,    53,    54,    55,    56,    57,    58,    59,    60,
+      61,    62,    63,    64,    65,    66,    67,    68,    69,    70,
+      71,    72,    73,    74,    75,    76,    77,    78,    79,    80,
+      81,    82,    83,    84,    85,    86,    87,    88,    89,    90,
+      91,    92,    93,    94,    95,    96,   122,   187,   188,   230,
+     231,   232,   219,   166,   167,   169,   286,   229,   229,   188,
+     188,   188,   132,   215,   116,     6,     7,    15,    42,    43,
+      44,    45,   144,   152,   173,   175,   177,   180,   188,   210,
+     213,   245,   262,   266,   149,   213,   188,   213,   188,   188,
+     153,   190,   191,   192,   193,   194,   195,   195,   196,   196,
+     196,   196,   197,   197,   198,   198,   199,   199,   199,   131,
+     201,   203,   154,   142,   287,   145,   244,   187,   187,   187,
+     187,   187,   187,   187,   187,   187,   187,   187,   187,   239,
+     187,   235,   187,   187,   187,   187,   187,   187,   187,   240,
+     187,   187,   187,   187,   187,   187,   187,   187,   187,   184,
+     187,   187,   213,   242,   187,   187,   241,   187,   187,   187,
+     187,   187,   239,   235,   187,   187,   187,   233,   116,   113,
+     221,   164,   117,   166,   280,   113,   209,   116,   134,   105,
+     109,   212,   246,   212,   210,   210,   286,   208,   263,   286,
+     116,   286,   203,   131,   202,   286,   166,   223,   173,   243,
+     242,   230,   118,   287,    21,    22,    23,    30,   283,   285,
+     188,   116,   216,   178,   228,   181,   118,   228,   203,   160,
+      30,   143,   177,   180,   222,   224,   225,   226,   247,   242,
+     234,   287,   142,    13,   284,   209,   215,    10,    14,   250,
+     251,   252,   250,   117,   267,   286,   267,   118,   248,   118,
+     175,   117,   123,   146,   166,   285,   212,   254,   255,   258,
+     259,   253,   221,   252,   221,   287,   287,   250,   287,   287,
+     168,   257,     7,   179,   264,   266,   229,     8,   275,     7,
+     260,   268,   146,   249,   223,   118,     8,   261,   212,   256,
+     265,   183,   277,   276,   212,   188,     9,   117,   118,   143,
+     177,   247,   269,   272,   286,   227,   287,   229,   275,   228,
+     228,   273,   287,   287,   118,   142,   277,   277,   228,   270,
+     287,   250,   268,   274,   271,   267,   118
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int16 yyr1[] =
+{
+       0,   136,   138,   137,   139,   140,   140,   141,   142,   142,
+     143,   143,   143,   145,   144,   146,   146,   147,   147,   147,
+     148,   149,   147,   151,   150,   153,   152,   154,   152,   155,
+     155,   155,   156,   156,   158,   157,   160,   159,   161,   162,
+     161,   163,   164,   161,   165,   165,   166,   166,   167,   168,
+     166,   169,   171,   170,   172,   172,   172,   172,   173,   173,
+     173,   173,   174,   176,   175,   175,   178,   177,   177,   179,
+     179,   181,   180,   180,   182,   182,   182,   183,   183,   184,
+     184,   185,   185,   185,   185,   186,   186,   187,   188,   189,
+     189,   190,   190,   191,   191,   192,   192,   193,   193,   194,
+     194,   194,   195,   195,   195,   195,   195,   196,   196,   196,
+     197,   197,   197,   198,   198,   198,   198,   199,   199,   199,
+     199,   200,   200,   200,   201,   201,   202,   202,   203,   204,
+     204,   205,   205,   206,   206,   206,   206,   206,   206,   206,
+     206,   206,   206,   206,   206,   206,   207,   208,   206,   206,
+     209,   209,   210,   210,   210,   211,   211,   211,   211,   211,
+     211,   212,   213,   213,   214,   214,   215,   215,   215,   216,
+     216,   218,   219,   217,   220,   220,   220,   220,   220,   220,
+     220,   220,   220,   220,   220,   221,   222,   221,   223,   223,
+     224,   224,   224,   224,   225,   224,   226,   227,   224,   228,
+     228,   229,   230,   230,   230,   231,   232,   233,   234,   232,
+     232,   232,   232,   232,   232,   232,   232,   232,   232,   232,
+     232,   232,   232,   232,   232,   232,   232,   232,   232,   232,
+     232,   232,   232,   232,   232,   232,   232,   232,   232,   232,
+     232,   232,   232,   232,   232,   232,   232,   232,   232,   232,
+     232,   232,   232,   232,   232,   232,   232,   232,   232,   232,
+     232,   232,   232,   232,   235,   236,   237,   238,   239,   240,
+     241,   242,   243,   242,   244,   244,   246,   245,   248,   249,
+     247,   250,   250,   251,   251,   252,   253,   252,   255,   256,
+     254,   257,   254,   258,   254,   259,   254,   260,   260,   261,
+     261,   263,   262,   265,   264,   266,   266,   266,   266,   266,
+     267,   267,   268,   268,   269,   269,   269,   269,   270,   271,
+     269,   273,   274,   272,   276,   275,   277,   277,   279,   280,
+     278,   282,   281,   283,   283,   284,   284,   285,   285,   285,
+     285,   286,   287,   287
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     0,     5,     2,     1,     3,     1,     0,     2,
+       1,     1,     2,     0,     4,     0,     2,     1,     1,     2,
+       0,     0,     7,     0,     4,     0,     7,     0,     7,     0,
+       2,     2,     0,     2,     0,     3,     0,     8,     0,     0,
+       2,     0,     0,     9,     1,     2,     1,     2,     0,     0,
+       9,     2,     0,     3,     1,     1,     2,     2,     2,     1,
+       1,     1,     2,     0,     4,     1,     0,     5,     1,     2,
+       1,     0,     4,     1,     1,     2,     1,     2,     1,     1,
+       3,     2,     2,     1,     1,     0,     1,     1,     1,     1,
+       3,     1,     3,     1,     3,     1,     3,     1,     3,     1,
+       3,     3,     1,     3,     3,     3,     3,     1,     3,     3,
+       1,     3,     3,     1,     3,     3,     3,     1,     2,     2,
+       2,     1,     3,     2,     2,     2,     0,     2,     2,     0,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       2,     2,     2,     2,     5,     3,     0,     0,     5,     1,
+       0,     3,     1,     2,     2,     2,     2,     1,     1,     1,
+       1,     1,     1,     3,     3,     6,     0,     2,     2,     0,
+       3,     0,     0,     5,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     1,     0,     6,     0,     2,
+       1,     1,     1,     1,     0,     2,     0,     0,     7,     0,
+       1,     3,     0,     1,     3,     1,     1,     0,     0,     5,
+       2,     2,     2,     2,     2,     2,     1,     2,     2,     2,
+       1,     2,     2,     2,     1,     2,     2,     1,     2,     2,
+       1,     2,     2,     2,     1,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     1,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     2,     2,
+       2,     2,     2,     2,     1,     1,     1,     1,     1,     1,
+       1,     0,     0,     3,     0,     2,     0,     5,     0,     0,
+       5,     0,     1,     1,     2,     2,     0,     4,     0,     0,
+       4,     0,     5,     0,     3,     0,     2,     0,     2,     0,
+       1,     0,     4,     0,     3,     1,     1,     1,     1,     1,
+       1,     5,     0,     2,     1,     1,     1,     1,     0,     0,
+       6,     0,     0,     6,     0,     4,     0,     1,     0,     0,
+       6,     0,     3,     0,     1,     0,     2,     1,     1,     1,
+       1,     2,     0,     2
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* $@1: %empty  */
+#line 335 "tcng.y"
+        {
+	    field_set("raw",
+	      op_ternary(&op_access,
+		data_field_root(field_root(0)),data_none(),
+	      data_unum(0)),data_none());
+	    field_set("__meta",
+	      op_ternary(&op_access,
+		data_field_root(field_root(1)),data_none(),
+	      data_unum(0)),data_none());
+	}
+#line 2435 "y.tab.c"
+    break;
+
+  case 7: /* warning_switch: STRING  */
+#line 363 "tcng.y"
+        {
+	    if (!set_warn_switch((yyvsp[0].str),0)) yywarn("unrecognized warning switch");
+	    free((yyvsp[0].str));
+	}
+#line 2444 "y.tab.c"
+    break;
+
+  case 13: /* $@2: %empty  */
+#line 384 "tcng.y"
+        {
+	    var_push_access();
+	}
+#line 2452 "y.tab.c"
+    break;
+
+  case 14: /* variable_assignment: variable '=' $@2 complex_expression  */
+#line 388 "tcng.y"
+        {
+	    var_pop_access();
+	    var_set(field_snapshot((yyvsp[0].data)));
+	}
+#line 2461 "y.tab.c"
+    break;
+
+  case 20: /* $@3: %empty  */
+#line 403 "tcng.y"
+        {
+	    if (pragma) yyerror("only one global pragma allowed");
+	}
+#line 2469 "y.tab.c"
+    break;
+
+  case 21: /* $@4: %empty  */
+#line 407 "tcng.y"
+        {
+	    pragma = (yyvsp[-1].list);
+	}
+#line 2477 "y.tab.c"
+    break;
+
+  case 23: /* $@5: %empty  */
+#line 415 "tcng.y"
+        {
+	    var_push_access();
+	}
+#line 2485 "y.tab.c"
+    break;
+
+  case 24: /* global_variable_assignment: variable '=' $@5 global_expression  */
+#line 419 "tcng.y"
+        {
+	    var_pop_access();
+	    var_set(field_snapshot((yyvsp[0].data)));
+	}
+#line 2494 "y.tab.c"
+    break;
+
+  case 25: /* $@6: %empty  */
+#line 431 "tcng.y"
+        {
+	    field_set((yyvsp[-3].str),(yyvsp[-1].data),(yyvsp[0].data));
+	    free((yyvsp[-3].str));
+	}
+#line 2503 "y.tab.c"
+    break;
+
+  case 27: /* $@7: %empty  */
+#line 437 "tcng.y"
+        {
+	    field_redefine((yyvsp[-3].field),(yyvsp[-1].data),(yyvsp[0].data));
+	}
+#line 2511 "y.tab.c"
+    break;
+
+  case 29: /* opt_condition: %empty  */
+#line 444 "tcng.y"
+        {
+	    (yyval.data) = data_none();
+	}
+#line 2519 "y.tab.c"
+    break;
+
+  case 30: /* opt_condition: TOK_IF expression  */
+#line 448 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 2527 "y.tab.c"
+    break;
+
+  case 31: /* opt_condition: TOK_IF_ANCHOR expression  */
+#line 452 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 2535 "y.tab.c"
+    break;
+
+  case 34: /* $@8: %empty  */
+#line 466 "tcng.y"
+        {
+	    /*
+	     * Make sure local variables get local scope. Note that we have to
+	     * enter the scope before parsing the device, because a variable
+	     * assignment can be the token immediately following the device
+	     * name, so lexer and parser would get de-synchronized.
+	     *
+	     * By pre-allocating the device, we can register a valid device
+	     * pointer, even though the device is created after the first
+	     * variable in its scope may have been scanned.
+	     *
+	     * All this is extremely messy. Should start disallowing device
+	     * bodies without curly braces.
+	     */
+	    parent.device = alloc_t(DEVICE);
+	    begin_scope(data_device(parent.device));
+	    /*
+	     * Language design bugs: if omitting device and braces, variables
+	     * may get global scope. If not using braces, variables are pulled
+	     * into local scope of previous device, which may be a bit of a
+	     * surprise.
+	     *
+	     * The solution: always use braces.
+	     */
+	}
+#line 2565 "y.tab.c"
+    break;
+
+  case 36: /* $@9: %empty  */
+#line 496 "tcng.y"
+        {
+	    end_scope();
+	}
+#line 2573 "y.tab.c"
+    break;
+
+  case 39: /* $@10: %empty  */
+#line 504 "tcng.y"
+        {
+	    create_device(NULL,default_device,NULL);
+		/* stralloc this if ever implementing deallocations */
+	    begin_scope(data_device(parent.device));
+	}
+#line 2583 "y.tab.c"
+    break;
+
+  case 40: /* opt_no_dev_specs: $@10 qdisc_expressions_noblock  */
+#line 510 "tcng.y"
+        {
+	    end_scope();
+	}
+#line 2591 "y.tab.c"
+    break;
+
+  case 41: /* $@11: %empty  */
+#line 513 "tcng.y"
+      {
+	    create_device(NULL,default_device,NULL);
+		/* stralloc this if ever implementing deallocations */
+	    begin_scope(data_device(parent.device));
+	}
+#line 2601 "y.tab.c"
+    break;
+
+  case 42: /* $@12: %empty  */
+#line 519 "tcng.y"
+        {
+	    end_scope();
+	}
+#line 2609 "y.tab.c"
+    break;
+
+  case 48: /* $@13: %empty  */
+#line 533 "tcng.y"
+        {
+	    begin_scope(data_none());
+	}
+#line 2617 "y.tab.c"
+    break;
+
+  case 49: /* $@14: %empty  */
+#line 537 "tcng.y"
+        {
+	    end_scope();
+	}
+#line 2625 "y.tab.c"
+    break;
+
+  case 51: /* single_qdisc_expression: qdisc_expression assignments  */
+#line 545 "tcng.y"
+        {
+	    if ((yyvsp[-1].data).u.qdisc->dsc == &ingress_dsc) {
+		if (parent.device->ingress)
+		    yyerror("ingress qdisc is already set");
+		parent.device->ingress = (yyvsp[-1].data).u.qdisc;
+	    }
+	    else {
+		if (parent.device->egress)
+		    yyerror("egress qdisc is already set");
+		parent.device->egress = (yyvsp[-1].data).u.qdisc;
+	    }
+	}
+#line 2642 "y.tab.c"
+    break;
+
+  case 52: /* $@15: %empty  */
+#line 561 "tcng.y"
+        {
+	    param_def = &device_def;
+	    device_tag = NULL;
+	    tag_anchor = &device_tag;
+	}
+#line 2652 "y.tab.c"
+    break;
+
+  case 53: /* device: device_name $@15 opt_parameters  */
+#line 567 "tcng.y"
+        {
+	    DEVICE *device;
+
+	    param_def = NULL;
+	    device = create_device(parent.device,(yyvsp[-2].str),(yyvsp[0].param));
+	    device->location.tag = device_tag;
+	}
+#line 2664 "y.tab.c"
+    break;
+
+  case 54: /* device_name: STRING  */
+#line 578 "tcng.y"
+        {
+	    (yyval.str) = (yyvsp[0].str);
+	}
+#line 2672 "y.tab.c"
+    break;
+
+  case 55: /* device_name: WORD  */
+#line 582 "tcng.y"
+        {
+	    (yyval.str) = (yyvsp[0].str);
+	}
+#line 2680 "y.tab.c"
+    break;
+
+  case 56: /* device_name: TOK_DEV WORD  */
+#line 586 "tcng.y"
+        {
+	    (yyval.str) = (yyvsp[0].str);
+	}
+#line 2688 "y.tab.c"
+    break;
+
+  case 57: /* device_name: TOK_DEV expression  */
+#line 590 "tcng.y"
+        {
+	    (yyval.str) = data_convert((yyvsp[0].data),dt_string).u.string;
+	}
+#line 2696 "y.tab.c"
+    break;
+
+  case 58: /* complex_expression: expression semicolon  */
+#line 601 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[-1].data);
+	}
+#line 2704 "y.tab.c"
+    break;
+
+  case 59: /* complex_expression: qdisc_expression  */
+#line 605 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 2712 "y.tab.c"
+    break;
+
+  case 60: /* complex_expression: class_expression  */
+#line 609 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 2720 "y.tab.c"
+    break;
+
+  case 61: /* complex_expression: filter_expression  */
+#line 613 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 2728 "y.tab.c"
+    break;
+
+  case 62: /* global_expression: expression semicolon  */
+#line 620 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[-1].data);
+	}
+#line 2736 "y.tab.c"
+    break;
+
+  case 63: /* @16: %empty  */
+#line 627 "tcng.y"
+        {
+	    (yyval.data) = data_convert((yyvsp[0].data),dt_qdisc);
+	    if ((yyval.data).u.qdisc->parent.device != parent.device)
+		yyerror("qdisc was created in different scope");
+	    (yyvsp[-1].parent) = parent; /* a little hackish ... @@@ */
+	    parent.qdisc = (yyval.data).u.qdisc;
+	    parent.class = NULL;
+	    parent.filter = NULL;
+	    parent.tunnel = NULL;
+	    begin_scope((yyval.data));
+	}
+#line 2752 "y.tab.c"
+    break;
+
+  case 64: /* qdisc_expression: TOK_QDISC variable_expression @16 opt_qdisc_or_class_body  */
+#line 639 "tcng.y"
+        {
+	    /* opt_qdisc_or_class_body ends the scope */
+	    parent = (yyvsp[-3].parent);
+	    (yyval.data) = (yyvsp[-1].data);
+	}
+#line 2762 "y.tab.c"
+    break;
+
+  case 65: /* qdisc_expression: qdisc_spec  */
+#line 645 "tcng.y"
+        {
+	    (yyval.data) = data_qdisc((yyvsp[0].qdisc));
+	}
+#line 2770 "y.tab.c"
+    break;
+
+  case 66: /* @17: %empty  */
+#line 652 "tcng.y"
+        {
+	    (yyval.data) = data_convert((yyvsp[0].data),dt_class);
+	    if ((yyval.data).u.class->parent.qdisc != parent.qdisc ||
+	      (yyval.data).u.class->parent.class != parent.class)
+		yyerror("class was created in different scope");
+	    (yyval.data).u.class->parent = parent;
+		/* okay to change it a little - the fields we may modify are
+		   only used temporarily during construction anyway */
+	    parent.class = (yyval.data).u.class;
+	    begin_scope((yyval.data));
+	}
+#line 2786 "y.tab.c"
+    break;
+
+  case 67: /* class_expression: TOK_CLASS variable_expression @17 opt_selectors opt_qdisc_or_class_body  */
+#line 664 "tcng.y"
+        {
+	    /* end_scope is called in opt_qdisc_or_class_body */
+	    if ((yyvsp[0].qdisc)) {
+		if (parent.class->qdisc) yyerror("class already has a qdisc");
+		parent.class->qdisc = (yyvsp[0].qdisc);
+	    }
+	    parent = parent.class->parent;
+	    (yyval.data) = (yyvsp[-2].data);
+	}
+#line 2800 "y.tab.c"
+    break;
+
+  case 68: /* class_expression: class_spec  */
+#line 674 "tcng.y"
+        {
+	    (yyval.data) = data_class((yyvsp[0].class));
+	}
+#line 2808 "y.tab.c"
+    break;
+
+  case 69: /* short_filter_expression: TOK_FILTER variable_expression  */
+#line 681 "tcng.y"
+        {
+	    (yyval.data) = data_convert((yyvsp[0].data),dt_filter);
+	    if ((yyval.data).u.filter->parent.qdisc != parent.qdisc ||
+	      (yyval.data).u.filter->parent.class != parent.class)
+		yyerror("filter was created in different scope");
+	}
+#line 2819 "y.tab.c"
+    break;
+
+  case 70: /* short_filter_expression: short_filter_spec  */
+#line 688 "tcng.y"
+        {
+	    (yyval.data) = data_filter((yyvsp[0].filter));
+	    if ((yyval.data).u.filter->parent.qdisc != parent.qdisc ||
+	      (yyval.data).u.filter->parent.class != parent.class)
+		yyerror("filter was created in different scope");
+	}
+#line 2830 "y.tab.c"
+    break;
+
+  case 71: /* @18: %empty  */
+#line 698 "tcng.y"
+        {
+	    (yyval.data) = data_convert((yyvsp[0].data),dt_filter);
+	    if ((yyval.data).u.filter->parent.qdisc != parent.qdisc)
+		yyerror("filter was created in different scope");
+	    (yyval.data).u.filter->parent.filter = parent.filter;
+	    parent.filter = (yyval.data).u.filter;
+	    /* we don't dare to touch any other fields of parent */
+	    begin_scope((yyval.data));
+	}
+#line 2844 "y.tab.c"
+    break;
+
+  case 72: /* filter_expression: TOK_FILTER variable_expression @18 opt_filter_body  */
+#line 708 "tcng.y"
+        {
+	    end_scope();
+	    parent.filter = parent.filter->parent.filter;
+	    (yyval.data) = (yyvsp[-1].data);
+	}
+#line 2854 "y.tab.c"
+    break;
+
+  case 73: /* filter_expression: filter_spec  */
+#line 714 "tcng.y"
+        {
+	    (yyval.data) = data_filter((yyvsp[0].filter));
+	    if ((yyval.data).u.filter->parent.qdisc != parent.qdisc ||
+	      (yyval.data).u.filter->parent.class != parent.class)
+		yyerror("filter was created in different scope");
+	}
+#line 2865 "y.tab.c"
+    break;
+
+  case 75: /* standalone_police_or_bucket_expression: TOK_BUCKET variable  */
+#line 725 "tcng.y"
+        {
+	    (yyval.data) = data_convert(var_get(),dt_bucket);
+	}
+#line 2873 "y.tab.c"
+    break;
+
+  case 76: /* standalone_police_or_bucket_expression: bucket_spec  */
+#line 729 "tcng.y"
+        {
+	    (yyval.data) = data_bucket((yyvsp[0].police));
+	}
+#line 2881 "y.tab.c"
+    break;
+
+  case 77: /* standalone_police_expression: TOK_POLICE variable  */
+#line 736 "tcng.y"
+        {
+	    (yyval.data) = data_convert(var_get(),dt_police);
+	}
+#line 2889 "y.tab.c"
+    break;
+
+  case 78: /* standalone_police_expression: police_spec  */
+#line 740 "tcng.y"
+        {
+	    (yyval.data) = data_police((yyvsp[0].police));
+	}
+#line 2897 "y.tab.c"
+    break;
+
+  case 79: /* police_expression_with_parentheses: police_expression  */
+#line 747 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 2905 "y.tab.c"
+    break;
+
+  case 80: /* police_expression_with_parentheses: '(' expression ')'  */
+#line 751 "tcng.y"
+        {
+	    (yyval.data) = data_convert((yyvsp[-1].data),(yyvsp[-1].data).type == dt_bucket ? dt_bucket : dt_police);
+	}
+#line 2913 "y.tab.c"
+    break;
+
+  case 81: /* police_expression: opt_police_keyword variable  */
+#line 759 "tcng.y"
+        {
+	    DATA d = var_get();
+	    (yyval.data) = data_convert(d,d.type == dt_bucket ? dt_bucket : dt_police);
+	}
+#line 2922 "y.tab.c"
+    break;
+
+  case 82: /* police_expression: TOK_BUCKET variable  */
+#line 764 "tcng.y"
+        {
+	    (yyval.data) = data_convert(var_get(),dt_bucket);
+	}
+#line 2930 "y.tab.c"
+    break;
+
+  case 83: /* police_expression: police_spec  */
+#line 768 "tcng.y"
+        {
+	    (yyval.data) = data_police((yyvsp[0].police));
+	}
+#line 2938 "y.tab.c"
+    break;
+
+  case 84: /* police_expression: bucket_spec  */
+#line 772 "tcng.y"
+        {
+	    (yyval.data) = data_bucket((yyvsp[0].police));
+	}
+#line 2946 "y.tab.c"
+    break;
+
+  case 87: /* constant_expression: expression  */
+#line 783 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	    if ((yyval.data).op) yyerror("constant expression isn't");
+	}
+#line 2955 "y.tab.c"
+    break;
+
+  case 88: /* expression: logical_or_expression  */
+#line 797 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 2963 "y.tab.c"
+    break;
+
+  case 89: /* logical_or_expression: logical_and_expression  */
+#line 804 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 2971 "y.tab.c"
+    break;
+
+  case 90: /* logical_or_expression: logical_or_expression LOGICAL_OR logical_and_expression  */
+#line 808 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_logical_or,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 2979 "y.tab.c"
+    break;
+
+  case 91: /* logical_and_expression: inclusive_or_expression  */
+#line 815 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 2987 "y.tab.c"
+    break;
+
+  case 92: /* logical_and_expression: logical_and_expression LOGICAL_AND inclusive_or_expression  */
+#line 819 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_logical_and,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 2995 "y.tab.c"
+    break;
+
+  case 93: /* inclusive_or_expression: exclusive_or_expression  */
+#line 826 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3003 "y.tab.c"
+    break;
+
+  case 94: /* inclusive_or_expression: inclusive_or_expression '|' exclusive_or_expression  */
+#line 830 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_or,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3011 "y.tab.c"
+    break;
+
+  case 95: /* exclusive_or_expression: and_expression  */
+#line 837 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3019 "y.tab.c"
+    break;
+
+  case 96: /* exclusive_or_expression: exclusive_or_expression '^' and_expression  */
+#line 841 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_xor,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3027 "y.tab.c"
+    break;
+
+  case 97: /* and_expression: equality_expression  */
+#line 848 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3035 "y.tab.c"
+    break;
+
+  case 98: /* and_expression: and_expression '&' equality_expression  */
+#line 852 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_and,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3043 "y.tab.c"
+    break;
+
+  case 99: /* equality_expression: relational_expression  */
+#line 859 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3051 "y.tab.c"
+    break;
+
+  case 100: /* equality_expression: equality_expression REL_EQ relational_expression  */
+#line 863 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_eq,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3059 "y.tab.c"
+    break;
+
+  case 101: /* equality_expression: equality_expression REL_NE relational_expression  */
+#line 867 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_ne,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3067 "y.tab.c"
+    break;
+
+  case 102: /* relational_expression: shift_expression  */
+#line 874 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3075 "y.tab.c"
+    break;
+
+  case 103: /* relational_expression: relational_expression '<' shift_expression  */
+#line 878 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_lt,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3083 "y.tab.c"
+    break;
+
+  case 104: /* relational_expression: relational_expression '>' shift_expression  */
+#line 882 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_gt,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3091 "y.tab.c"
+    break;
+
+  case 105: /* relational_expression: relational_expression REL_LE shift_expression  */
+#line 886 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_le,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3099 "y.tab.c"
+    break;
+
+  case 106: /* relational_expression: relational_expression REL_GE shift_expression  */
+#line 890 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_ge,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3107 "y.tab.c"
+    break;
+
+  case 107: /* shift_expression: additive_expression  */
+#line 897 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3115 "y.tab.c"
+    break;
+
+  case 108: /* shift_expression: shift_expression SHIFT_RIGHT additive_expression  */
+#line 901 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_shift_right,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3123 "y.tab.c"
+    break;
+
+  case 109: /* shift_expression: shift_expression SHIFT_LEFT additive_expression  */
+#line 905 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_shift_left,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3131 "y.tab.c"
+    break;
+
+  case 110: /* additive_expression: multiplicative_expression  */
+#line 912 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3139 "y.tab.c"
+    break;
+
+  case 111: /* additive_expression: additive_expression '+' multiplicative_expression  */
+#line 916 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_plus,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3147 "y.tab.c"
+    break;
+
+  case 112: /* additive_expression: additive_expression '-' multiplicative_expression  */
+#line 920 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_minus,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3155 "y.tab.c"
+    break;
+
+  case 113: /* multiplicative_expression: unary_expression  */
+#line 927 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3163 "y.tab.c"
+    break;
+
+  case 114: /* multiplicative_expression: multiplicative_expression '*' unary_expression  */
+#line 931 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_mult,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3171 "y.tab.c"
+    break;
+
+  case 115: /* multiplicative_expression: multiplicative_expression '/' unary_expression  */
+#line 935 "tcng.y"
+        {
+	    /*
+	     * Access $1 before op_binary, because op_binary may destroy it.
+	     * Issue warning after op_binary, because op_binary may decide to
+	     * issue an error (e.g. if $3 is not dt_unum.
+	     */
+	    int warn = warn_const_pfx &&
+	      !(yyvsp[-2].data).op && ((yyvsp[-2].data).type == dt_ipv4 || (yyvsp[-2].data).type == dt_ipv6);
+
+	    (yyval.data) = op_binary(&op_div,(yyvsp[-2].data),(yyvsp[0].data));
+	    if (warn) yywarn("taking prefix of constant (and not field)");
+	}
+#line 3188 "y.tab.c"
+    break;
+
+  case 116: /* multiplicative_expression: multiplicative_expression '%' unary_expression  */
+#line 948 "tcng.y"
+        {
+	    (yyval.data) = op_binary(&op_mod,(yyvsp[-2].data),(yyvsp[0].data));
+	}
+#line 3196 "y.tab.c"
+    break;
+
+  case 117: /* unary_expression: mask_expression  */
+#line 955 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3204 "y.tab.c"
+    break;
+
+  case 118: /* unary_expression: '!' mask_expression  */
+#line 959 "tcng.y"
+        {
+	    (yyval.data) = op_unary(&op_logical_not,(yyvsp[0].data));
+	}
+#line 3212 "y.tab.c"
+    break;
+
+  case 119: /* unary_expression: '~' mask_expression  */
+#line 963 "tcng.y"
+        {
+	    (yyval.data) = op_unary(&op_not,(yyvsp[0].data));
+	}
+#line 3220 "y.tab.c"
+    break;
+
+  case 120: /* unary_expression: '-' mask_expression  */
+#line 967 "tcng.y"
+        {
+	    (yyval.data) = op_unary(&op_unary_minus,(yyvsp[0].data));
+	}
+#line 3228 "y.tab.c"
+    break;
+
+  case 121: /* mask_expression: simple_expression  */
+#line 974 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3236 "y.tab.c"
+    break;
+
+  case 122: /* mask_expression: simple_expression ':' mask_selector  */
+#line 978 "tcng.y"
+        {
+	    (yyval.data) = op_ternary(&op_mask,(yyvsp[-2].data),(yyvsp[0].mask).b,(yyvsp[0].mask).c);
+	}
+#line 3244 "y.tab.c"
+    break;
+
+  case 123: /* mask_expression: simple_expression IPV6  */
+#line 987 "tcng.y"
+        {
+	    yyerror("Sorry, mis-parsed \"::\". Please use \": :\" instead.");
+	}
+#line 3252 "y.tab.c"
+    break;
+
+  case 124: /* mask_selector: simple_expression opt_mask_len  */
+#line 994 "tcng.y"
+        {
+	    (yyval.mask).b = (yyvsp[-1].data);
+	    (yyval.mask).c = (yyvsp[0].data);
+	}
+#line 3261 "y.tab.c"
+    break;
+
+  case 125: /* mask_selector: ':' simple_expression  */
+#line 999 "tcng.y"
+        {
+	    (yyval.mask).b = data_none();
+	    (yyval.mask).c = (yyvsp[0].data);
+	}
+#line 3270 "y.tab.c"
+    break;
+
+  case 126: /* opt_mask_len: %empty  */
+#line 1006 "tcng.y"
+        {
+	    (yyval.data) = data_none();
+	}
+#line 3278 "y.tab.c"
+    break;
+
+  case 127: /* opt_mask_len: ':' simple_expression  */
+#line 1010 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3286 "y.tab.c"
+    break;
+
+  case 128: /* simple_expression: primary_expression opt_unit_qualifier  */
+#line 1017 "tcng.y"
+        {
+	    (yyval.data) = data_add_unit((yyvsp[-1].data),(yyvsp[0].data));
+	}
+#line 3294 "y.tab.c"
+    break;
+
+  case 129: /* opt_unit_qualifier: %empty  */
+#line 1023 "tcng.y"
+        {
+	    (yyval.data) = data_none();
+	}
+#line 3302 "y.tab.c"
+    break;
+
+  case 130: /* opt_unit_qualifier: WORD  */
+#line 1027 "tcng.y"
+        {
+	    const char *unit = (yyvsp[0].str);
+
+	    if (strchr("mkMG",*unit)) unit++;
+	    (yyval.data) = data_none();
+	    if (!strcmp(unit,"bps")) {
+		(yyval.data).type = dt_rate;
+		(yyval.data).u.fnum = si_prefix(*(yyvsp[0].str),1000,1);
+	    }
+	    else if (!strcmp(unit,"Bps")) {
+		(yyval.data).type = dt_rate;
+		(yyval.data).u.fnum = si_prefix(*(yyvsp[0].str),1000,1)*8.0;
+	    }
+	    else if (!strcmp(unit,"b") || !strcmp(unit,"bit") ||
+	      !strcmp(unit,"bits")) {
+		(yyval.data).type = dt_size;
+		(yyval.data).u.fnum = si_prefix(*(yyvsp[0].str),1024,1)/8.0;
+	    }
+	    else if (!strcmp(unit,"B") || !strcmp(unit,"Byte") ||
+	      !strcmp(unit,"Bytes")) {
+		(yyval.data).type = dt_size;
+		(yyval.data).u.fnum = si_prefix(*(yyvsp[0].str),1024,1);
+	    }
+	    else if (!strcmp(unit,"p") || !strcmp(unit,"pck") ||
+	      !strcmp(unit,"pcks")) {
+		(yyval.data).type = dt_psize;
+		(yyval.data).u.fnum = si_prefix(*(yyvsp[0].str),1000,1);
+	    }
+	    else if (!strcmp(unit,"pps")) {
+		(yyval.data).type = dt_prate;
+		(yyval.data).u.fnum = si_prefix(*(yyvsp[0].str),1000,1);
+	    }
+	    else if (!strcmp(unit,"s") || !strcmp(unit,"sec") ||
+	      !strcmp(unit,"secs")) {
+		(yyval.data).type = dt_time;
+		(yyval.data).u.fnum = si_prefix(*(yyvsp[0].str),1000,0);
+	    }
+	    else yyerrorf("unrecognized unit name \"%s\"",(yyvsp[0].str));
+	    free((yyvsp[0].str));
+	}
+#line 3347 "y.tab.c"
+    break;
+
+  case 132: /* primary_expression: primary_policing_expression  */
+#line 1072 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3355 "y.tab.c"
+    break;
+
+  case 133: /* simple_primary_expression: variable_expression  */
+#line 1079 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3363 "y.tab.c"
+    break;
+
+  case 134: /* simple_primary_expression: UNUM  */
+#line 1083 "tcng.y"
+        {
+	    (yyval.data) = data_unum((yyvsp[0].unum));
+	}
+#line 3371 "y.tab.c"
+    break;
+
+  case 135: /* simple_primary_expression: IPV4  */
+#line 1087 "tcng.y"
+        {
+	    (yyval.data) = data_ipv4((yyvsp[0].unum));
+	}
+#line 3379 "y.tab.c"
+    break;
+
+  case 136: /* simple_primary_expression: IPV6  */
+#line 1091 "tcng.y"
+        {
+	    (yyval.data) = data_ipv6((yyvsp[0].u128));
+	}
+#line 3387 "y.tab.c"
+    break;
+
+  case 137: /* simple_primary_expression: FNUM  */
+#line 1095 "tcng.y"
+        {
+	    (yyval.data) = data_fnum((yyvsp[0].fnum));
+	}
+#line 3395 "y.tab.c"
+    break;
+
+  case 138: /* simple_primary_expression: STRING  */
+#line 1099 "tcng.y"
+        {
+	    (yyval.data) = data_string((yyvsp[0].str));
+	    free((yyvsp[0].str));
+	}
+#line 3404 "y.tab.c"
+    break;
+
+  case 139: /* simple_primary_expression: access_expression  */
+#line 1104 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3412 "y.tab.c"
+    break;
+
+  case 140: /* simple_primary_expression: TOK_HOST primary_host  */
+#line 1108 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3420 "y.tab.c"
+    break;
+
+  case 141: /* simple_primary_expression: TOK_HOST4 primary_host4  */
+#line 1112 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3428 "y.tab.c"
+    break;
+
+  case 142: /* simple_primary_expression: TOK_HOST6 primary_host6  */
+#line 1116 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3436 "y.tab.c"
+    break;
+
+  case 143: /* simple_primary_expression: TOK_PRECOND primary_expression  */
+#line 1120 "tcng.y"
+        {
+	    (yyval.data) = op_unary(&op_precond,(yyvsp[0].data));
+	}
+#line 3444 "y.tab.c"
+    break;
+
+  case 144: /* simple_primary_expression: TOK_SPRINTF '(' expression opt_sprintf_args ')'  */
+#line 1124 "tcng.y"
+        {
+	    char *s;
+	    DATA_LIST *walk,*next;
+
+	    s = sprintf_data(data_convert((yyvsp[-2].data),dt_string).u.string,(yyvsp[-1].list));
+	    (yyval.data) = data_string(s);
+	    free(s);
+	    for (walk = (yyvsp[-1].list); walk; walk = next) {
+		data_destroy(*walk->ref);
+		free(walk->ref);
+		next = walk->next;
+		free(walk);
+	    }
+	}
+#line 3463 "y.tab.c"
+    break;
+
+  case 145: /* simple_primary_expression: '(' expression ')'  */
+#line 1139 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[-1].data);
+	}
+#line 3471 "y.tab.c"
+    break;
+
+  case 146: /* $@19: %empty  */
+#line 1142 "tcng.y"
+        {
+	    begin_scope(data_none());
+	}
+#line 3479 "y.tab.c"
+    break;
+
+  case 147: /* $@20: %empty  */
+#line 1146 "tcng.y"
+        {
+	    end_scope();
+	}
+#line 3487 "y.tab.c"
+    break;
+
+  case 148: /* simple_primary_expression: $@19 '{' assignments_with_expression $@20 '}'  */
+#line 1150 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[-2].data);
+	}
+#line 3495 "y.tab.c"
+    break;
+
+  case 149: /* simple_primary_expression: standalone_police_or_bucket_expression  */
+#line 1154 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3503 "y.tab.c"
+    break;
+
+  case 150: /* opt_sprintf_args: %empty  */
+#line 1160 "tcng.y"
+        {
+	    (yyval.list) = NULL;
+	}
+#line 3511 "y.tab.c"
+    break;
+
+  case 151: /* opt_sprintf_args: ',' expression opt_sprintf_args  */
+#line 1164 "tcng.y"
+        {
+	    DATA *d = alloc_t(DATA);
+
+	    *d = (yyvsp[-1].data);
+	    (yyval.list) = data_list_element(d);
+	    (yyval.list)->next = (yyvsp[0].list);
+	}
+#line 3523 "y.tab.c"
+    break;
+
+  case 152: /* assignments_with_expression: complex_expression  */
+#line 1175 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3531 "y.tab.c"
+    break;
+
+  case 153: /* assignments_with_expression: variable_assignment assignments_with_expression  */
+#line 1179 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3539 "y.tab.c"
+    break;
+
+  case 154: /* assignments_with_expression: field assignments_with_expression  */
+#line 1183 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 3547 "y.tab.c"
+    break;
+
+  case 155: /* primary_policing_expression: TOK_CONFORM police_expression_with_parentheses  */
+#line 1190 "tcng.y"
+        {
+	    (yyval.data) = op_unary(&op_conform,(yyvsp[0].data));
+	}
+#line 3555 "y.tab.c"
+    break;
+
+  case 156: /* primary_policing_expression: TOK_COUNT police_expression_with_parentheses  */
+#line 1194 "tcng.y"
+        {
+	    (yyval.data) = op_unary(&op_count,(yyvsp[0].data));
+	}
+#line 3563 "y.tab.c"
+    break;
+
+  case 157: /* primary_policing_expression: TOK_DROP  */
+#line 1198 "tcng.y"
+        {
+	    (yyval.data) = data_decision(dr_drop,NULL);
+	}
+#line 3571 "y.tab.c"
+    break;
+
+  case 158: /* primary_policing_expression: TOK_RECLASSIFY  */
+#line 1202 "tcng.y"
+        {
+	    (yyval.data) = data_decision(dr_reclassify,NULL);
+	}
+#line 3579 "y.tab.c"
+    break;
+
+  case 159: /* primary_policing_expression: TOK_PASS  */
+#line 1206 "tcng.y"
+        {
+	    static int warn = 1;
+
+	    if (warn) {
+		yywarnf("direct use of \"pass\" is discouraged");
+		warn = 0;
+	    }
+	    (yyval.data) = data_decision(dr_class,NULL);
+	}
+#line 3593 "y.tab.c"
+    break;
+
+  case 160: /* primary_policing_expression: TOK_CONTINUE  */
+#line 1216 "tcng.y"
+        {
+	    static int warn = 1;
+
+	    if (warn) {
+		yywarnf("direct use of \"continue\" is discouraged");
+		warn = 0;
+	    }
+	    (yyval.data) = data_decision(dr_continue,NULL);
+	}
+#line 3607 "y.tab.c"
+    break;
+
+  case 161: /* variable_expression: variable  */
+#line 1229 "tcng.y"
+        {
+	    (yyval.data) = data_clone(var_get());
+	}
+#line 3615 "y.tab.c"
+    break;
+
+  case 162: /* variable: VARIABLE  */
+#line 1236 "tcng.y"
+        {
+	    var_begin_access(var_find((yyvsp[0].str)));
+	    free((yyvsp[0].str));
+	}
+#line 3624 "y.tab.c"
+    break;
+
+  case 163: /* variable: variable '.' WORD  */
+#line 1241 "tcng.y"
+        {
+	    var_follow((yyvsp[0].str));
+	    free((yyvsp[0].str));
+	}
+#line 3633 "y.tab.c"
+    break;
+
+  case 164: /* access_expression: FIELD_NAME opt_index_expression opt_size_qualifier  */
+#line 1249 "tcng.y"
+        {
+	    (yyval.data) = op_ternary(&op_access,data_field((yyvsp[-2].field)),(yyvsp[-1].data),
+	      data_unum((yyvsp[0].unum) > 0 ? (yyvsp[0].unum) : -(yyvsp[0].unum)));
+	    (yyval.data).type = (yyvsp[-2].field)->access.type;
+	    if ((yyvsp[0].unum) == -32) (yyval.data).type = dt_ipv4;
+	    else if ((yyvsp[0].unum) == -128) (yyval.data).type = dt_ipv6;
+	    else if ((yyvsp[0].unum)) (yyval.data).type = dt_unum;
+	}
+#line 3646 "y.tab.c"
+    break;
+
+  case 165: /* access_expression: TOK_FIELD_ROOT '(' expression ')' opt_index_expression opt_size_qualifier  */
+#line 1258 "tcng.y"
+        {
+	    int offset_group;
+
+	    offset_group = data_convert((yyvsp[-3].data),dt_unum).u.unum;
+	    if (offset_group < RESERVED_OFFSET_GROUPS)
+		yyerrorf("field root numbers < %d are reserved for internal "
+		  "use",RESERVED_OFFSET_GROUPS);
+	    (yyval.data) = op_ternary(&op_access,
+              data_field_root(field_root(offset_group)),
+	      (yyvsp[-1].data),data_unum((yyvsp[0].unum) > 0 ? (yyvsp[0].unum) : -(yyvsp[0].unum)));
+	    if ((yyvsp[0].unum) == -32) (yyval.data).type = dt_ipv4;
+	    else if ((yyvsp[0].unum) == -128) (yyval.data).type = dt_ipv6;
+	}
+#line 3664 "y.tab.c"
+    break;
+
+  case 166: /* opt_size_qualifier: %empty  */
+#line 1274 "tcng.y"
+        {
+	    (yyval.unum) = 0;
+	}
+#line 3672 "y.tab.c"
+    break;
+
+  case 167: /* opt_size_qualifier: '.' UNUM  */
+#line 1278 "tcng.y"
+        {
+	    if ((yyvsp[0].unum) != 8 && (yyvsp[0].unum) != 16 && (yyvsp[0].unum) != 32)
+		yyerrorf("size must be 8, 16, or 32, not %d",(yyvsp[0].unum));
+	    (yyval.unum) = (yyvsp[0].unum);
+	}
+#line 3682 "y.tab.c"
+    break;
+
+  case 168: /* opt_size_qualifier: '.' WORD  */
+#line 1284 "tcng.y"
+        {
+	    if (!strcmp((yyvsp[0].str),"b")) (yyval.unum) = 8;
+	    else if (!strcmp((yyvsp[0].str),"ns")) (yyval.unum) = 16;
+	    else if (!strcmp((yyvsp[0].str),"nl")) (yyval.unum) = 32;
+	    else if (!strcmp((yyvsp[0].str),"ipv4")) (yyval.unum) = -32;
+	    else if (!strcmp((yyvsp[0].str),"ipv6")) (yyval.unum) = -128;
+	    else if (!strcmp((yyvsp[0].str),"hs") || !strcmp((yyvsp[0].str),"hl"))
+		yyerror("host byte order access not supported");
+	    else yyerrorf("unknown size qualifier \"%s\"",(yyvsp[0].str));
+	    free((yyvsp[0].str));
+	}
+#line 3698 "y.tab.c"
+    break;
+
+  case 169: /* opt_index_expression: %empty  */
+#line 1298 "tcng.y"
+        {
+	    (yyval.data) = data_none();
+	}
+#line 3706 "y.tab.c"
+    break;
+
+  case 170: /* opt_index_expression: '[' expression ']'  */
+#line 1302 "tcng.y"
+        {
+	    (yyval.data) = (yyvsp[-1].data);
+	}
+#line 3714 "y.tab.c"
+    break;
+
+  case 171: /* @21: %empty  */
+#line 1313 "tcng.y"
+        {
+	    if (!parent.device) yyerror("qdisc without device");
+	    (yyval.qdisc) = alloc_t(QDISC);
+	    (yyval.qdisc)->parent = parent;
+	    (yyval.qdisc)->dsc = (yyvsp[0].qddsc);
+	    (yyval.qdisc)->number = UNDEF_U32;
+	    (yyval.qdisc)->location = current_location();
+	    (yyval.qdisc)->classes = NULL;
+	    (yyval.qdisc)->filters = NULL;
+	    (yyval.qdisc)->if_expr = data_none();
+	    parent.qdisc = (yyval.qdisc);
+	    parent.class = NULL;
+	    parent.filter = NULL;
+	    param_def = (yyvsp[0].qddsc)->qdisc_param;
+	    number_anchor = (yyvsp[0].qddsc) != &ingress_dsc ? &(yyval.qdisc)->number : NULL;
+	    tag_anchor = &(yyval.qdisc)->location.tag;
+	    begin_scope(data_qdisc((yyval.qdisc)));
+	}
+#line 3737 "y.tab.c"
+    break;
+
+  case 172: /* @22: %empty  */
+#line 1332 "tcng.y"
+        {
+	    (yyval.qdisc) = (yyvsp[-1].qdisc);
+	    (yyval.qdisc)->params = (yyvsp[0].param);
+	    check_required((yyvsp[0].param),(yyval.qdisc)->dsc->qdisc_param->required,
+	      current_location());
+	}
+#line 3748 "y.tab.c"
+    break;
+
+  case 173: /* qdisc_spec: qdisc_name @21 opt_parameters @22 opt_qdisc_or_class_body  */
+#line 1339 "tcng.y"
+        {
+	    /* end_scope is called in opt_qdisc_or_class_body */
+	    (yyval.qdisc) = (yyvsp[-3].qdisc);
+	    parent = (yyval.qdisc)->parent;
+	}
+#line 3758 "y.tab.c"
+    break;
+
+  case 174: /* qdisc_name: TOK_INGRESS  */
+#line 1348 "tcng.y"
+        {
+	    (yyval.qddsc) = &ingress_dsc;
+	}
+#line 3766 "y.tab.c"
+    break;
+
+  case 175: /* qdisc_name: TOK_CBQ  */
+#line 1352 "tcng.y"
+        {
+	    (yyval.qddsc) = &cbq_dsc;
+	}
+#line 3774 "y.tab.c"
+    break;
+
+  case 176: /* qdisc_name: TOK_DSMARK  */
+#line 1356 "tcng.y"
+        {
+	    (yyval.qddsc) = &dsmark_dsc;
+	}
+#line 3782 "y.tab.c"
+    break;
+
+  case 177: /* qdisc_name: TOK_EGRESS  */
+#line 1360 "tcng.y"
+        {
+	    (yyval.qddsc) = &egress_dsc;
+	}
+#line 3790 "y.tab.c"
+    break;
+
+  case 178: /* qdisc_name: TOK_FIFO  */
+#line 1364 "tcng.y"
+        {
+	    (yyval.qddsc) = &fifo_dsc;
+	}
+#line 3798 "y.tab.c"
+    break;
+
+  case 179: /* qdisc_name: TOK_GRED  */
+#line 1368 "tcng.y"
+        {
+	    (yyval.qddsc) = &gred_dsc;
+	}
+#line 3806 "y.tab.c"
+    break;
+
+  case 180: /* qdisc_name: TOK_HTB  */
+#line 1372 "tcng.y"
+        {
+	    (yyval.qddsc) = &htb_dsc;
+	}
+#line 3814 "y.tab.c"
+    break;
+
+  case 181: /* qdisc_name: TOK_PRIO  */
+#line 1376 "tcng.y"
+        {
+	    (yyval.qddsc) = &prio_dsc;
+	}
+#line 3822 "y.tab.c"
+    break;
+
+  case 182: /* qdisc_name: TOK_RED  */
+#line 1380 "tcng.y"
+        {
+	    (yyval.qddsc) = &red_dsc;
+	}
+#line 3830 "y.tab.c"
+    break;
+
+  case 183: /* qdisc_name: TOK_SFQ  */
+#line 1384 "tcng.y"
+        {
+	    (yyval.qddsc) = &sfq_dsc;
+	}
+#line 3838 "y.tab.c"
+    break;
+
+  case 184: /* qdisc_name: TOK_TBF  */
+#line 1388 "tcng.y"
+        {
+	    (yyval.qddsc) = &tbf_dsc;
+	}
+#line 3846 "y.tab.c"
+    break;
+
+  case 185: /* opt_qdisc_or_class_body: semicolon  */
+#line 1395 "tcng.y"
+        {
+	    end_scope();
+	    (yyval.qdisc) = NULL;
+	}
+#line 3855 "y.tab.c"
+    break;
+
+  case 186: /* $@23: %empty  */
+#line 1400 "tcng.y"
+        {
+	    end_scope();
+	}
+#line 3863 "y.tab.c"
+    break;
+
+  case 187: /* opt_qdisc_or_class_body: '{' extra_semicolons qdisc_or_class_body $@23 '}' extra_semicolons  */
+#line 1404 "tcng.y"
+        {
+	    (yyval.qdisc) = (yyvsp[-3].qdisc);
+	}
+#line 3871 "y.tab.c"
+    break;
+
+  case 188: /* qdisc_or_class_body: %empty  */
+#line 1410 "tcng.y"
+        {
+	    (yyval.qdisc) = NULL;
+	}
+#line 3879 "y.tab.c"
+    break;
+
+  case 189: /* qdisc_or_class_body: qdisc_or_class_body qdisc_or_class_body_element  */
+#line 1414 "tcng.y"
+        {
+	    /* qdiscs are only returned in class body */
+	    if ((yyvsp[-1].qdisc) && (yyvsp[0].qdisc))
+		lerror((yyvsp[0].qdisc)->location,"only one qdisc allowed in class body");
+	    (yyval.qdisc) = (yyvsp[-1].qdisc) ? (yyvsp[-1].qdisc) : (yyvsp[0].qdisc);
+	}
+#line 3890 "y.tab.c"
+    break;
+
+  case 190: /* qdisc_or_class_body_element: assignment  */
+#line 1424 "tcng.y"
+        {
+	    (yyval.qdisc) = NULL;
+	}
+#line 3898 "y.tab.c"
+    break;
+
+  case 191: /* qdisc_or_class_body_element: filter_expression  */
+#line 1428 "tcng.y"
+        {
+	    /* ignore value */
+	    (yyval.qdisc) = NULL;
+	}
+#line 3907 "y.tab.c"
+    break;
+
+  case 192: /* qdisc_or_class_body_element: class_expression  */
+#line 1433 "tcng.y"
+        {
+	    /* ignore value */
+	    (yyval.qdisc) = NULL;
+	}
+#line 3916 "y.tab.c"
+    break;
+
+  case 193: /* qdisc_or_class_body_element: drop_expression  */
+#line 1438 "tcng.y"
+        {
+	    (yyval.qdisc) = NULL;
+	}
+#line 3924 "y.tab.c"
+    break;
+
+  case 194: /* @24: %empty  */
+#line 1441 "tcng.y"
+        {
+	    (yyval.class) = parent.class;
+	    if (!parent.class) begin_class(1);
+	}
+#line 3933 "y.tab.c"
+    break;
+
+  case 195: /* qdisc_or_class_body_element: @24 qdisc_expression  */
+#line 1446 "tcng.y"
+        {
+	    if ((yyvsp[-1].class)) (yyval.qdisc) = (yyvsp[0].data).u.qdisc;
+	    else {
+		end_scope(); /* end_class does not end its scope */
+		end_class(NULL,(yyvsp[0].data).u.qdisc);
+		(yyval.qdisc) = NULL;
+	    }
+	}
+#line 3946 "y.tab.c"
+    break;
+
+  case 196: /* $@25: %empty  */
+#line 1454 "tcng.y"
+        {
+	    begin_scope(data_none());
+	}
+#line 3954 "y.tab.c"
+    break;
+
+  case 197: /* $@26: %empty  */
+#line 1458 "tcng.y"
+        {
+	    end_scope();
+	}
+#line 3962 "y.tab.c"
+    break;
+
+  case 198: /* qdisc_or_class_body_element: $@25 '{' extra_semicolons qdisc_or_class_body $@26 '}' extra_semicolons  */
+#line 1462 "tcng.y"
+        {
+	    (yyval.qdisc) = (yyvsp[-3].qdisc);
+	}
+#line 3970 "y.tab.c"
+    break;
+
+  case 199: /* opt_parameters: %empty  */
+#line 1472 "tcng.y"
+        {
+	    (yyval.param) = NULL;
+	}
+#line 3978 "y.tab.c"
+    break;
+
+  case 200: /* opt_parameters: parameters  */
+#line 1476 "tcng.y"
+        {
+	    (yyval.param) = (yyvsp[0].param);
+	}
+#line 3986 "y.tab.c"
+    break;
+
+  case 201: /* parameters: '(' parameter_list ')'  */
+#line 1483 "tcng.y"
+        {
+	    const PARAM *walk,*scan;
+
+	    for (walk = (yyvsp[-1].param); walk; walk = walk->next)
+		for (scan = walk->next; scan; scan = scan->next)
+		    if (walk->dsc == scan->dsc)
+			yyerrorf("duplicate parameter \"%s\"",walk->dsc->id);
+	    (yyval.param) = (yyvsp[-1].param);
+	}
+#line 4000 "y.tab.c"
+    break;
+
+  case 202: /* parameter_list: %empty  */
+#line 1495 "tcng.y"
+        {
+	    (yyval.param) = NULL;
+	}
+#line 4008 "y.tab.c"
+    break;
+
+  case 203: /* parameter_list: parameter  */
+#line 1499 "tcng.y"
+        {
+	    (yyval.param) = (yyvsp[0].param);
+	}
+#line 4016 "y.tab.c"
+    break;
+
+  case 204: /* parameter_list: parameter ',' parameter_list  */
+#line 1503 "tcng.y"
+        {
+	    if ((yyvsp[-2].param)) {
+		(yyval.param) = (yyvsp[-2].param);
+		(yyval.param)->next = (yyvsp[0].param);
+	    }
+	    else {
+		(yyval.param) = (yyvsp[0].param);
+	    }
+	}
+#line 4030 "y.tab.c"
+    break;
+
+  case 205: /* parameter: parameter_expression  */
+#line 1516 "tcng.y"
+        {
+	    (yyval.param) = (yyvsp[0].param);
+	    if ((yyval.param))
+		check_optional((yyval.param),param_def->required,param_def->optional,
+		  current_location());
+	}
+#line 4041 "y.tab.c"
+    break;
+
+  case 206: /* parameter_expression: constant_expression  */
+#line 1526 "tcng.y"
+        {
+	    if ((yyvsp[0].data).type == dt_string) add_tag((yyvsp[0].data).u.string);
+	    else {
+		if (!number_anchor) yyerror("number/handle not valid here");
+		if (*number_anchor != UNDEF_U32)
+		    yyerror("number/handle already set");
+		*number_anchor = data_convert((yyvsp[0].data),dt_unum).u.unum;
+	    }
+	    (yyval.param) = NULL;
+	}
+#line 4056 "y.tab.c"
+    break;
+
+  case 207: /* $@27: %empty  */
+#line 1537 "tcng.y"
+        {
+	    var_outer_scope();
+	}
+#line 4064 "y.tab.c"
+    break;
+
+  case 208: /* $@28: %empty  */
+#line 1541 "tcng.y"
+        {
+	    var_inner_scope(); /* undo effect of var_outer_scope */
+	}
+#line 4072 "y.tab.c"
+    break;
+
+  case 209: /* parameter_expression: '<' $@27 forward_class_list $@28 '>'  */
+#line 1545 "tcng.y"
+        {
+	    if (!(parent.qdisc->dsc->flags & QDISC_CLASS_SEL_PATHS))
+		yyerrorf("%s does not support class selection paths",
+		  parent.qdisc->dsc->name);
+	    (yyval.param) = param_make(&prm_class_sel_path,data_list((yyvsp[-2].list)));
+	}
+#line 4083 "y.tab.c"
+    break;
+
+  case 210: /* parameter_expression: TOK_TAG constant_expression  */
+#line 1552 "tcng.y"
+        {
+	    add_tag(data_convert((yyvsp[0].data),dt_string).u.string);
+	    (yyval.param) = NULL;
+	}
+#line 4092 "y.tab.c"
+    break;
+
+  case 211: /* parameter_expression: TOK_AH constant_expression  */
+#line 1557 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_ah,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4101 "y.tab.c"
+    break;
+
+  case 212: /* parameter_expression: TOK_ALLOT constant_expression  */
+#line 1562 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_allot,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4110 "y.tab.c"
+    break;
+
+  case 213: /* parameter_expression: TOK_AVPKT constant_expression  */
+#line 1567 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_avpkt,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4119 "y.tab.c"
+    break;
+
+  case 214: /* parameter_expression: TOK_BANDS constant_expression  */
+#line 1572 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_bands,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"%lu",TCQ_PRIO_MIN_BANDS,TCQ_PRIO_BANDS);
+	}
+#line 4128 "y.tab.c"
+    break;
+
+  case 215: /* parameter_expression: TOK_BANDWIDTH constant_expression  */
+#line 1577 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_bandwidth,(yyvsp[0].data));
+	}
+#line 4136 "y.tab.c"
+    break;
+
+  case 216: /* parameter_expression: TOK_BOUNDED  */
+#line 1581 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_bounded,data_unum(1));
+	}
+#line 4144 "y.tab.c"
+    break;
+
+  case 217: /* parameter_expression: TOK_BURST constant_expression  */
+#line 1585 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_burst,(yyvsp[0].data));
+	    /* check against expected psched_mtu */
+	}
+#line 4153 "y.tab.c"
+    break;
+
+  case 218: /* parameter_expression: TOK_CBURST constant_expression  */
+#line 1590 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_cburst,(yyvsp[0].data));
+	}
+#line 4161 "y.tab.c"
+    break;
+
+  case 219: /* parameter_expression: TOK_CEIL constant_expression  */
+#line 1594 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_ceil,(yyvsp[0].data));
+	}
+#line 4169 "y.tab.c"
+    break;
+
+  case 220: /* parameter_expression: TOK_DEFAULT  */
+#line 1598 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_default,data_unum(1));
+	}
+#line 4177 "y.tab.c"
+    break;
+
+  case 221: /* parameter_expression: TOK_DEFAULT_INDEX constant_expression  */
+#line 1602 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_default_index,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"0x%lx",0,0xffff);
+	}
+#line 4186 "y.tab.c"
+    break;
+
+  case 222: /* parameter_expression: TOK_DPORT port  */
+#line 1607 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_dport,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"%lu",1,0xffff);
+	}
+#line 4195 "y.tab.c"
+    break;
+
+  case 223: /* parameter_expression: TOK_DST host  */
+#line 1612 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_dst,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4204 "y.tab.c"
+    break;
+
+  case 224: /* parameter_expression: TOK_ECN  */
+#line 1617 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_ecn,data_unum(1));
+	}
+#line 4212 "y.tab.c"
+    break;
+
+  case 225: /* parameter_expression: TOK_ESP constant_expression  */
+#line 1621 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_esp,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4221 "y.tab.c"
+    break;
+
+  case 226: /* parameter_expression: TOK_EWMA constant_expression  */
+#line 1626 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_ewma,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"%lu",1,TC_CBQ_MAX_EWMA);
+	}
+#line 4230 "y.tab.c"
+    break;
+
+  case 227: /* parameter_expression: TOK_FALL_THROUGH  */
+#line 1631 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_fall_through,data_unum(1));
+	}
+#line 4238 "y.tab.c"
+    break;
+
+  case 228: /* parameter_expression: TOK_FROM constant_expression  */
+#line 1635 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_from,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"0x%lx",0,0xff);
+	}
+#line 4247 "y.tab.c"
+    break;
+
+  case 229: /* parameter_expression: TOK_FROMIF constant_expression  */
+#line 1640 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_fromif,(yyvsp[0].data));
+	    /* @@@ tcng should check if interface exists */
+	}
+#line 4256 "y.tab.c"
+    break;
+
+  case 230: /* parameter_expression: TOK_GRIO  */
+#line 1645 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_grio,data_unum(1));
+	}
+#line 4264 "y.tab.c"
+    break;
+
+  case 231: /* parameter_expression: TOK_HASH constant_expression  */
+#line 1649 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_hash,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"%lu",1,0x10000);
+	}
+#line 4273 "y.tab.c"
+    break;
+
+  case 232: /* parameter_expression: TOK_INDICES constant_expression  */
+#line 1654 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_indices,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"0x%lx",1,0x10000);
+	    /* 2^n checked in qdisc.c */
+	}
+#line 4283 "y.tab.c"
+    break;
+
+  case 233: /* parameter_expression: TOK_IPPROTO ipproto  */
+#line 1660 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_ipproto,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"%lu",0,0xff);
+	}
+#line 4292 "y.tab.c"
+    break;
+
+  case 234: /* parameter_expression: TOK_ISOLATED  */
+#line 1665 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_isolated,data_unum(1));
+	}
+#line 4300 "y.tab.c"
+    break;
+
+  case 235: /* parameter_expression: TOK_LIMIT constant_expression  */
+#line 1669 "tcng.y"
+        {
+	    if ((yyvsp[0].data).type == dt_psize) (yyval.param) = param_make(&prm_plimit,(yyvsp[0].data));
+	    else (yyval.param) = param_make(&prm_limit,(yyvsp[0].data));
+	}
+#line 4309 "y.tab.c"
+    break;
+
+  case 236: /* parameter_expression: TOK_MASK constant_expression  */
+#line 1674 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_mask,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"0x%lx",0,0xffff);
+	    /* DSMARK: 0..0xff, checked in qdisc.c */
+	}
+#line 4319 "y.tab.c"
+    break;
+
+  case 237: /* parameter_expression: TOK_MAX constant_expression  */
+#line 1680 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_max,(yyvsp[0].data));
+	}
+#line 4327 "y.tab.c"
+    break;
+
+  case 238: /* parameter_expression: TOK_MAXBURST constant_expression  */
+#line 1684 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_maxburst,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4336 "y.tab.c"
+    break;
+
+  case 239: /* parameter_expression: TOK_MIN constant_expression  */
+#line 1689 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_min,(yyvsp[0].data));
+	}
+#line 4344 "y.tab.c"
+    break;
+
+  case 240: /* parameter_expression: TOK_MINBURST constant_expression  */
+#line 1693 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_minburst,(yyvsp[0].data));
+	}
+#line 4352 "y.tab.c"
+    break;
+
+  case 241: /* parameter_expression: TOK_MPU constant_expression  */
+#line 1697 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_mpu,(yyvsp[0].data));
+	}
+#line 4360 "y.tab.c"
+    break;
+
+  case 242: /* parameter_expression: TOK_MTU constant_expression  */
+#line 1701 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_mtu,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4369 "y.tab.c"
+    break;
+
+  case 243: /* parameter_expression: TOK_ORDER constant_expression  */
+#line 1706 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_order,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"0x%lx",0,0xff);
+	}
+#line 4378 "y.tab.c"
+    break;
+
+  case 244: /* parameter_expression: TOK_OVERFLOW police_expression_with_parentheses  */
+#line 1711 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_overflow,(yyvsp[0].data));
+	}
+#line 4386 "y.tab.c"
+    break;
+
+  case 245: /* parameter_expression: TOK_PASS_ON  */
+#line 1715 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_fall_through,data_unum(0));
+	}
+#line 4394 "y.tab.c"
+    break;
+
+  case 246: /* parameter_expression: TOK_PEAKRATE constant_expression  */
+#line 1719 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_peakrate,(yyvsp[0].data));
+	}
+#line 4402 "y.tab.c"
+    break;
+
+  case 247: /* parameter_expression: TOK_PERTURB constant_expression  */
+#line 1723 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_perturb,(yyvsp[0].data));
+	}
+#line 4410 "y.tab.c"
+    break;
+
+  case 248: /* parameter_expression: TOK_PRAGMA pragma_list  */
+#line 1727 "tcng.y"
+        {
+	    (yyval.param) = (yyvsp[0].list) ? (yyval.param) = param_make(&prm_pragma,data_list((yyvsp[0].list))) : NULL;
+	}
+#line 4418 "y.tab.c"
+    break;
+
+  case 249: /* parameter_expression: TOK_PRIO constant_expression  */
+#line 1731 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_prio,(yyvsp[0].data));
+	}
+#line 4426 "y.tab.c"
+    break;
+
+  case 250: /* parameter_expression: TOK_PRIOMAP forward_class_list  */
+#line 1735 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_priomap,data_list((yyvsp[0].list)));
+	}
+#line 4434 "y.tab.c"
+    break;
+
+  case 251: /* parameter_expression: TOK_PROBABILITY constant_expression  */
+#line 1739 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_probability,(yyvsp[0].data));
+	}
+#line 4442 "y.tab.c"
+    break;
+
+  case 252: /* parameter_expression: TOK_PROTOCOL ether_proto  */
+#line 1743 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_protocol,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"0x%lx",0,0xffff);
+	}
+#line 4451 "y.tab.c"
+    break;
+
+  case 253: /* parameter_expression: TOK_QUANTUM constant_expression  */
+#line 1748 "tcng.y"
+        {
+	    if ((yyvsp[0].data).type == dt_size) (yyval.param) = param_make(&prm_quantum,(yyvsp[0].data));
+	    else (yyval.param) = param_make(&prm_tquantum,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4461 "y.tab.c"
+    break;
+
+  case 254: /* parameter_expression: TOK_R2Q constant_expression  */
+#line 1754 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_r2q,(yyvsp[0].data));
+	}
+#line 4469 "y.tab.c"
+    break;
+
+  case 255: /* parameter_expression: TOK_RATE constant_expression  */
+#line 1758 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_rate,(yyvsp[0].data));
+	    /* NONZERO($$); @@@ policer may have zero rate */
+	}
+#line 4478 "y.tab.c"
+    break;
+
+  case 256: /* parameter_expression: TOK_SET_TC_INDEX  */
+#line 1763 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_set_tc_index,data_unum(1));
+	}
+#line 4486 "y.tab.c"
+    break;
+
+  case 257: /* parameter_expression: TOK_SHIFT constant_expression  */
+#line 1767 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_shift,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"%lu",0,15);
+	}
+#line 4495 "y.tab.c"
+    break;
+
+  case 258: /* parameter_expression: TOK_SKIP constant_expression  */
+#line 1772 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_skip,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4504 "y.tab.c"
+    break;
+
+  case 259: /* parameter_expression: TOK_SPORT port  */
+#line 1777 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_sport,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"%lu",1,0xffff);
+	}
+#line 4513 "y.tab.c"
+    break;
+
+  case 260: /* parameter_expression: TOK_SRC host  */
+#line 1782 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_src,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4522 "y.tab.c"
+    break;
+
+  case 261: /* parameter_expression: TOK_TO constant_expression  */
+#line 1787 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_to,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"0x%lx",0,0xff);
+	}
+#line 4531 "y.tab.c"
+    break;
+
+  case 262: /* parameter_expression: TOK_VALUE constant_expression  */
+#line 1792 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_value,(yyvsp[0].data));
+	    UNUM_RANGE((yyval.param),"0x%lx",0,0xff);
+	}
+#line 4540 "y.tab.c"
+    break;
+
+  case 263: /* parameter_expression: TOK_WEIGHT constant_expression  */
+#line 1797 "tcng.y"
+        {
+	    (yyval.param) = param_make(&prm_weight,(yyvsp[0].data));
+	    NONZERO((yyval.param));
+	}
+#line 4549 "y.tab.c"
+    break;
+
+  case 264: /* host: constant_expression  */
+#line 1805 "tcng.y"
+        {
+	    if ((yyvsp[0].data).type == dt_string) (yyval.data) = data_unum(ipv4_host((yyvsp[0].data).u.string,1));
+	    else (yyval.data) = (yyvsp[0].data);
+	}
+#line 4558 "y.tab.c"
+    break;
+
+  case 265: /* primary_host: primary_host4  */
+#line 1813 "tcng.y"
+        {
+	    /*
+	     * Note: "host" must _not_ try to "guess" the address type, because
+	     * an IPv4 address is used in a completely different way than an
+	     * IPv6 address.
+	     */
+	    (yyval.data) = (yyvsp[0].data);
+	}
+#line 4571 "y.tab.c"
+    break;
+
+  case 266: /* primary_host4: primary_expression  */
+#line 1825 "tcng.y"
+        {
+	    if ((yyvsp[0].data).type == dt_string) (yyval.data) = data_ipv4(ipv4_host((yyvsp[0].data).u.string,1));
+	    else (yyval.data) = data_convert((yyvsp[0].data),dt_ipv4);
+	}
+#line 4580 "y.tab.c"
+    break;
+
+  case 267: /* primary_host6: primary_expression  */
+#line 1833 "tcng.y"
+        {
+	    if ((yyvsp[0].data).type == dt_string) (yyval.data) = data_ipv6(ipv6_host((yyvsp[0].data).u.string,1));
+	    else (yyval.data) = data_convert((yyvsp[0].data),dt_ipv6);
+	}
+#line 4589 "y.tab.c"
+    break;
+
+  case 268: /* port: constant_expression  */
+#line 1841 "tcng.y"
+        {
+	    if ((yyvsp[0].data).type == dt_string) (yyval.data) = data_unum(ip_port((yyvsp[0].data).u.string));
+	    else (yyval.data) = (yyvsp[0].data);
+	}
+#line 4598 "y.tab.c"
+    break;
+
+  case 269: /* ipproto: constant_expression  */
+#line 1849 "tcng.y"
+        {
+	    if ((yyvsp[0].data).type == dt_string) (yyval.data) = data_unum(ip_proto((yyvsp[0].data).u.string));
+	    else (yyval.data) = (yyvsp[0].data);
+	}
+#line 4607 "y.tab.c"
+    break;
+
+  case 270: /* ether_proto: constant_expression  */
+#line 1857 "tcng.y"
+        {
+	    if ((yyvsp[0].data).type == dt_string) (yyval.data) = data_unum(ether_proto((yyvsp[0].data).u.string));
+	    else (yyval.data) = (yyvsp[0].data);
+	}
+#line 4616 "y.tab.c"
+    break;
+
+  case 271: /* forward_class_list: %empty  */
+#line 1877 "tcng.y"
+        {
+	    (yyval.list) = NULL;
+	}
+#line 4624 "y.tab.c"
+    break;
+
+  case 272: /* @29: %empty  */
+#line 1881 "tcng.y"
+        {
+	    (yyval.list) = data_list_element(var_forward());
+	}
+#line 4632 "y.tab.c"
+    break;
+
+  case 273: /* forward_class_list: variable @29 forward_class_list  */
+#line 1885 "tcng.y"
+        {
+	    (yyval.list) = (yyvsp[-1].list);
+	    (yyval.list)->next = (yyvsp[0].list);
+	}
+#line 4641 "y.tab.c"
+    break;
+
+  case 274: /* pragma_list: %empty  */
+#line 1892 "tcng.y"
+        {
+	    (yyval.list) = NULL;
+	}
+#line 4649 "y.tab.c"
+    break;
+
+  case 275: /* pragma_list: simple_primary_expression pragma_list  */
+#line 1896 "tcng.y"
+        {
+	    const char *s;
+	    DATA *d;
+
+	    (yyvsp[-1].data) = data_convert((yyvsp[-1].data),dt_string);
+	    if (!*(yyvsp[-1].data).u.string) (yyval.list) = (yyvsp[0].list);
+	    else {
+		for (s = (yyvsp[-1].data).u.string; *s; s++)
+		    if (*s <= ' ' || *s > '~')
+			yyerror("invalid character in pragma");
+		d = alloc_t(DATA);
+		*d = (yyvsp[-1].data);
+		(yyval.list) = data_list_element(d);
+		(yyval.list)->next = (yyvsp[0].list);
+	    }
+	}
+#line 4670 "y.tab.c"
+    break;
+
+  case 276: /* @30: %empty  */
+#line 1920 "tcng.y"
+        {
+	    (yyval.class) = begin_class(0);
+	}
+#line 4678 "y.tab.c"
+    break;
+
+  case 277: /* class_spec: TOK_CLASS @30 opt_parameters opt_selectors opt_qdisc_or_class_body  */
+#line 1924 "tcng.y"
+        {
+	    (yyval.class) = (yyvsp[-3].class);
+	    end_class((yyvsp[-2].param),(yyvsp[0].qdisc));
+	}
+#line 4687 "y.tab.c"
+    break;
+
+  case 278: /* @31: %empty  */
+#line 1933 "tcng.y"
+        {
+	    (yyval.class) = parent.class;
+	    parent.class = &class_is_drop;
+	}
+#line 4696 "y.tab.c"
+    break;
+
+  case 279: /* $@32: %empty  */
+#line 1938 "tcng.y"
+        {
+	    parent.class = (yyvsp[-1].class);
+	}
+#line 4704 "y.tab.c"
+    break;
+
+  case 281: /* opt_selectors: %empty  */
+#line 1945 "tcng.y"
+        {
+	    if (parent.filter) yywarn("class without selector inside filter");
+	    else if (parent.class == &class_is_drop)
+		    yywarn("ignoring \"drop\" without selector");
+	}
+#line 4714 "y.tab.c"
+    break;
+
+  case 286: /* @33: %empty  */
+#line 1961 "tcng.y"
+        {
+	    (yyval.location) = current_location();
+	}
+#line 4722 "y.tab.c"
+    break;
+
+  case 287: /* selector: TOK_IF @33 opt_filter expression  */
+#line 1965 "tcng.y"
+        {
+	    DATA d = (yyvsp[0].data);
+	    ELEMENT *element;
+
+	    debug_expr("Raw IF expression",d);
+	    d = field_expand(d);
+	    debug_expr("Expanded IF expression",d);
+	    if ((yyvsp[-1].filter) && (yyvsp[-1].filter)->dsc != &if_dsc)
+		yyerrorf("if requires filter \"if\", not \"%s\"",(yyvsp[-1].filter)->dsc->name);
+	    element = add_if(d,parent,(yyvsp[-1].filter),(yyvsp[-2].location));
+	}
+#line 4738 "y.tab.c"
+    break;
+
+  case 288: /* $@34: %empty  */
+#line 1979 "tcng.y"
+        {
+	    /*
+	     * This is a little ugly. Background:
+	     *  - element gets class from parent.class
+	     *  - if filter_expression generates a filter, its parent is the
+	     *    parent of the current class.
+	     */
+	    /* @@@ make it work ? NO ! */
+	    if (parent.class == &class_is_drop) /* @@@ fix this */
+		yyerror("we currently don't support \"drop on\"");
+	    tmp_parent = parent;
+	    parent = parent.class->parent;
+	}
+#line 4756 "y.tab.c"
+    break;
+
+  case 289: /* $@35: %empty  */
+#line 1993 "tcng.y"
+        {
+	    parent = tmp_parent;
+	    parent.filter = (yyvsp[0].data).u.filter;
+	    if (parent.class == &class_is_tunnel &&
+	      parent.filter != parent.tunnel->parent.filter)
+		yyerror("can't assign tunnel to different filter");
+	    parent.tunnel = NULL;
+	}
+#line 4769 "y.tab.c"
+    break;
+
+  case 290: /* on_selector: $@34 short_filter_expression $@35 element_spec  */
+#line 2002 "tcng.y"
+        {
+	    parent = tmp_parent;
+	}
+#line 4777 "y.tab.c"
+    break;
+
+  case 291: /* $@36: %empty  */
+#line 2006 "tcng.y"
+        {
+	    if (parent.class == &class_is_drop)
+		yyerror("we currently don't support \"drop on\"");
+	    tmp_parent = parent;
+	    parent.filter = data_convert((yyvsp[0].data),dt_filter).u.filter;
+	    if (parent.filter->parent.qdisc != parent.qdisc)
+		yyerror("filter was created in different scope");
+	    if (parent.class == &class_is_tunnel &&
+	      parent.filter != parent.tunnel->parent.filter)
+		yyerror("can't assign tunnel to different filter");
+	    parent.tunnel = NULL;
+	    begin_element();
+	}
+#line 4795 "y.tab.c"
+    break;
+
+  case 292: /* on_selector: variable_expression $@36 opt_element parameters opt_police  */
+#line 2020 "tcng.y"
+        {
+	    end_element((yyvsp[-1].param),(yyvsp[0].police));
+	    parent = tmp_parent;
+	}
+#line 4804 "y.tab.c"
+    break;
+
+  case 293: /* $@37: %empty  */
+#line 2025 "tcng.y"
+        {
+	    if (parent.class == &class_is_drop)
+		yyerror("we currently don't support \"drop on\"");
+	    begin_element();
+	}
+#line 4814 "y.tab.c"
+    break;
+
+  case 294: /* on_selector: $@37 parameters opt_police  */
+#line 2031 "tcng.y"
+        {
+	    end_element((yyvsp[-1].param),(yyvsp[0].police));
+	}
+#line 4822 "y.tab.c"
+    break;
+
+  case 295: /* $@38: %empty  */
+#line 2035 "tcng.y"
+        {
+	    if (parent.class == &class_is_drop)
+		yyerror("we currently don't support \"drop on\"");
+	}
+#line 4831 "y.tab.c"
+    break;
+
+  case 297: /* opt_filter: %empty  */
+#line 2043 "tcng.y"
+        {
+	    (yyval.filter) = NULL;
+	}
+#line 4839 "y.tab.c"
+    break;
+
+  case 298: /* opt_filter: TOK_FILTER variable_expression  */
+#line 2047 "tcng.y"
+        {
+	    (yyval.filter) = data_convert((yyvsp[0].data),dt_filter).u.filter;
+	    if ((yyval.filter)->parent.qdisc != parent.qdisc)
+		yyerror("filter was created in different scope");
+	}
+#line 4849 "y.tab.c"
+    break;
+
+  case 301: /* @39: %empty  */
+#line 2064 "tcng.y"
+        {
+	    (yyval.filter) = begin_filter((yyvsp[0].fdsc));
+	}
+#line 4857 "y.tab.c"
+    break;
+
+  case 302: /* filter_spec: filter_name @39 opt_parameters opt_filter_body  */
+#line 2068 "tcng.y"
+        {
+	    (yyval.filter) = (yyvsp[-2].filter);
+	    end_filter((yyval.filter),(yyvsp[-1].param));
+	}
+#line 4866 "y.tab.c"
+    break;
+
+  case 303: /* @40: %empty  */
+#line 2076 "tcng.y"
+        {
+	    (yyval.filter) = begin_filter((yyvsp[0].fdsc));
+	}
+#line 4874 "y.tab.c"
+    break;
+
+  case 304: /* short_filter_spec: filter_name @40 opt_parameters  */
+#line 2080 "tcng.y"
+        {
+	    (yyval.filter) = (yyvsp[-1].filter);
+	    end_filter((yyval.filter),(yyvsp[0].param));
+	}
+#line 4883 "y.tab.c"
+    break;
+
+  case 305: /* filter_name: TOK_FW  */
+#line 2088 "tcng.y"
+        {
+	    (yyval.fdsc) = &fw_dsc;
+	}
+#line 4891 "y.tab.c"
+    break;
+
+  case 306: /* filter_name: TOK_ROUTE  */
+#line 2092 "tcng.y"
+        {
+	    (yyval.fdsc) = &route_dsc;
+	}
+#line 4899 "y.tab.c"
+    break;
+
+  case 307: /* filter_name: TOK_RSVP  */
+#line 2096 "tcng.y"
+        {
+	    (yyval.fdsc) = &rsvp_dsc;
+	}
+#line 4907 "y.tab.c"
+    break;
+
+  case 308: /* filter_name: TOK_TCINDEX  */
+#line 2100 "tcng.y"
+        {
+	    (yyval.fdsc) = &tcindex_dsc;
+	}
+#line 4915 "y.tab.c"
+    break;
+
+  case 309: /* filter_name: TOK_IF_ANCHOR  */
+#line 2104 "tcng.y"
+        {
+	    yyerror("\"if\" anchor doesn't work yet and will be re-designed");
+	    (yyval.fdsc) = &if_dsc;
+	}
+#line 4924 "y.tab.c"
+    break;
+
+  case 315: /* filter_body_element: class_expression  */
+#line 2122 "tcng.y"
+        {
+	    /* ignore value */
+	}
+#line 4932 "y.tab.c"
+    break;
+
+  case 318: /* $@41: %empty  */
+#line 2128 "tcng.y"
+        {
+	    begin_scope(data_none());
+	}
+#line 4940 "y.tab.c"
+    break;
+
+  case 319: /* $@42: %empty  */
+#line 2132 "tcng.y"
+        {
+	    end_scope();
+	}
+#line 4948 "y.tab.c"
+    break;
+
+  case 321: /* $@43: %empty  */
+#line 2144 "tcng.y"
+        {
+	    TUNNEL *tunnel;
+
+	    tunnel = alloc_t(TUNNEL);
+	    tunnel->parent = parent;
+	    tunnel->number = UNDEF_U32;
+	    tunnel->location = current_location();
+	    parent.tunnel = tunnel;
+	    parent.class = &class_is_tunnel;
+	    param_def = &tunnel_param;
+	    number_anchor = &tunnel->number;
+	    tag_anchor = &tunnel->location.tag;
+	    begin_scope(data_tunnel(tunnel));
+	}
+#line 4967 "y.tab.c"
+    break;
+
+  case 322: /* $@44: %empty  */
+#line 2159 "tcng.y"
+        {
+	    parent.class = parent.tunnel->parent.class;
+	    parent.tunnel->params = (yyvsp[-1].param);
+	    check_required((yyvsp[-1].param),tunnel_param.required,current_location());
+	}
+#line 4977 "y.tab.c"
+    break;
+
+  case 323: /* tunnel: TOK_TUNNEL $@43 opt_parameters opt_selectors $@44 opt_filter_body  */
+#line 2165 "tcng.y"
+        {
+	    end_scope();
+	    parent = parent.tunnel->parent;
+	}
+#line 4986 "y.tab.c"
+    break;
+
+  case 324: /* $@45: %empty  */
+#line 2176 "tcng.y"
+        {
+	    begin_element();
+	}
+#line 4994 "y.tab.c"
+    break;
+
+  case 325: /* element_spec: TOK_ELEMENT $@45 opt_parameters opt_police  */
+#line 2180 "tcng.y"
+        {
+	    end_element((yyvsp[-1].param),(yyvsp[0].police));
+	}
+#line 5002 "y.tab.c"
+    break;
+
+  case 326: /* opt_police: %empty  */
+#line 2186 "tcng.y"
+        {
+	    (yyval.police) = NULL;
+	}
+#line 5010 "y.tab.c"
+    break;
+
+  case 327: /* opt_police: standalone_police_expression  */
+#line 2190 "tcng.y"
+        {
+	    (yyval.police) = (yyvsp[0].data).u.police;
+	}
+#line 5018 "y.tab.c"
+    break;
+
+  case 328: /* @46: %empty  */
+#line 2202 "tcng.y"
+        {
+	    (yyval.police) = alloc_t(POLICE);
+	    (yyval.police)->number = UNDEF_U32;
+	    (yyval.police)->location = current_location();
+	    number_anchor = &(yyval.police)->number;
+	    tag_anchor = &(yyval.police)->location.tag;
+	    param_def = &police_def;
+	}
+#line 5031 "y.tab.c"
+    break;
+
+  case 329: /* @47: %empty  */
+#line 2211 "tcng.y"
+        {
+	    (yyval.police) = (yyvsp[-1].police);
+	    (yyval.police)->params = (yyvsp[0].param);
+	    check_required((yyvsp[0].param),police_def.required,current_location());
+	}
+#line 5041 "y.tab.c"
+    break;
+
+  case 330: /* police_spec: TOK_POLICE @46 parameters @47 opt_policing_decision opt_else  */
+#line 2217 "tcng.y"
+        {
+	    (yyval.police) = (yyvsp[-4].police);
+	    (yyval.police)->out_profile = (yyvsp[-1].decis);
+	    (yyval.police)->in_profile = (yyvsp[0].decis);
+	    add_police((yyval.police));
+	}
+#line 5052 "y.tab.c"
+    break;
+
+  case 331: /* @48: %empty  */
+#line 2227 "tcng.y"
+        {
+	    (yyval.police) = alloc_t(POLICE);
+	    (yyval.police)->number = UNDEF_U32;
+	    (yyval.police)->location = current_location();
+	    number_anchor = &(yyval.police)->number;
+	    tag_anchor = &(yyval.police)->location.tag;
+	    param_def = &bucket_def;
+	}
+#line 5065 "y.tab.c"
+    break;
+
+  case 332: /* bucket_spec: TOK_BUCKET @48 parameters  */
+#line 2236 "tcng.y"
+        {
+	    (yyval.police) = (yyvsp[-1].police);
+	    (yyval.police)->params = (yyvsp[0].param);
+	    check_required((yyvsp[0].param),bucket_def.required,current_location());
+	    (yyval.police)->out_profile = pd_reclassify;
+	    (yyval.police)->in_profile = pd_ok; 
+	    add_police((yyval.police));
+	}
+#line 5078 "y.tab.c"
+    break;
+
+  case 333: /* opt_policing_decision: %empty  */
+#line 2247 "tcng.y"
+        {
+	    (yyval.decis) = pd_reclassify;
+	}
+#line 5086 "y.tab.c"
+    break;
+
+  case 334: /* opt_policing_decision: policing_decision  */
+#line 2251 "tcng.y"
+        {
+	    (yyval.decis) = (yyvsp[0].decis);
+	}
+#line 5094 "y.tab.c"
+    break;
+
+  case 335: /* opt_else: %empty  */
+#line 2257 "tcng.y"
+        {
+	    (yyval.decis) = pd_ok;
+	}
+#line 5102 "y.tab.c"
+    break;
+
+  case 336: /* opt_else: TOK_ELSE policing_decision  */
+#line 2261 "tcng.y"
+        {
+	    (yyval.decis) = (yyvsp[0].decis);
+	}
+#line 5110 "y.tab.c"
+    break;
+
+  case 337: /* policing_decision: TOK_PASS  */
+#line 2268 "tcng.y"
+        {
+	    (yyval.decis) = pd_ok;
+	}
+#line 5118 "y.tab.c"
+    break;
+
+  case 338: /* policing_decision: TOK_RECLASSIFY  */
+#line 2272 "tcng.y"
+        {
+	    (yyval.decis) = pd_reclassify;
+	}
+#line 5126 "y.tab.c"
+    break;
+
+  case 339: /* policing_decision: TOK_DROP  */
+#line 2276 "tcng.y"
+        {
+	    (yyval.decis) = pd_drop;
+	}
+#line 5134 "y.tab.c"
+    break;
+
+  case 340: /* policing_decision: TOK_CONTINUE  */
+#line 2280 "tcng.y"
+        {
+	    (yyval.decis) = pd_continue;
+	}
+#line 5142 "y.tab.c"
+    break;
+
+
+#line 5146 "y.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
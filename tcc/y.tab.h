@@ -0,0 +1,331 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    TOK_WARN = 258,                /* TOK_WARN  */
+    TOK_DEV = 259,                 /* TOK_DEV  */
+    TOK_QDISC = 260,               /* TOK_QDISC  */
+    TOK_CLASS = 261,               /* TOK_CLASS  */
+    TOK_FILTER = 262,              /* TOK_FILTER  */
+    TOK_ELEMENT = 263,             /* TOK_ELEMENT  */
+    TOK_TUNNEL = 264,              /* TOK_TUNNEL  */
+    TOK_ON = 265,                  /* TOK_ON  */
+    TOK_POLICE = 266,              /* TOK_POLICE  */
+    TOK_BUCKET = 267,              /* TOK_BUCKET  */
+    TOK_ELSE = 268,                /* TOK_ELSE  */
+    TOK_IF = 269,                  /* TOK_IF  */
+    TOK_IF_ANCHOR = 270,           /* TOK_IF_ANCHOR  */
+    TOK_HOST = 271,                /* TOK_HOST  */
+    TOK_HOST4 = 272,               /* TOK_HOST4  */
+    TOK_HOST6 = 273,               /* TOK_HOST6  */
+    TOK_SPRINTF = 274,             /* TOK_SPRINTF  */
+    TOK_PRAGMA = 275,              /* TOK_PRAGMA  */
+    TOK_PASS = 276,                /* TOK_PASS  */
+    TOK_RECLASSIFY = 277,          /* TOK_RECLASSIFY  */
+    TOK_CONTINUE = 278,            /* TOK_CONTINUE  */
+    TOK_FIELD = 279,               /* TOK_FIELD  */
+    TOK_TAG = 280,                 /* TOK_TAG  */
+    TOK_FIELD_ROOT = 281,          /* TOK_FIELD_ROOT  */
+    TOK_CONFORM = 282,             /* TOK_CONFORM  */
+    TOK_COUNT = 283,               /* TOK_COUNT  */
+    TOK_PRECOND = 284,             /* TOK_PRECOND  */
+    TOK_DROP = 285,                /* TOK_DROP  */
+    TOK_CBQ = 286,                 /* TOK_CBQ  */
+    TOK_DSMARK = 287,              /* TOK_DSMARK  */
+    TOK_FIFO = 288,                /* TOK_FIFO  */
+    TOK_GRED = 289,                /* TOK_GRED  */
+    TOK_HTB = 290,                 /* TOK_HTB  */
+    TOK_PRIO = 291,                /* TOK_PRIO  */
+    TOK_RED = 292,                 /* TOK_RED  */
+    TOK_SFQ = 293,                 /* TOK_SFQ  */
+    TOK_TBF = 294,                 /* TOK_TBF  */
+    TOK_INGRESS = 295,             /* TOK_INGRESS  */
+    TOK_EGRESS = 296,              /* TOK_EGRESS  */
+    TOK_FW = 297,                  /* TOK_FW  */
+    TOK_ROUTE = 298,               /* TOK_ROUTE  */
+    TOK_RSVP = 299,                /* TOK_RSVP  */
+    TOK_TCINDEX = 300,             /* TOK_TCINDEX  */
+    TOK_AH = 301,                  /* TOK_AH  */
+    TOK_ALLOT = 302,               /* TOK_ALLOT  */
+    TOK_AVPKT = 303,               /* TOK_AVPKT  */
+    TOK_BANDS = 304,               /* TOK_BANDS  */
+    TOK_BANDWIDTH = 305,           /* TOK_BANDWIDTH  */
+    TOK_BOUNDED = 306,             /* TOK_BOUNDED  */
+    TOK_BURST = 307,               /* TOK_BURST  */
+    TOK_CBURST = 308,              /* TOK_CBURST  */
+    TOK_CEIL = 309,                /* TOK_CEIL  */
+    TOK_DEFAULT = 310,             /* TOK_DEFAULT  */
+    TOK_DEFAULT_INDEX = 311,       /* TOK_DEFAULT_INDEX  */
+    TOK_DPORT = 312,               /* TOK_DPORT  */
+    TOK_DST = 313,                 /* TOK_DST  */
+    TOK_ECN = 314,                 /* TOK_ECN  */
+    TOK_ESP = 315,                 /* TOK_ESP  */
+    TOK_EWMA = 316,                /* TOK_EWMA  */
+    TOK_FALL_THROUGH = 317,        /* TOK_FALL_THROUGH  */
+    TOK_FROM = 318,                /* TOK_FROM  */
+    TOK_FROMIF = 319,              /* TOK_FROMIF  */
+    TOK_GRIO = 320,                /* TOK_GRIO  */
+    TOK_HASH = 321,                /* TOK_HASH  */
+    TOK_INDICES = 322,             /* TOK_INDICES  */
+    TOK_ISOLATED = 323,            /* TOK_ISOLATED  */
+    TOK_IPPROTO = 324,             /* TOK_IPPROTO  */
+    TOK_LIMIT = 325,               /* TOK_LIMIT  */
+    TOK_MASK = 326,                /* TOK_MASK  */
+    TOK_MAX = 327,                 /* TOK_MAX  */
+    TOK_MAXBURST = 328,            /* TOK_MAXBURST  */
+    TOK_MIN = 329,                 /* TOK_MIN  */
+    TOK_MINBURST = 330,            /* TOK_MINBURST  */
+    TOK_MPU = 331,                 /* TOK_MPU  */
+    TOK_MTU = 332,                 /* TOK_MTU  */
+    TOK_ORDER = 333,               /* TOK_ORDER  */
+    TOK_OVERFLOW = 334,            /* TOK_OVERFLOW  */
+    TOK_PASS_ON = 335,             /* TOK_PASS_ON  */
+    TOK_PEAKRATE = 336,            /* TOK_PEAKRATE  */
+    TOK_PERTURB = 337,             /* TOK_PERTURB  */
+    TOK_PRIOMAP = 338,             /* TOK_PRIOMAP  */
+    TOK_PROBABILITY = 339,         /* TOK_PROBABILITY  */
+    TOK_PROTOCOL = 340,            /* TOK_PROTOCOL  */
+    TOK_QUANTUM = 341,             /* TOK_QUANTUM  */
+    TOK_R2Q = 342,                 /* TOK_R2Q  */
+    TOK_RATE = 343,                /* TOK_RATE  */
+    TOK_SET_TC_INDEX = 344,        /* TOK_SET_TC_INDEX  */
+    TOK_SHIFT = 345,               /* TOK_SHIFT  */
+    TOK_SKIP = 346,                /* TOK_SKIP  */
+    TOK_SPORT = 347,               /* TOK_SPORT  */
+    TOK_SRC = 348,                 /* TOK_SRC  */
+    TOK_TO = 349,                  /* TOK_TO  */
+    TOK_VALUE = 350,               /* TOK_VALUE  */
+    TOK_WEIGHT = 351,              /* TOK_WEIGHT  */
+    SHIFT_RIGHT = 352,             /* SHIFT_RIGHT  */
+    SHIFT_LEFT = 353,              /* SHIFT_LEFT  */
+    LOGICAL_AND = 354,             /* LOGICAL_AND  */
+    LOGICAL_OR = 355,              /* LOGICAL_OR  */
+    REL_EQ = 356,                  /* REL_EQ  */
+    REL_NE = 357,                  /* REL_NE  */
+    REL_LE = 358,                  /* REL_LE  */
+    REL_GE = 359,                  /* REL_GE  */
+    UNUM = 360,                    /* UNUM  */
+    IPV4 = 361,                    /* IPV4  */
+    IPV6 = 362,                    /* IPV6  */
+    FNUM = 363,                    /* FNUM  */
+    WORD = 364,                    /* WORD  */
+    STRING = 365,                  /* STRING  */
+    VARIABLE = 366,                /* VARIABLE  */
+    FIELD_NAME = 367               /* FIELD_NAME  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
+#define TOK_WARN 258
+#define TOK_DEV 259
+#define TOK_QDISC 260
+#define TOK_CLASS 261
+#define TOK_FILTER 262
+#define TOK_ELEMENT 263
+#define TOK_TUNNEL 264
+#define TOK_ON 265
+#define TOK_POLICE 266
+#define TOK_BUCKET 267
+#define TOK_ELSE 268
+#define TOK_IF 269
+#define TOK_IF_ANCHOR 270
+#define TOK_HOST 271
+#define TOK_HOST4 272
+#define TOK_HOST6 273
+#define TOK_SPRINTF 274
+#define TOK_PRAGMA 275
+#define TOK_PASS 276
+#define TOK_RECLASSIFY 277
+#define TOK_CONTINUE 278
+#define TOK_FIELD 279
+#define TOK_TAG 280
+#define TOK_FIELD_ROOT 281
+#define TOK_CONFORM 282
+#define TOK_COUNT 283
+#define TOK_PRECOND 284
+#define TOK_DROP 285
+#define TOK_CBQ 286
+#define TOK_DSMARK 287
+#define TOK_FIFO 288
+#define TOK_GRED 289
+#define TOK_HTB 290
+#define TOK_PRIO 291
+#define TOK_RED 292
+#define TOK_SFQ 293
+#define TOK_TBF 294
+#define TOK_INGRESS 295
+#define TOK_EGRESS 296
+#define TOK_FW 297
+#define TOK_ROUTE 298
+#define TOK_RSVP 299
+#define TOK_TCINDEX 300
+#define TOK_AH 301
+#define TOK_ALLOT 302
+#define TOK_AVPKT 303
+#define TOK_BANDS 304
+#define TOK_BANDWIDTH 305
+#define TOK_BOUNDED 306
+#define TOK_BURST 307
+#define TOK_CBURST 308
+#define TOK_CEIL 309
+#define TOK_DEFAULT 310
+#define TOK_DEFAULT_INDEX 311
+#define TOK_DPORT 312
+#define TOK_DST 313
+#define TOK_ECN 314
+#define TOK_ESP 315
+#define TOK_EWMA 316
+#define TOK_FALL_THROUGH 317
+#define TOK_FROM 318
+#define TOK_FROMIF 319
+#define TOK_GRIO 320
+#define TOK_HASH 321
+#define TOK_INDICES 322
+#define TOK_ISOLATED 323
+#define TOK_IPPROTO 324
+#define TOK_LIMIT 325
+#define TOK_MASK 326
+#define TOK_MAX 327
+#define TOK_MAXBURST 328
+#define TOK_MIN 329
+#define TOK_MINBURST 330
+#define TOK_MPU 331
+#define TOK_MTU 332
+#define TOK_ORDER 333
+#define TOK_OVERFLOW 334
+#define TOK_PASS_ON 335
+#define TOK_PEAKRATE 336
+#define TOK_PERTURB 337
+#define TOK_PRIOMAP 338
+#define TOK_PROBABILITY 339
+#define TOK_PROTOCOL 340
+#define TOK_QUANTUM 341
+#define TOK_R2Q 342
+#define TOK_RATE 343
+#define TOK_SET_TC_INDEX 344
+#define TOK_SHIFT 345
+#define TOK_SKIP 346
+#define TOK_SPORT 347
+#define TOK_SRC 348
+#define TOK_TO 349
+#define TOK_VALUE 350
+#define TOK_WEIGHT 351
+#define SHIFT_RIGHT 352
+#define SHIFT_LEFT 353
+#define LOGICAL_AND 354
+#define LOGICAL_OR 355
+#define REL_EQ 356
+#define REL_NE 357
+#define REL_LE 358
+#define REL_GE 359
+#define UNUM 360
+#define IPV4 361
+#define IPV6 362
+#define FNUM 363
+#define WORD 364
+#define STRING 365
+#define VARIABLE 366
+#define FIELD_NAME 367
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 237 "tcng.y"
+
+    int unum;
+    U128 u128;
+    double fnum;
+    const char *str;
+    DATA data;
+    DATA_LIST *list;
+    VAR *var;
+    DEVICE *dev;
+    QDISC *qdisc;
+    QDISC_DSC *qddsc;
+    CLASS *class;
+    FILTER *filter;
+    FILTER_DSC *fdsc;
+    ELEMENT *element;
+    POLICE *police;
+    DECISION decis;
+    PARAM *param;
+    FIELD *field;
+    struct {
+	DATA b,c;
+    } mask;
+    LOCATION location; /* abuse for temporary variable */
+    PARENT parent; /* abuse for temporary variable */
+
+#line 317 "y.tab.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_Y_TAB_H_INCLUDED  */
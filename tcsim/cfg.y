@@ -78,7 +78,7 @@ static void bad_rate_unit(const char *unit)
 
 %token		TOK_DEV TOK_TC TOK_TIME TOK_SEND TOK_POLL TOK_EVERY TOK_UNTIL
 %token		TOK_END TOK_HOST TOK_CONNECT TOK_ROUTE TOK_NETMASK TOK_DEFAULT
-%token		TOK_INSMOD TOK_PRELOAD TOK_COMMAND TOK_ATTRIBUTE
+%token		TOK_INSMOD TOK_PRELOAD TOK_NETLINK TOK_COMMAND TOK_ATTRIBUTE
 %token		TOK_NL TOK_TCC TOK_ECHO SHIFT_RIGHT SHIFT_LEFT
 %token		TOK_NFMARK TOK_PRIORITY TOK_PROTOCOL TOK_TC_INDEX
 %token	<str>	TOK_WORD TOK_STRING ASSIGNMENT VARIABLE TOK_PRINTF_FORMAT
@@ -128,6 +128,11 @@ item:
 	    preload_tc_module($2);
 	    free($2);
 	}
+    | TOK_NETLINK TOK_WORD
+	{
+	    if (!check_only) netlink_replay($2);
+	    free($2);
+	}
     | TOK_TIME abs_time assignments
 	{
 	    if (terminating) yyerror("TIME after END");
@@ -109,6 +109,7 @@ int pseudo_netlink_to_kernel(const void *buf,int size)
 {
     struct sk_buff *skb;
 
+    netlink_record(buf,size);
     skb = alloc_skb(size,GFP_KERNEL);
     skb->tail += size;
     skb->len += size;
@@ -0,0 +1,189 @@
+/*
+ * nlfile.c - Record and replay rtnetlink messages
+ */
+
+/*
+ * A netlink file contains the traffic control configuration as the rtnetlink
+ * messages tc sent to the kernel. It begins with the 4 bytes "TCNL", followed
+ * by the format version (a 32 bit integer in host byte order). Then, for each
+ * message, there is the name of the interface (IFNAMSIZ bytes, zero-padded),
+ * followed by the message itself, padded to NLMSG_ALIGN. Interface indices
+ * differ between systems, so the tcm_ifindex of each message is set from the
+ * interface name when loading the file.
+ *
+ * Only messages adding, changing, or deleting qdiscs, classes, or filters are
+ * recorded.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tckernel.h"
+
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include <memutil.h>
+
+#include "tcsim.h"
+
+
+#define NLFILE_MAGIC	"TCNL"
+#define NLFILE_VERSION	1
+
+
+static FILE *record = NULL;
+static const char *record_name;
+
+
+static int is_tc_msg(const struct nlmsghdr *h)
+{
+    switch (h->nlmsg_type) {
+	case RTM_NEWQDISC:
+	case RTM_DELQDISC:
+	case RTM_NEWTCLASS:
+	case RTM_DELTCLASS:
+	case RTM_NEWTFILTER:
+	case RTM_DELTFILTER:
+	    return h->nlmsg_len >= NLMSG_LENGTH(sizeof(struct tcmsg));
+	default:
+	    return 0;
+    }
+}
+
+
+static void record_write(const void *buf,size_t size)
+{
+    if (fwrite(buf,1,size,record) != size) {
+	perror(record_name);
+	exit(1);
+    }
+}
+
+
+void netlink_record_open(const char *name)
+{
+    uint32_t version = NLFILE_VERSION;
+
+    record_name = name;
+    record = fopen(name,"w");
+    if (!record) {
+	perror(name);
+	exit(1);
+    }
+    record_write(NLFILE_MAGIC,4);
+    record_write(&version,sizeof(version));
+}
+
+
+void netlink_record(const void *buf,int size)
+{
+    const struct nlmsghdr *h;
+
+    if (!record) return;
+    for (h = buf; NLMSG_OK(h,size); h = NLMSG_NEXT(h,size)) {
+	static const char pad[NLMSG_ALIGNTO];
+	const struct tcmsg *tcm = NLMSG_DATA(h);
+	const struct net_device *dev;
+	char name[IFNAMSIZ];
+
+	if (!is_tc_msg(h)) continue;
+	dev = dev_get_by_index(tcm->tcm_ifindex);
+	if (!dev) errorf("netlink message for unknown interface index %d",
+	      tcm->tcm_ifindex);
+	memset(name,0,IFNAMSIZ);
+	strncpy(name,dev->name,IFNAMSIZ-1);
+	record_write(name,IFNAMSIZ);
+	record_write(h,h->nlmsg_len);
+	record_write(pad,NLMSG_ALIGN(h->nlmsg_len)-h->nlmsg_len);
+    }
+}
+
+
+void netlink_record_close(void)
+{
+    if (!record) return;
+    if (fclose(record) == EOF) {
+	perror(record_name);
+	exit(1);
+    }
+    record = NULL;
+}
+
+
+/*
+ * We feed the messages directly to the kernel, without going through tc.
+ * Errors are reported like tc would.
+ */
+
+static void check_replies(const char *name)
+{
+    char buf[8192];
+    int len;
+
+    while ((len = pseudo_netlink_from_kernel(buf,sizeof(buf))) > 0) {
+	const struct nlmsghdr *h;
+
+	for (h = (struct nlmsghdr *) buf; NLMSG_OK(h,len);
+	  h = NLMSG_NEXT(h,len)) {
+	    const struct nlmsgerr *err = NLMSG_DATA(h);
+
+	    if (h->nlmsg_type == NLMSG_ERROR && err->error)
+		errorf("%s: RTNETLINK answers: %s",name,strerror(-err->error));
+	}
+    }
+}
+
+
+void netlink_replay(const char *name)
+{
+    FILE *file;
+    char magic[4];
+    uint32_t version;
+    char dev_name[IFNAMSIZ];
+    struct nlmsghdr hdr;
+
+    file = fopen(name,"r");
+    if (!file) {
+	perror(name);
+	exit(1);
+    }
+    if (fread(magic,1,4,file) != 4 || memcmp(magic,NLFILE_MAGIC,4) ||
+      fread(&version,sizeof(version),1,file) != 1)
+	errorf("%s: not a netlink file",name);
+    if (version != NLFILE_VERSION)
+	errorf("%s: unsupported version %u",name,(unsigned) version);
+    while (fread(dev_name,1,IFNAMSIZ,file) == IFNAMSIZ) {
+	const struct net_device *dev;
+	struct nlmsghdr *h;
+	struct tcmsg *tcm;
+
+	if (fread(&hdr,sizeof(hdr),1,file) != 1 ||
+	  hdr.nlmsg_len < NLMSG_LENGTH(sizeof(struct tcmsg)))
+	    errorf("%s: truncated or invalid message",name);
+	h = alloc(NLMSG_ALIGN(hdr.nlmsg_len));
+	*h = hdr;
+	if (fread(h+1,1,NLMSG_ALIGN(hdr.nlmsg_len)-sizeof(hdr),file) !=
+	  NLMSG_ALIGN(hdr.nlmsg_len)-sizeof(hdr))
+	    errorf("%s: truncated message",name);
+	dev_name[IFNAMSIZ-1] = 0;
+	dev = lookup_net_device(dev_name);
+	if (!dev) errorf("%s: unknown interface \"%s\"",name,dev_name);
+	tcm = NLMSG_DATA(h);
+	tcm->tcm_ifindex = dev->ifindex;
+	if (verbose > 0) {
+	    print_time(now);
+	    printf(" T : netlink %s %d bytes\n",dev_name,(int) h->nlmsg_len);
+	}
+	(void) pseudo_netlink_to_kernel(h,h->nlmsg_len);
+	free(h);
+	check_replies(name);
+    }
+    if (ferror(file)) {
+	perror(name);
+	exit(1);
+    }
+    (void) fclose(file);
+}
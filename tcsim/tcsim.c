@@ -244,7 +244,7 @@ static void finish_cpp(void)
 static void usage(const char *name)
 {
     fprintf(stderr,"usage: %s [-c] [-d [-d]] [-g] [-j] [-k number] [-n] [-p] "
-      "[-q]\n",name);
+      "[-q] [-w file]\n",name);
     fprintf(stderr,"%12s [-s snap_len] [-v ...] [-Xphase,arg] "
       "[cpp_option ...] [file]\n","");
     fprintf(stderr,"%6s %s -V\n\n","",name);
@@ -266,6 +266,7 @@ static void usage(const char *name)
     fprintf(stderr,"  -v -v        also trace function invocation\n");
     fprintf(stderr,"  -v -v -v     also trace internal element state\n");
     fprintf(stderr,"  -V           print version number and exit\n");
+    fprintf(stderr,"  -w file      write rtnetlink messages to file\n");
     fprintf(stderr,"  -Xphase,arg  verbatim argument for specific build "
       "phase\n");
     fprintf(stderr,"               phases: c=tcc, P=cpp (tcsim), p=cpp (tcc), "
@@ -313,7 +314,7 @@ int main(int argc,char *const *argv)
       tcng_topdir ? tcng_topdir : DATA_DIR);
     if (tcng_topdir) tcc_cmd = alloc_sprintf("%s/bin/tcng",tcng_topdir);
     cpp_argv[cpp_argc++] = alloc_sprintf("-I%s",include); /* @@@ leak */
-    while ((c = getopt(argc,argv,"cdgjhk:npqs:vD:U:I:VX:")) != EOF)
+    while ((c = getopt(argc,argv,"cdgjhk:npqs:vw:D:U:I:VX:")) != EOF)
 	switch (c) {
 	    case 'c':
 		check_only = 1;
@@ -352,6 +353,9 @@ int main(int argc,char *const *argv)
 		if (verbose < 0) usage(argv[0]);
 		verbose++;
 		break;
+	    case 'w':
+		netlink_record_open(optarg);
+		break;
 	    case ':':
 		usage(argv[0]);
 	    case 'V':
@@ -398,5 +402,6 @@ int main(int argc,char *const *argv)
     run_cpp(cpp_argc,cpp_argv);
     (void) yyparse();
     finish_cpp();
+    netlink_record_close();
     return 0;
 }
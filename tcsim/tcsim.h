@@ -36,6 +36,10 @@ extern int check_only;
 int pseudo_netlink_to_kernel(const void *buf,int size);
 int pseudo_netlink_from_kernel(void *buf,int len);
 int tc_main(int argc,char **argv);
+void netlink_record_open(const char *name);
+void netlink_record(const void *buf,int size);
+void netlink_record_close(void);
+void netlink_replay(const char *name);
 int kernel_enqueue(struct net_device *dev,void *buf,int size,
   struct attributes attr);
 void kernel_poll(struct net_device *dev,int unbusy);
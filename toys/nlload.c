@@ -0,0 +1,161 @@
+/*
+ * nlload.c - Load a netlink file written by tcsim -w into the kernel
+ *
+ * Build with: cc -o nlload nlload.c
+ *
+ * Usage: nlload file
+ *
+ * All messages are sent with as few sendmsg calls as the socket buffer
+ * allows, and then all the acknowledgements are collected. The interface
+ * index of each message is set from the interface name stored in the file.
+ * See tcsim/nlfile.c for the file format.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+
+#define BATCH	65536	/* bytes per sendmsg */
+
+
+static int fd;
+static unsigned pending = 0,errors = 0;
+
+
+static void collect_acks(void)
+{
+    char buf[8192];
+
+    while (pending) {
+	struct nlmsghdr *h;
+	int len;
+
+	len = recv(fd,buf,sizeof(buf),0);
+	if (len < 0) {
+	    perror("recv");
+	    exit(1);
+	}
+	for (h = (struct nlmsghdr *) buf; NLMSG_OK(h,len);
+	  h = NLMSG_NEXT(h,len)) {
+	    const struct nlmsgerr *err = NLMSG_DATA(h);
+
+	    if (h->nlmsg_type != NLMSG_ERROR) continue;
+	    pending--;
+	    if (err->error) {
+		fprintf(stderr,"message %u: RTNETLINK answers: %s\n",
+		  err->msg.nlmsg_seq,strerror(-err->error));
+		errors++;
+	    }
+	}
+    }
+}
+
+
+static void send_batch(void *buf,size_t len)
+{
+    struct sockaddr_nl nladdr;
+    struct iovec iov = { buf, len };
+    struct msghdr msg = {
+	.msg_name = &nladdr,
+	.msg_namelen = sizeof(nladdr),
+	.msg_iov = &iov,
+	.msg_iovlen = 1,
+    };
+
+    memset(&nladdr,0,sizeof(nladdr));
+    nladdr.nl_family = AF_NETLINK;
+    if (sendmsg(fd,&msg,0) < 0) {
+	perror("sendmsg");
+	exit(1);
+    }
+    collect_acks();
+}
+
+
+int main(int argc,char **argv)
+{
+    FILE *file;
+    struct stat st;
+    char *data,*p,*end,*batch;
+    size_t batch_len = 0;
+    unsigned seq = 0;
+
+    if (argc != 2) {
+	fprintf(stderr,"usage: %s file\n",argv[0]);
+	return 1;
+    }
+    file = fopen(argv[1],"r");
+    if (!file || fstat(fileno(file),&st) < 0) {
+	perror(argv[1]);
+	return 1;
+    }
+    data = malloc(st.st_size);
+    batch = malloc(BATCH);
+    if (!data || !batch) {
+	perror("malloc");
+	return 1;
+    }
+    if (fread(data,1,st.st_size,file) != (size_t) st.st_size) {
+	perror(argv[1]);
+	return 1;
+    }
+    (void) fclose(file);
+    if (st.st_size < 8 || memcmp(data,"TCNL",4) ||
+      *(uint32_t *) (data+4) != 1) {
+	fprintf(stderr,"%s: not a netlink file (version 1)\n",argv[1]);
+	return 1;
+    }
+    fd = socket(AF_NETLINK,SOCK_RAW,NETLINK_ROUTE);
+    if (fd < 0) {
+	perror("socket");
+	return 1;
+    }
+    end = data+st.st_size;
+    for (p = data+8; p < end; ) {
+	struct nlmsghdr *h = (struct nlmsghdr *) (p+IFNAMSIZ);
+	struct tcmsg *tcm = NLMSG_DATA(h);
+	size_t len;
+
+	if (p+IFNAMSIZ+sizeof(*h) > end ||
+	  h->nlmsg_len < NLMSG_LENGTH(sizeof(*tcm)) ||
+	  p+IFNAMSIZ+NLMSG_ALIGN(h->nlmsg_len) > end) {
+	    fprintf(stderr,"%s: truncated or invalid message\n",argv[1]);
+	    return 1;
+	}
+	p[IFNAMSIZ-1] = 0;
+	tcm->tcm_ifindex = if_nametoindex(p);
+	if (!tcm->tcm_ifindex) {
+	    fprintf(stderr,"%s: unknown interface\n",p);
+	    return 1;
+	}
+	h->nlmsg_flags |= NLM_F_ACK;
+	h->nlmsg_seq = ++seq;
+	len = NLMSG_ALIGN(h->nlmsg_len);
+	if (batch_len && batch_len+len > BATCH) {
+	    send_batch(batch,batch_len);
+	    batch_len = 0;
+	}
+	pending++;
+	if (len > BATCH) send_batch(h,len);
+	else {
+	    memcpy(batch+batch_len,h,len);
+	    batch_len += len;
+	}
+	p += IFNAMSIZ+len;
+    }
+    if (batch_len) send_batch(batch,batch_len);
+    fprintf(stderr,"%u message%s, %u error%s\n",seq,seq == 1 ? "" : "s",
+      errors,errors == 1 ? "" : "s");
+    return !!errors;
+}